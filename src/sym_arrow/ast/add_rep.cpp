@@ -31,6 +31,8 @@ namespace sd = sym_arrow :: details;
 
 add_rep::~add_rep()
 {
+    expr_order::remove_node();
+
     for (size_t i = 0; i < m_size + 1; ++i)
         m_data[i].~value_expr();
 
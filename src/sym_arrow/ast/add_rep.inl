@@ -22,6 +22,7 @@
 
 #include "sym_arrow/ast/add_rep.h"
 #include "sym_arrow/exception.h"
+#include "sym_arrow/ast/helpers/expr_order.h"
 
 namespace sym_arrow { namespace ast
 {
@@ -31,6 +32,8 @@ add_rep::add_rep(const add_rep_info<item_type>& pi)
     :base_type(this), m_hash(pi.m_hash_add)
     ,m_size(pi.n), m_data(nullptr)
 {
+    expr_order::add_node();
+
     using context_type  = sym_dag::dag_context<term_tag>;
     context_type& c     = context_type::get();
 
@@ -75,13 +78,13 @@ size_t add_rep::eval_hash(const add_rep_info<item_type>& pi)
     for (size_t i = 0; i < pi.n; ++i)
     {
         boost::hash_combine(seed,pi.elems[i].get_value().hash_value());
-        boost::hash_combine(seed,pi.elems[i].get_expr_handle());
+        boost::hash_combine(seed, expr_order::hash(pi.elems[i].get_expr_handle()));
     };
 
     if (pi.log_expr == nullptr)
         boost::hash_combine(seed, expr_handle());
     else
-        boost::hash_combine(seed, pi.log_expr->get_expr_handle());
+        boost::hash_combine(seed, expr_order::hash(pi.log_expr->get_expr_handle()));
 
     pi.m_hash_add = seed;
     return seed;
@@ -39,6 +39,10 @@ struct ast_flags
 
     // temporary flag
     static const size_t work        = 2;
+
+    // flag marking cannonized nodes processed by common subexpression
+    // elimination
+    static const size_t cse_done    = 3;
 };
 
 }};
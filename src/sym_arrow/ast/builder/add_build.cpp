@@ -96,7 +96,7 @@ void add_build::insert_elem(const value& scal, expr_handle expr)
             return;
         };
 
-        sym_arrow::expr tmp = cannonize().make_mult(mb, do_cse_default);
+        sym_arrow::expr tmp = cannonize().make_mult(mb, cannonize::do_cse_lazy());
         
         expr_handle be(tmp.get_ptr().get());
         return insert_elem(scal, be);
@@ -162,13 +162,13 @@ void add_build::insert_log_elem(expr_handle expr)
         case (size_t)term_types::mult_build:
         {
             const mult_build* mb= expr->static_cast_to<mult_build>();
-            sym_arrow::expr tmp  = cannonize().make_mult(mb, do_cse_default);
+            sym_arrow::expr tmp  = cannonize().make_mult(mb, cannonize::do_cse_lazy());
             return insert_log_elem(tmp.get_ptr().get());
         }
         case (size_t)term_types::add_build:
         {
             const add_build* ab = expr->static_cast_to<add_build>();
-            sym_arrow::expr tmp  = cannonize().make_add(ab, do_cse_default);       
+            sym_arrow::expr tmp  = cannonize().make_add(ab, cannonize::do_cse_lazy());
             return insert_log_elem(tmp.get_ptr().get());
         }
         default:
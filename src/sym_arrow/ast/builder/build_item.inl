@@ -21,6 +21,7 @@
 #pragma once
 
 #include "sym_arrow/ast/builder/build_item.h"
+#include "sym_arrow/ast/helpers/expr_order.h"
 
 namespace sym_arrow { namespace ast
 {
@@ -116,7 +117,7 @@ inline bool build_item<Value_type>::is_special() const
 template<class Value_type>
 inline bool build_item<Value_type>::compare(const build_item& b) const
 {
-    return this->m_expr < b.m_expr;
+    return expr_order::less(this->m_expr.get(), b.m_expr.get());
 };
 
 //-------------------------------------------------------------------
@@ -142,7 +143,7 @@ inline bool build_item_handle<Value_type>::is_special() const
 template<class Value_type>
 inline bool build_item_handle<Value_type>::compare(const build_item_handle& b) const
 {
-    return this->m_expr < b.m_expr;
+    return expr_order::less(this->m_expr, b.m_expr);
 }
 
 };};
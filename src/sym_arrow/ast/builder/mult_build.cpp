@@ -164,7 +164,7 @@ void mult_build::insert_ielem(int vpow, expr_handle expr)
         };
 
         value scal = value::make_one();
-        sym_arrow::expr tmp = cannonize().make_normalize(ab, scal, do_cse_default);
+        sym_arrow::expr tmp = cannonize().make_normalize(ab, scal, cannonize::do_cse_lazy());
 
         expr_handle be(tmp.get_ptr().get());
 
@@ -219,7 +219,7 @@ void mult_build::insert_relem(const value& pow, expr_handle expr)
         };
 
         value scal          = value::make_one();
-        sym_arrow::expr tmp  = cannonize().make_normalize(ab, scal, do_cse_default);
+        sym_arrow::expr tmp  = cannonize().make_normalize(ab, scal, cannonize::do_cse_lazy());
 
         expr_handle be(tmp.get_ptr().get());
 
@@ -326,7 +326,7 @@ void mult_build::insert_elem_exp(expr_handle expr)
         case (size_t)term_types::mult_build:
         {
             const mult_build* mb  = expr->static_cast_to<mult_build>();
-            sym_arrow::expr tmp = cannonize().make_mult(mb, do_cse_default);
+            sym_arrow::expr tmp = cannonize().make_mult(mb, cannonize::do_cse_lazy());
         
             expr_handle be(tmp.get_ptr().get());
             return insert_elem_exp(be);
@@ -334,7 +334,7 @@ void mult_build::insert_elem_exp(expr_handle expr)
         case (size_t)term_types::add_build:
         {
             const add_build* ab  = expr->static_cast_to<add_build>();
-            sym_arrow::expr tmp = cannonize().make_add(ab, do_cse_default);
+            sym_arrow::expr tmp = cannonize().make_add(ab, cannonize::do_cse_lazy());
         
             expr_handle be(tmp.get_ptr().get());
             return insert_elem_exp(be);
@@ -31,7 +31,11 @@ branch_predictor::branch_predictor()
 {};
 
 branch_predictor::branch_predictor(int tag)
-    :m_tag(tag)
+    :branch_predictor(tag, 0.995)
+{};
+
+branch_predictor::branch_predictor(int tag, double variance_scal)
+    :m_variance_scal(variance_scal), m_tag(tag)
 {
     initialize_priors();
     initialize_state();
@@ -106,7 +110,7 @@ double branch_predictor::get_prior_mean(bool obs, const bool* lags,
 
 SYM_ARROW_FORCE_INLINE
 void branch_predictor::update_dirichler_prior(bool obs, const bool* lags, 
-                double* prior_table_root)
+                double* prior_table_root, double variance_scal)
 {
     double* table;
 
@@ -142,7 +146,7 @@ void branch_predictor::add_observation(bool obs, bool pred)
     m_predictions       += 1.0;
 
     // update prior
-    update_dirichler_prior(obs, m_lags, m_prior_table);
+    update_dirichler_prior(obs, m_lags, m_prior_table, m_variance_scal);
           
     // update state
     update_lags(m_lags, obs);
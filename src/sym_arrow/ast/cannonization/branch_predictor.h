@@ -30,9 +30,6 @@ namespace sym_arrow { namespace ast
 // predict realization of boolean variable
 class branch_predictor
 {
-    private:
-        static constexpr double variance_scal   = 0.995;
-
     private:
         static const int n_lags     = 5;
         static const int data_size  = 0;
@@ -44,6 +41,7 @@ class branch_predictor
 
         double          m_pred_error;
         double          m_predictions;
+        double          m_variance_scal;
         int             m_tag;
 
     public:
@@ -51,6 +49,10 @@ class branch_predictor
 
         branch_predictor(int tag);
 
+        // variance_scal determines rate at which old observations are
+        // forgotten
+        branch_predictor(int tag, double variance_scal);
+
         // get prediction of the binary variable; before calling this
         // function again add_observation must be called
         bool            get_prediction();
@@ -72,7 +74,7 @@ class branch_predictor
 
         static size_t   get_prior_offset(const bool* lags);
         static void     update_dirichler_prior(bool obs, const bool* lags, 
-                            double* prior_table);
+                            double* prior_table, double variance_scal);
         static double   get_prior_mean(bool obs, const bool* lags, 
                             const double* prior_table);
 };
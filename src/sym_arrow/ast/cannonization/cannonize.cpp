@@ -20,6 +20,7 @@
 
 #include "sym_arrow/ast/cannonization/cannonize.h"
 #include "sym_arrow/ast/builder/add_build.h"
+#include "sym_arrow/ast/builder/mult_build.h"
 
 #include "sym_arrow/ast/cannonization/item_collector.inl"
 #include "sym_arrow/ast/cannonization/simplifier.inl"
@@ -28,13 +29,25 @@
 #include "sym_arrow/ast/ast.h"
 #include "sym_arrow/func/compound.h"
 #include "sym_arrow/ast/cannonization/cse_hash.h"
+#include "sym_arrow/ast/cannonization/cse_budget.h"
 
 #include "sym_arrow/ast/cannonization/subexpr_collector.h"
 #include "dag/details/vector_provider.h"
 
+#include <chrono>
+
 namespace sym_arrow { namespace ast
 {
 
+using clock_type    = std::chrono::steady_clock;
+using time_point    = clock_type::time_point;
+
+// time in seconds elapsed from t0
+static double elapsed_time(const time_point& t0)
+{
+    return std::chrono::duration<double>(clock_type::now() - t0).count();
+};
+
 //-------------------------------------------------------------------
 //                  cannonize
 //-------------------------------------------------------------------
@@ -133,34 +146,186 @@ expr cannonize::make(const expr& ex, bool do_cse)
     };
 };
 
+expr cannonize::make(const expr& ex, const cse_policy& policy, cse_report& report)
+{
+    cse_budget budget(policy);
+    expr ret    = make(ex, true);
+    report      = budget.get_report();
+
+    return ret;
+};
+
 expr cannonize::make_cse(const expr& ex)
 {    
-    if (!ex.get_ptr())
-        return ex;
+    // subexpressions cannonized without cse can be nested at any depth
+    // (for example sums in products or in function arguments); the light
+    // form is created first and cse is performed bottom-up on all nodes
+    // not processed before, which gives the same result as cannonization
+    // with cse of the whole expression
+    expr ret    = make(ex, false);
+
+    if (!ret.get_ptr())
+        return ret;
 
-    switch (ex.get_ptr()->get_code())
+    cse_map done;
+    return make_cse_impl(ret.get_ptr().get(), done);
+};
+
+expr cannonize::make_cse_impl(expr_handle h, cse_map& done)
+{
+    if (is_cse_done(h) == true)
+        return expr(expr_ptr::from_this(h));
+
+    auto pos    = done.find(h);
+
+    if (pos != done.end())
+        return pos->second;
+
+    expr ret;
+
+    switch (h->get_code())
     {
-        case (size_t)term_types::add_build:
-        {
-            const add_build* ab = ex.get_ptr()->static_cast_to<add_build>();        
-            return make_add(ab, true);
-        }
-        case (size_t)term_types::mult_build:
-        {
-            const mult_build* ab = ex.get_ptr()->static_cast_to<mult_build>();
-            return make_mult(ab, true);
-        }
         case (size_t)term_types::add_rep:
-        {
-            const add_rep* ab   = ex.get_ptr()->static_cast_to<add_rep>();
-            expr ret            = make_add_impl(ab);
-            return ret;
-        }
+            ret = make_cse_impl(h->static_cast_to<add_rep>(), done);
+            break;
+        case (size_t)term_types::mult_rep:
+            ret = make_cse_impl(h->static_cast_to<mult_rep>(), done);
+            break;
+        case (size_t)term_types::function_rep:
+            ret = make_cse_impl(h->static_cast_to<function_rep>(), done);
+            break;
         default:
-        {
-            return ex;
-        }
+            assertion(0,"unexpected expression");
+            throw;
+    };
+
+    // result truncated by a cse budget is not final
+    if (cse_budget::is_complete() == true)
+        set_cse_done(ret);
+
+    done.insert(cse_map::value_type(h, ret));
+
+    return ret;
+};
+
+expr cannonize::make_cse_impl(const add_rep* h, cse_map& done)
+{
+    using item          = build_item<value>;
+
+    size_t n            = h->size();
+    bool modified       = false;
+
+    std::vector<item> items;
+    items.reserve(n);
+
+    for (size_t i = 0; i < n; ++i)
+    {
+        expr tmp        = make_cse_impl(h->E(i), done);
+        modified        |= tmp.get_ptr().get() != h->E(i);
+
+        items.push_back(item(h->V(i), std::move(tmp)));
+    };
+
+    expr log_term;
+
+    if (h->has_log() == true)
+    {
+        log_term        = make_cse_impl(h->Log(), done);
+        modified        |= log_term.get_ptr().get() != h->Log();
     };
+
+    if (modified == false)
+        return make_add_impl(h);
+
+    expr_ptr ret;
+
+    if (log_term.is_null() == true)
+    {
+        add_build_info2<item> bi(h->V0(), n, items.data(), nullptr);
+        ret             = add_build::make(bi);
+    }
+    else
+    {
+        item log_it     = item(value::make_one(), std::move(log_term));
+
+        add_build_info2<item> bi(h->V0(), n, items.data(), &log_it);
+        ret             = add_build::make(bi);
+    };
+
+    return make(expr(std::move(ret)), true);
+};
+
+expr cannonize::make_cse_impl(const mult_rep* h, cse_map& done)
+{
+    using iitem         = build_item<int>;
+    using ritem         = build_item<value>;
+
+    size_t in           = h->isize();
+    size_t rn           = h->rsize();
+    bool modified       = false;
+
+    std::vector<iitem> iitems;
+    std::vector<ritem> ritems;
+    iitems.reserve(in);
+    ritems.reserve(rn);
+
+    for (size_t i = 0; i < in; ++i)
+    {
+        expr tmp        = make_cse_impl(h->IE(i), done);
+        modified        |= tmp.get_ptr().get() != h->IE(i);
+
+        iitems.push_back(iitem(h->IV(i), std::move(tmp)));
+    };
+
+    for (size_t i = 0; i < rn; ++i)
+    {
+        expr tmp        = make_cse_impl(h->RE(i), done);
+        modified        |= tmp.get_ptr().get() != h->RE(i);
+
+        ritems.push_back(ritem(h->RV(i), std::move(tmp)));
+    };
+
+    expr exp_term;
+
+    if (h->has_exp() == true)
+    {
+        exp_term        = make_cse_impl(h->Exp(), done);
+        modified        |= exp_term.get_ptr().get() != h->Exp();
+    };
+
+    // cse is performed only on sums; products of processed terms
+    // need not be rebuilt
+    if (modified == false)
+        return expr(expr_ptr::from_this(h));
+
+    expr_handle ex_h    = exp_term.is_null() ? nullptr : exp_term.get_ptr().get();
+
+    mult_build_info<iitem, ritem> bi(in, iitems.data(), rn, ritems.data(), ex_h);
+
+    return make(expr(mult_build::make(bi)), true);
+};
+
+expr cannonize::make_cse_impl(const function_rep* h, cse_map& done)
+{
+    size_t n            = h->size();
+    bool modified       = false;
+
+    std::vector<expr> args;
+    args.reserve(n);
+
+    for (size_t i = 0; i < n; ++i)
+    {
+        expr tmp        = make_cse_impl(h->arg(i), done);
+        modified        |= tmp.get_ptr().get() != h->arg(i);
+
+        args.push_back(std::move(tmp));
+    };
+
+    if (modified == false)
+        return expr(expr_ptr::from_this(h));
+
+    function_rep_info bi(h->name(), n, args.data());
+    return expr(function_rep::make(bi));
 };
 
 
@@ -184,6 +349,68 @@ bool cannonize::is_cannonized(const expr& ex) const
     return is_cannonized(ex.get_ptr().get());
 };
 
+bool cannonize::is_cse_done(const expr& ex) const
+{
+    if (!ex.get_ptr())
+        return true;
+
+    return is_cse_done(ex.get_ptr().get());
+};
+
+bool cannonize::is_cse_done(expr_handle h) const
+{
+    switch (h->get_code())
+    {
+        case (size_t)term_types::scalar:
+        case (size_t)term_types::symbol:
+            return true;
+        case (size_t)term_types::add_build:
+        case (size_t)term_types::mult_build:
+            return false;
+        default:
+            return h->get_user_flag<ast_flags::cse_done>();
+    };
+};
+
+void cannonize::set_cse_done(const expr& ex) const
+{
+    if (!ex.get_ptr())
+        return;
+
+    expr_handle h   = ex.get_ptr().get();
+
+    if (is_cannonized(h) == true)
+        h->set_user_flag<ast_flags::cse_done>(true);
+};
+
+cannonize_level cannonize::get_level(const expr& ex) const
+{
+    if (is_cannonized(ex) == false)
+        return cannonize_level::none;
+
+    if (is_cse_done(ex) == true)
+        return cannonize_level::full;
+    else
+        return cannonize_level::light;
+};
+
+static bool g_lazy  = false;
+
+bool cannonize::is_lazy()
+{
+    return g_lazy;
+};
+
+void cannonize::set_lazy(bool val)
+{
+    g_lazy  = val;
+};
+
+bool cannonize::do_cse_lazy()
+{
+    return (g_lazy == true) ? false : do_cse_default;
+};
+
 expr cannonize::make_add(const add_build* h, bool do_cse)
 {
     value scal  = value::make_one();
@@ -195,11 +422,22 @@ expr cannonize::make_mult(const mult_build* h, bool do_cse)
 {
     expr ret = h->get_cannonized();
     
-    if (ret.is_null() == false)
+    // result cannonized without cse cannot be reused when cse is requested
+    if (ret.is_null() == false && (do_cse == false || is_cse_done(ret) == true))
         return ret;
 
     ret = make_mult_impl(h, do_cse);
-    h->set_cannonized(ret);
+
+    // result truncated by a cse budget is not stored on the shared build
+    // node and is not marked as fully cannonized; otherwise later unlimited
+    // cannonization would reuse it
+    if (do_cse == false || cse_budget::is_complete() == true)
+    {
+        h->set_cannonized(ret);
+
+        if (do_cse == true)
+            set_cse_done(ret);
+    };
 
     return ret;
 };
@@ -208,11 +446,20 @@ expr cannonize::make_normalize(const add_build* h, value& scal, bool do_cse)
 {
     expr ret = h->get_cannonized(scal);
     
-    if (ret.is_null() == false)
+    // result cannonized without cse cannot be reused when cse is requested
+    if (ret.is_null() == false && (do_cse == false || is_cse_done(ret) == true))
         return ret;
 
-    ret = make_add_impl(h, scal, true, do_cse);
-    h->set_cannonized(ret, scal);
+    scal    = value::make_one();
+    ret     = make_add_impl(h, scal, true, do_cse);
+
+    if (do_cse == false || cse_budget::is_complete() == true)
+    {
+        h->set_cannonized(ret, scal);
+
+        if (do_cse == true)
+            set_cse_done(ret);
+    };
 
     return ret;
 };
@@ -282,16 +529,21 @@ expr cannonize::process_add(size_t n, item_collector_add& ic, value& ret_scal,
     value scal_test;
     bool check_hash     = false;
     cse_hash& hashed    = cse_hash::get();
+    cse_observation obs = cse_observation();
+    time_point t_start;
 
     if (normalize == true)
     {
         check_hash      = hashed.check_hash();
+        obs.m_checked   = check_hash;
 
         if (check_hash == true)
         {
             expr ex_simpl;
             value simpl_norm;
 
+            t_start         = clock_type::now();
+
             ex_test         = finalize_add(ic, n, scal_test, true, false);
             size_t refcount = ex_test.get_expr_handle()->refcount();
             bool succ       = false;
@@ -303,9 +555,13 @@ expr cannonize::process_add(size_t n, item_collector_add& ic, value& ret_scal,
                                 simpl_norm, ex_simpl);
             }            
 
+            obs.m_lookup_time   = elapsed_time(t_start);
+
             if (succ == true)
             {
-                hashed.add_observation(succ, check_hash);
+                obs.m_hit           = true;
+                obs.m_factorized    = true;
+                hashed.add_observation(obs);
 
                 ret_scal    = simpl_norm * scal_test;
                 return ex_simpl;
@@ -314,9 +570,16 @@ expr cannonize::process_add(size_t n, item_collector_add& ic, value& ret_scal,
     };
 
     bool factorized     = false;
+    cse_budget* budget  = cse_budget::get();
+
+    if (normalize == true)
+        t_start         = clock_type::now();
 
-    for (;;)
+    for (size_t round = 0;; ++round)
     {
+        if (budget != nullptr && budget->start_round(round) == false)
+            break;
+
         expr fact;
         value scal;
 
@@ -337,7 +600,9 @@ expr cannonize::process_add(size_t n, item_collector_add& ic, value& ret_scal,
 
     if (normalize == true)
     {
-        hashed.add_observation(factorized, check_hash);
+        obs.m_factorized    = factorized;
+        obs.m_fact_time     = elapsed_time(t_start);
+        hashed.add_observation(obs);
 
         if (factorized == false && check_hash == true)
         {
@@ -350,7 +615,8 @@ expr cannonize::process_add(size_t n, item_collector_add& ic, value& ret_scal,
 
     expr ret    = finalize_add(ic, n, ret_scal, normalize, true);
 
-    if (factorized == true && check_hash == true)
+    // results obtained with limited budget are not hashed
+    if (factorized == true && check_hash == true && budget == nullptr)
     {
         // add factorization result to hash table; rescale 
         // normalization constant as if normalized expr was factorized
@@ -1174,3 +1440,23 @@ expr cannonize::make_exp_mult_rep(const expr& ex_exp) const
 };
 
 };};
+
+namespace sym_arrow
+{
+
+void sym_arrow::set_lazy_cannonization(bool val)
+{
+    ast::cannonize::set_lazy(val);
+};
+
+bool sym_arrow::get_lazy_cannonization()
+{
+    return ast::cannonize::is_lazy();
+};
+
+cannonize_level sym_arrow::get_cannonize_level(const expr& ex)
+{
+    return ast::cannonize().get_level(ex);
+};
+
+};
@@ -22,6 +22,9 @@
 
 #include "sym_arrow/nodes/expr.h"
 #include "sym_arrow/ast/builder/build_item.h"
+#include "sym_arrow/functions/lazy_cannonize.h"
+
+#include <unordered_map>
 
 namespace sym_arrow { namespace ast
 {
@@ -34,6 +37,7 @@ class cannonize
         using collect_stack_type    = std::vector<aab_value>;
         using add_item_handle       = build_item_handle<value>;
         using expr_stack            = std::vector<expr>;
+        using cse_map               = std::unordered_map<expr_handle, expr>;
 
     private:
         expr_stack*                 m_expr_stack;
@@ -50,7 +54,13 @@ class cannonize
         expr            make(const expr& ex, bool do_cse);
 
         // cannonize expression and perform common subexpression elimination
-        // even for cannonized add terms
+        // limited by a policy; summary of the elimination is stored in report
+        expr            make(const expr& ex, const cse_policy& policy, 
+                            cse_report& report);
+
+        // cannonize expression and perform common subexpression elimination
+        // for all subexpressions, also for subexpressions cannonized before
+        // without common subexpression elimination
         expr            make_cse(const expr& ex);
 
         // cannonize mult build 
@@ -84,6 +94,29 @@ class cannonize
         bool            is_cannonized(const expr& ex) const;
         bool            is_cannonized(expr_handle ex) const;
 
+        // return true if common subexpression elimination was performed
+        // on cannonized expression ex and all its subexpressions
+        bool            is_cse_done(const expr& ex) const;
+
+        // mark cannonized expression ex as processed by common
+        // subexpression elimination; all subexpressions of ex must be
+        // processed
+        void            set_cse_done(const expr& ex) const;
+
+        // return level of cannonization of ex
+        cannonize_level get_level(const expr& ex) const;
+
+        // return true if lazy cannonization is used
+        static bool     is_lazy();
+
+        // enable or disable lazy cannonization
+        static void     set_lazy(bool val);
+
+        // do_cse flag used when subexpressions are cannonized during
+        // building of new expressions or before evaluation; common
+        // subexpression elimination is delayed in lazy mode
+        static bool     do_cse_lazy();
+
         // get normalization scalar
         template<class Item>
         static value    get_normalize_scaling(const value& V0, size_t n, const Item* V);
@@ -93,6 +126,15 @@ class cannonize
         expr            make_add_impl(const add_build* h, value& scal, bool normalize,
                             bool do_cse);
         expr            make_add_impl(const add_rep* h);
+
+        // perform common subexpression elimination on cannonized expression
+        // h and its subexpressions not processed by cse; results are stored
+        // in done
+        expr            make_cse_impl(expr_handle h, cse_map& done);
+        expr            make_cse_impl(const add_rep* h, cse_map& done);
+        expr            make_cse_impl(const mult_rep* h, cse_map& done);
+        expr            make_cse_impl(const function_rep* h, cse_map& done);
+        bool            is_cse_done(expr_handle h) const;
         expr            process_add(size_t n, item_collector_add& ic, value& ret_scal,
                             bool normalize, bool do_cse);
 
@@ -0,0 +1,161 @@
+/* 
+ *  This file is a part of sym_arrow library.
+ *
+ *  Copyright (c) Pawe Kowal 2017 - 2021
+ *
+ *  This program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program; if not, write to the Free Software
+ *  Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA 02111-1307 USA
+ */
+
+#include "sym_arrow/ast/cannonization/cse_budget.h"
+
+namespace sym_arrow
+{
+
+//-------------------------------------------------------------------
+//                  cse_policy
+//-------------------------------------------------------------------
+cse_policy::cse_policy()
+    :m_max_rounds(size_t(-1)), m_max_group_size(size_t(-1))
+    ,m_work_budget(size_t(-1)), m_time_limit(-1.0)
+{};
+
+cse_policy& cse_policy::set_max_rounds(size_t n)
+{
+    m_max_rounds        = n;
+    return *this;
+};
+
+cse_policy& cse_policy::set_max_group_size(size_t n)
+{
+    // at least one subexpression must be factored out in each round
+    m_max_group_size    = (n == 0) ? 1 : n;
+    return *this;
+};
+
+cse_policy& cse_policy::set_work_budget(size_t n)
+{
+    m_work_budget       = n;
+    return *this;
+};
+
+cse_policy& cse_policy::set_time_limit(double sec)
+{
+    m_time_limit        = sec;
+    return *this;
+};
+
+bool cse_policy::is_unlimited() const
+{
+    return m_max_rounds == size_t(-1) && m_max_group_size == size_t(-1)
+        && m_work_budget == size_t(-1) && m_time_limit < 0.0;
+};
+
+//-------------------------------------------------------------------
+//                  cse_report
+//-------------------------------------------------------------------
+cse_report::cse_report()
+    :m_rounds(0), m_work(0), m_round_limited(0), m_group_limited(0)
+    ,m_work_exceeded(false), m_time_exceeded(false)
+{};
+
+bool cse_report::is_complete() const
+{
+    return m_round_limited == 0 && m_group_limited == 0
+        && m_work_exceeded == false && m_time_exceeded == false;
+};
+
+};
+
+namespace sym_arrow { namespace ast
+{
+
+//-------------------------------------------------------------------
+//                  cse_budget
+//-------------------------------------------------------------------
+static cse_budget* g_active_budget = nullptr;
+
+cse_budget::cse_budget(const cse_policy& pol)
+    :m_policy(pol), m_has_deadline(pol.get_time_limit() >= 0.0)
+    ,m_prev(g_active_budget)
+{
+    if (m_has_deadline == true)
+    {
+        auto limit  = std::chrono::duration<double>(pol.get_time_limit());
+        m_deadline  = clock_type::now()
+                    + std::chrono::duration_cast<clock_type::duration>(limit);
+    };
+
+    g_active_budget = this;
+};
+
+cse_budget::~cse_budget()
+{
+    g_active_budget = m_prev;
+};
+
+cse_budget* cse_budget::get()
+{
+    return g_active_budget;
+};
+
+bool cse_budget::is_complete()
+{
+    if (g_active_budget == nullptr)
+        return true;
+
+    return g_active_budget->m_report.is_complete();
+};
+
+bool cse_budget::start_round(size_t round)
+{
+    if (round >= m_policy.get_max_rounds())
+    {
+        ++m_report.m_round_limited;
+        return false;
+    };
+
+    if (m_report.m_work >= m_policy.get_work_budget())
+    {
+        m_report.m_work_exceeded    = true;
+        return false;
+    };
+
+    if (m_has_deadline == true && clock_type::now() >= m_deadline)
+    {
+        m_report.m_time_exceeded    = true;
+        return false;
+    };
+
+    ++m_report.m_rounds;
+    return true;
+};
+
+void cse_budget::add_work(size_t n)
+{
+    m_report.m_work += n;
+};
+
+size_t cse_budget::limit_group_size(size_t group_size)
+{
+    size_t max_size = m_policy.get_max_group_size();
+
+    if (group_size <= max_size)
+        return group_size;
+
+    ++m_report.m_group_limited;
+    return max_size;
+};
+
+}};
@@ -0,0 +1,81 @@
+/* 
+ *  This file is a part of sym_arrow library.
+ *
+ *  Copyright (c) Pawe Kowal 2017 - 2021
+ *
+ *  This program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program; if not, write to the Free Software
+ *  Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA 02111-1307 USA
+ */
+
+#pragma once
+
+#include "sym_arrow/functions/cse_policy.h"
+
+#include <chrono>
+
+namespace sym_arrow { namespace ast
+{
+
+// limits of common subexpression elimination active during one call
+// to cannonize::make; budget is active until destroyed, nested budgets
+// are allowed
+class cse_budget
+{
+    private:
+        using clock_type    = std::chrono::steady_clock;
+        using time_point    = clock_type::time_point;
+
+    private:
+        cse_policy          m_policy;
+        cse_report          m_report;
+        time_point          m_deadline;
+        bool                m_has_deadline;
+        cse_budget*         m_prev;
+
+    private:
+        cse_budget(const cse_budget&) = delete;
+        cse_budget& operator=(const cse_budget&) = delete;
+
+    public:
+        // activate budget given by a policy
+        explicit cse_budget(const cse_policy& pol);
+
+        // deactivate budget; previous budget is restored
+        ~cse_budget();
+
+        // get active budget; return nullptr if there is no active budget
+        static cse_budget*  get();
+
+        // return true if there is no active budget or the active budget
+        // has not limited cse so far; only then results of cse are final
+        // and can be cached or marked as fully cannonized
+        static bool         is_complete();
+
+        // return true if next factorization round of a sum can be
+        // started; round is the number of rounds already performed on
+        // this sum
+        bool                start_round(size_t round);
+
+        // add work done measured as number of compared items
+        void                add_work(size_t n);
+
+        // return number of subexpressions that can be factored out
+        // from group of size group_size
+        size_t              limit_group_size(size_t group_size);
+
+        // get summary
+        const cse_report&   get_report() const  { return m_report; };
+};
+
+};};
@@ -49,11 +49,8 @@ namespace sym_arrow { namespace ast
 #endif
 
 cse_hash::cse_hash()
-    :m_nest_level(0)
+    :m_predictor(make_cse_predictor_dirichlet()), m_nest_level(0)
 {
-    for (int i = 0; i < num_predictors; ++i)
-        m_predictors[i].set_tag(i);
-
     using track_func = expr_base::track_function;
 
     size_t code     = (size_t)ast::track_function_code::cse;
@@ -74,8 +71,9 @@ cse_hash::~cse_hash()
         for (size_t i = 0; i < log_pred_logs.size(); ++i)
             log_pred_logs[i]->flush();
 
-        for (size_t i = 0; i < num_predictors; ++i)
-            m_predictors[i].print_stats(*log_pred_stats);
+        *log_pred_stats << "accuracy: " << m_stats.accuracy()
+                        << ", predictions: " << m_stats.m_predictions
+                        << ", saved time: " << m_stats.m_saved_time << "\n";
 
         log_pred_stats->flush();
     #endif
@@ -105,35 +103,75 @@ cse_hash& cse_hash::get()
     return *g_cse_hash;
 }
 
-SYM_ARROW_FORCE_INLINE
-branch_predictor& cse_hash::get_predictor(int level)
+void cse_hash::set_predictor(const predictor_ptr& pred)
 {
-    // merge branch predictions for highly nested calls;
-    // this will confuse the predictor, prediction will be
-    // weak, but deep calls should be very rare
-    return m_predictors[std::min(level, num_predictors - 1)];
-}
+    assertion(m_nest_level == 0, "predictor cannot be changed during cannonization");
+    m_predictor = pred;
+};
+
+const cse_hash::predictor_ptr& cse_hash::get_predictor() const
+{
+    return m_predictor;
+};
+
+const cse_predictor_stats& cse_hash::get_stats() const
+{
+    return m_stats;
+};
+
+void cse_hash::reset_stats()
+{
+    m_stats = cse_predictor_stats();
+};
 
 bool cse_hash::check_hash()
 {
-    bool pred   = get_predictor(m_nest_level).get_prediction();
+    bool pred   = m_predictor->get_prediction(m_nest_level);
     ++m_nest_level;
 
     return pred;
 }
 
-void cse_hash::add_observation(bool obs, bool pred)
+void cse_hash::add_observation(const cse_observation& obs)
 {
     --m_nest_level;    
     assertion(m_nest_level >= 0, "error in cse_hash");
 
     #if SYM_ARROW_LOG_BRANCH_PRED
-        size_t lev  = std::min(m_nest_level, num_predictors - 1);
-        get_log(lev)    << (obs == false ? 1 : 2) << " " 
-                        << (pred == false ? 1 : 2) << "\n";
+        get_log(m_nest_level)   << (obs.m_factorized == false ? 1 : 2) << " " 
+                                << (obs.m_checked == false ? 1 : 2) << "\n";
     #endif
 
-    return get_predictor(m_nest_level).add_observation(obs, pred);
+    ++m_stats.m_predictions;
+
+    if (obs.m_checked != obs.m_factorized)
+        ++m_stats.m_errors;
+
+    if (obs.m_hit == false)
+    {
+        ++m_stats.m_factorizations;
+        m_stats.m_fact_time     += obs.m_fact_time;
+    };
+
+    // every lookup costs time, also a successful one, which is then
+    // spent instead of the factorization
+    if (obs.m_checked == true)
+    {
+        ++m_stats.m_checks;
+        m_stats.m_lookup_time   += obs.m_lookup_time;
+        m_stats.m_saved_time    -= obs.m_lookup_time;
+    };
+
+    if (obs.m_hit == true)
+    {
+        // factorization was avoided
+        ++m_stats.m_hits;
+
+        if (m_stats.m_factorizations > 0)
+            m_stats.m_saved_time    += m_stats.m_fact_time / double(m_stats.m_factorizations);
+    };
+
+    m_predictor->add_observation(m_nest_level, obs);
 }
 
 bool cse_hash::get_hashed_subexpr_elim(const expr& ex, value& norm, expr& simpl)
@@ -21,7 +21,7 @@
 #pragma once
 
 #include "sym_arrow/nodes/expr.h"
-#include "sym_arrow/ast/cannonization/branch_predictor.h"
+#include "sym_arrow/functions/cse_predictor.h"
 #include "sym_arrow/ast/cannonization/cse_hash_data.h"
 #include "sym_arrow/ast/helpers/utils.h"
 #include "sym_arrow/ast/expr_cache.h"
@@ -44,10 +44,11 @@ class cse_hash : public sym_dag::node_cache
         using stack_type    = ast::expr_base::stack_type;
 
     private:
-        static const int    num_predictors  = 5;
+        using predictor_ptr = std::shared_ptr<cse_predictor>;
 
     private:
-        branch_predictor    m_predictors[num_predictors];
+        predictor_ptr       m_predictor;
+        cse_predictor_stats m_stats;
         int                 m_nest_level;
         expr_cache          m_cache;
         hash_map            m_hash_map;
@@ -65,15 +66,27 @@ class cse_hash : public sym_dag::node_cache
 
         static cse_hash&    get();
 
+        // return true if result of cse should be looked up in the
+        // hash table; add_observation must be called later
         bool                check_hash();
-        void                add_observation(bool obs, bool pred);
+
+        // report observation after call to check_hash
+        void                add_observation(const cse_observation& obs);
 
         // get and set result of common subexpr elimination
         bool                get_hashed_subexpr_elim(const expr& ex, 
                                 value& norm, expr& simpl);
         void                set_hashed_subexpr_elim(const expr& ex, 
                                 const value& norm, const expr& simpl);
-        branch_predictor&   get_predictor(int level);
+
+        // set and get predictor used by check_hash
+        void                set_predictor(const predictor_ptr& pred);
+        const predictor_ptr&   get_predictor() const;
+
+        // get and reset statistics of predictions
+        const cse_predictor_stats&
+                            get_stats() const;
+        void                reset_stats();
 
         virtual void        clear() override;
 
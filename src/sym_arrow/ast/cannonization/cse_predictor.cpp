@@ -0,0 +1,254 @@
+/* 
+ *  This file is a part of sym_arrow library.
+ *
+ *  Copyright (c) Pawe Kowal 2017 - 2021
+ *
+ *  This program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program; if not, write to the Free Software
+ *  Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA 02111-1307 USA
+ */
+
+#include "sym_arrow/functions/cse_predictor.h"
+#include "sym_arrow/ast/cannonization/branch_predictor.h"
+#include "sym_arrow/ast/cannonization/cse_hash.h"
+
+#include <vector>
+
+namespace sym_arrow { namespace ast
+{
+
+//-------------------------------------------------------------------
+//                  dirichlet_cse_predictor
+//-------------------------------------------------------------------
+class dirichlet_cse_predictor : public cse_predictor
+{
+    private:
+        std::vector<branch_predictor>   m_predictors;
+
+    public:
+        dirichlet_cse_predictor(int num_levels, double variance_scal);
+
+        virtual bool    get_prediction(int level) override;
+        virtual void    add_observation(int level, const cse_observation& obs) override;
+
+    private:
+        branch_predictor&   get_predictor(int level);
+};
+
+dirichlet_cse_predictor::dirichlet_cse_predictor(int num_levels, double variance_scal)
+{
+    if (num_levels < 1)
+        num_levels = 1;
+
+    for (int i = 0; i < num_levels; ++i)
+        m_predictors.push_back(branch_predictor(i, variance_scal));
+};
+
+inline branch_predictor& dirichlet_cse_predictor::get_predictor(int level)
+{
+    // merge branch predictions for highly nested calls;
+    // this will confuse the predictor, prediction will be
+    // weak, but deep calls should be very rare
+    int max_level   = (int)m_predictors.size() - 1;
+    return m_predictors[level < max_level ? level : max_level];
+};
+
+bool dirichlet_cse_predictor::get_prediction(int level)
+{
+    return get_predictor(level).get_prediction();
+};
+
+void dirichlet_cse_predictor::add_observation(int level, const cse_observation& obs)
+{
+    get_predictor(level).add_observation(obs.m_factorized, obs.m_checked);
+};
+
+//-------------------------------------------------------------------
+//                  const_cse_predictor
+//-------------------------------------------------------------------
+class const_cse_predictor : public cse_predictor
+{
+    private:
+        bool            m_value;
+
+    public:
+        const_cse_predictor(bool val)
+            :m_value(val)
+        {};
+
+        virtual bool    get_prediction(int level) override;
+        virtual void    add_observation(int level, const cse_observation& obs) override;
+};
+
+bool const_cse_predictor::get_prediction(int level)
+{
+    (void)level;
+    return m_value;
+};
+
+void const_cse_predictor::add_observation(int level, const cse_observation& obs)
+{
+    (void)level;
+    (void)obs;
+};
+
+//-------------------------------------------------------------------
+//                  cost_model_cse_predictor
+//-------------------------------------------------------------------
+class cost_model_cse_predictor : public cse_predictor
+{
+    private:
+        static const int    num_levels  = 5;
+
+        struct level_data
+        {
+            double          m_hit_rate;
+            double          m_lookup_time;
+            double          m_fact_time;
+            int             m_calls;
+        };
+
+    private:
+        level_data          m_levels[num_levels];
+        double              m_decay;
+        int                 m_explore_period;
+
+    public:
+        cost_model_cse_predictor(double decay, int explore_period);
+
+        virtual bool    get_prediction(int level) override;
+        virtual void    add_observation(int level, const cse_observation& obs) override;
+
+    private:
+        level_data&     get_data(int level);
+        void            update(double& est, double val) const;
+};
+
+cost_model_cse_predictor::cost_model_cse_predictor(double decay, int explore_period)
+    :m_decay(decay), m_explore_period(explore_period < 1 ? 1 : explore_period)
+{
+    // hash table is checked until first estimates are available
+    for (int i = 0; i < num_levels; ++i)
+    {
+        m_levels[i].m_hit_rate      = 1.0;
+        m_levels[i].m_lookup_time   = 0.0;
+        m_levels[i].m_fact_time     = 0.0;
+        m_levels[i].m_calls         = 0;
+    };
+};
+
+inline cost_model_cse_predictor::level_data&
+cost_model_cse_predictor::get_data(int level)
+{
+    return m_levels[level < num_levels - 1 ? level : num_levels - 1];
+};
+
+inline void cost_model_cse_predictor::update(double& est, double val) const
+{
+    est = m_decay * est + (1.0 - m_decay) * val;
+};
+
+bool cost_model_cse_predictor::get_prediction(int level)
+{
+    level_data& data    = get_data(level);
+
+    ++data.m_calls;
+
+    if (data.m_calls >= m_explore_period)
+    {
+        data.m_calls    = 0;
+        return true;
+    };
+
+    return data.m_hit_rate * data.m_fact_time >= data.m_lookup_time;
+};
+
+void cost_model_cse_predictor::add_observation(int level, const cse_observation& obs)
+{
+    level_data& data    = get_data(level);
+
+    if (obs.m_checked == true)
+    {
+        update(data.m_hit_rate, obs.m_hit ? 1.0 : 0.0);
+        update(data.m_lookup_time, obs.m_lookup_time);
+    };
+
+    if (obs.m_hit == false)
+        update(data.m_fact_time, obs.m_fact_time);
+};
+
+}};
+
+namespace sym_arrow
+{
+
+//-------------------------------------------------------------------
+//                  cse_predictor_stats
+//-------------------------------------------------------------------
+cse_predictor_stats::cse_predictor_stats()
+    :m_predictions(0), m_errors(0), m_checks(0), m_hits(0), m_factorizations(0)
+    ,m_lookup_time(0.0), m_fact_time(0.0), m_saved_time(0.0)
+{};
+
+double cse_predictor_stats::accuracy() const
+{
+    if (m_predictions == 0)
+        return 1.0;
+
+    return 1.0 - double(m_errors) / double(m_predictions);
+};
+
+//-------------------------------------------------------------------
+//                  functions
+//-------------------------------------------------------------------
+std::shared_ptr<cse_predictor>
+sym_arrow::make_cse_predictor_dirichlet(int num_levels, double variance_scal)
+{
+    return std::make_shared<ast::dirichlet_cse_predictor>(num_levels, variance_scal);
+};
+
+std::shared_ptr<cse_predictor> sym_arrow::make_cse_predictor_const(bool value)
+{
+    return std::make_shared<ast::const_cse_predictor>(value);
+};
+
+std::shared_ptr<cse_predictor>
+sym_arrow::make_cse_predictor_cost_model(double decay, int explore_period)
+{
+    return std::make_shared<ast::cost_model_cse_predictor>(decay, explore_period);
+};
+
+void sym_arrow::set_cse_predictor(const std::shared_ptr<cse_predictor>& pred)
+{
+    if (!pred)
+        ast::cse_hash::get().set_predictor(make_cse_predictor_dirichlet());
+    else
+        ast::cse_hash::get().set_predictor(pred);
+};
+
+std::shared_ptr<cse_predictor> sym_arrow::get_cse_predictor()
+{
+    return ast::cse_hash::get().get_predictor();
+};
+
+cse_predictor_stats sym_arrow::get_cse_predictor_stats()
+{
+    return ast::cse_hash::get().get_stats();
+};
+
+void sym_arrow::reset_cse_predictor_stats()
+{
+    ast::cse_hash::get().reset_stats();
+};
+
+};
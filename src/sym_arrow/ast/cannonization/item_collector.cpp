@@ -111,6 +111,18 @@ item_collector_mult_arrays::item_collector_mult_arrays(const collector_size& siz
 //----------------------------------------------------------------
 //                  item_collector_mult
 //----------------------------------------------------------------
+// hash of an expression handle used by collect_base; nodes are
+// aligned, low bits are discarded
+static inline size_t hash_base(expr_handle eh)
+{
+    size_t h    = size_t(eh) >> 4;
+    h           ^= h >> 15;
+    h           *= 0x2c1b3c6d;
+    h           ^= h >> 12;
+
+    return h;
+};
+
 item_collector_mult::item_collector_mult(collector_size& size, 
                             item_collector_mult_arrays& arr)
     : m_scal(value::make_one()), m_size(size)
@@ -201,22 +213,32 @@ void item_collector_mult::collect_base()
     if (this->rsize() == 0 || this->isize() == 0)
         return;
 
-    // map based implementation is fast enough
     struct info
     {
-        int     pos_r;
-        int     pos_i;
-        int     pow_i;
-
-        info(int posr) :pos_r(posr), pos_i(-1), pow_i(0) {};
+        expr_handle     base;
+        int             pos_r;
+        int             pos_i;
+        int             pow_i;
     };
 
-    using base_map          = std::map<expr_handle, info>;
     using info_vec          = sd::stack_array<info*>;
+    using info_table        = sd::stack_array<info>;
     using int_vec           = sd::stack_array<int>;
-    using base_value_type   = base_map::value_type;
 
-    base_map    m_base_map;    
+    // open addressing table with linear probing indexed by bases of real
+    // powers; load factor is at most 1/2
+    size_t capacity     = 16;
+
+    while (capacity < 2 * rsize())
+        capacity        *= 2;
+
+    size_t mask         = capacity - 1;
+
+    info_table m_table_arr(capacity);
+    info* m_table       = m_table_arr.get();
+
+    for (size_t i = 0; i < capacity; ++i)
+        m_table[i].base = nullptr;
 
     for (size_t i = 0; i < rsize(); ++i)
     {
@@ -224,8 +246,19 @@ void item_collector_mult::collect_base()
             continue;
 
         expr_handle eh      = m_rih[i].get_expr_handle();
+        size_t pos          = hash_base(eh) & mask;
+
+        while (m_table[pos].base != nullptr && m_table[pos].base != eh)
+            pos             = (pos + 1) & mask;
+
+        // first occurrence of a base is kept
+        if (m_table[pos].base != nullptr)
+            continue;
 
-        m_base_map.insert(base_value_type(eh, info((int)i)));
+        m_table[pos].base   = eh;
+        m_table[pos].pos_r  = (int)i;
+        m_table[pos].pos_i  = -1;
+        m_table[pos].pow_i  = 0;
     };
 
     size_t ipos     = 0;
@@ -237,19 +270,24 @@ void item_collector_mult::collect_base()
     while (ipos < isize)
     {
         if (m_iih[ipos].is_special() == true)
+        {
+            ++ipos;
             continue;
+        };
 
         expr_handle eh      = m_iih[ipos].get_expr_handle();
+        size_t pos          = hash_base(eh) & mask;
 
-        auto pos            = m_base_map.find(eh);
+        while (m_table[pos].base != nullptr && m_table[pos].base != eh)
+            pos             = (pos + 1) & mask;
 
-        if (pos == m_base_map.end())
+        if (m_table[pos].base == nullptr)
         {
             ++ipos;
             continue;
         };
 
-        info& in            = pos->second;
+        info& in            = m_table[pos];
         if (in.pos_i == -1)
         {
             in.pos_i        = (int)ipos;
@@ -0,0 +1,101 @@
+/* 
+ *  This file is a part of sym_arrow library.
+ *
+ *  Copyright (c) Pawe Kowal 2017 - 2021
+ *
+ *  This program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program; if not, write to the Free Software
+ *  Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA 02111-1307 USA
+ */
+
+#include "sym_arrow/ast/cannonization/parallel_cannonize.h"
+
+#include <thread>
+#include <vector>
+
+namespace sym_arrow { namespace ast
+{
+
+static size_t g_num_threads = 0;
+static size_t g_min_size    = 100000;
+
+// chunks smaller than this are not worth a thread
+static const size_t min_chunk_size  = 10000;
+
+static size_t get_hardware_threads()
+{
+    size_t n    = std::thread::hardware_concurrency();
+    return n == 0 ? 1 : n;
+};
+
+size_t parallel_cannonize::get_num_chunks(size_t n)
+{
+    if (n < g_min_size)
+        return 0;
+
+    size_t n_threads    = (g_num_threads == 0) ? get_hardware_threads() : g_num_threads;
+    size_t n_chunks     = n / min_chunk_size;
+
+    if (n_chunks > n_threads)
+        n_chunks        = n_threads;
+
+    // sums of this size are always processed by the stable algorithm,
+    // also when only one thread is available
+    return n_chunks == 0 ? 1 : n_chunks;
+};
+
+void parallel_cannonize::run(size_t n_tasks, const task_function& f)
+{
+    if (n_tasks == 0)
+        return;
+
+    std::vector<std::thread> threads;
+    threads.reserve(n_tasks - 1);
+
+    for (size_t i = 1; i < n_tasks; ++i)
+        threads.push_back(std::thread(f, i));
+
+    f(0);
+
+    for (auto& th : threads)
+        th.join();
+};
+
+void parallel_cannonize::make_bounds(size_t n, size_t n_chunks, size_t* bounds)
+{
+    for (size_t k = 0; k <= n_chunks; ++k)
+        bounds[k]   = (n * k) / n_chunks;
+};
+
+}};
+
+namespace sym_arrow
+{
+
+void sym_arrow::set_cannonize_threads(size_t num_threads, size_t min_size)
+{
+    ast::g_num_threads  = num_threads;
+    ast::g_min_size     = min_size;
+};
+
+size_t sym_arrow::get_cannonize_threads()
+{
+    return ast::g_num_threads == 0 ? ast::get_hardware_threads() : ast::g_num_threads;
+};
+
+size_t sym_arrow::get_cannonize_min_size()
+{
+    return ast::g_min_size;
+};
+
+};
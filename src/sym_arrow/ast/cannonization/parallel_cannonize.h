@@ -0,0 +1,50 @@
+/* 
+ *  This file is a part of sym_arrow library.
+ *
+ *  Copyright (c) Pawe Kowal 2017 - 2021
+ *
+ *  This program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program; if not, write to the Free Software
+ *  Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA 02111-1307 USA
+ */
+
+#pragma once
+
+#include "sym_arrow/functions/parallel_options.h"
+
+#include <functional>
+
+namespace sym_arrow { namespace ast
+{
+
+// settings of parallel processing of wide sums and products
+class parallel_cannonize
+{
+    public:
+        using task_function = std::function<void (size_t)>;
+
+    public:
+        // return number of chunks used to process n items; return 0 if
+        // n items should be processed by the default sequential algorithm
+        static size_t       get_num_chunks(size_t n);
+
+        // call f(0), ..., f(n_tasks - 1) concurrently; f(0) is called
+        // on the current thread
+        static void         run(size_t n_tasks, const task_function& f);
+
+        // split n items into n_chunks ranges of similar size; k-th range
+        // is [bounds[k], bounds[k + 1])
+        static void         make_bounds(size_t n, size_t n_chunks, size_t* bounds);
+};
+
+};};
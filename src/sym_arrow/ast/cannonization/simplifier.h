@@ -28,12 +28,23 @@ namespace sym_arrow { namespace ast
 template<class Item>
 class simplify_expr
 {
+    private:
+        // radix sort is used for arrays of at least this size
+        static const size_t radix_min_size  = 256;
+
     public:
         static void     make(Item* ptr, size_t& size);
         static void     sort(Item* ptr, size_t size);
 
     private:
         static void     simplify(Item* ptr, size_t size, bool& any_simpl);
+        static void     remove_empty(Item* ptr, size_t& size);
+
+        // sort and merge items of a wide sum or product in n_chunks
+        // chunks; items are sorted stably, therefore result does not
+        // depend on n_chunks and is the same as result of the sequential
+        // algorithm for arrays of at least radix_min_size elements
+        static void     make_parallel(Item* ptr, size_t& size, size_t n_chunks);
 };
 
 };};
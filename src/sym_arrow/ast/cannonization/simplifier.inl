@@ -21,11 +21,20 @@
 #pragma once
 
 #include "sym_arrow/ast/cannonization/simplifier.h"
+#include "sym_arrow/ast/cannonization/parallel_cannonize.h"
+#include "sym_arrow/ast/helpers/utils.h"
+#include "sym_arrow/ast/helpers/expr_order.h"
+#include "sym_arrow/utils/stack_array.h"
 #include "sym_arrow/utils/sort.inl"
 
+#include <algorithm>
+#include <vector>
+
 namespace sym_arrow { namespace ast
 {
 
+namespace sd = sym_arrow :: details;
+
 template<class Item>
 void simplify_expr<Item>::sort(Item* ptr, size_t size)
 {
@@ -37,7 +46,26 @@ void simplify_expr<Item>::sort(Item* ptr, size_t size)
         };
     };
 
-    sym_arrow::utils::sort_q(ptr, size, expr_comp());
+    if (size < radix_min_size)
+        return sym_arrow::utils::sort_q(ptr, size, expr_comp());
+
+    // radix keys are not available for structural ordering
+    if (expr_order::is_deterministic() == true)
+        return std::stable_sort(ptr, ptr + size, expr_comp());
+
+    // items are compared by addresses of expressions
+    struct expr_key
+    {
+        size_t operator()(const Item& a) const
+        {
+            return size_t(a.get_expr_handle());
+        };
+    };
+
+    using buffer_type   = sd::stack_array<details::pod_type<Item>>;
+
+    buffer_type buf(size);
+    sym_arrow::utils::sort_radix(ptr, buf.template get_cast<Item>(), size, expr_key());
 };
 
 template<class Item>
@@ -46,26 +74,125 @@ void simplify_expr<Item>::make(Item* ptr, size_t& size)
     if (size < 2)
         return;
 
+    size_t n_chunks = parallel_cannonize::get_num_chunks(size);
+
+    if (n_chunks > 0)
+        return make_parallel(ptr, size, n_chunks);
+
     sort(ptr, size);
 
     bool any_simpl = false;
     simplify(ptr, size, any_simpl);
 
     if (any_simpl == true)
+        remove_empty(ptr, size);
+};
+
+template<class Item>
+void simplify_expr<Item>::remove_empty(Item* ptr, size_t& size)
+{
+    size_t pos = 0;
+
+    for (size_t i = 0; i < size; ++i)
+    {
+        if (ptr[i].get_expr_handle() != nullptr)
+        {
+            ptr[pos] = std::move(ptr[i]);
+            ++pos;
+        };
+    };
+
+    size = pos;
+};
+
+template<class Item>
+void simplify_expr<Item>::make_parallel(Item* ptr, size_t& size, size_t n_chunks)
+{
+    struct expr_comp
+    {
+        bool operator()(const Item& a, const Item& b) const
+        {
+            return a.compare(b);
+        };
+    };
+
+    struct expr_key
+    {
+        size_t operator()(const Item& a) const
+        {
+            return size_t(a.get_expr_handle());
+        };
+    };
+
+    using buffer_type   = sd::stack_array<details::pod_type<Item>>;
+
+    std::vector<size_t> bounds(n_chunks + 1);
+    parallel_cannonize::make_bounds(size, n_chunks, bounds.data());
+
+    buffer_type buf(size);
+    Item* buf_ptr       = buf.template get_cast<Item>();
+
+    bool use_radix      = expr_order::is_deterministic() == false;
+
+    // sort chunks; both sorting algorithms are stable
+    parallel_cannonize::run(n_chunks, [&](size_t k)
+    {
+        size_t first    = bounds[k];
+        size_t n        = bounds[k + 1] - first;
+
+        if (use_radix == true)
+            sym_arrow::utils::sort_radix(ptr + first, buf_ptr + first, n, expr_key());
+        else
+            std::stable_sort(ptr + first, ptr + first + n, expr_comp());
+    });
+
+    // merge sorted chunks pairwise; merging is stable, equal items from
+    // the left chunk are placed first
+    for (size_t width = 1; width < n_chunks; width *= 2)
+    {
+        size_t n_merges = (n_chunks - width + 2 * width - 1) / (2 * width);
+
+        parallel_cannonize::run(n_merges, [&](size_t k)
+        {
+            size_t first    = 2 * width * k;
+            size_t middle   = first + width;
+            size_t last     = std::min(first + 2 * width, n_chunks);
+
+            std::inplace_merge(ptr + bounds[first], ptr + bounds[middle], 
+                               ptr + bounds[last], expr_comp());
+        });
+    };
+
+    // move chunk boundaries forward past the end of a group of equal items
+    // crossing the boundary, then all items with the same expression are
+    // merged by one task in the same order as in sequential algorithm
+    for (size_t k = 1; k < n_chunks; ++k)
     {
-        size_t pos = 0;
+        size_t pos  = std::max(bounds[k], bounds[k - 1]);
 
-        for (size_t i = 0; i < size; ++i)
+        while (pos > bounds[k - 1] && pos < size 
+               && ptr[pos].get_expr_handle() == ptr[pos - 1].get_expr_handle())
         {
-            if (ptr[i].get_expr_handle() != nullptr)
-            {
-                ptr[pos] = std::move(ptr[i]);
-                ++pos;
-            };
+            ++pos;
         };
 
-        size = pos;
+        bounds[k]   = pos;
     };
+
+    std::vector<char> any_simpl(n_chunks, 0);
+
+    parallel_cannonize::run(n_chunks, [&](size_t k)
+    {
+        bool simpl  = false;
+
+        if (bounds[k + 1] > bounds[k])
+            simplify(ptr + bounds[k], bounds[k + 1] - bounds[k], simpl);
+
+        any_simpl[k]    = simpl;
+    });
+
+    if (std::find(any_simpl.begin(), any_simpl.end(), 1) != any_simpl.end())
+        remove_empty(ptr, size);
 };
 
 template<class Item>
@@ -22,7 +22,9 @@
 #include "sym_arrow/ast/ast.h"
 #include "sym_arrow/functions/expr_functions.h"
 #include "sym_arrow/ast/cannonization/cannonize.h"
+#include "sym_arrow/ast/cannonization/cse_budget.h"
 #include "sym_arrow/ast/mult_rep.inl"
+#include "sym_arrow/ast/helpers/expr_order.h"
 #include "sym_arrow/utils/stack_array.h"
 #include "sym_arrow/utils/sort.h"
 #include "sym_arrow/ast/cannonization/simplifier.inl"
@@ -81,29 +83,23 @@ void subs_counter::add_exp()
 
 bool ipow_comparer::operator()(const ipow_item& a, const ipow_item& b) const
 {
-    if (a.m_expr < b.m_expr)
-        return true;
-
-    if (a.m_expr > b.m_expr)
-        return false;
+    if (a.m_expr != b.m_expr)
+        return expr_order::less(a.m_expr, b.m_expr);
 
     return a.m_pow < b.m_pow;
 };
 
 bool rpow_comparer::operator()(const rpow_item& a, const rpow_item& b) const
 {
-    if (a.m_expr < b.m_expr)
-        return true;
-
-    if (a.m_expr > b.m_expr)
-        return false;
+    if (a.m_expr != b.m_expr)
+        return expr_order::less(a.m_expr, b.m_expr);
 
     return a.m_pow < b.m_pow;
 };
 
 bool exp_comparer::operator()(const exp_item& a, const exp_item& b) const
 {
-    return a.m_expr < b.m_expr;
+    return expr_order::less(a.m_expr, b.m_expr);
 };
 
 factorizations::factorizations(subs_vec& subs)
@@ -195,6 +191,11 @@ bool subexpr_collector::make(size_t n, add_item_handle* ih, expr& res,
         return false;
     };
 
+    cse_budget* budget  = cse_budget::get();
+
+    if (budget != nullptr)
+        budget->add_work(n + counter.n_ipow + counter.n_rpow + counter.n_exp);
+
     // collect subexpressions
     static const size_t buffer_size = 10;
 
@@ -261,6 +262,10 @@ bool subexpr_collector::make(size_t n, add_item_handle* ih, expr& res,
     size_t group_size   = 0;
     select_subexpr(subs, ibuf, rbuf, ebuf, group_size);
 
+    // subset of a group is also a valid factorization
+    if (budget != nullptr && group_size > 0)
+        group_size  = budget->limit_group_size(group_size);
+
     // when group_size > 1, then factorization elements must be
     // sorted according to add_pos
     if (group_size > 1)
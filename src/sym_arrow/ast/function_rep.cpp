@@ -21,6 +21,7 @@
 #include "sym_arrow/ast/function_rep.h"
 #include "sym_arrow/nodes/symbol.h"
 #include "sym_arrow/ast/ast.h"
+#include "sym_arrow/ast/helpers/expr_order.h"
 
 namespace sym_arrow { namespace ast
 {
@@ -29,6 +30,8 @@ function_rep::function_rep(const function_rep_info& pi)
     :base_type(this), m_hash(pi.m_hash)
     ,m_size(pi.m_size), m_expr(nullptr), m_name(symbol_ptr::from_this(pi.m_name))
 {
+    expr_order::add_node();
+
     if (m_size == 0)
         return;
 
@@ -48,6 +51,8 @@ function_rep::function_rep(const function_rep_info& pi)
 
 function_rep::~function_rep()
 {
+    expr_order::remove_node();
+
     if (m_size == 0)
         return;
 
@@ -84,10 +89,10 @@ size_t function_rep::eval_hash(const function_rep_info& pi)
     if (pi.m_hash != 0)
         return pi.m_hash;
 
-    size_t seed = (size_t)pi.m_name; 
+    size_t seed = expr_order::hash(pi.m_name);
 
     for (size_t i = 0; i < pi.m_size; ++i)
-        boost::hash_combine(seed,pi.m_args[i].get_ptr().get());
+        boost::hash_combine(seed, expr_order::hash(pi.m_args[i].get_ptr().get()));
 
     pi.m_hash = seed;
     return seed;
@@ -0,0 +1,241 @@
+/* 
+ *  This file is a part of sym_arrow library.
+ *
+ *  Copyright (c) Pawe Kowal 2017 - 2021
+ *
+ *  This program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program; if not, write to the Free Software
+ *  Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA 02111-1307 USA
+ */
+
+#include "sym_arrow/ast/helpers/expr_order.h"
+#include "sym_arrow/functions/ordering.h"
+#include "sym_arrow/ast/ast.h"
+#include "sym_arrow/ast/mult_rep.inl"
+#include "sym_arrow/error/error_formatter.h"
+
+#include <cstring>
+
+namespace sym_arrow { namespace ast
+{
+
+bool expr_order::g_deterministic = false;
+size_t expr_order::g_num_nodes    = 0;
+
+void expr_order::set_deterministic(bool val)
+{
+    if (val == g_deterministic)
+        return;
+
+    // hashes and orderings of existing sums, products and functions
+    // would become invalid
+    if (g_num_nodes > 0)
+    {
+        error::error_formatter ef;
+        ef.head() << "unable to change deterministic ordering mode";
+
+        ef.new_info();
+        ef.line() << "mode must be set before any expression is created; "
+                  << "number of existing nodes: " << g_num_nodes;
+
+        throw std::runtime_error(ef.str());
+    };
+
+    g_deterministic = val;
+};
+
+// compare two values; nan values are ordered after all numbers and are
+// equivalent to each other
+static int compare_values(const value& a, const value& b)
+{
+    bool a_nan  = a.is_nan();
+    bool b_nan  = b.is_nan();
+
+    if (a_nan == true || b_nan == true)
+    {
+        if (a_nan == b_nan)
+            return 0;
+
+        return (a_nan == true) ? 1 : -1;
+    };
+
+    if (a < b)
+        return -1;
+    if (b < a)
+        return 1;
+
+    return 0;
+};
+
+static int compare_sizes(size_t a, size_t b)
+{
+    if (a == b)
+        return 0;
+
+    return (a < b) ? -1 : 1;
+};
+
+size_t expr_order::structural_hash(expr_handle h)
+{
+    // hashes of hashed nodes are computed from hashes of subnodes,
+    // build nodes are not hashed
+    switch (h->get_code())
+    {
+        case (size_t)term_types::scalar:
+            return h->static_cast_to<scalar_rep>()->hash_value();
+        case (size_t)term_types::symbol:
+            return h->static_cast_to<symbol_rep>()->hash_value();
+        case (size_t)term_types::add_rep:
+            return h->static_cast_to<add_rep>()->hash_value();
+        case (size_t)term_types::mult_rep:
+            return h->static_cast_to<mult_rep>()->hash_value();
+        case (size_t)term_types::function_rep:
+            return h->static_cast_to<function_rep>()->hash_value();
+        default:
+            return (size_t)h;
+    };
+};
+
+int expr_order::compare(expr_handle a, expr_handle b)
+{
+    if (a == b)
+        return 0;
+
+    int res         = compare_sizes(a->get_code(), b->get_code());
+
+    if (res != 0)
+        return res;
+
+    res             = compare_sizes(structural_hash(a), structural_hash(b));
+
+    if (res != 0)
+        return res;
+
+    // hash collision
+    switch (a->get_code())
+    {
+        case (size_t)term_types::scalar:
+        {
+            res     = compare_values(a->static_cast_to<scalar_rep>()->get_data(),
+                                     b->static_cast_to<scalar_rep>()->get_data());
+            break;
+        }
+        case (size_t)term_types::symbol:
+        {
+            res     = std::strcmp(a->static_cast_to<symbol_rep>()->get_name(),
+                                  b->static_cast_to<symbol_rep>()->get_name());
+            break;
+        }
+        case (size_t)term_types::add_rep:
+        {
+            const add_rep* ah   = a->static_cast_to<add_rep>();
+            const add_rep* bh   = b->static_cast_to<add_rep>();
+
+            res     = compare_sizes(ah->size(), bh->size());
+
+            if (res == 0)
+                res = compare_sizes(ah->has_log(), bh->has_log());
+            if (res == 0)
+                res = compare_values(ah->V0(), bh->V0());
+
+            for (size_t i = 0; res == 0 && i < ah->size(); ++i)
+            {
+                res = compare_values(ah->V(i), bh->V(i));
+
+                if (res == 0)
+                    res = compare(ah->E(i), bh->E(i));
+            };
+
+            if (res == 0 && ah->has_log() == true)
+                res = compare(ah->Log(), bh->Log());
+
+            break;
+        }
+        case (size_t)term_types::mult_rep:
+        {
+            const mult_rep* ah  = a->static_cast_to<mult_rep>();
+            const mult_rep* bh  = b->static_cast_to<mult_rep>();
+
+            res     = compare_sizes(ah->isize(), bh->isize());
+
+            if (res == 0)
+                res = compare_sizes(ah->rsize(), bh->rsize());
+            if (res == 0)
+                res = compare_sizes(ah->has_exp(), bh->has_exp());
+
+            for (size_t i = 0; res == 0 && i < ah->isize(); ++i)
+            {
+                int ap  = ah->IV(i);
+                int bp  = bh->IV(i);
+                res     = (ap == bp) ? 0 : ((ap < bp) ? -1 : 1);
+
+                if (res == 0)
+                    res = compare(ah->IE(i), bh->IE(i));
+            };
+
+            for (size_t i = 0; res == 0 && i < ah->rsize(); ++i)
+            {
+                res = compare_values(ah->RV(i), bh->RV(i));
+
+                if (res == 0)
+                    res = compare(ah->RE(i), bh->RE(i));
+            };
+
+            if (res == 0 && ah->has_exp() == true)
+                res = compare(ah->Exp(), bh->Exp());
+
+            break;
+        }
+        case (size_t)term_types::function_rep:
+        {
+            const function_rep* ah  = a->static_cast_to<function_rep>();
+            const function_rep* bh  = b->static_cast_to<function_rep>();
+
+            res     = compare(ah->name(), bh->name());
+
+            if (res == 0)
+                res = compare_sizes(ah->size(), bh->size());
+
+            for (size_t i = 0; res == 0 && i < ah->size(); ++i)
+                res = compare(ah->arg(i), bh->arg(i));
+
+            break;
+        }
+        default:
+            break;
+    };
+
+    if (res != 0)
+        return res;
+
+    // different nodes with the same structure can exist only if nodes
+    // are not hashed
+    return (a < b) ? -1 : 1;
+};
+
+}};
+
+namespace sym_arrow
+{
+
+void sym_arrow::set_deterministic_ordering(bool val)
+{
+    ast::expr_order::set_deterministic(val);
+};
+
+bool sym_arrow::get_deterministic_ordering()
+{
+    return ast::expr_order::is_deterministic();
+};
+
+};
@@ -0,0 +1,78 @@
+/* 
+ *  This file is a part of sym_arrow library.
+ *
+ *  Copyright (c) Pawe Kowal 2017 - 2021
+ *
+ *  This program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program; if not, write to the Free Software
+ *  Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA 02111-1307 USA
+ */
+
+#pragma once
+
+#include "sym_arrow/fwd_decls.h"
+
+namespace sym_arrow { namespace ast
+{
+
+// ordering and hashing of expression nodes; by default nodes are ordered
+// and hashed by addresses; in deterministic mode structural hashes are
+// used, ties are resolved by comparing structure of nodes
+class expr_order
+{
+    private:
+        static bool     g_deterministic;
+        static size_t   g_num_nodes;
+
+    public:
+        // return true if deterministic mode is used
+        static bool     is_deterministic()          { return g_deterministic; };
+
+        // set deterministic mode; throw an exception if the mode is
+        // changed when nodes depending on the mode exist
+        static void     set_deterministic(bool val);
+
+        // register creation and destruction of a node, whose hash and
+        // order of subnodes depend on the mode
+        static void     add_node()                  { ++g_num_nodes; };
+        static void     remove_node()               { --g_num_nodes; };
+
+        // hash of a node used to build hashes of parent nodes
+        static size_t   hash(expr_handle h);
+
+        // strict weak ordering of nodes; different nodes are never
+        // equivalent
+        static bool     less(expr_handle a, expr_handle b);
+
+    private:
+        static size_t   structural_hash(expr_handle h);
+        static int      compare(expr_handle a, expr_handle b);
+};
+
+inline size_t expr_order::hash(expr_handle h)
+{
+    if (g_deterministic == false)
+        return (size_t)h;
+    else
+        return structural_hash(h);
+};
+
+inline bool expr_order::less(expr_handle a, expr_handle b)
+{
+    if (g_deterministic == false || a == b)
+        return a < b;
+    else
+        return compare(a, b) < 0;
+};
+
+};};
@@ -29,6 +29,8 @@ namespace sd = sym_arrow :: details;
 
 mult_rep::~mult_rep()
 {
+    expr_order::remove_node();
+
     using context_type  = sym_dag::dag_context<term_tag>;
     context_type& c     = context_type::get();
 
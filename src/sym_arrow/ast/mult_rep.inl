@@ -22,6 +22,7 @@
 
 #include "sym_arrow/ast/mult_rep.h"
 #include "sym_arrow/exception.h"
+#include "sym_arrow/ast/helpers/expr_order.h"
 
 namespace sym_arrow { namespace ast
 {
@@ -32,6 +33,8 @@ mult_rep::mult_rep(const mult_rep_info<Iitem_type, Ritem_type>& pi)
     , m_int_size(pi.in), m_int_data(nullptr), m_real_data(nullptr)
     , m_real_size(pi.rn)
 {
+    expr_order::add_node();
+
     using context_type  = sym_dag::dag_context<term_tag>;
     context_type& c     = context_type::get();
 
@@ -83,18 +86,18 @@ size_t mult_rep::eval_hash(const mult_rep_info<Iitem_type, Ritem_type>& pi)
     for (size_t i = 0; i < pi.in; ++i)
     {
         boost::hash_combine(seed, size_t(pi.iexpr[i].m_value));
-        boost::hash_combine(seed,pi.iexpr[i].get_expr_handle());
+        boost::hash_combine(seed, expr_order::hash(pi.iexpr[i].get_expr_handle()));
     };
 
     if (pi.exp_expr == nullptr)
         boost::hash_combine(seed, expr_handle());
     else
-        boost::hash_combine(seed, pi.exp_expr->get_expr_handle());
+        boost::hash_combine(seed, expr_order::hash(pi.exp_expr->get_expr_handle()));
     
     for (size_t i = 0; i < pi.rn; ++i)
     {
         boost::hash_combine(seed, pi.rexpr[i].m_value.hash_value());
-        boost::hash_combine(seed, pi.rexpr[i].get_expr_handle());
+        boost::hash_combine(seed, expr_order::hash(pi.rexpr[i].get_expr_handle()));
     };
 
     pi.m_hash_mult = seed;
@@ -0,0 +1,356 @@
+/* 
+ *  This file is a part of sym_arrow library.
+ *
+ *  Copyright (c) Pawe Kowal 2017 - 2021
+ *
+ *  This program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program; if not, write to the Free Software
+ *  Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA 02111-1307 USA
+ */
+
+#include "sym_arrow/func/builtin_table.h"
+#include "sym_arrow/functions/builtin_functions.h"
+#include "sym_arrow/functions/expr_functions.h"
+#include "sym_arrow/ast/ast.h"
+#include "sym_arrow/ast/cannonization/cannonize.h"
+#include "dag/dag.h"
+
+#include <cmath>
+#include <cstring>
+
+namespace sym_arrow { namespace details
+{
+
+// 2/sqrt(pi)
+static const double two_over_sqrt_pi    = 1.12837916709551257390;
+
+static inline double eval_logistic(double x)
+{
+    // avoid overflow of exp for large |x|
+    if (x >= 0.0)
+        return 1.0 / (1.0 + std::exp(-x));
+
+    double e    = std::exp(x);
+    return e / (1.0 + e);
+};
+
+builtin_table::builtin_table()
+{};
+
+builtin_table* g_builtin_table
+    = sym_dag::global_objects::make_before<builtin_table>();
+
+builtin_table& builtin_table::get()
+{
+    return *g_builtin_table;
+};
+
+void builtin_table::init()
+{
+    // symbols are created on first use, when dag contexts are ready;
+    // names beginning with '$' are reserved and cannot be used by user
+    // symbols, therefore user functions named sin, cos, ... are not
+    // taken as builtin functions
+    const char* names[] = {"", "$sin", "$cos", "$tanh", "$erf", "$atan2", "$logistic",
+                           "$sqrt"};
+    size_t n            = sizeof(names) / sizeof(names[0]);
+
+    m_names.push_back(symbol());
+
+    for (size_t i = 1; i < n; ++i)
+    {
+        ast::named_symbol_info info(names[i], std::strlen(names[i]));
+        symbol sym      = symbol(ast::symbol_rep::make(info));
+        size_t code     = sym.get_ptr()->get_symbol_code();
+
+        if (code >= m_codes.size())
+            m_codes.resize(code + 1, builtin_code::none);
+
+        m_codes[code]   = builtin_code(i);
+        m_names.push_back(sym);
+    };
+};
+
+const symbol& builtin_table::get_name(builtin_code code)
+{
+    if (m_names.empty() == true)
+        init();
+
+    return m_names[size_t(code)];
+};
+
+size_t builtin_table::num_args(builtin_code code)
+{
+    switch (code)
+    {
+        case builtin_code::atan2:
+            return 2;
+        case builtin_code::none:
+            return 0;
+        default:
+            return 1;
+    };
+};
+
+double builtin_table::eval(builtin_code code, const double* args)
+{
+    switch (code)
+    {
+        case builtin_code::sin:         return std::sin(args[0]);
+        case builtin_code::cos:         return std::cos(args[0]);
+        case builtin_code::tanh:        return std::tanh(args[0]);
+        case builtin_code::erf:         return std::erf(args[0]);
+        case builtin_code::atan2:       return std::atan2(args[0], args[1]);
+        case builtin_code::logistic:    return eval_logistic(args[0]);
+        case builtin_code::sqrt:        return std::sqrt(args[0]);
+        default:
+            assertion(0, "unknown builtin function");
+            throw;
+    };
+};
+
+void builtin_table::eval(builtin_code code, size_t n, const double* const* args,
+                         double* res)
+{
+    // simple loops, that can be vectorized
+    const double* a     = args[0];
+
+    switch (code)
+    {
+        case builtin_code::sin:
+            for (size_t j = 0; j < n; ++j)
+                res[j]  = std::sin(a[j]);
+            break;
+        case builtin_code::cos:
+            for (size_t j = 0; j < n; ++j)
+                res[j]  = std::cos(a[j]);
+            break;
+        case builtin_code::tanh:
+            for (size_t j = 0; j < n; ++j)
+                res[j]  = std::tanh(a[j]);
+            break;
+        case builtin_code::erf:
+            for (size_t j = 0; j < n; ++j)
+                res[j]  = std::erf(a[j]);
+            break;
+        case builtin_code::atan2:
+        {
+            const double* b = args[1];
+
+            for (size_t j = 0; j < n; ++j)
+                res[j]  = std::atan2(a[j], b[j]);
+            break;
+        }
+        case builtin_code::logistic:
+            for (size_t j = 0; j < n; ++j)
+                res[j]  = eval_logistic(a[j]);
+            break;
+        case builtin_code::sqrt:
+            for (size_t j = 0; j < n; ++j)
+                res[j]  = std::sqrt(a[j]);
+            break;
+        default:
+            assertion(0, "unknown builtin function");
+            throw;
+    };
+};
+
+void builtin_table::eval_sin_cos(double x, double& s, double& c)
+{
+    s   = std::sin(x);
+    c   = std::cos(x);
+};
+
+double builtin_table::eval_diff(builtin_code code, const double* args, double* grad,
+                               double* hess)
+{
+    double x    = args[0];
+    double f, f1, f2;
+
+    switch (code)
+    {
+        case builtin_code::sin:
+            f       = std::sin(x);
+            f1      = std::cos(x);
+            f2      = -f;
+            break;
+        case builtin_code::cos:
+            f       = std::cos(x);
+            f1      = -std::sin(x);
+            f2      = -f;
+            break;
+        case builtin_code::tanh:
+            f       = std::tanh(x);
+            f1      = 1.0 - f * f;
+            f2      = -2.0 * f * f1;
+            break;
+        case builtin_code::erf:
+            f       = std::erf(x);
+            f1      = two_over_sqrt_pi * std::exp(-x * x);
+            f2      = -2.0 * x * f1;
+            break;
+        case builtin_code::atan2:
+        {
+            // atan2(y, x)
+            double y    = args[0];
+            double z    = args[1];
+            double r2   = y * y + z * z;
+
+            grad[0]     = z / r2;
+            grad[1]     = -y / r2;
+
+            if (hess != nullptr)
+            {
+                double r4   = r2 * r2;
+                hess[0]     = -2.0 * y * z / r4;
+                hess[1]     = (y * y - z * z) / r4;
+                hess[2]     = hess[1];
+                hess[3]     = 2.0 * y * z / r4;
+            };
+
+            return std::atan2(y, z);
+        }
+        case builtin_code::logistic:
+            f       = eval_logistic(x);
+            f1      = f * (1.0 - f);
+            f2      = f1 * (1.0 - 2.0 * f);
+            break;
+        case builtin_code::sqrt:
+            f       = std::sqrt(x);
+            f1      = 0.5 / f;
+            f2      = -0.5 * f1 / x;
+            break;
+        default:
+            assertion(0, "unknown builtin function");
+            throw;
+    };
+
+    grad[0]     = f1;
+
+    if (hess != nullptr)
+        hess[0] = f2;
+
+    return f;
+};
+
+expr builtin_table::diff(builtin_code code, size_t arg, const expr* args)
+{
+    const expr& x   = args[0];
+
+    switch (code)
+    {
+        case builtin_code::sin:
+            return sym_arrow::cos(x);
+        case builtin_code::cos:
+            return -sym_arrow::sin(x);
+        case builtin_code::tanh:
+            return value::make_one() - power_int(sym_arrow::tanh(x), 2);
+        case builtin_code::erf:
+            return value::make_value(two_over_sqrt_pi) * exp(-power_int(x, 2));
+        case builtin_code::atan2:
+        {
+            // atan2(y, x); d/dy = x / (x^2 + y^2), d/dx = -y / (x^2 + y^2)
+            const expr& y   = args[0];
+            const expr& z   = args[1];
+            expr den        = power_int(y, 2) + power_int(z, 2);
+
+            if (arg == 0)
+                return z / den;
+            else
+                return -y / den;
+        }
+        case builtin_code::logistic:
+        {
+            expr l          = sym_arrow::logistic(x);
+            return l * (value::make_one() - l);
+        }
+        case builtin_code::sqrt:
+            return value::make_value(0.5) * power_int(sym_arrow::sqrt(x), -1);
+        default:
+            assertion(0, "unknown builtin function");
+            throw;
+    };
+};
+
+// create a builtin function node; scalar arguments are evaluated
+static expr make_builtin(builtin_code code, const expr* args)
+{
+    using table     = builtin_table;
+
+    size_t n        = table::num_args(code);
+    bool all_scalar = true;
+    double vals[2];
+
+    for (size_t i = 0; i < n; ++i)
+    {
+        args[i].cannonize(ast::cannonize::do_cse_lazy());
+
+        ast::expr_handle h  = args[i].get_expr_handle();
+
+        if (h->isa<ast::scalar_rep>() == false)
+        {
+            all_scalar      = false;
+            break;
+        };
+
+        vals[i]             = h->static_cast_to<ast::scalar_rep>()->get_data().get_value();
+    };
+
+    if (all_scalar == true)
+        return expr(value::make_value(table::eval(code, vals)));
+
+    return function(table::get().get_name(code), args, n);
+};
+
+}};
+
+namespace sym_arrow
+{
+
+expr sym_arrow::sin(const expr& x)
+{
+    return details::make_builtin(details::builtin_code::sin, &x);
+};
+
+expr sym_arrow::cos(const expr& x)
+{
+    return details::make_builtin(details::builtin_code::cos, &x);
+};
+
+expr sym_arrow::tanh(const expr& x)
+{
+    return details::make_builtin(details::builtin_code::tanh, &x);
+};
+
+expr sym_arrow::erf(const expr& x)
+{
+    return details::make_builtin(details::builtin_code::erf, &x);
+};
+
+expr sym_arrow::sqrt(const expr& x)
+{
+    return details::make_builtin(details::builtin_code::sqrt, &x);
+};
+
+expr sym_arrow::atan2(const expr& y, const expr& x)
+{
+    expr args[] = {y, x};
+    return details::make_builtin(details::builtin_code::atan2, args);
+};
+
+expr sym_arrow::logistic(const expr& x)
+{
+    return details::make_builtin(details::builtin_code::logistic, &x);
+};
+
+};
@@ -0,0 +1,111 @@
+/* 
+ *  This file is a part of sym_arrow library.
+ *
+ *  Copyright (c) Pawe Kowal 2017 - 2021
+ *
+ *  This program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program; if not, write to the Free Software
+ *  Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA 02111-1307 USA
+ */
+
+#pragma once
+
+#include "sym_arrow/nodes/expr.h"
+#include "sym_arrow/ast/symbol_rep.h"
+
+#include <vector>
+
+namespace sym_arrow { namespace details
+{
+
+// codes of builtin functions
+enum class builtin_code : unsigned char
+{
+    none, sin, cos, tanh, erf, atan2, logistic, sqrt
+};
+
+// builtin elementary functions; builtin functions are represented by
+// function_rep nodes with reserved names, but derivatives and values are
+// computed without diff_context and data_provider
+class builtin_table
+{
+    private:
+        using symbol_vec    = std::vector<symbol>;
+        using code_vec      = std::vector<builtin_code>;
+
+    private:
+        // function names indexed by builtin codes
+        symbol_vec          m_names;
+
+        // builtin codes indexed by symbol codes
+        code_vec            m_codes;
+
+    public:
+        builtin_table();
+
+        // global instance
+        static builtin_table&   get();
+
+        // name of a builtin function
+        const symbol&       get_name(builtin_code code);
+
+        // code of a function with given name and number of arguments;
+        // return builtin_code::none if this is not a builtin function
+        builtin_code        get_code(ast::symbol_handle name, size_t n_args);
+
+        // number of arguments of a builtin function
+        static size_t       num_args(builtin_code code);
+
+        // evaluate a builtin function
+        static double       eval(builtin_code code, const double* args);
+
+        // evaluate a builtin function at n points; args[i] is an array
+        // of values of i-th argument
+        static void         eval(builtin_code code, size_t n, const double* const* args,
+                                double* res);
+
+        // evaluate sin and cos of the same argument
+        static void         eval_sin_cos(double x, double& s, double& c);
+
+        // evaluate a builtin function, its partial derivatives grad[i]
+        // and second order partial derivatives hess[i * n + j], where n
+        // is the number of arguments; hess can be null
+        static double       eval_diff(builtin_code code, const double* args,
+                                double* grad, double* hess);
+
+        // partial derivative with respect to arg-th argument
+        static expr         diff(builtin_code code, size_t arg, const expr* args);
+
+    private:
+        void                init();
+};
+
+inline builtin_code builtin_table::get_code(ast::symbol_handle name, size_t n_args)
+{
+    if (m_names.empty() == true)
+        init();
+
+    size_t sym_code     = name->get_symbol_code();
+
+    if (sym_code >= m_codes.size())
+        return builtin_code::none;
+
+    builtin_code code   = m_codes[sym_code];
+
+    if (code == builtin_code::none || num_args(code) != n_args)
+        return builtin_code::none;
+
+    return code;
+};
+
+}};
@@ -0,0 +1,383 @@
+/* 
+ *  This file is a part of sym_arrow library.
+ *
+ *  Copyright (c) Pawe Kowal 2017 - 2021
+ *
+ *  This program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program; if not, write to the Free Software
+ *  Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA 02111-1307 USA
+ */
+
+#include "sym_arrow/config.h"
+#include "sym_arrow/nodes/expr.h"
+#include "sym_arrow/functions/expr_functions.h"
+#include "sl_program.h"
+#include "builtin_table.h"
+
+#include <iomanip>
+#include <sstream>
+#include <cmath>
+
+namespace sym_arrow { namespace details
+{
+
+class codegen_c_impl
+{
+    private:
+        const sl_program&   m_prog;
+        std::ostream&       m_os;
+
+        // index of a function in the array f of user functions or
+        // no_index if the function is builtin
+        std::vector<size_t> m_user_index;
+
+        static const size_t no_index = size_t(-1);
+
+    public:
+        codegen_c_impl(const sl_program& prog, std::ostream& os);
+
+        void                make(const std::string& func_name);
+
+    private:
+        void                init_functions();
+        void                print_header(const std::string& func_name);
+        void                print_instr(size_t k);
+        void                print_call(size_t k, builtin_code code);
+        void                print_reg(size_t k);
+        void                print_scal(const value& v);
+        bool                is_inlined(size_t k) const;
+};
+
+codegen_c_impl::codegen_c_impl(const sl_program& prog, std::ostream& os)
+    :m_prog(prog), m_os(os)
+{
+    init_functions();
+};
+
+void codegen_c_impl::init_functions()
+{
+    // builtin functions are evaluated by functions from math.h, only
+    // user functions are called through pointers
+    const auto& fun     = m_prog.get_functions();
+    const auto& args    = m_prog.get_call_args();
+
+    std::vector<bool> is_user(fun.size(), false);
+
+    for (size_t k = 0; k < m_prog.size(); ++k)
+    {
+        const sl_instr& ins = m_prog.get_instr(k);
+
+        if (ins.m_code != sl_code::call)
+            continue;
+
+        size_t n_args       = args[ins.m_arg2];
+        builtin_code code   = builtin_table::get().get_code
+                                (fun[ins.m_arg1].get_ptr().get(), n_args);
+
+        if (code == builtin_code::none)
+            is_user[ins.m_arg1] = true;
+    };
+
+    size_t n_user       = 0;
+    m_user_index.assign(fun.size(), size_t(no_index));
+
+    for (size_t i = 0; i < fun.size(); ++i)
+    {
+        if (is_user[i] == true)
+            m_user_index[i] = n_user++;
+    };
+};
+
+void codegen_c_impl::make(const std::string& func_name)
+{
+    print_header(func_name);
+
+    m_os << "{" << "\n";
+
+    size_t n    = m_prog.size();
+
+    for (size_t k = 0; k < n; ++k)
+    {
+        if (is_inlined(k) == true)
+            continue;
+
+        print_instr(k);
+    };
+
+    if (n > 0)
+        m_os << "\n";
+
+    const auto& out = m_prog.get_outputs();
+
+    for (size_t i = 0; i < out.size(); ++i)
+    {
+        m_os << "    y[" << i << "] = ";
+        print_reg(out[i]);
+        m_os << ";" << "\n";
+    };
+
+    m_os << "}" << "\n";
+};
+
+void codegen_c_impl::print_header(const std::string& func_name)
+{
+    const auto& in  = m_prog.get_inputs();
+    const auto& fun = m_prog.get_functions();
+
+    m_os << "#include <math.h>" << "\n";
+    m_os << "\n";
+    m_os << "#ifndef SYM_ARROW_FUNC_DEFINED" << "\n";
+    m_os << "#define SYM_ARROW_FUNC_DEFINED" << "\n";
+    m_os << "typedef double (*sym_arrow_func)(const double* args, int n_args);" << "\n";
+    m_os << "\n";
+    m_os << "/* logistic function; exp does not overflow for large |x| */" << "\n";
+    m_os << "static inline double sym_arrow_logistic(double x)" << "\n";
+    m_os << "{" << "\n";
+    m_os << "    double e;" << "\n";
+    m_os << "    if (x >= 0.0)" << "\n";
+    m_os << "        return 1.0 / (1.0 + exp(-x));" << "\n";
+    m_os << "    e = exp(x);" << "\n";
+    m_os << "    return e / (1.0 + e);" << "\n";
+    m_os << "}" << "\n";
+    m_os << "#endif" << "\n";
+    m_os << "\n";
+
+    m_os << "/*" << "\n";
+
+    for (size_t i = 0; i < in.size(); ++i)
+        m_os << " *  x[" << i << "] = " << in[i].get_name() << "\n";
+
+    for (size_t i = 0; i < fun.size(); ++i)
+    {
+        if (m_user_index[i] != no_index)
+            m_os << " *  f[" << m_user_index[i] << "] = " << fun[i].get_name() << "\n";
+    };
+
+    m_os << " */" << "\n";
+
+    m_os << "void " << func_name
+         << "(const double* x, double* y, const sym_arrow_func* f)" << "\n";
+};
+
+// inputs and constants are not stored in temporaries
+bool codegen_c_impl::is_inlined(size_t k) const
+{
+    sl_code code = m_prog.get_instr(k).m_code;
+    return code == sl_code::input || code == sl_code::constant;
+};
+
+void codegen_c_impl::print_reg(size_t k)
+{
+    const sl_instr& ins = m_prog.get_instr(k);
+
+    if (ins.m_code == sl_code::input)
+        m_os << "x[" << ins.m_arg1 << "]";
+    else if (ins.m_code == sl_code::constant)
+        print_scal(ins.m_scal);
+    else
+        m_os << "t" << k;
+};
+
+void codegen_c_impl::print_scal(const value& v)
+{
+    double val  = v.get_value();
+
+    if (v.is_nan() == true)
+    {
+        m_os << "NAN";
+        return;
+    }
+    else if (v.is_inf_plus() == true)
+    {
+        m_os << "HUGE_VAL";
+        return;
+    }
+    else if (v.is_inf_minus() == true)
+    {
+        m_os << "(-HUGE_VAL)";
+        return;
+    };
+
+    std::ostringstream os;
+    os << std::setprecision(17) << val;
+
+    std::string str = os.str();
+
+    // make sure that the literal has floating point type
+    if (str.find_first_of(".eE") == std::string::npos)
+        str += ".0";
+
+    if (val < 0.0)
+        m_os << "(" << str << ")";
+    else
+        m_os << str;
+};
+
+void codegen_c_impl::print_instr(size_t k)
+{
+    const sl_instr& ins = m_prog.get_instr(k);
+
+    if (ins.m_code == sl_code::call)
+    {
+        const auto& fun     = m_prog.get_functions();
+        const auto& args    = m_prog.get_call_args();
+        size_t n_args       = args[ins.m_arg2];
+
+        builtin_code code   = builtin_table::get().get_code
+                                (fun[ins.m_arg1].get_ptr().get(), n_args);
+
+        if (code != builtin_code::none)
+        {
+            print_call(k, code);
+            return;
+        };
+
+        if (n_args > 0)
+        {
+            m_os << "    double a" << k << "[" << n_args << "] = {";
+
+            for (size_t i = 0; i < n_args; ++i)
+            {
+                if (i > 0)
+                    m_os << ", ";
+
+                print_reg(args[ins.m_arg2 + 1 + i]);
+            };
+
+            m_os << "};" << "\n";
+        };
+
+        m_os << "    double t" << k << " = f[" << m_user_index[ins.m_arg1] << "](";
+
+        if (n_args > 0)
+            m_os << "a" << k;
+        else
+            m_os << "0";
+
+        m_os << ", " << n_args << ");" << "\n";
+        return;
+    };
+
+    m_os << "    double t" << k << " = ";
+
+    switch (ins.m_code)
+    {
+        case sl_code::add:
+            print_reg(ins.m_arg1);
+            m_os << " + ";
+            print_reg(ins.m_arg2);
+            break;
+        case sl_code::sub:
+            print_reg(ins.m_arg1);
+            m_os << " - ";
+            print_reg(ins.m_arg2);
+            break;
+        case sl_code::mult:
+            print_reg(ins.m_arg1);
+            m_os << " * ";
+            print_reg(ins.m_arg2);
+            break;
+        case sl_code::add_scal:
+            print_scal(ins.m_scal);
+            m_os << " + ";
+            print_reg(ins.m_arg1);
+            break;
+        case sl_code::scale:
+            if (ins.m_scal.is_minus_one() == true)
+            {
+                m_os << "-";
+            }
+            else
+            {
+                print_scal(ins.m_scal);
+                m_os << " * ";
+            };
+            print_reg(ins.m_arg1);
+            break;
+        case sl_code::inv:
+            m_os << "1.0 / ";
+            print_reg(ins.m_arg1);
+            break;
+        case sl_code::pow_real:
+            m_os << "pow(fabs(";
+            print_reg(ins.m_arg1);
+            m_os << "), ";
+            print_scal(ins.m_scal);
+            m_os << ")";
+            break;
+        case sl_code::exp:
+            m_os << "exp(";
+            print_reg(ins.m_arg1);
+            m_os << ")";
+            break;
+        case sl_code::log:
+            m_os << "log(fabs(";
+            print_reg(ins.m_arg1);
+            m_os << "))";
+            break;
+        default:
+            assertion(0, "unexpected instruction");
+            throw;
+    };
+
+    m_os << ";" << "\n";
+};
+
+void codegen_c_impl::print_call(size_t k, builtin_code code)
+{
+    const sl_instr& ins = m_prog.get_instr(k);
+    const auto& args    = m_prog.get_call_args();
+    const size_t* arg   = args.data() + ins.m_arg2 + 1;
+
+    m_os << "    double t" << k << " = ";
+
+    switch (code)
+    {
+        case builtin_code::sin:         m_os << "sin(";                 break;
+        case builtin_code::cos:         m_os << "cos(";                 break;
+        case builtin_code::tanh:        m_os << "tanh(";                break;
+        case builtin_code::erf:         m_os << "erf(";                 break;
+        case builtin_code::atan2:       m_os << "atan2(";               break;
+        case builtin_code::logistic:    m_os << "sym_arrow_logistic(";  break;
+        case builtin_code::sqrt:        m_os << "sqrt(";                break;
+        default:
+            assertion(0, "unknown builtin function");
+            throw;
+    };
+
+    size_t n_args       = builtin_table::num_args(code);
+
+    for (size_t i = 0; i < n_args; ++i)
+    {
+        if (i > 0)
+            m_os << ", ";
+
+        print_reg(arg[i]);
+    };
+
+    m_os << ");" << "\n";
+};
+
+}};
+
+namespace sym_arrow
+{
+
+void sym_arrow::codegen_c(const std::vector<expr>& ex, const std::vector<symbol>& inputs,
+                          std::ostream& os, const std::string& func_name)
+{
+    details::sl_program prog(ex, inputs);
+    details::codegen_c_impl(prog, os).make(func_name);
+};
+
+};
@@ -0,0 +1,849 @@
+/* 
+ *  This file is a part of sym_arrow library.
+ *
+ *  Copyright (c) Pawe Kowal 2017 - 2021
+ *
+ *  This program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program; if not, write to the Free Software
+ *  Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA 02111-1307 USA
+ */
+
+#include "sym_arrow/functions/compiled_expr.h"
+#include "sym_arrow/functions/expr_functions.h"
+#include "sym_arrow/utils/stack_array.h"
+#include "sym_arrow/error/error_formatter.h"
+#include "sl_program.h"
+#include "builtin_table.h"
+
+#include <boost/functional/hash.hpp>
+#include <unordered_map>
+#include <tuple>
+#include <cmath>
+#include <algorithm>
+
+namespace sym_arrow { namespace details
+{
+
+namespace sd = sym_arrow :: details;
+
+//--------------------------------------------------------------------
+//                  numeric_ops
+//--------------------------------------------------------------------
+
+// operations on real numeric types used by compiled expressions
+template<class T>
+struct numeric_ops
+{
+    static T make(const value& v)
+    {
+        return T(v.get_value());
+    };
+
+    static double to_double(const T& x)
+    {
+        return double(x);
+    };
+
+    // |x|^c
+    static T pow_abs(const T& x, const T& c)
+    {
+        using std::pow;
+        using std::abs;
+        return pow(abs(x), c);
+    };
+
+    static T exp(const T& x)
+    {
+        using std::exp;
+        return exp(x);
+    };
+
+    // log|x|
+    static T log_abs(const T& x)
+    {
+        using std::log;
+        using std::abs;
+        return log(abs(x));
+    };
+
+    static void builtin(builtin_code code, size_t n, const T* const* args, T* res);
+
+    static T logistic(const T& x)
+    {
+        using std::exp;
+
+        // avoid overflow of exp for large |x|
+        if (x >= T(0.0))
+            return T(1.0) / (T(1.0) + exp(-x));
+
+        T e     = exp(x);
+        return e / (T(1.0) + e);
+    };
+};
+
+template<>
+inline double numeric_ops<double_double>::to_double(const double_double& x)
+{
+    return x.to_double();
+};
+
+template<class T>
+void numeric_ops<T>::builtin(builtin_code code, size_t n, const T* const* args, T* res)
+{
+    using std::sin;
+    using std::cos;
+    using std::tanh;
+    using std::erf;
+    using std::atan2;
+    using std::sqrt;
+
+    const T* a          = args[0];
+
+    switch (code)
+    {
+        case builtin_code::sin:
+            for (size_t j = 0; j < n; ++j)
+                res[j]  = sin(a[j]);
+            break;
+        case builtin_code::cos:
+            for (size_t j = 0; j < n; ++j)
+                res[j]  = cos(a[j]);
+            break;
+        case builtin_code::tanh:
+            for (size_t j = 0; j < n; ++j)
+                res[j]  = tanh(a[j]);
+            break;
+        case builtin_code::erf:
+            for (size_t j = 0; j < n; ++j)
+                res[j]  = erf(a[j]);
+            break;
+        case builtin_code::atan2:
+        {
+            const T* b  = args[1];
+
+            for (size_t j = 0; j < n; ++j)
+                res[j]  = atan2(a[j], b[j]);
+            break;
+        }
+        case builtin_code::logistic:
+            for (size_t j = 0; j < n; ++j)
+                res[j]  = logistic(a[j]);
+            break;
+        case builtin_code::sqrt:
+            for (size_t j = 0; j < n; ++j)
+                res[j]  = sqrt(a[j]);
+            break;
+        default:
+            assertion(0, "unknown builtin function");
+            throw;
+    };
+};
+
+// builtin functions on doubles are evaluated by builtin_table
+template<>
+void numeric_ops<double>::builtin(builtin_code code, size_t n, const double* const* args,
+                                  double* res)
+{
+    builtin_table::eval(code, n, args, res);
+};
+
+// operations on complex numbers; log and real powers act on the absolute
+// value as for real numbers, therefore results are real; functions, that
+// are not holomorphic (erf, atan2) and user functions are not available
+template<>
+struct numeric_ops<std::complex<double>>
+{
+    using T                 = std::complex<double>;
+
+    static T make(const value& v)
+    {
+        return T(v.get_value());
+    };
+
+    static double to_double(const T& x);
+
+    static T pow_abs(const T& x, const T& c)
+    {
+        return T(std::pow(std::abs(x), c.real()));
+    };
+
+    static T exp(const T& x)
+    {
+        return std::exp(x);
+    };
+
+    static T log_abs(const T& x)
+    {
+        return T(std::log(std::abs(x)));
+    };
+
+    static void builtin(builtin_code code, size_t n, const T* const* args, T* res);
+};
+
+static void error_complex_function(const symbol& f)
+{
+    error::error_formatter ef;
+    ef.head() << "function " << f.get_name() << " cannot be evaluated for complex numbers";
+
+    throw std::runtime_error(ef.str());
+};
+
+double numeric_ops<std::complex<double>>::to_double(const T& x)
+{
+    (void)x;
+
+    error::error_formatter ef;
+    ef.head() << "user functions cannot be evaluated for complex numbers";
+
+    throw std::runtime_error(ef.str());
+};
+
+void numeric_ops<std::complex<double>>::builtin(builtin_code code, size_t n,
+                                                const T* const* args, T* res)
+{
+    const T* a          = args[0];
+
+    switch (code)
+    {
+        case builtin_code::sin:
+            for (size_t j = 0; j < n; ++j)
+                res[j]  = std::sin(a[j]);
+            break;
+        case builtin_code::cos:
+            for (size_t j = 0; j < n; ++j)
+                res[j]  = std::cos(a[j]);
+            break;
+        case builtin_code::tanh:
+            for (size_t j = 0; j < n; ++j)
+                res[j]  = std::tanh(a[j]);
+            break;
+        case builtin_code::logistic:
+            // poles at i * pi * (2k + 1), no overflow protection needed
+            // for finite results
+            for (size_t j = 0; j < n; ++j)
+                res[j]  = T(1.0) / (T(1.0) + std::exp(-a[j]));
+            break;
+        case builtin_code::sqrt:
+            // principal square root
+            for (size_t j = 0; j < n; ++j)
+                res[j]  = std::sqrt(a[j]);
+            break;
+        case builtin_code::erf:
+        case builtin_code::atan2:
+            error_complex_function(builtin_table::get().get_name(code));
+            break;
+        default:
+            assertion(0, "unknown builtin function");
+            throw;
+    };
+};
+
+//--------------------------------------------------------------------
+//                  compiled_expr_impl
+//--------------------------------------------------------------------
+
+// single instruction operating on slots; slots are assigned to
+// registers of sl_program such that slots of dead registers are reused;
+// scalar of k-th instruction is stored in k-th element of coefficient
+// tables
+struct tape_instr
+{
+    sl_code         m_code;
+    size_t          m_dst;
+    size_t          m_arg1;
+    size_t          m_arg2;
+};
+
+class compiled_expr_impl
+{
+    private:
+        // number of points evaluated in one pass over the tape
+        static const size_t block_size  = 256;
+
+    private:
+        using instr_vec     = std::vector<tape_instr>;
+        using index_vec     = std::vector<size_t>;
+        using symbol_vec    = std::vector<symbol>;
+
+        // scalars converted to all supported numeric types
+        using coef_tables   = std::tuple<std::vector<float>, std::vector<double>,
+                                std::vector<long double>, std::vector<std::complex<double>>,
+                                std::vector<double_double>>;
+
+    private:
+        instr_vec           m_tape;
+        coef_tables         m_coefs;
+        index_vec           m_args;
+        index_vec           m_outputs;
+        symbol_vec          m_functions;
+        size_t              m_num_inputs;
+        size_t              m_num_slots;
+
+    public:
+        compiled_expr_impl(const sl_program& prog);
+
+        size_t              num_inputs() const      { return m_num_inputs; };
+        size_t              num_outputs() const     { return m_outputs.size(); };
+        size_t              num_instructions() const{ return m_tape.size(); };
+
+        template<class T>
+        void                eval(size_t n_points, const T* in, T* out,
+                                const data_provider& dp) const;
+
+    private:
+        template<class T>
+        void                make_coefs(const std::vector<value>& scal);
+
+        template<class T>
+        const T*            get_coefs() const;
+
+        template<class T>
+        void                eval_block(size_t n_points, size_t first, size_t n,
+                                size_t stride, const T* in, T* out, T* slots,
+                                const data_provider& dp) const;
+
+        template<class T>
+        void                eval_call(const tape_instr& ins, size_t n, size_t stride,
+                                T* slots, const data_provider& dp) const;
+};
+
+compiled_expr_impl::compiled_expr_impl(const sl_program& prog)
+    : m_functions(prog.get_functions()), m_num_inputs(prog.get_inputs().size())
+    , m_num_slots(0)
+{
+    size_t n                = prog.size();
+    const index_vec& args   = prog.get_call_args();
+    const index_vec& out    = prog.get_outputs();
+
+    // last instruction reading given register; outputs are never released
+    index_vec last_use(n, 0);
+
+    for (size_t k = 0; k < n; ++k)
+    {
+        const sl_instr& ins = prog.get_instr(k);
+
+        switch (ins.m_code)
+        {
+            case sl_code::input:
+            case sl_code::constant:
+                break;
+            case sl_code::add:
+            case sl_code::sub:
+            case sl_code::mult:
+                last_use[ins.m_arg1]    = k;
+                last_use[ins.m_arg2]    = k;
+                break;
+            case sl_code::call:
+            {
+                size_t n_args   = args[ins.m_arg2];
+
+                for (size_t i = 0; i < n_args; ++i)
+                    last_use[args[ins.m_arg2 + 1 + i]] = k;
+
+                break;
+            }
+            default:
+                last_use[ins.m_arg1]    = k;
+                break;
+        };
+    };
+
+    for (size_t i = 0; i < out.size(); ++i)
+        last_use[out[i]]    = n;
+
+    index_vec slot(n);
+    index_vec free_slots;
+    std::vector<bool> released(n, false);
+
+    auto release = [&](size_t r, size_t k)
+    {
+        if (last_use[r] == k && released[r] == false)
+        {
+            released[r]     = true;
+            free_slots.push_back(slot[r]);
+        };
+    };
+
+    m_tape.reserve(n);
+
+    std::vector<value> scal;
+    scal.reserve(n);
+
+    for (size_t k = 0; k < n; ++k)
+    {
+        const sl_instr& ins = prog.get_instr(k);
+
+        tape_instr ti;
+        ti.m_code   = ins.m_code;
+        ti.m_arg1   = ins.m_arg1;
+        ti.m_arg2   = ins.m_arg2;
+
+        scal.push_back(ins.m_scal);
+
+        // operands are released before the result is allocated; all
+        // instructions are elementwise, so the result can overwrite
+        // an operand
+        switch (ins.m_code)
+        {
+            case sl_code::input:
+            case sl_code::constant:
+                break;
+            case sl_code::add:
+            case sl_code::sub:
+            case sl_code::mult:
+                ti.m_arg1   = slot[ins.m_arg1];
+                ti.m_arg2   = slot[ins.m_arg2];
+                release(ins.m_arg1, k);
+                release(ins.m_arg2, k);
+                break;
+            case sl_code::call:
+            {
+                size_t n_args   = args[ins.m_arg2];
+                ti.m_arg2       = m_args.size();
+
+                m_args.push_back(n_args);
+
+                for (size_t i = 0; i < n_args; ++i)
+                    m_args.push_back(slot[args[ins.m_arg2 + 1 + i]]);
+
+                for (size_t i = 0; i < n_args; ++i)
+                    release(args[ins.m_arg2 + 1 + i], k);
+
+                break;
+            }
+            default:
+                ti.m_arg1   = slot[ins.m_arg1];
+                release(ins.m_arg1, k);
+                break;
+        };
+
+        if (free_slots.empty() == false)
+        {
+            slot[k]         = free_slots.back();
+            free_slots.pop_back();
+        }
+        else
+        {
+            slot[k]         = m_num_slots++;
+        };
+
+        ti.m_dst            = slot[k];
+        m_tape.push_back(ti);
+    };
+
+    m_outputs.reserve(out.size());
+
+    for (size_t i = 0; i < out.size(); ++i)
+        m_outputs.push_back(slot[out[i]]);
+
+    // coefficients are converted once
+    make_coefs<float>(scal);
+    make_coefs<double>(scal);
+    make_coefs<long double>(scal);
+    make_coefs<std::complex<double>>(scal);
+    make_coefs<double_double>(scal);
+};
+
+template<class T>
+void compiled_expr_impl::make_coefs(const std::vector<value>& scal)
+{
+    std::vector<T>& coefs   = std::get<std::vector<T>>(m_coefs);
+    coefs.reserve(scal.size());
+
+    for (const value& v : scal)
+        coefs.push_back(numeric_ops<T>::make(v));
+};
+
+template<class T>
+inline const T* compiled_expr_impl::get_coefs() const
+{
+    return std::get<std::vector<T>>(m_coefs).data();
+};
+
+template<class T>
+void compiled_expr_impl::eval(size_t n_points, const T* in, T* out,
+                              const data_provider& dp) const
+{
+    size_t stride       = (n_points < block_size) ? n_points : block_size;
+
+    // all supported numeric types are trivially copyable
+    sd::stack_array<sd::pod_type<T>, 64> buff(m_num_slots * stride);
+    T* slots            = buff.get_cast<T>();
+
+    for (size_t first = 0; first < n_points; first += stride)
+    {
+        size_t n        = std::min(stride, n_points - first);
+        eval_block(n_points, first, n, stride, in, out, slots, dp);
+    };
+};
+
+template<class T>
+void compiled_expr_impl::eval_block(size_t n_points, size_t first, size_t n,
+                size_t stride, const T* in, T* out, T* slots,
+                const data_provider& dp) const
+{
+    using ops       = numeric_ops<T>;
+
+    size_t size     = m_tape.size();
+    const T* coefs  = get_coefs<T>();
+
+    for (size_t k = 0; k < size; ++k)
+    {
+        const tape_instr& ins   = m_tape[k];
+        T* res                  = slots + ins.m_dst * stride;
+        const T* a1             = slots + ins.m_arg1 * stride;
+        const T* a2             = slots + ins.m_arg2 * stride;
+        const T& c              = coefs[k];
+
+        // simple loops over points, that can be vectorized by compiler
+        switch (ins.m_code)
+        {
+            case sl_code::input:
+            {
+                const T* x  = in + ins.m_arg1 * n_points + first;
+
+                for (size_t j = 0; j < n; ++j)
+                    res[j]  = x[j];
+
+                break;
+            }
+            case sl_code::constant:
+                for (size_t j = 0; j < n; ++j)
+                    res[j]  = c;
+                break;
+            case sl_code::add:
+                for (size_t j = 0; j < n; ++j)
+                    res[j]  = a1[j] + a2[j];
+                break;
+            case sl_code::sub:
+                for (size_t j = 0; j < n; ++j)
+                    res[j]  = a1[j] - a2[j];
+                break;
+            case sl_code::mult:
+                for (size_t j = 0; j < n; ++j)
+                    res[j]  = a1[j] * a2[j];
+                break;
+            case sl_code::add_scal:
+                for (size_t j = 0; j < n; ++j)
+                    res[j]  = c + a1[j];
+                break;
+            case sl_code::scale:
+                for (size_t j = 0; j < n; ++j)
+                    res[j]  = c * a1[j];
+                break;
+            case sl_code::inv:
+                for (size_t j = 0; j < n; ++j)
+                    res[j]  = T(1.0) / a1[j];
+                break;
+            case sl_code::pow_real:
+                for (size_t j = 0; j < n; ++j)
+                    res[j]  = ops::pow_abs(a1[j], c);
+                break;
+            case sl_code::exp:
+                for (size_t j = 0; j < n; ++j)
+                    res[j]  = ops::exp(a1[j]);
+                break;
+            case sl_code::log:
+                for (size_t j = 0; j < n; ++j)
+                    res[j]  = ops::log_abs(a1[j]);
+                break;
+            case sl_code::call:
+                eval_call(ins, n, stride, slots, dp);
+                break;
+            default:
+                assertion(0, "unknown instruction");
+                throw;
+        };
+    };
+
+    size_t n_out    = m_outputs.size();
+
+    for (size_t i = 0; i < n_out; ++i)
+    {
+        const T* res        = slots + m_outputs[i] * stride;
+        T* y                = out + i * n_points + first;
+
+        for (size_t j = 0; j < n; ++j)
+            y[j]            = res[j];
+    };
+};
+
+template<class T>
+void compiled_expr_impl::eval_call(const tape_instr& ins, size_t n, size_t stride,
+                                   T* slots, const data_provider& dp) const
+{
+    using ops           = numeric_ops<T>;
+
+    size_t n_args       = m_args[ins.m_arg2];
+    const size_t* a     = m_args.data() + ins.m_arg2 + 1;
+    T* res              = slots + ins.m_dst * stride;
+    const symbol& f     = m_functions[ins.m_arg1];
+
+    builtin_code code   = builtin_table::get().get_code(f.get_ptr().get(), n_args);
+
+    if (code != builtin_code::none)
+    {
+        const T* arg_ptr[2];
+
+        for (size_t i = 0; i < n_args; ++i)
+            arg_ptr[i]  = slots + a[i] * stride;
+
+        ops::builtin(code, n, arg_ptr, res);
+        return;
+    };
+
+    using value_pod     =  sd::pod_type<value>;
+    int size_counter    = 0;
+    value_pod::destructor_type d(&size_counter);
+
+    sd::stack_array<value_pod> buff(n_args, &d);
+    value* args         = reinterpret_cast<value*>(buff.get());
+
+    for (size_t i = 0; i < n_args; ++i)
+    {
+        new(args + size_counter) value();
+        ++size_counter;
+    };
+
+    // user functions are evaluated in double precision
+    for (size_t j = 0; j < n; ++j)
+    {
+        for (size_t i = 0; i < n_args; ++i)
+            args[i]     = value::make_value(ops::to_double(slots[a[i] * stride + j]));
+
+        res[j]          = ops::make(dp.eval_function(f, args, n_args));
+    };
+};
+
+//--------------------------------------------------------------------
+//                  compiled_expr_cache
+//--------------------------------------------------------------------
+
+// cache of compiled expressions; since expressions are hashed (equal
+// cannonized expressions have the same address), then the structural
+// hash is computed from addresses of cannonized expressions
+class compiled_expr_cache : public sym_dag::node_cache
+{
+    private:
+        // when number of stored items exceeds this value, then the cache
+        // is cleared
+        static const size_t max_size    = 1000;
+
+    private:
+        using impl_ptr      = std::shared_ptr<const compiled_expr_impl>;
+
+        struct entry
+        {
+            std::vector<expr>   m_ex;
+            std::vector<symbol> m_inputs;
+            impl_ptr            m_impl;
+        };
+
+        using entry_vec     = std::vector<entry>;
+        using hash_map      = std::unordered_map<size_t, entry_vec>;
+
+    private:
+        hash_map            m_map;
+        size_t              m_size;
+
+    private:
+        compiled_expr_cache();
+
+        compiled_expr_cache(const compiled_expr_cache&) = delete;
+        compiled_expr_cache& operator=(const compiled_expr_cache&) = delete;
+
+        friend sym_dag::global_objects;
+
+    public:
+        static compiled_expr_cache& get();
+
+        // find compiled code or compile expressions ex
+        impl_ptr            make(const std::vector<expr>& ex,
+                                const std::vector<symbol>& inputs);
+
+        virtual void        clear() override;
+
+    private:
+        static size_t       eval_hash(const std::vector<expr>& ex,
+                                const std::vector<symbol>& inputs);
+        static bool         equal(const entry& e, const std::vector<expr>& ex,
+                                const std::vector<symbol>& inputs);
+};
+
+compiled_expr_cache::compiled_expr_cache()
+    :m_size(0)
+{
+    sym_dag::registered_dag_context::get().register_cache(this);
+};
+
+compiled_expr_cache* g_compiled_expr_cache
+    = sym_dag::global_objects::make_before<compiled_expr_cache>();
+
+compiled_expr_cache& compiled_expr_cache::get()
+{
+    return *g_compiled_expr_cache;
+};
+
+void compiled_expr_cache::clear()
+{
+    m_map.clear();
+    m_size = 0;
+};
+
+size_t compiled_expr_cache::eval_hash(const std::vector<expr>& ex,
+                                      const std::vector<symbol>& inputs)
+{
+    size_t seed = ex.size();
+
+    for (const expr& e : ex)
+        boost::hash_combine(seed, e.get_ptr().get());
+
+    for (const symbol& s : inputs)
+        boost::hash_combine(seed, s.get_ptr()->get_symbol_code());
+
+    return seed;
+};
+
+bool compiled_expr_cache::equal(const entry& e, const std::vector<expr>& ex,
+                                const std::vector<symbol>& inputs)
+{
+    if (e.m_ex.size() != ex.size() || e.m_inputs.size() != inputs.size())
+        return false;
+
+    for (size_t i = 0; i < ex.size(); ++i)
+    {
+        if (e.m_ex[i].get_ptr().get() != ex[i].get_ptr().get())
+            return false;
+    };
+
+    for (size_t i = 0; i < inputs.size(); ++i)
+    {
+        if (e.m_inputs[i].get_ptr().get() != inputs[i].get_ptr().get())
+            return false;
+    };
+
+    return true;
+};
+
+compiled_expr_cache::impl_ptr
+compiled_expr_cache::make(const std::vector<expr>& ex, const std::vector<symbol>& inputs)
+{
+    for (const expr& e : ex)
+        e.cannonize(do_cse_default);
+
+    size_t hash     = eval_hash(ex, inputs);
+    auto pos        = m_map.find(hash);
+
+    if (pos != m_map.end())
+    {
+        for (const entry& e : pos->second)
+        {
+            if (equal(e, ex, inputs) == true)
+                return e.m_impl;
+        };
+    };
+
+    sl_program prog(ex, inputs);
+    impl_ptr impl   = impl_ptr(new compiled_expr_impl(prog));
+
+    if (m_size >= max_size)
+        clear();
+
+    entry e;
+    e.m_ex          = ex;
+    e.m_inputs      = inputs;
+    e.m_impl        = impl;
+
+    m_map[hash].push_back(std::move(e));
+    ++m_size;
+
+    return impl;
+};
+
+}};
+
+namespace sym_arrow
+{
+
+compiled_expr::compiled_expr(const std::vector<expr>& ex, const std::vector<symbol>& inputs)
+    :m_impl(details::compiled_expr_cache::get().make(ex, inputs))
+{};
+
+compiled_expr::compiled_expr(const expr& ex, const std::vector<symbol>& inputs)
+    :m_impl(details::compiled_expr_cache::get().make(std::vector<expr>{ex}, inputs))
+{};
+
+size_t compiled_expr::num_inputs() const
+{
+    return m_impl->num_inputs();
+};
+
+size_t compiled_expr::num_outputs() const
+{
+    return m_impl->num_outputs();
+};
+
+size_t compiled_expr::num_instructions() const
+{
+    return m_impl->num_instructions();
+};
+
+void compiled_expr::eval(const double* in, double* out, const data_provider& dp) const
+{
+    m_impl->eval(1, in, out, dp);
+};
+
+void compiled_expr::eval(size_t n_points, const double* in, double* out,
+                         const data_provider& dp) const
+{
+    m_impl->eval(n_points, in, out, dp);
+};
+
+template<class T>
+void compiled_expr::eval(const T* in, T* out, const data_provider& dp) const
+{
+    m_impl->eval(1, in, out, dp);
+};
+
+template<class T>
+void compiled_expr::eval(size_t n_points, const T* in, T* out, const data_provider& dp) const
+{
+    m_impl->eval(n_points, in, out, dp);
+};
+
+template void compiled_expr::eval<float>(const float*, float*,
+                                const data_provider&) const;
+template void compiled_expr::eval<double>(const double*, double*,
+                                const data_provider&) const;
+template void compiled_expr::eval<long double>(const long double*,
+                                long double*, const data_provider&) const;
+template void compiled_expr::eval<std::complex<double>>(
+                                const std::complex<double>*, std::complex<double>*,
+                                const data_provider&) const;
+template void compiled_expr::eval<double_double>(const double_double*,
+                                double_double*, const data_provider&) const;
+
+template void compiled_expr::eval<float>(size_t, const float*, float*,
+                                const data_provider&) const;
+template void compiled_expr::eval<double>(size_t, const double*, double*,
+                                const data_provider&) const;
+template void compiled_expr::eval<long double>(size_t, const long double*,
+                                long double*, const data_provider&) const;
+template void compiled_expr::eval<std::complex<double>>(size_t,
+                                const std::complex<double>*, std::complex<double>*,
+                                const data_provider&) const;
+template void compiled_expr::eval<double_double>(size_t,
+                                const double_double*, double_double*,
+                                const data_provider&) const;
+
+};
@@ -24,8 +24,12 @@
 #include "sym_arrow/ast/ast.h"
 #include "sym_arrow/functions/expr_functions.h"
 #include "sym_arrow/error/error_formatter.h"
+#include "sym_arrow/func/subs_skeleton.h"
+
+#include <boost/functional/hash.hpp>
 
 #include <sstream>
+#include <unordered_map>
 
 namespace sym_arrow { namespace details
 {
@@ -35,8 +39,12 @@ class subs_context_impl
     public:
         using expr_vec      = std::vector<expr>;
         using sym_map       = std::map<symbol, size_t>;
+        using slot_vec      = std::vector<size_t>;
         using dbs           = dbs_lib::dbs;
 
+        // slot of symbols without substitution
+        static const size_t no_slot     = size_t(-1);
+
     public:
         subs_context_impl();
 
@@ -45,13 +53,26 @@ class subs_context_impl
         expr_vec            m_buffer;
         const expr*         m_bind;
 
+        // map from symbol codes to positions in m_buffer; symbol codes
+        // are small integers, therefore direct indexing is used; m_map
+        // is only used to visit substitutions in a fixed order
+        slot_vec            m_slots;
+
     public:
         void                remove_bind();
 
+        // set position in m_buffer for a symbol with given code
+        void                set_slot(size_t sym_code, size_t slot);
+
+        // return position in m_buffer or no_slot
+        size_t              get_slot(size_t sym_code) const;
+
     public:
         void                error_invalid_bind_size(size_t size, size_t exp_size) const;
 };    
 
+const size_t subs_context_impl::no_slot;
+
 subs_context_impl::subs_context_impl()
     :m_bind(nullptr)
 {};
@@ -61,6 +82,19 @@ void subs_context_impl::remove_bind()
     m_bind = nullptr;
 }
 
+void subs_context_impl::set_slot(size_t sym_code, size_t slot)
+{
+    if (sym_code >= m_slots.size())
+        m_slots.resize(sym_code + 1, no_slot);
+
+    m_slots[sym_code] = slot;
+};
+
+inline size_t subs_context_impl::get_slot(size_t sym_code) const
+{
+    return sym_code < m_slots.size() ? m_slots[sym_code] : no_slot;
+};
+
 void subs_context_impl::error_invalid_bind_size(size_t size, size_t exp_size) const
 {
     error::error_formatter ef;
@@ -124,16 +158,22 @@ void subs_context::add_symbol(const symbol& sym, size_t code)
 {
     m_impl->remove_bind();
 
+    size_t sym_code     = sym.get_ptr()->get_symbol_code();
+
     m_impl->m_map[sym]  = code;
-    m_impl->m_set       = m_impl->m_set.set(sym.get_ptr()->get_symbol_code());
+    m_impl->m_set       = m_impl->m_set.set(sym_code);
+    m_impl->set_slot(sym_code, code);
 };
 
 void subs_context::remove_symbol(const symbol& sym)
 {
     remove_bind();
 
+    size_t sym_code = sym.get_ptr()->get_symbol_code();
+
     m_impl->m_map.erase(sym);
-    m_impl->m_set = m_impl->m_set.reset(sym.get_ptr()->get_symbol_code());
+    m_impl->m_set   = m_impl->m_set.reset(sym_code);
+    m_impl->set_slot(sym_code, details::subs_context_impl::no_slot);
 };
 
 size_t subs_context::size() const
@@ -172,15 +212,19 @@ void subs_context::disp(std::ostream& os) const
 
 expr subs_context::subs(const symbol& sh) const
 {
-    auto pos = m_impl->m_map.find(sh);
+    return subs(sh.get_ptr()->get_symbol_code());
+};
+
+expr subs_context::subs(size_t sym_code) const
+{
+    size_t code     = m_impl->get_slot(sym_code);
 
-    if (pos == m_impl->m_map.end())
+    if (code == details::subs_context_impl::no_slot)
         return expr();
 
-    size_t code = pos->second;
-    expr ex     = m_impl->m_buffer[code];
+    const expr& ex  = m_impl->m_buffer[code];
 
-    if (ex.is_null() == true && m_impl->m_bind == nullptr)
+    if (ex.is_null() == false || m_impl->m_bind == nullptr)
         return ex;
     else
         return m_impl->m_bind[code];
@@ -213,11 +257,17 @@ void subs_context::visit_substitutions(substitution_vis& info) const
 namespace details
 {
 
+// differentiation rule compiled to a substitution skeleton of the
+// rule body; argument i is substituted for i-th rule symbol
 class diff_rule
 {
     private:
-        expr            m_expr;
-        subs_context    m_subs;
+        using skeleton_ptr  = std::shared_ptr<subs_skeleton>;
+
+    private:
+        expr                m_expr;
+        std::vector<symbol> m_args;
+        skeleton_ptr        m_skeleton;
 
     public:
         diff_rule(size_t n_args, const symbol* args, const expr& dif);
@@ -225,7 +275,7 @@ class diff_rule
         const expr&     get_diff_result() const;
         size_t          number_args() const;
         void            get_function_args(std::vector<symbol>& rule_args) const;
-        expr            make_subs(size_t n_args, const expr* args);
+        expr            make_subs(size_t n_args, const expr* args) const;
 };
 
 class diff_context_impl
@@ -235,16 +285,52 @@ class diff_context_impl
         using key       = std::tuple<symbol, size_t, size_t>;
         using value     = diff_rule;
 
-        using diff_map  = std::map<key, value>;
+        struct key_hash
+        {
+            size_t operator()(const key& k) const;
+        };
+
+        struct key_equal
+        {
+            bool operator()(const key& k1, const key& k2) const;
+        };
+
+        using diff_map  = std::unordered_map<key, value, key_hash, key_equal>;
+
+        // rule and arguments of a rule application; arguments are
+        // stored in order to keep handles valid
+        struct memo_key
+        {
+            const diff_rule*    m_rule;
+            std::vector<expr>   m_args;
+        };
+
+        struct memo_hash
+        {
+            size_t operator()(const memo_key& k) const;
+        };
+
+        struct memo_equal
+        {
+            bool operator()(const memo_key& k1, const memo_key& k2) const;
+        };
+
+        using memo_map  = std::unordered_map<memo_key, expr, memo_hash, memo_equal>;
+
+        // memo is cleared when this size is exceeded
+        static const size_t max_memo_size   = 10000;
 
     private:
         diff_map        m_diff_map;
+        memo_map        m_memo;
 
     public:
         diff_context_impl();
 
         expr            diff(const symbol& func_name, size_t arg_num, const expr* args,
                             size_t n_args);
+        expr            get_diff_rule(const symbol& func_name, size_t arg_num,
+                            size_t n_args, std::vector<symbol>& rule_args) const;
         void            add_diff_rule(const symbol& func_name, size_t n_args,
                             const symbol* args, size_t diff_arg, const expr& dif);
 
@@ -259,10 +345,10 @@ class diff_context_impl
 };
 
 diff_rule::diff_rule(size_t n_args, const symbol* args, const expr& dif)
-    :m_expr(dif)
+    :m_expr(dif), m_args(args, args + n_args)
 {
-    for (size_t i = 0; i < n_args; ++i)
-        m_subs.add_symbol(args[i]);
+    m_expr.cannonize(do_cse_default);
+    m_skeleton  = std::make_shared<subs_skeleton>(m_expr.get_expr_handle(), m_args);
 };
 
 const expr& diff_rule::get_diff_result() const
@@ -272,40 +358,65 @@ const expr& diff_rule::get_diff_result() const
 
 size_t diff_rule::number_args() const
 {
-    return m_subs.size();
+    return m_args.size();
 }
 
-expr diff_rule::make_subs(size_t n_args, const expr* args)
+expr diff_rule::make_subs(size_t n_args, const expr* args) const
 {
-    m_subs.set_bind(n_args, args);
-    return subs(m_expr, m_subs);
+    (void)n_args;
+
+    expr ret    = m_skeleton->make(args);
+
+    if (ret.is_null() == true)
+        return m_expr;
+    else
+        return ret;
 };
 
 void diff_rule::get_function_args(std::vector<symbol>& rule_args) const
 {
-    struct substitution_info_impl : public substitution_vis
-    {
-        std::vector<symbol>& rule_args;
+    rule_args   = m_args;
+};
 
-        substitution_info_impl(std::vector<symbol>& args)
-            :rule_args(args)
-        {};
+size_t diff_context_impl::key_hash::operator()(const key& k) const
+{
+    size_t seed = std::get<0>(k).get_ptr()->get_symbol_code();
+    boost::hash_combine(seed, std::get<1>(k));
+    boost::hash_combine(seed, std::get<2>(k));
 
-        void report_size(size_t size, size_t bind_length) override
-        {
-            (void)size;
-            rule_args.resize(bind_length);
-        };
+    return seed;
+};
 
-        void report_subs(const symbol& sym, const expr& ex, size_t code) override
-        {
-            (void)ex;
-            rule_args[code] = sym;
-        };
+bool diff_context_impl::key_equal::operator()(const key& k1, const key& k2) const
+{
+    return std::get<0>(k1).get_ptr()->get_symbol_code()
+                == std::get<0>(k2).get_ptr()->get_symbol_code()
+        && std::get<1>(k1) == std::get<1>(k2) && std::get<2>(k1) == std::get<2>(k2);
+};
+
+size_t diff_context_impl::memo_hash::operator()(const memo_key& k) const
+{
+    size_t seed = 0;
+    boost::hash_combine(seed, k.m_rule);
+
+    for (const expr& e : k.m_args)
+        boost::hash_combine(seed, e.get_ptr().get());
+
+    return seed;
+};
+
+bool diff_context_impl::memo_equal::operator()(const memo_key& k1, const memo_key& k2) const
+{
+    if (k1.m_rule != k2.m_rule || k1.m_args.size() != k2.m_args.size())
+        return false;
+
+    for (size_t i = 0; i < k1.m_args.size(); ++i)
+    {
+        if (k1.m_args[i].get_ptr().get() != k2.m_args[i].get_ptr().get())
+            return false;
     };
 
-    substitution_info_impl si(rule_args);
-    m_subs.visit_substitutions(si);
+    return true;
 };
 
 diff_context_impl::diff_context_impl()
@@ -335,7 +446,37 @@ expr diff_context_impl::diff(const symbol& func_name, size_t arg_num, const expr
     if (pos == m_diff_map.end())
         return expr();
 
-    return pos->second.make_subs(n_args, args);
+    const diff_rule& rule   = pos->second;
+
+    memo_key mk{&rule, std::vector<expr>(args, args + n_args)};
+    auto pos_memo   = m_memo.find(mk);
+
+    if (pos_memo != m_memo.end())
+        return pos_memo->second;
+
+    expr ret        = rule.make_subs(n_args, args);
+
+    if (m_memo.size() >= max_memo_size)
+        m_memo.clear();
+
+    m_memo.insert(memo_map::value_type(std::move(mk), ret));
+    return ret;
+};
+
+expr diff_context_impl::get_diff_rule(const symbol& func_name, size_t arg_num,
+                    size_t n_args, std::vector<symbol>& rule_args) const
+{
+    key k       = key(func_name, n_args, arg_num);
+
+    auto pos = m_diff_map.find(k);
+
+    if (pos == m_diff_map.end())
+        return expr();
+
+    const diff_rule& rule   = pos->second;
+    rule.get_function_args(rule_args);
+
+    return rule.get_diff_result();
 };
 
 void diff_context_impl::error_rule_defined(const symbol& func_name, size_t n_args,
@@ -410,6 +551,12 @@ expr diff_context::diff(const symbol& func_name, size_t arg_num, const expr* arg
     return m_impl->diff(func_name, arg_num, args, n_args);
 };
 
+expr diff_context::get_diff_rule(const symbol& func_name, size_t arg_num,
+                    size_t n_args, std::vector<symbol>& rule_args) const
+{
+    return m_impl->get_diff_rule(func_name, arg_num, n_args, rule_args);
+};
+
 void diff_context::add_diff_rule(const symbol& func_name, size_t n_args,
                     const symbol* args, size_t diff_arg, const expr& dif)
 {
@@ -28,6 +28,7 @@
 #include "sym_arrow/func/symbol_functions.h"
 #include "sym_arrow/ast/cannonization/cannonize.h"
 #include "sym_arrow/func/diff_hash.h"
+#include "sym_arrow/func/builtin_table.h"
 #include "sym_arrow/functions/expr_functions.h"
 
 #include "sym_arrow/error/error_formatter.h"
@@ -430,7 +431,13 @@ expr do_diff_vis::func_derivative(const symbol& func_name, size_t arg, const exp
     if (is_zero == true)
         return arg_dif;
 
-    expr dif    = m_diff_context.diff(func_name, arg, args, n_args);
+    builtin_code code   = builtin_table::get().get_code(func_name.get_ptr().get(), n_args);
+    expr dif;
+
+    if (code != builtin_code::none)
+        dif     = builtin_table::diff(code, arg, args);
+    else
+        dif     = m_diff_context.diff(func_name, arg, args, n_args);
 
     if (dif.is_null() == true)
         error_diff_rule_not_defined(func_name, n_args, arg);
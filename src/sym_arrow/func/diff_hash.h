@@ -111,7 +111,7 @@ struct expr_sym
 
     size_t eval_hash() const
     {
-        size_t seed = m_code + (size_t)m_handle;
+        size_t seed = m_code + ast::expr_order::hash(m_handle);
         //boost::hash_combine(seed, m_code);
         return seed;
     }
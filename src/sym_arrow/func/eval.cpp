@@ -25,8 +25,12 @@
 #include "sym_arrow/ast/builder/vlist_add.h"
 #include "sym_arrow/utils/stack_array.h"
 #include "sym_arrow/functions/contexts.h"
+#include "sym_arrow/functions/static_eval.h"
 #include "sym_arrow/ast/mult_rep.inl"
 #include "sym_arrow/functions/expr_functions.h"
+#include "sym_arrow/ast/cannonization/cannonize.h"
+#include "sym_arrow/func/builtin_table.h"
+#include "sym_arrow/error/error_formatter.h"
 
 #include <sstream>
 
@@ -35,68 +39,169 @@ namespace sym_arrow { namespace details
 
 namespace sd = sym_arrow :: details;
 
-class do_eval_vis : public sym_dag::dag_visitor<sym_arrow::ast::term_tag, do_eval_vis>
+// access to values of symbols and functions through data_provider
+class virtual_leaf
 {
+    private:
+        const data_provider&    m_dp;
+
     public:
-        using tag_type  = sym_arrow::ast::term_tag;
+        virtual_leaf(const data_provider& dp)
+            :m_dp(dp)
+        {};
+
+        value get_value(const ast::symbol_rep* h) const
+        {
+            return m_dp.get_value(symbol(h));
+        };
+
+        value eval_function(const ast::function_rep* h, const value* args, 
+                            size_t n_size) const
+        {
+            symbol sym  = symbol(ast::symbol_ptr::from_this(h->name()));
+            return m_dp.eval_function(sym, args, n_size);
+        };
+};
+
+// access to values of symbols stored in an array indexed by symbol code
+class indexed_leaf
+{
+    private:
+        const value*        m_values;
+        size_t              m_size;
+        const unsigned char* m_set_mask;
+        const void*         m_provider;
+        eval_function_ptr   m_func;
 
     public:
-        template<class Node>
-        value eval(const Node* ast, const data_provider& dp);
+        indexed_leaf(const value* vals, size_t n_vals, const unsigned char* set_mask,
+                     const void* provider, eval_function_ptr func)
+            :m_values(vals), m_size(n_vals), m_set_mask(set_mask), m_provider(provider)
+            ,m_func(func)
+        {};
+
+        value get_value(const ast::symbol_rep* h) const
+        {
+            size_t code = h->get_symbol_code();
+
+            if (code >= m_size)
+                error_value_not_set(h);
+
+            if (m_set_mask != nullptr && m_set_mask[code] == 0)
+                error_value_not_set(h);
 
-        value eval(const ast::scalar_rep* h, const data_provider& dp);
-        value eval(const ast::symbol_rep* h, const data_provider& dp);
-        value eval(const ast::add_build* h, const data_provider& dp);
-        value eval(const ast::mult_build* h, const data_provider& dp);
-        value eval(const ast::add_rep* h, const data_provider& dp);
-        value eval(const ast::mult_rep* h, const data_provider& dp);
-        value eval(const ast::function_rep* h, const data_provider& dp);
+            return m_values[code];
+        };
+
+        value eval_function(const ast::function_rep* h, const value* args, 
+                            size_t n_size) const
+        {
+            return m_func(m_provider, h->name()->get_symbol_code(), args, n_size);
+        };
+
+    private:
+        static void error_value_not_set(const ast::symbol_rep* h);
 };
 
-class do_eval_vis_log : public sym_dag::dag_visitor<sym_arrow::ast::term_tag, do_eval_vis_log>
+void indexed_leaf::error_value_not_set(const ast::symbol_rep* h)
 {
+    error::error_formatter ef;
+    ef.head() << "value of symbol not set";
+
+    ef.new_info();
+    ef.line() << "symbol: ";
+    disp(ef.line(), symbol(h), false);
+
+    throw std::runtime_error(ef.str());
+};
+
+template<class Leaf>
+class do_eval_vis : public sym_dag::dag_visitor<sym_arrow::ast::term_tag, do_eval_vis<Leaf>>
+{
+    private:
+        // sin and cos of the last argument of sin or cos function
+        ast::expr_handle    m_sin_cos_arg;
+        double              m_sin;
+        double              m_cos;
+
     public:
         using tag_type  = sym_arrow::ast::term_tag;
 
     public:
+        do_eval_vis();
+
         template<class Node>
-        value eval(const Node* ast, const data_provider& dp);
+        value eval(const Node* ast, const Leaf& dp);
+
+        value eval(const ast::scalar_rep* h, const Leaf& dp);
+        value eval(const ast::symbol_rep* h, const Leaf& dp);
+        value eval(const ast::add_build* h, const Leaf& dp);
+        value eval(const ast::mult_build* h, const Leaf& dp);
+        value eval(const ast::add_rep* h, const Leaf& dp);
+        value eval(const ast::mult_rep* h, const Leaf& dp);
+        value eval(const ast::function_rep* h, const Leaf& dp);
+
+    private:
+        value eval_builtin(builtin_code code, const ast::function_rep* h, 
+                        const Leaf& dp);
+};
+
+template<class Leaf>
+class do_eval_vis_log : public sym_dag::dag_visitor<sym_arrow::ast::term_tag, do_eval_vis_log<Leaf>>
+{
+    public:
+        using tag_type  = sym_arrow::ast::term_tag;
 
-        value eval(const ast::scalar_rep* h, const data_provider& dp);
-        value eval(const ast::symbol_rep* h, const data_provider& dp);
-        value eval(const ast::add_build* h, const data_provider& dp);
-        value eval(const ast::mult_build* h, const data_provider& dp);
-        value eval(const ast::add_rep* h, const data_provider& dp);
-        value eval(const ast::mult_rep* h, const data_provider& dp);
-        value eval(const ast::function_rep* h, const data_provider& dp);
+    public:
+        template<class Node>
+        value eval(const Node* ast, const Leaf& dp);
+
+        value eval(const ast::scalar_rep* h, const Leaf& dp);
+        value eval(const ast::symbol_rep* h, const Leaf& dp);
+        value eval(const ast::add_build* h, const Leaf& dp);
+        value eval(const ast::mult_build* h, const Leaf& dp);
+        value eval(const ast::add_rep* h, const Leaf& dp);
+        value eval(const ast::mult_rep* h, const Leaf& dp);
+        value eval(const ast::function_rep* h, const Leaf& dp);
 };
 
-value do_eval_vis::eval(const ast::scalar_rep* h, const data_provider&)
+template<class Leaf>
+do_eval_vis<Leaf>::do_eval_vis()
+    :m_sin_cos_arg(nullptr), m_sin(0.0), m_cos(0.0)
+{};
+
+template<class Leaf>
+value do_eval_vis<Leaf>::eval(const ast::scalar_rep* h, const Leaf&)
 {
     return h->get_data();
 };
-value do_eval_vis_log::eval(const ast::scalar_rep* h, const data_provider&)
+template<class Leaf>
+value do_eval_vis_log<Leaf>::eval(const ast::scalar_rep* h, const Leaf&)
 {
     return log(h->get_data());
 };
 
-value do_eval_vis::eval(const ast::symbol_rep* h, const data_provider& dp)
+template<class Leaf>
+value do_eval_vis<Leaf>::eval(const ast::symbol_rep* h, const Leaf& dp)
 {
-    return dp.get_value(symbol(h));
+    return dp.get_value(h);
 };
-value do_eval_vis_log::eval(const ast::symbol_rep* h, const data_provider& dp)
+template<class Leaf>
+value do_eval_vis_log<Leaf>::eval(const ast::symbol_rep* h, const Leaf& dp)
 {
-    return log(dp.get_value(symbol(h)));
+    return log(dp.get_value(h));
 };
 
-value do_eval_vis::eval(const ast::add_build* h, const data_provider& dp)
+template<class Leaf>
+value do_eval_vis<Leaf>::eval(const ast::add_build* h, const Leaf& dp)
 {
     (void)h;
     (void)dp;
     assertion(0,"we should not be here");
     throw;
 }
-value do_eval_vis_log::eval(const ast::add_build* h, const data_provider& dp)
+template<class Leaf>
+value do_eval_vis_log<Leaf>::eval(const ast::add_build* h, const Leaf& dp)
 {
     (void)h;
     (void)dp;
@@ -104,14 +209,16 @@ value do_eval_vis_log::eval(const ast::add_build* h, const data_provider& dp)
     throw;
 }
 
-value do_eval_vis::eval(const ast::mult_build* h, const data_provider& dp)
+template<class Leaf>
+value do_eval_vis<Leaf>::eval(const ast::mult_build* h, const Leaf& dp)
 {
     (void)h;
     (void)dp;
     assertion(0,"we should not be here");
     throw;
 }
-value do_eval_vis_log::eval(const ast::mult_build* h, const data_provider& dp)
+template<class Leaf>
+value do_eval_vis_log<Leaf>::eval(const ast::mult_build* h, const Leaf& dp)
 {
     (void)h;
     (void)dp;
@@ -119,71 +226,81 @@ value do_eval_vis_log::eval(const ast::mult_build* h, const data_provider& dp)
     throw;
 }
 
-value do_eval_vis::eval(const ast::add_rep* h, const data_provider& dp)
+template<class Leaf>
+value do_eval_vis<Leaf>::eval(const ast::add_rep* h, const Leaf& dp)
 {
     value ret   = h->V0();
     size_t size = h->size();
 
     for(size_t i = 0; i < size; ++i)
     {
-        value tmp = h->V(i) * visit(h->E(i), dp);
+        value tmp = h->V(i) * this->visit(h->E(i), dp);
         ret = ret + tmp;
     };
 
     if (h->has_log())
-        ret = ret + do_eval_vis_log().visit(h->Log(), dp);
+        ret = ret + do_eval_vis_log<Leaf>().visit(h->Log(), dp);
 
     return ret;
 };
 
-value do_eval_vis_log::eval(const ast::add_rep* h, const data_provider& dp)
+template<class Leaf>
+value do_eval_vis_log<Leaf>::eval(const ast::add_rep* h, const Leaf& dp)
 {
-    value ret   = do_eval_vis().eval(h, dp);
+    value ret   = do_eval_vis<Leaf>().eval(h, dp);
     return log(ret);
 };
 
-value do_eval_vis::eval(const ast::mult_rep* h, const data_provider& dp)
+template<class Leaf>
+value do_eval_vis<Leaf>::eval(const ast::mult_rep* h, const Leaf& dp)
 {
     value ret = value::make_one();
 
     for(size_t i = 0; i < h->isize(); ++i)
-        ret = ret * power_int(visit(h->IE(i), dp), h->IV(i));
+        ret = ret * power_int(this->visit(h->IE(i), dp), h->IV(i));
 
     for(size_t i = 0; i < h->rsize(); ++i)
     {
         const value& tmp = h->RV(i);
-        ret = ret * power_real(visit(h->RE(i), dp), tmp);
+        ret = ret * power_real(this->visit(h->RE(i), dp), tmp);
     };
 
     if (h->has_exp())
-        ret = ret * exp(visit(h->Exp(), dp));
+        ret = ret * exp(this->visit(h->Exp(), dp));
 
     return ret;
 };
 
-value do_eval_vis_log::eval(const ast::mult_rep* h, const data_provider& dp)
+template<class Leaf>
+value do_eval_vis_log<Leaf>::eval(const ast::mult_rep* h, const Leaf& dp)
 {
     value ret = value::make_zero();
 
     for(size_t i = 0; i < h->isize(); ++i)
-        ret = ret + h->IV(i) * visit(h->IE(i), dp);
+        ret = ret + h->IV(i) * this->visit(h->IE(i), dp);
 
     for(size_t i = 0; i < h->rsize(); ++i)
     {
         const value& tmp = h->RV(i);
-        ret = ret + tmp * visit(h->RE(i), dp);
+        ret = ret + tmp * this->visit(h->RE(i), dp);
     };
 
     if (h->has_exp())
-        ret = ret + do_eval_vis().visit(h->Exp(), dp);
+        ret = ret + do_eval_vis<Leaf>().visit(h->Exp(), dp);
 
     return ret;
 };
 
-value do_eval_vis::eval(const ast::function_rep* h, const data_provider& dp)
+template<class Leaf>
+value do_eval_vis<Leaf>::eval(const ast::function_rep* h, const Leaf& dp)
 {
     size_t size = h->size();
 
+    builtin_code code   = builtin_table::get().get_code(h->name(), size);
+
+    if (code != builtin_code::none)
+        return eval_builtin(code, h, dp);
+
     using value_pod     =  sd::pod_type<value>;
     int size_counter    = 0;
     value_pod::destructor_type d(&size_counter);
@@ -194,20 +311,49 @@ value do_eval_vis::eval(const ast::function_rep* h, const data_provider& dp)
 
     for(size_t i = 0; i < size; ++i)
     {
-        value tmp = visit(h->arg(i), dp);
+        value tmp = this->visit(h->arg(i), dp);
 
         new(buff_ptr + size_counter) value(tmp);
         ++size_counter;
     };
 
-    symbol sym  = symbol(ast::symbol_ptr::from_this(h->name()));
-    value ret   = dp.eval_function(sym, buff_ptr, size);
+    value ret   = dp.eval_function(h, buff_ptr, size);
     return ret;
 };
 
-value do_eval_vis_log::eval(const ast::function_rep* h, const data_provider& dp)
+template<class Leaf>
+value do_eval_vis<Leaf>::eval_builtin(builtin_code code, const ast::function_rep* h, 
+                                const Leaf& dp)
 {
-    value ret = do_eval_vis().eval(h, dp);
+    if (code == builtin_code::sin || code == builtin_code::cos)
+    {
+        // sin and cos of the same argument are computed together
+        ast::expr_handle arg    = h->arg(0);
+
+        if (arg != m_sin_cos_arg)
+        {
+            double x        = this->visit(arg, dp).get_value();
+
+            builtin_table::eval_sin_cos(x, m_sin, m_cos);
+            m_sin_cos_arg   = arg;
+        };
+
+        return value::make_value(code == builtin_code::sin ? m_sin : m_cos);
+    };
+
+    double args[2];
+    size_t size     = h->size();
+
+    for (size_t i = 0; i < size; ++i)
+        args[i]     = this->visit(h->arg(i), dp).get_value();
+
+    return value::make_value(builtin_table::eval(code, args));
+};
+
+template<class Leaf>
+value do_eval_vis_log<Leaf>::eval(const ast::function_rep* h, const Leaf& dp)
+{
+    value ret = do_eval_vis<Leaf>().eval(h, dp);
     return log(ret);
 };
 
@@ -216,13 +362,77 @@ value do_eval_vis_log::eval(const ast::function_rep* h, const data_provider& dp)
 namespace sym_arrow
 {
 
+//-------------------------------------------------------------------
+//                  indexed_data_provider
+//-------------------------------------------------------------------
+indexed_data_provider::indexed_data_provider()
+{};
+
+void indexed_data_provider::set_value(const symbol& sym, const value& val)
+{
+    size_t code = sym.get_symbol_code();
+
+    if (code >= m_values.size())
+    {
+        m_values.resize(code + 1);
+        m_set.resize(code + 1, 0);
+    };
+
+    m_values[code]  = val;
+    m_set[code]     = 1;
+};
+
+const value* indexed_data_provider::values() const
+{
+    return m_values.data();
+};
+
+size_t indexed_data_provider::size() const
+{
+    return m_values.size();
+};
+
+const unsigned char* indexed_data_provider::set_mask() const
+{
+    return m_set.data();
+};
+
+value indexed_data_provider::eval_function(size_t name_code, const value* args,
+                                           size_t n_size) const
+{
+    (void)name_code;
+    (void)args;
+    (void)n_size;
+
+    throw std::runtime_error("indexed_data_provider: only builtin functions can be evaluated");
+};
+
+//-------------------------------------------------------------------
+//                  functions
+//-------------------------------------------------------------------
 value sym_arrow::eval(const expr& ex, const data_provider& dp)
 {
-    ex.cannonize(do_cse_default);
+    ex.cannonize(ast::cannonize::do_cse_lazy());
 
     const ast::expr_base* h     = ex.get_ptr().get();
 
-    value ret = details::do_eval_vis().visit(h, dp);
+    details::virtual_leaf leaf(dp);
+
+    value ret = details::do_eval_vis<details::virtual_leaf>().visit(h, leaf);
+    return ret;
+};
+
+value details::eval_indexed(const expr& ex, const value* vals, size_t n_vals,
+                            const unsigned char* set_mask, const void* provider, 
+                            eval_function_ptr func)
+{
+    ex.cannonize(ast::cannonize::do_cse_lazy());
+
+    const ast::expr_base* h     = ex.get_ptr().get();
+
+    details::indexed_leaf leaf(vals, n_vals, set_mask, provider, func);
+
+    value ret = details::do_eval_vis<details::indexed_leaf>().visit(h, leaf);
     return ret;
 };
 
@@ -0,0 +1,709 @@
+/* 
+ *  This file is a part of sym_arrow library.
+ *
+ *  Copyright (c) Pawe Kowal 2017 - 2021
+ *
+ *  This program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program; if not, write to the Free Software
+ *  Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA 02111-1307 USA
+ */
+
+#include "sym_arrow/config.h"
+#include "sym_arrow/nodes/expr.h"
+#include "dag/dag.h"
+#include "sym_arrow/ast/ast.h"
+#include "sym_arrow/ast/mult_rep.inl"
+#include "sym_arrow/ast/builder/add_build.h"
+#include "sym_arrow/ast/builder/mult_build.h"
+#include "sym_arrow/ast/cannonization/cannonize.h"
+#include "sym_arrow/ast/helpers/expr_order.h"
+#include "sym_arrow/utils/stack_array.h"
+#include "sym_arrow/functions/expr_functions.h"
+
+#include <boost/functional/hash.hpp>
+
+#include <unordered_map>
+#include <memory>
+#include <vector>
+#include <algorithm>
+
+namespace sym_arrow { namespace details
+{
+
+namespace sd = sym_arrow :: details;
+
+//--------------------------------------------------------------------
+//                  expand_poly
+//--------------------------------------------------------------------
+
+// factor base^pow of a monomial
+struct mono_factor
+{
+    ast::expr_handle    m_base;
+    int                 m_pow;
+};
+
+// polynomial in atoms (symbols, functions and other terms, that cannot
+// be expanded); every term is a coefficient and a monomial given by
+// factors sorted by addresses of bases; like terms are merged using
+// an open addressing hash table
+class expand_poly
+{
+    private:
+        std::vector<value>          m_coef;
+
+        // factors of k-th term are stored at positions m_first[k], ...,
+        // m_first[k+1] - 1
+        std::vector<size_t>         m_first;
+        std::vector<mono_factor>    m_factors;
+        std::vector<size_t>         m_hash;
+
+        // term index + 1 or 0 for empty slot
+        std::vector<size_t>         m_table;
+
+    public:
+        expand_poly();
+
+        // number of terms
+        size_t                  size() const;
+
+        // coefficient of k-th term
+        const value&            coef(size_t k) const;
+
+        // factors of k-th term
+        const mono_factor*      factors(size_t k) const;
+        size_t                  num_factors(size_t k) const;
+
+        // add term c * prod f[i]; factors must be sorted; return index
+        // of the term
+        size_t                  add_term(const value& c, const mono_factor* f, size_t n);
+
+        // add scal * p
+        void                    add(const value& scal, const expand_poly& p);
+
+        // add a * b
+        void                    add_mult(const expand_poly& a, const expand_poly& b);
+
+        // reserve memory for n terms
+        void                    reserve(size_t n);
+
+    private:
+        static size_t           eval_hash(const mono_factor* f, size_t n);
+        bool                    equal(size_t k, const mono_factor* f, size_t n) const;
+        void                    rehash(size_t capacity);
+};
+
+expand_poly::expand_poly()
+{
+    m_first.push_back(0);
+};
+
+inline size_t expand_poly::size() const
+{
+    return m_coef.size();
+};
+
+inline const value& expand_poly::coef(size_t k) const
+{
+    return m_coef[k];
+};
+
+inline const mono_factor* expand_poly::factors(size_t k) const
+{
+    return m_factors.data() + m_first[k];
+};
+
+inline size_t expand_poly::num_factors(size_t k) const
+{
+    return m_first[k + 1] - m_first[k];
+};
+
+inline size_t expand_poly::eval_hash(const mono_factor* f, size_t n)
+{
+    size_t seed = n;
+
+    for (size_t i = 0; i < n; ++i)
+    {
+        boost::hash_combine(seed, f[i].m_base);
+        boost::hash_combine(seed, f[i].m_pow);
+    };
+
+    return seed;
+};
+
+inline bool expand_poly::equal(size_t k, const mono_factor* f, size_t n) const
+{
+    if (num_factors(k) != n)
+        return false;
+
+    const mono_factor* g    = factors(k);
+
+    for (size_t i = 0; i < n; ++i)
+    {
+        if (f[i].m_base != g[i].m_base || f[i].m_pow != g[i].m_pow)
+            return false;
+    };
+
+    return true;
+};
+
+void expand_poly::reserve(size_t n)
+{
+    m_coef.reserve(n);
+    m_first.reserve(n + 1);
+    m_hash.reserve(n);
+
+    size_t capacity = 16;
+
+    while (capacity < 2 * n)
+        capacity    *= 2;
+
+    if (capacity > m_table.size())
+        rehash(capacity);
+};
+
+void expand_poly::rehash(size_t capacity)
+{
+    m_table.assign(capacity, 0);
+
+    size_t mask     = capacity - 1;
+
+    for (size_t k = 0; k < m_coef.size(); ++k)
+    {
+        size_t pos  = m_hash[k] & mask;
+
+        while (m_table[pos] != 0)
+            pos     = (pos + 1) & mask;
+
+        m_table[pos] = k + 1;
+    };
+};
+
+size_t expand_poly::add_term(const value& c, const mono_factor* f, size_t n)
+{
+    // load factor is at most 1/2
+    if (2 * (m_coef.size() + 1) > m_table.size())
+        rehash(std::max<size_t>(16, 2 * m_table.size()));
+
+    size_t hash     = eval_hash(f, n);
+    size_t mask     = m_table.size() - 1;
+    size_t pos      = hash & mask;
+
+    while (m_table[pos] != 0)
+    {
+        size_t k    = m_table[pos] - 1;
+
+        if (m_hash[k] == hash && equal(k, f, n) == true)
+        {
+            m_coef[k]   = m_coef[k] + c;
+            return k;
+        };
+
+        pos         = (pos + 1) & mask;
+    };
+
+    m_table[pos]    = m_coef.size() + 1;
+
+    m_coef.push_back(c);
+    m_hash.push_back(hash);
+    m_factors.insert(m_factors.end(), f, f + n);
+    m_first.push_back(m_factors.size());
+
+    return m_coef.size() - 1;
+};
+
+void expand_poly::add(const value& scal, const expand_poly& p)
+{
+    size_t n        = p.size();
+
+    for (size_t k = 0; k < n; ++k)
+    {
+        value c     = scal * p.coef(k);
+
+        if (c.is_zero() == false)
+            add_term(c, p.factors(k), p.num_factors(k));
+    };
+};
+
+void expand_poly::add_mult(const expand_poly& a, const expand_poly& b)
+{
+    size_t na       = a.size();
+    size_t nb       = b.size();
+
+    reserve(size() + std::min<size_t>(na * nb, 1 << 24));
+
+    std::vector<mono_factor> buf;
+
+    for (size_t i = 0; i < na; ++i)
+    {
+        const mono_factor* fa   = a.factors(i);
+        size_t ka               = a.num_factors(i);
+
+        for (size_t j = 0; j < nb; ++j)
+        {
+            const mono_factor* fb   = b.factors(j);
+            size_t kb               = b.num_factors(j);
+
+            // merge sorted factors
+            buf.clear();
+
+            size_t ia   = 0;
+            size_t ib   = 0;
+
+            while (ia < ka || ib < kb)
+            {
+                if (ib == kb || (ia < ka && fa[ia].m_base < fb[ib].m_base))
+                {
+                    buf.push_back(fa[ia]);
+                    ++ia;
+                }
+                else if (ia == ka || fb[ib].m_base < fa[ia].m_base)
+                {
+                    buf.push_back(fb[ib]);
+                    ++ib;
+                }
+                else
+                {
+                    int pow = fa[ia].m_pow + fb[ib].m_pow;
+
+                    if (pow != 0)
+                        buf.push_back(mono_factor{fa[ia].m_base, pow});
+
+                    ++ia;
+                    ++ib;
+                };
+            };
+
+            value c     = a.coef(i) * b.coef(j);
+
+            if (c.is_zero() == false)
+                add_term(c, buf.data(), buf.size());
+        };
+    };
+};
+
+//--------------------------------------------------------------------
+//                  do_expand_vis
+//--------------------------------------------------------------------
+class do_expand_vis : public sym_dag::dag_visitor<sym_arrow::ast::term_tag, do_expand_vis>
+{
+    public:
+        using tag_type      = sym_arrow::ast::term_tag;
+        using poly_ptr      = std::shared_ptr<expand_poly>;
+
+    private:
+        using poly_map      = std::unordered_map<ast::expr_handle, poly_ptr>;
+
+    private:
+        poly_map            m_map;
+
+        // atoms created during expansion
+        std::vector<expr>   m_atoms;
+
+    public:
+        // expand cannonized expression h
+        poly_ptr            make(ast::expr_handle h);
+
+        // create expression from a polynomial
+        expr                make_expr(const expand_poly& p) const;
+
+        // create monomial
+        static expr         make_monomial(const mono_factor* f, size_t n);
+
+    public:
+        template<class Node>
+        poly_ptr eval(const Node* ast);
+
+        poly_ptr eval(const ast::scalar_rep* h);
+        poly_ptr eval(const ast::symbol_rep* h);
+        poly_ptr eval(const ast::add_build* h);
+        poly_ptr eval(const ast::mult_build* h);
+        poly_ptr eval(const ast::add_rep* h);
+        poly_ptr eval(const ast::mult_rep* h);
+        poly_ptr eval(const ast::function_rep* h);
+
+    private:
+        static poly_ptr     make_const(const value& v);
+        static poly_ptr     make_atom(ast::expr_handle h, int pow);
+        poly_ptr            make_atom(expr&& ex);
+        static poly_ptr     power(const poly_ptr& p, int pow);
+};
+
+do_expand_vis::poly_ptr do_expand_vis::make(ast::expr_handle h)
+{
+    auto pos        = m_map.find(h);
+
+    if (pos != m_map.end())
+        return pos->second;
+
+    poly_ptr ret    = visit(h);
+    m_map.insert(poly_map::value_type(h, ret));
+
+    return ret;
+};
+
+do_expand_vis::poly_ptr do_expand_vis::make_const(const value& v)
+{
+    poly_ptr ret    = std::make_shared<expand_poly>();
+    ret->add_term(v, nullptr, 0);
+    return ret;
+};
+
+do_expand_vis::poly_ptr do_expand_vis::make_atom(ast::expr_handle h, int pow)
+{
+    poly_ptr ret    = std::make_shared<expand_poly>();
+    mono_factor f   = mono_factor{h, pow};
+
+    ret->add_term(value::make_one(), &f, 1);
+    return ret;
+};
+
+do_expand_vis::poly_ptr do_expand_vis::make_atom(expr&& ex)
+{
+    ast::expr_handle h  = ex.get_expr_handle();
+    m_atoms.push_back(std::move(ex));
+
+    return make_atom(h, 1);
+};
+
+do_expand_vis::poly_ptr do_expand_vis::power(const poly_ptr& p, int pow)
+{
+    if (pow == 1)
+        return p;
+
+    poly_ptr half   = power(p, pow / 2);
+    poly_ptr ret    = std::make_shared<expand_poly>();
+    ret->add_mult(*half, *half);
+
+    if (pow % 2 == 0)
+        return ret;
+
+    poly_ptr ret2   = std::make_shared<expand_poly>();
+    ret2->add_mult(*ret, *p);
+
+    return ret2;
+};
+
+do_expand_vis::poly_ptr do_expand_vis::eval(const ast::scalar_rep* h)
+{
+    return make_const(h->get_data());
+};
+
+do_expand_vis::poly_ptr do_expand_vis::eval(const ast::symbol_rep* h)
+{
+    return make_atom(h, 1);
+};
+
+do_expand_vis::poly_ptr do_expand_vis::eval(const ast::add_build* h)
+{
+    (void)h;
+    assertion(0,"expression not explicit");
+    throw;
+};
+
+do_expand_vis::poly_ptr do_expand_vis::eval(const ast::mult_build* h)
+{
+    (void)h;
+    assertion(0,"expression not explicit");
+    throw;
+};
+
+do_expand_vis::poly_ptr do_expand_vis::eval(const ast::add_rep* h)
+{
+    poly_ptr ret        = make_const(h->V0());
+    size_t n            = h->size();
+
+    for (size_t i = 0; i < n; ++i)
+        ret->add(h->V(i), *make(h->E(i)));
+
+    if (h->has_log() == true)
+    {
+        // log|el| is an atom
+        using item_handle   = ast::build_item<value>::handle_type;
+
+        item_handle log_it(value::make_one(), h->Log());
+
+        ast::add_rep_info<item_handle> ai(value::make_zero(), 0, nullptr, &log_it);
+        ret->add(value::make_one(), *make_atom(expr(ast::add_rep::make(ai))));
+    };
+
+    return ret;
+};
+
+do_expand_vis::poly_ptr do_expand_vis::eval(const ast::mult_rep* h)
+{
+    using iitem_handle  = ast::build_item<int>::handle_type;
+    using ritem_handle  = ast::build_item<value>::handle_type;
+
+    poly_ptr ret        = make_const(value::make_one());
+
+    size_t in           = h->isize();
+    size_t rn           = h->rsize();
+
+    for (size_t i = 0; i < in; ++i)
+    {
+        int pow         = h->IV(i);
+
+        // denominators are not expanded
+        poly_ptr fact   = (pow > 0) ? power(make(h->IE(i)), pow)
+                                    : make_atom(h->IE(i), pow);
+
+        poly_ptr tmp    = std::make_shared<expand_poly>();
+        tmp->add_mult(*ret, *fact);
+        ret             = tmp;
+    };
+
+    for (size_t i = 0; i < rn; ++i)
+    {
+        ritem_handle it(h->RV(i), h->RE(i));
+
+        ast::mult_rep_info<iitem_handle, ritem_handle> mi(0, nullptr, nullptr, 1, &it);
+        poly_ptr fact   = make_atom(expr(ast::mult_rep::make(mi)));
+
+        poly_ptr tmp    = std::make_shared<expand_poly>();
+        tmp->add_mult(*ret, *fact);
+        ret             = tmp;
+    };
+
+    if (h->has_exp() == true)
+    {
+        iitem_handle it(1, h->Exp());
+
+        ast::mult_rep_info<iitem_handle, ritem_handle> mi(0, nullptr, &it, 0, nullptr);
+        poly_ptr fact   = make_atom(expr(ast::mult_rep::make(mi)));
+
+        poly_ptr tmp    = std::make_shared<expand_poly>();
+        tmp->add_mult(*ret, *fact);
+        ret             = tmp;
+    };
+
+    return ret;
+};
+
+do_expand_vis::poly_ptr do_expand_vis::eval(const ast::function_rep* h)
+{
+    return make_atom(h, 1);
+};
+
+expr do_expand_vis::make_monomial(const mono_factor* f, size_t n)
+{
+    if (n == 0)
+        return expr(value::make_one());
+
+    if (n == 1 && f[0].m_pow == 1)
+        return expr(f[0].m_base);
+
+    bool simple     = true;
+
+    for (size_t i = 0; i < n; ++i)
+    {
+        if (f[i].m_base->isa<ast::symbol_rep>() == false
+            && f[i].m_base->isa<ast::function_rep>() == false)
+        {
+            simple  = false;
+            break;
+        };
+    };
+
+    if (simple == true)
+    {
+        // powers of symbols and functions are already cannonical
+        using iitem_handle  = ast::build_item<int>::handle_type;
+        using ritem_handle  = ast::build_item<value>::handle_type;
+        using iitem_array   = sd::stack_array<sd::pod_type<iitem_handle>>;
+
+        iitem_array arr(n);
+        iitem_handle* ih    = (iitem_handle*)arr.get();
+
+        for (size_t i = 0; i < n; ++i)
+            new(ih + i) iitem_handle(f[i].m_pow, f[i].m_base);
+
+        std::sort(ih, ih + n, [](const iitem_handle& a, const iitem_handle& b)
+                  { return a.compare(b); });
+
+        ast::mult_rep_info<iitem_handle, ritem_handle> mi(n, ih, nullptr, 0, nullptr);
+        return expr(ast::mult_rep::make(mi));
+    };
+
+    using iitem         = ast::build_item<int>;
+    using ritem         = ast::build_item<value>;
+
+    std::vector<iitem> items;
+    items.reserve(n);
+
+    for (size_t i = 0; i < n; ++i)
+        items.push_back(iitem(f[i].m_pow, f[i].m_base));
+
+    ast::mult_build_info<iitem, ritem> bi(n, items.data(), 0, nullptr, nullptr);
+
+    expr ret        = expr(ast::mult_build::make(bi));
+    ret.cannonize(false);
+
+    return ret;
+};
+
+expr do_expand_vis::make_expr(const expand_poly& p) const
+{
+    using item          = ast::build_item<value>;
+
+    value add           = value::make_zero();
+    size_t n            = p.size();
+
+    std::vector<item> items;
+    items.reserve(n);
+
+    for (size_t k = 0; k < n; ++k)
+    {
+        const value& c  = p.coef(k);
+
+        if (c.is_zero() == true)
+            continue;
+
+        if (p.num_factors(k) == 0)
+            add         = add + c;
+        else
+            items.push_back(item(c, make_monomial(p.factors(k), p.num_factors(k))));
+    };
+
+    if (items.size() == 0)
+        return expr(add);
+
+    ast::add_build_info2<item> bi(add, items.size(), items.data(), nullptr);
+
+    // cse would factor the polynomial again
+    expr ret            = expr(ast::add_build::make(bi));
+    ret.cannonize(false);
+
+    ast::cannonize().set_cse_done(ret);
+    return ret;
+};
+
+// symbols used by collect function
+class collect_symbols
+{
+    private:
+        std::vector<size_t> m_codes;
+
+    public:
+        collect_symbols(const std::vector<symbol>& syms);
+
+        // return true if h is one of collected symbols
+        bool            is_collected(ast::expr_handle h) const;
+};
+
+collect_symbols::collect_symbols(const std::vector<symbol>& syms)
+{
+    for (const symbol& s : syms)
+        m_codes.push_back(s.get_ptr()->get_symbol_code());
+
+    std::sort(m_codes.begin(), m_codes.end());
+};
+
+bool collect_symbols::is_collected(ast::expr_handle h) const
+{
+    if (h->isa<ast::symbol_rep>() == false)
+        return false;
+
+    size_t code = h->static_cast_to<ast::symbol_rep>()->get_symbol_code();
+    return std::binary_search(m_codes.begin(), m_codes.end(), code);
+};
+
+}};
+
+namespace sym_arrow
+{
+
+expr sym_arrow::expand(const expr& ex)
+{
+    ex.cannonize(false);
+
+    details::do_expand_vis vis;
+    details::do_expand_vis::poly_ptr p  = vis.make(ex.get_expr_handle());
+
+    return vis.make_expr(*p);
+};
+
+expr sym_arrow::collect(const expr& ex, const std::vector<symbol>& syms)
+{
+    ex.cannonize(false);
+
+    details::do_expand_vis vis;
+    details::do_expand_vis::poly_ptr p  = vis.make(ex.get_expr_handle());
+
+    details::collect_symbols cs(syms);
+
+    // p is rewritten as sum_k m_k * c_k, where m_k are monomials in syms;
+    // c_k are stored as polynomials in the remaining atoms
+    using poly_ptr      = details::do_expand_vis::poly_ptr;
+
+    details::expand_poly groups;
+    std::vector<poly_ptr> coefs;
+    std::vector<details::mono_factor> fs, fr;
+
+    size_t n            = p->size();
+
+    for (size_t k = 0; k < n; ++k)
+    {
+        const details::mono_factor* f   = p->factors(k);
+        size_t nf       = p->num_factors(k);
+
+        fs.clear();
+        fr.clear();
+
+        for (size_t i = 0; i < nf; ++i)
+        {
+            if (cs.is_collected(f[i].m_base) == true)
+                fs.push_back(f[i]);
+            else
+                fr.push_back(f[i]);
+        };
+
+        // coefficients of groups are not used
+        size_t pos      = groups.add_term(value::make_one(), fs.data(), fs.size());
+
+        if (pos == coefs.size())
+            coefs.push_back(std::make_shared<details::expand_poly>());
+
+        coefs[pos]->add_term(p->coef(k), fr.data(), fr.size());
+    };
+
+    using item          = ast::build_item<value>;
+
+    std::vector<item> items;
+    items.reserve(groups.size());
+
+    for (size_t k = 0; k < groups.size(); ++k)
+    {
+        expr m          = details::do_expand_vis::make_monomial(groups.factors(k),
+                            groups.num_factors(k));
+        expr c          = vis.make_expr(*coefs[k]);
+
+        expr mc         = m * c;
+        mc.cannonize(false);
+
+        items.push_back(item(value::make_one(), mc));
+    };
+
+    if (items.size() == 0)
+        return expr(value::make_zero());
+
+    ast::add_build_info2<item> bi(value::make_zero(), items.size(), items.data(), nullptr);
+
+    expr ret            = expr(ast::add_build::make(bi));
+    ret.cannonize(false);
+
+    ast::cannonize().set_cse_done(ret);
+    return ret;
+};
+
+};
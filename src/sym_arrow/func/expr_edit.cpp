@@ -0,0 +1,427 @@
+/* 
+ *  This file is a part of sym_arrow library.
+ *
+ *  Copyright (c) Pawe Kowal 2017 - 2021
+ *
+ *  This program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program; if not, write to the Free Software
+ *  Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA 02111-1307 USA
+ */
+
+#include "sym_arrow/functions/expr_edit.h"
+#include "sym_arrow/functions/expr_functions.h"
+#include "sym_arrow/ast/ast.h"
+#include "sym_arrow/ast/mult_rep.inl"
+#include "sym_arrow/ast/builder/build_item.h"
+#include "sym_arrow/ast/helpers/expr_order.h"
+#include "sym_arrow/utils/stack_array.h"
+
+namespace sym_arrow { namespace details
+{
+
+namespace sd = sym_arrow :: details;
+
+using item_handle   = ast::build_item<value>::handle_type;
+using iitem_handle  = ast::build_item<int>::handle_type;
+
+static const size_t edit_buffer_size    = 20;
+
+using item_array    = sd::stack_array<sd::pod_type<item_handle>, edit_buffer_size>;
+using iitem_array   = sd::stack_array<sd::pod_type<iitem_handle>, edit_buffer_size>;
+
+//--------------------------------------------------------------------
+//                  sums
+//--------------------------------------------------------------------
+
+// return h as a sum without log term; return nullptr if h is not such
+// a sum
+static const ast::add_rep* get_sum(ast::expr_handle h)
+{
+    if (h->isa<ast::add_rep>() == false)
+        return nullptr;
+
+    const ast::add_rep* ah  = h->static_cast_to<ast::add_rep>();
+
+    if (ah->has_log() == true)
+        return nullptr;
+
+    return ah;
+};
+
+// return true if h is stored as a single term of a sum
+static bool is_sum_item(ast::expr_handle h)
+{
+    return h->isa<ast::symbol_rep>() == true || h->isa<ast::mult_rep>() == true
+        || h->isa<ast::function_rep>() == true;
+};
+
+// find position of the first term of h not less than t
+static size_t find_term(const ast::add_rep* h, ast::expr_handle t)
+{
+    size_t first    = 0;
+    size_t last     = h->size();
+
+    while (first < last)
+    {
+        size_t mid  = first + (last - first) / 2;
+
+        if (ast::expr_order::less(h->E(mid), t))
+            first   = mid + 1;
+        else
+            last    = mid;
+    };
+
+    return first;
+};
+
+// create a sum from sorted terms; the same rules as in
+// cannonize::finalize_add are applied
+static expr make_sum(const value& add, size_t n, item_handle* ih)
+{
+    if (n == 0)
+        return expr(add);
+
+    if (n == 1 && add.is_zero() == true && ih[0].m_value.is_one() == true)
+        return expr(ih[0].m_expr);
+
+    ast::add_rep_info<item_handle> ai(add, n, ih, nullptr);
+    return expr(ast::add_rep::make(ai));
+};
+
+// merge terms of h with k sorted terms it; terms with zero coefficient
+// are removed
+static expr merge_sum(const ast::add_rep* h, const value& add, size_t k,
+                      const item_handle* it)
+{
+    size_t n            = h->size();
+
+    item_array arr(n + k);
+    item_handle* ih     = (item_handle*)arr.get();
+
+    size_t pos          = 0;
+    size_t i            = 0;
+    size_t j            = 0;
+
+    while (i < n || j < k)
+    {
+        if (j == k || (i < n && ast::expr_order::less(h->E(i), it[j].m_expr)))
+        {
+            new(ih + pos) item_handle(h->V(i), h->E(i));
+            ++pos;
+            ++i;
+        }
+        else if (i == n || ast::expr_order::less(it[j].m_expr, h->E(i)))
+        {
+            new(ih + pos) item_handle(it[j].m_value, it[j].m_expr);
+            ++pos;
+            ++j;
+        }
+        else
+        {
+            value v     = h->V(i) + it[j].m_value;
+
+            if (v.is_zero() == false)
+            {
+                new(ih + pos) item_handle(v, h->E(i));
+                ++pos;
+            };
+
+            ++i;
+            ++j;
+        };
+    };
+
+    return make_sum(add, pos, ih);
+};
+
+//--------------------------------------------------------------------
+//                  products
+//--------------------------------------------------------------------
+
+// return true if h can be stored as a base of integer power without
+// further simplifications
+static bool is_power_base(ast::expr_handle h)
+{
+    return h->isa<ast::symbol_rep>() == true || h->isa<ast::function_rep>() == true;
+};
+
+// find position of the first integer power subterm of h not less
+// than t
+static size_t find_power(const ast::mult_rep* h, ast::expr_handle t)
+{
+    size_t first    = 0;
+    size_t last     = h->isize();
+
+    while (first < last)
+    {
+        size_t mid  = first + (last - first) / 2;
+
+        if (ast::expr_order::less(h->IE(mid), t))
+            first   = mid + 1;
+        else
+            last    = mid;
+    };
+
+    return first;
+};
+
+// return true if a mult_rep h has a real power of t
+static bool has_real_power(const ast::mult_rep* h, ast::expr_handle t)
+{
+    size_t first    = 0;
+    size_t last     = h->rsize();
+
+    while (first < last)
+    {
+        size_t mid  = first + (last - first) / 2;
+
+        if (ast::expr_order::less(h->RE(mid), t))
+            first   = mid + 1;
+        else
+            last    = mid;
+    };
+
+    return first < h->rsize() && h->RE(first) == t;
+};
+
+// multiply product h by t^p; h is a mult_rep without exp term
+static expr merge_product(const ast::mult_rep* h, ast::expr_handle t, int p)
+{
+    size_t in           = h->isize();
+    size_t rn           = h->rsize();
+
+    iitem_array iarr(in + 1);
+    item_array rarr(rn);
+
+    iitem_handle* iih   = (iitem_handle*)iarr.get();
+    item_handle* rih    = (item_handle*)rarr.get();
+
+    size_t pos          = 0;
+    bool inserted       = false;
+
+    for (size_t i = 0; i < in; ++i)
+    {
+        ast::expr_handle e  = h->IE(i);
+
+        if (inserted == false && ast::expr_order::less(t, e))
+        {
+            new(iih + pos) iitem_handle(p, t);
+            ++pos;
+            inserted    = true;
+        };
+
+        if (e == t)
+        {
+            int pow     = h->IV(i) + p;
+            inserted    = true;
+
+            if (pow != 0)
+            {
+                new(iih + pos) iitem_handle(pow, e);
+                ++pos;
+            };
+
+            continue;
+        };
+
+        new(iih + pos) iitem_handle(h->IV(i), e);
+        ++pos;
+    };
+
+    if (inserted == false)
+    {
+        new(iih + pos) iitem_handle(p, t);
+        ++pos;
+    };
+
+    for (size_t i = 0; i < rn; ++i)
+        new(rih + i) item_handle(h->RV(i), h->RE(i));
+
+    // the same rules as in cannonize::process_mult
+    if (pos == 0 && rn == 0)
+        return expr(value::make_one());
+
+    if (pos == 1 && rn == 0 && iih[0].m_value == 1)
+        return expr(iih[0].m_expr);
+
+    ast::mult_rep_info<iitem_handle, item_handle> ai(pos, iih, nullptr, rn, rih);
+    return expr(ast::mult_rep::make(ai));
+};
+
+}};
+
+namespace sym_arrow
+{
+
+expr sym_arrow::insert_term(const expr& ex, const value& c, const expr& t)
+{
+    ex.cannonize(false);
+    t.cannonize(false);
+
+    ast::expr_handle eh         = ex.get_expr_handle();
+    ast::expr_handle th         = t.get_expr_handle();
+    const ast::add_rep* ah      = details::get_sum(eh);
+
+    if (ah != nullptr && c.is_zero() == false)
+    {
+        if (th->isa<ast::scalar_rep>() == true)
+        {
+            const value& v      = th->static_cast_to<ast::scalar_rep>()->get_data();
+            return details::merge_sum(ah, ah->V0() + v * c, 0, nullptr);
+        };
+
+        if (details::is_sum_item(th) == true)
+        {
+            details::item_handle it(c, th);
+            return details::merge_sum(ah, ah->V0(), 1, &it);
+        };
+
+        const ast::add_rep* at  = details::get_sum(th);
+
+        if (at != nullptr)
+        {
+            size_t k            = at->size();
+
+            details::item_array arr(k);
+            details::item_handle* it = (details::item_handle*)arr.get();
+
+            for (size_t i = 0; i < k; ++i)
+                new(it + i) details::item_handle(at->V(i) * c, at->E(i));
+
+            return details::merge_sum(ah, ah->V0() + at->V0() * c, k, it);
+        };
+    };
+
+    expr ret        = ex + c * t;
+    ret.cannonize(false);
+
+    return ret;
+};
+
+expr sym_arrow::remove_term(const expr& ex, const expr& t, value& coef)
+{
+    ex.cannonize(false);
+    t.cannonize(false);
+
+    ast::expr_handle eh         = ex.get_expr_handle();
+    ast::expr_handle th         = t.get_expr_handle();
+
+    coef            = value::make_zero();
+
+    if (eh == th)
+    {
+        coef        = value::make_one();
+        return expr(value::make_zero());
+    };
+
+    if (eh->isa<ast::add_rep>() == false)
+        return ex;
+
+    const ast::add_rep* ah      = eh->static_cast_to<ast::add_rep>();
+    size_t pos                  = details::find_term(ah, th);
+
+    if (pos == ah->size() || ah->E(pos) != th)
+        return ex;
+
+    coef            = ah->V(pos);
+    return insert_term(ex, -coef, t);
+};
+
+expr sym_arrow::scale(const expr& ex, const value& c)
+{
+    ex.cannonize(false);
+
+    if (c.is_one() == true)
+        return ex;
+
+    const ast::add_rep* ah      = details::get_sum(ex.get_expr_handle());
+
+    if (ah != nullptr && c.is_zero() == false)
+    {
+        size_t n            = ah->size();
+
+        details::item_array arr(n);
+        details::item_handle* ih = (details::item_handle*)arr.get();
+
+        for (size_t i = 0; i < n; ++i)
+            new(ih + i) details::item_handle(ah->V(i) * c, ah->E(i));
+
+        return details::make_sum(ah->V0() * c, n, ih);
+    };
+
+    expr ret        = c * ex;
+    ret.cannonize(false);
+
+    return ret;
+};
+
+expr sym_arrow::insert_factor(const expr& ex, const expr& t, int p)
+{
+    ex.cannonize(false);
+    t.cannonize(false);
+
+    if (p == 0)
+        return ex;
+
+    ast::expr_handle eh         = ex.get_expr_handle();
+    ast::expr_handle th         = t.get_expr_handle();
+
+    if (details::is_power_base(th) == true)
+    {
+        if (eh->isa<ast::mult_rep>() == true)
+        {
+            const ast::mult_rep* mh = eh->static_cast_to<ast::mult_rep>();
+
+            // integer and real powers of the same base are merged by
+            // cannonization
+            if (mh->has_exp() == false && details::has_real_power(mh, th) == false)
+                return details::merge_product(mh, th, p);
+        };
+    };
+
+    expr ret        = ex * power_int(t, p);
+    ret.cannonize(false);
+
+    return ret;
+};
+
+expr sym_arrow::remove_factor(const expr& ex, const expr& t, int& pow)
+{
+    ex.cannonize(false);
+    t.cannonize(false);
+
+    ast::expr_handle eh         = ex.get_expr_handle();
+    ast::expr_handle th         = t.get_expr_handle();
+
+    pow             = 0;
+
+    if (eh == th)
+    {
+        pow         = 1;
+        return expr(value::make_one());
+    };
+
+    if (eh->isa<ast::mult_rep>() == false)
+        return ex;
+
+    const ast::mult_rep* mh     = eh->static_cast_to<ast::mult_rep>();
+    size_t pos                  = details::find_power(mh, th);
+
+    if (pos == mh->isize() || mh->IE(pos) != th)
+        return ex;
+
+    pow             = mh->IV(pos);
+    return insert_factor(ex, t, -pow);
+};
+
+};
@@ -0,0 +1,963 @@
+/* 
+ *  This file is a part of sym_arrow library.
+ *
+ *  Copyright (c) Pawe Kowal 2017 - 2021
+ *
+ *  This program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program; if not, write to the Free Software
+ *  Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA 02111-1307 USA
+ */
+
+#include "expr_parser.h"
+#include "sym_arrow/nodes/symbol.h"
+#include "sym_arrow/ast/ast.h"
+#include "sym_arrow/ast/builder/add_build.h"
+#include "sym_arrow/ast/builder/mult_build.h"
+#include "sym_arrow/utils/stack_array.h"
+#include "sym_arrow/functions/expr_functions.h"
+
+#pragma warning(push)
+#pragma warning(disable:4702)
+#include <boost/lexical_cast.hpp>
+#pragma warning(pop)
+
+#include <sstream>
+#include <iostream>
+#include <limits>
+#include <cmath>
+#include <cstring>
+
+namespace sym_arrow { namespace details
+{
+
+namespace sd = sym_arrow :: details;
+
+//--------------------------------------------------------------------
+//                  expr_lexer
+//--------------------------------------------------------------------
+expr_lexer::expr_lexer(const char* str, size_t size)
+    :m_pos(str), m_end(str + size), m_line(1), m_column(1)
+    ,m_newline(true), m_continued(false)
+{};
+
+inline char expr_lexer::LA(size_t k) const
+{
+    // '\0' is not a valid character in the grammar
+    return (m_pos + k - 1 < m_end) ? m_pos[k - 1] : '\0';
+};
+
+inline void expr_lexer::consume()
+{
+    if (*m_pos == '\t')
+        m_column = ((m_column - 1) / tab_size + 1) * tab_size + 1;
+    else
+        ++m_column;
+
+    ++m_pos;
+};
+
+inline void expr_lexer::consume(size_t n)
+{
+    for (size_t i = 0; i < n; ++i)
+        consume();
+};
+
+inline void expr_lexer::newline()
+{
+    ++m_line;
+    m_column = 1;
+
+    // new line after continuation is ignored
+    if (m_continued == true)
+        m_continued = false;
+    else
+        m_newline = true;
+};
+
+token expr_lexer::next()
+{
+    for (;;)
+    {
+        while (skip_hidden() == true)
+        {};
+
+        token t;
+        t.m_begin   = m_pos;
+        t.m_line    = m_line;
+        t.m_column  = m_column;
+        t.m_newline = m_newline;
+
+        if (m_pos == m_end)
+        {
+            t.m_type    = token_type::eof;
+            t.m_length  = 0;
+            return t;
+        };
+
+        char c      = LA(1);
+        bool valid  = true;
+
+        switch (c)
+        {
+            case '(':   t.m_type = token_type::lparen;  consume(); break;
+            case ')':   t.m_type = token_type::rparen;  consume(); break;
+            case '[':   t.m_type = token_type::lbrack;  consume(); break;
+            case ']':   t.m_type = token_type::rbrack;  consume(); break;
+            case '{':   t.m_type = token_type::lcurl;   consume(); break;
+            case '}':   t.m_type = token_type::rcurl;   consume(); break;
+            case '*':   t.m_type = token_type::mult;    consume(); break;
+            case '/':   t.m_type = token_type::div;     consume(); break;
+            case '\\':  t.m_type = token_type::div;     consume(); break;
+            case '+':   t.m_type = token_type::plus;    consume(); break;
+            case '-':   t.m_type = token_type::minus;   consume(); break;
+            case '^':   t.m_type = token_type::power;   consume(); break;
+            case ';':   t.m_type = token_type::semi;    consume(); break;
+            case '=':   t.m_type = token_type::assign;  consume(); break;
+            case ',':   t.m_type = token_type::comma;   consume(); break;
+            case '|':   t.m_type = token_type::or_;     consume(); break;
+
+            case '`':
+                t.m_type    = token_type::string;
+                skip_string();
+                break;
+
+            case '"':
+                if (LA(2) == '"' && LA(3) == '"')
+                {
+                    t.m_type    = token_type::string;
+                    skip_string();
+                }
+                else
+                {
+                    valid       = false;
+                };
+                break;
+
+            case '.':
+                if (LA(2) == '.')
+                {
+                    t.m_type    = token_type::ddot;
+                    consume(2);
+                }
+                else if (LA(2) >= '0' && LA(2) <= '9')
+                {
+                    read_number(t);
+                }
+                else
+                {
+                    t.m_type    = token_type::dot;
+                    consume();
+                };
+                break;
+
+            default:
+                if (c >= '0' && c <= '9')
+                {
+                    read_number(t);
+                }
+                else if ((c >= 'a' && c <= 'z') || (c >= 'A' && c <= 'Z'))
+                {
+                    t.m_type    = token_type::identifier;
+                    consume();
+
+                    for (;;)
+                    {
+                        char c2 = LA(1);
+
+                        if ((c2 >= 'a' && c2 <= 'z') || (c2 >= 'A' && c2 <= 'Z')
+                            || (c2 >= '0' && c2 <= '9') || c2 == '_')
+                        {
+                            consume();
+                        }
+                        else
+                        {
+                            break;
+                        };
+                    };
+                }
+                else
+                {
+                    valid       = false;
+                };
+                break;
+        };
+
+        if (valid == false)
+        {
+            // the same as default error handler in generated lexer:
+            // report error and skip the character
+            report_char(m_line, m_column);
+            consume();
+            continue;
+        };
+
+        t.m_length  = m_pos - t.m_begin;
+        m_newline   = false;
+        return t;
+    };
+};
+
+// skip white spaces, new lines, comments and continuations; return
+// true if something was skipped
+bool expr_lexer::skip_hidden()
+{
+    switch (LA(1))
+    {
+        case ' ':
+        case '\t':
+        case '\f':
+            consume();
+            return true;
+
+        case '\r':
+            consume();
+
+            if (LA(1) == '\n')
+                consume();
+
+            newline();
+            return true;
+
+        case '\n':
+            consume();
+            newline();
+            return true;
+
+        case '%':
+        {
+            if (LA(2) == '{')
+            {
+                skip_ml_comment(m_line, m_column);
+                return true;
+            };
+
+            // single line comment
+            while (m_pos != m_end && LA(1) != '\r' && LA(1) != '\n')
+                consume();
+
+            return true;
+        }
+
+        case '.':
+        {
+            if (LA(2) != '.' || LA(3) != '.')
+                return false;
+
+            // continuation; new line is skipped later
+            m_continued = true;
+
+            while (m_pos != m_end && LA(1) != '\r' && LA(1) != '\n')
+                consume();
+
+            return true;
+        }
+
+        default:
+            return false;
+    };
+};
+
+void expr_lexer::skip_ml_comment(size_t line, size_t col)
+{
+    consume(2);
+
+    // multiline comment does not start a new line
+    bool newline    = m_newline;
+    size_t depth    = 1;
+
+    for (;;)
+    {
+        if (m_pos == m_end)
+            error_eof("comment", line, col);
+
+        char c  = LA(1);
+
+        if (c == '%' && LA(2) == '}')
+        {
+            consume(2);
+            --depth;
+
+            if (depth == 0)
+            {
+                m_newline   = newline;
+                return;
+            };
+        }
+        else if (c == '%' && LA(2) == '{')
+        {
+            consume(2);
+            ++depth;
+        }
+        else if (c == '`' || (c == '"' && LA(2) == '"' && LA(3) == '"'))
+        {
+            skip_string();
+        }
+        else if (c == '\r')
+        {
+            consume();
+
+            if (LA(1) == '\n')
+                consume();
+
+            newline();
+        }
+        else if (c == '\n')
+        {
+            consume();
+            newline();
+        }
+        else
+        {
+            consume();
+        };
+    };
+};
+
+void expr_lexer::skip_string()
+{
+    size_t line     = m_line;
+    size_t col      = m_column;
+
+    if (LA(1) == '`')
+    {
+        consume();
+
+        for (;;)
+        {
+            char c  = LA(1);
+
+            if (m_pos == m_end || c == '\r' || c == '\n')
+                error_eof("string", line, col);
+
+            consume();
+
+            if (c == '`')
+                return;
+        };
+    };
+
+    // multiline string
+    consume(3);
+
+    for (;;)
+    {
+        if (m_pos == m_end)
+            error_eof("string", line, col);
+
+        char c  = LA(1);
+
+        if (c == '"' && LA(2) == '"' && LA(3) == '"')
+        {
+            consume(3);
+            return;
+        }
+        else if (c == '\r')
+        {
+            consume();
+
+            if (LA(1) == '\n')
+                consume();
+
+            newline();
+        }
+        else if (c == '\n')
+        {
+            consume();
+            newline();
+        }
+        else
+        {
+            consume();
+        };
+    };
+};
+
+void expr_lexer::read_number(token& t)
+{
+    t.m_type        = token_type::integer;
+
+    while (LA(1) >= '0' && LA(1) <= '9')
+        consume();
+
+    if (LA(1) == '.' && LA(2) >= '0' && LA(2) <= '9')
+    {
+        t.m_type    = token_type::number;
+        consume();
+
+        while (LA(1) >= '0' && LA(1) <= '9')
+            consume();
+
+        if (LA(1) == 'e' || LA(1) == 'E')
+            read_exponent(t);
+    }
+    else if (LA(1) == 'e' || LA(1) == 'E')
+    {
+        t.m_type    = token_type::number;
+        read_exponent(t);
+    };
+};
+
+void expr_lexer::read_exponent(token& t)
+{
+    consume();
+
+    if (LA(1) == '+' || LA(1) == '-')
+        consume();
+
+    if (LA(1) < '0' || LA(1) > '9')
+    {
+        std::ostringstream os;
+        os << "expecting exponent, found '" << LA(1) << "', line: "
+           << m_line << ":" << m_column;
+
+        throw std::runtime_error(os.str());
+    };
+
+    while (LA(1) >= '0' && LA(1) <= '9')
+        consume();
+
+    (void)t;
+};
+
+void expr_lexer::error_eof(const char* what, size_t line, size_t col)
+{
+    std::ostringstream os;
+    os << "unexpected end of file in " << what << ", line: " << line << ":" << col;
+
+    throw std::runtime_error(os.str());
+};
+
+void expr_lexer::report_char(size_t line, size_t col)
+{
+    std::cerr << "line " << line << ":" << col << ": "
+              << "unexpected char: '" << LA(1) << "'" << "\n";
+};
+
+//--------------------------------------------------------------------
+//                  expr_parser
+//--------------------------------------------------------------------
+expr_parser::expr_parser(const char* str, size_t size)
+    :m_lexer(str, size), m_tokens(nullptr)
+{};
+
+expr_parser::expr_parser(const token* tokens)
+    :m_lexer(nullptr, 0), m_tokens(tokens)
+{};
+
+inline token expr_parser::next_token()
+{
+    if (m_tokens == nullptr)
+        return m_lexer.next();
+
+    // eof token is returned repeatedly
+    token t     = *m_tokens;
+
+    if (t.m_type != token_type::eof)
+        ++m_tokens;
+
+    return t;
+};
+
+expr expr_parser::make()
+{
+    m_token = next_token();
+    return term();
+};
+
+expr expr_parser::make_all()
+{
+    m_token = next_token();
+    expr ex = term();
+
+    if (m_token.m_type != token_type::eof)
+        unexpected_token();
+
+    return ex;
+};
+
+void expr_parser::consume()
+{
+    m_token = next_token();
+};
+
+void expr_parser::match(token_type type)
+{
+    if (m_token.m_type != type)
+        mismatched_token(type);
+
+    consume();
+};
+
+bool expr_parser::is_term_start() const
+{
+    switch (m_token.m_type)
+    {
+        case token_type::minus:
+        case token_type::plus:
+        case token_type::number:
+        case token_type::integer:
+        case token_type::identifier:
+        case token_type::or_:
+        case token_type::lparen:
+            return true;
+        default:
+            return false;
+    };
+};
+
+// addExpr: multExpr ((PLUS | MINUS) multExpr)*
+expr expr_parser::term()
+{
+    expr x  = mult_expr();
+
+    if (m_token.m_type != token_type::plus && m_token.m_type != token_type::minus)
+        return x;
+
+    using item          = ast::build_item<value>;
+    using item_pod      = sd::pod_type<item>;
+
+    // scalars are added to the free term
+    value add           = value::make_zero();
+
+    size_t base         = m_exprs.size();
+
+    if (x.get_ptr()->isa<ast::scalar_rep>() == true)
+        add             = cast_scalar(x).get_value();
+    else
+        push(value::make_one(), std::move(x));
+
+    while (m_token.m_type == token_type::plus || m_token.m_type == token_type::minus)
+    {
+        bool is_plus    = m_token.m_type == token_type::plus;
+        consume();
+
+        expr tmp        = mult_expr();
+
+        if (tmp.get_ptr()->isa<ast::scalar_rep>() == true)
+        {
+            const value& v  = cast_scalar(tmp).get_value();
+            add             = is_plus ? add + v : add - v;
+        }
+        else
+        {
+            push(is_plus ? value::make_one() : value::make_minus_one(), std::move(tmp));
+        };
+    };
+
+    size_t n            = m_exprs.size() - base;
+
+    if (n == 0)
+        return expr(add);
+
+    int size_counter    = 0;
+    item_pod::destructor_type d(&size_counter);
+    sd::stack_array<item_pod> buff(n, &d);
+
+    item* items         = buff.get_cast<item>();
+
+    for (size_t i = 0; i < n; ++i)
+    {
+        new (items + size_counter) item(m_coefs[base + i], std::move(m_exprs[base + i]));
+        ++size_counter;
+    };
+
+    pop(base);
+
+    ast::add_build_info2<item> bi(add, n, items, nullptr);
+    return expr(ast::add_build::make(bi));
+};
+
+// multExpr: sgnAtom ((MULT | DIV) sgnAtom)*
+expr expr_parser::mult_expr()
+{
+    expr x  = sgn_atom();
+
+    if (m_token.m_type != token_type::mult && m_token.m_type != token_type::div)
+        return x;
+
+    // scalars are multiplied into the multiplication constant
+    value mult          = value::make_one();
+
+    size_t base         = m_exprs.size();
+
+    if (x.get_ptr()->isa<ast::scalar_rep>() == true)
+        mult            = cast_scalar(x).get_value();
+    else
+        push(value::make_one(), std::move(x));
+
+    while (m_token.m_type == token_type::mult || m_token.m_type == token_type::div)
+    {
+        bool is_mult    = m_token.m_type == token_type::mult;
+        consume();
+
+        expr tmp        = sgn_atom();
+
+        if (tmp.get_ptr()->isa<ast::scalar_rep>() == true)
+        {
+            const value& v  = cast_scalar(tmp).get_value();
+            mult            = is_mult ? mult * v : mult / v;
+        }
+        else
+        {
+            push(is_mult ? value::make_one() : value::make_minus_one(), std::move(tmp));
+        };
+    };
+
+    size_t n            = m_exprs.size() - base;
+
+    if (n == 0)
+        return expr(mult);
+
+    sd::stack_array<int> pow_buff(n);
+    sd::stack_array<ast::expr_handle> ex_buff(n);
+
+    int* pow            = pow_buff.get();
+    ast::expr_handle* ex= ex_buff.get();
+
+    for (size_t i = 0; i < n; ++i)
+    {
+        pow[i]          = m_coefs[base + i].is_one() ? 1 : -1;
+        ex[i]           = m_exprs[base + i].get_ptr().get();
+    };
+
+    ast::mult_build_info_int<ast::expr_handle> bi(mult, n, pow, ex);
+    expr ret            = expr(ast::mult_build::make(bi));
+
+    pop(base);
+    return ret;
+};
+
+// sgnAtom: MINUS powExpr | PLUS powExpr | powExpr
+expr expr_parser::sgn_atom()
+{
+    if (m_token.m_type == token_type::minus)
+    {
+        consume();
+        return - pow_expr();
+    }
+    else if (m_token.m_type == token_type::plus)
+    {
+        consume();
+        return pow_expr();
+    }
+    else
+    {
+        return pow_expr();
+    };
+};
+
+// powExpr: atoms (POWER sgnAtom)*
+expr expr_parser::pow_expr()
+{
+    expr x  = atoms();
+
+    while (m_token.m_type == token_type::power)
+    {
+        consume();
+
+        expr p  = sgn_atom();
+        x       = make_power(std::move(x), std::move(p));
+    };
+
+    return x;
+};
+
+// atoms: NUMBER | INT | star_or_symbol | OR term OR | LPAREN term RPAREN
+expr expr_parser::atoms()
+{
+    switch (m_token.m_type)
+    {
+        case token_type::number:
+            return make_number();
+
+        case token_type::integer:
+            return make_int();
+
+        case token_type::identifier:
+            return star_or_symbol();
+
+        case token_type::or_:
+        {
+            consume();
+            expr x  = term();
+            match(token_type::or_);
+            return abs(x);
+        }
+
+        case token_type::lparen:
+        {
+            consume();
+            expr x  = term();
+            match(token_type::rparen);
+            return x;
+        }
+
+        default:
+            unexpected_token();
+    };
+};
+
+// star_or_symbol: ID (LBRACK (term (COMMA term)*)? RBRACK)?
+expr expr_parser::star_or_symbol()
+{
+    symbol sym(m_token.m_begin, m_token.m_length);
+    consume();
+
+    if (m_token.m_type != token_type::lbrack)
+        return sym;
+
+    consume();
+
+    size_t base     = m_exprs.size();
+
+    if (is_term_start() == true)
+    {
+        push(value::make_one(), term());
+
+        while (m_token.m_type == token_type::comma)
+        {
+            consume();
+            push(value::make_one(), term());
+        };
+    };
+
+    match(token_type::rbrack);
+
+    size_t n        = m_exprs.size() - base;
+    expr ret        = make_function(sym, m_exprs.data() + base, n);
+
+    pop(base);
+    return ret;
+};
+
+expr expr_parser::make_function(const symbol& sym, const expr* args, size_t n)
+{
+    const char* name    = sym.get_name();
+
+    if (n == 1 && std::strcmp(name, "exp") == 0)
+        return sym_arrow::exp(args[0]);
+
+    if (n == 1 && std::strcmp(name, "log") == 0)
+        return sym_arrow::log(args[0]);
+
+    return sym_arrow::function(sym, args, n);
+};
+
+expr expr_parser::make_power(expr&& x, expr&& p)
+{
+    static const double tol = 100 * std::numeric_limits<double>::epsilon();
+
+    if (p.get_ptr()->isa<ast::scalar_rep>() == true)
+    {
+        double val      = p.get_ptr()->static_cast_to<ast::scalar_rep>()
+                            ->get_data().get_value();
+        double val_r    = ::floor(val);
+        int val_ri      = static_cast<int>(val_r);
+
+        if (std::abs(val - val_r) < tol * std::abs(val))
+            return power_int(std::move(x), val_ri);
+        else if (std::abs(val - val_r - 1.) < tol * std::abs(val))
+            return power_int(std::move(x),val_ri + 1);
+        else
+            return power_real(std::move(x), std::move(p));
+    }
+    else
+    {
+        return power_real(std::move(x), std::move(p));
+    }
+};
+
+expr expr_parser::make_int()
+{
+    const char* str     = m_token.m_begin;
+    size_t length       = m_token.m_length;
+    size_t max_digits   = std::numeric_limits<int>::digits10;
+
+    if (length > max_digits)
+        report_error("integer value too large");
+
+    int value           = 0;
+
+    for (size_t i = 0; i < length; ++i)
+        value           = value * 10 + str[i] - '0';
+
+    consume();
+    return expr(value);
+};
+
+expr expr_parser::make_number()
+{
+    const char* str     = m_token.m_begin;
+    size_t length       = m_token.m_length;
+
+    size_t radix;
+    long exp;
+    get_precission(str, length, radix, exp);
+
+    size_t prec_d = std::numeric_limits<double>::digits10;
+
+    if (radix > prec_d)
+        report_warning("too many significant digits, precision is lost");
+
+    int max_exp    = std::numeric_limits<double>::max_exponent10;
+    int min_exp    = std::numeric_limits<double>::min_exponent10;
+
+    if (exp + static_cast<long>(radix) > max_exp
+        || exp + static_cast<long>(radix) - 1 < min_exp)
+    {
+        report_error("numeric value too large");
+    };
+
+    double val  = boost::lexical_cast<double>(str, length);
+
+    consume();
+    return expr(val);
+};
+
+// count significant digits and decimal exponent of a number
+void expr_parser::get_precission(const char* str, size_t length, size_t& radix, long& exp)
+{
+    radix           = 0;
+    exp             = 0;
+    int exp_mult    = 1;
+    long e_exp      = 0;
+
+    enum STATE {S_INIT, S_RADIX, S_DOT, S_INIT_DOT, S_EXP};
+    STATE state     = S_INIT;
+
+    for (size_t i = 0; i < length; ++i)
+    {
+        char c      = str[i];
+
+        if (c == '0')
+        {
+            switch (state)
+            {
+                case S_INIT:                            break;
+                case S_RADIX:       ++radix;            break;
+                case S_DOT:         ++radix; --exp;     break;
+                case S_INIT_DOT:    --exp;              break;
+                case S_EXP:         e_exp = e_exp*10;   break;
+            };
+        }
+        else if (c >= '1' && c <= '9')
+        {
+            switch (state)
+            {
+                case S_INIT:        ++radix; state = S_RADIX;           break;
+                case S_RADIX:       ++radix;                            break;
+                case S_DOT:         ++radix; --exp;                     break;
+                case S_INIT_DOT:    ++radix; --exp; state = S_DOT;      break;
+                case S_EXP:         e_exp = e_exp*10 + c - '0';         break;
+            };
+        }
+        else if (c == '.')
+        {
+            if (state == S_INIT)
+                state = S_INIT_DOT;
+            else if (state == S_RADIX)
+                state = S_DOT;
+        }
+        else if (c == 'e' || c == 'E')
+        {
+            if (state == S_INIT || state == S_INIT_DOT)
+                return;
+
+            state = S_EXP;
+        }
+        else if (c == '-')
+        {
+            if (state == S_EXP)
+                exp_mult = -1;
+        };
+    };
+
+    exp = exp + exp_mult*e_exp;
+};
+
+void expr_parser::push(const value& coef, expr&& ex)
+{
+    m_coefs.push_back(coef);
+    m_exprs.push_back(std::move(ex));
+};
+
+void expr_parser::pop(size_t base)
+{
+    m_coefs.resize(base);
+    m_exprs.resize(base);
+};
+
+const char* expr_parser::token_name(token_type type)
+{
+    switch (type)
+    {
+        case token_type::eof:           return "EOF";
+        case token_type::integer:       return "integer";
+        case token_type::number:        return "number";
+        case token_type::identifier:    return "an identifier";
+        case token_type::string:        return "string";
+        case token_type::lparen:        return "'('";
+        case token_type::rparen:        return "')'";
+        case token_type::lbrack:        return "'['";
+        case token_type::rbrack:        return "']'";
+        case token_type::lcurl:         return "'{'";
+        case token_type::rcurl:         return "'}'";
+        case token_type::mult:          return "'*'";
+        case token_type::div:           return "'/'";
+        case token_type::plus:          return "'+'";
+        case token_type::minus:         return "'-'";
+        case token_type::power:         return "'^'";
+        case token_type::semi:          return "';'";
+        case token_type::assign:        return "'='";
+        case token_type::comma:         return "','";
+        case token_type::or_:           return "|";
+        case token_type::dot:           return "dot";
+        case token_type::ddot:          return "double dot";
+        default:                        return "<invalid>";
+    };
+};
+
+void expr_parser::unexpected_token()
+{
+    std::ostringstream os;
+
+    if (m_token.m_type == token_type::eof)
+        os << "unexpected end of file";
+    else
+        os << "unexpected token: " << std::string(m_token.m_begin, m_token.m_length);
+
+    os << ", line: " << m_token.m_line << ":" << m_token.m_column;
+    throw std::runtime_error(os.str());
+};
+
+void expr_parser::mismatched_token(token_type expected)
+{
+    std::ostringstream os;
+    os << "expecting " << token_name(expected) << ", found '"
+       << std::string(m_token.m_begin, m_token.m_length) << "'";
+
+    os << ", line: " << m_token.m_line << ":" << m_token.m_column;
+    throw std::runtime_error(os.str());
+};
+
+void expr_parser::report_error(const std::string& msg)
+{
+    throw std::runtime_error(msg);
+};
+
+void expr_parser::report_warning(const std::string& msg)
+{
+    std::cout << "warning: " << msg << "\n";
+};
+
+}};
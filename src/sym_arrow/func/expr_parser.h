@@ -0,0 +1,169 @@
+/* 
+ *  This file is a part of sym_arrow library.
+ *
+ *  Copyright (c) Pawe Kowal 2017 - 2021
+ *
+ *  This program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program; if not, write to the Free Software
+ *  Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA 02111-1307 USA
+ */
+
+#pragma once
+
+#include "sym_arrow/nodes/expr.h"
+
+#include <vector>
+#include <string>
+
+namespace sym_arrow { namespace details
+{
+
+// token types; hidden tokens (white spaces, new lines, comments and
+// continuations) are not reported
+enum class token_type
+{
+    eof,
+    integer,
+    number,
+    identifier,
+    string,
+    lparen,
+    rparen,
+    lbrack,
+    rbrack,
+    lcurl,
+    rcurl,
+    mult,
+    div,
+    plus,
+    minus,
+    power,
+    semi,
+    assign,
+    comma,
+    or_,
+    dot,
+    ddot,
+};
+
+struct token
+{
+    token_type          m_type;
+    const char*         m_begin;
+    size_t              m_length;
+    size_t              m_line;
+    size_t              m_column;
+
+    // true if this is the first token in a line; lines joined by
+    // continuations are treated as one line
+    bool                m_newline;
+};
+
+// lexer of the grammar defined in sym_arrow.g
+class expr_lexer
+{
+    private:
+        static const size_t tab_size    = 8;
+
+    private:
+        const char*         m_pos;
+        const char*         m_end;
+        size_t              m_line;
+        size_t              m_column;
+        bool                m_newline;
+        bool                m_continued;
+
+    public:
+        expr_lexer(const char* str, size_t size);
+
+        // read next token
+        token               next();
+
+    private:
+        char                LA(size_t k) const;
+        void                consume();
+        void                consume(size_t n);
+        void                newline();
+
+        bool                skip_hidden();
+        void                skip_ml_comment(size_t line, size_t col);
+        void                skip_string();
+        void                read_number(token& t);
+        void                read_exponent(token& t);
+
+        [[noreturn]] void   error_eof(const char* what, size_t line, size_t col);
+        void                report_char(size_t line, size_t col);
+};
+
+// recursive descent parser of the grammar defined in sym_arrow.g;
+// sums and products are build directly as add_build and mult_build
+// nodes
+class expr_parser
+{
+    private:
+        expr_lexer          m_lexer;
+        token               m_token;
+
+        // tokens read by another lexer or nullptr if m_lexer is used
+        const token*        m_tokens;
+
+        // operands of sums, products and functions currently parsed;
+        // storage is reused by all nested expressions
+        std::vector<expr>   m_exprs;
+        std::vector<value>  m_coefs;
+
+    public:
+        expr_parser(const char* str, size_t size);
+
+        // parser of tokens already read by a lexer; the last token must
+        // have the type token_type::eof; the input is not lexed again
+        explicit expr_parser(const token* tokens);
+
+        // parse an expression; trailing tokens are ignored
+        expr                make();
+
+        // parse an expression; trailing tokens are not allowed
+        expr                make_all();
+
+    private:
+        expr                term();
+        expr                mult_expr();
+        expr                sgn_atom();
+        expr                pow_expr();
+        expr                atoms();
+        expr                star_or_symbol();
+        expr                make_int();
+        expr                make_number();
+        expr                make_function(const symbol& sym, const expr* args,
+                                size_t n);
+        expr                make_power(expr&& x, expr&& p);
+
+        void                push(const value& coef, expr&& ex);
+        void                pop(size_t base);
+
+        token               next_token();
+        void                consume();
+        void                match(token_type type);
+        bool                is_term_start() const;
+
+        [[noreturn]] void   unexpected_token();
+        [[noreturn]] void   mismatched_token(token_type expected);
+        [[noreturn]] void   report_error(const std::string& msg);
+        void                report_warning(const std::string& msg);
+
+        static const char*  token_name(token_type type);
+        static void         get_precission(const char* str, size_t length,
+                                size_t& radix, long& exp);
+};
+
+}};
@@ -0,0 +1,465 @@
+/* 
+ *  This file is a part of sym_arrow library.
+ *
+ *  Copyright (c) Pawe Kowal 2017 - 2021
+ *
+ *  This program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program; if not, write to the Free Software
+ *  Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA 02111-1307 USA
+ */
+
+#include "sym_arrow/functions/extract_cse.h"
+#include "sym_arrow/functions/expr_functions.h"
+#include "sym_arrow/ast/ast.h"
+#include "sym_arrow/ast/mult_rep.inl"
+#include "sym_arrow/ast/builder/add_build.h"
+#include "sym_arrow/ast/builder/mult_build.h"
+
+#include <unordered_map>
+#include <sstream>
+
+namespace sym_arrow { namespace details
+{
+
+namespace sd = sym_arrow :: details;
+
+//--------------------------------------------------------------------
+//                  cse_counter
+//--------------------------------------------------------------------
+
+struct cse_node_info
+{
+    // number of references to a node in the union dag
+    size_t          m_uses;
+
+    // number of operations required to evaluate the node as a tree
+    size_t          m_cost;
+};
+
+// count references to nodes and number of operations
+class cse_counter : public sym_dag::dag_visitor<sym_arrow::ast::term_tag,
+                            cse_counter>
+{
+    public:
+        using tag_type      = sym_arrow::ast::term_tag;
+
+    private:
+        using info_map      = std::unordered_map<ast::expr_handle, cse_node_info>;
+
+    private:
+        info_map            m_info;
+
+    public:
+        // register new reference to h; return number of operations
+        // required to evaluate h
+        size_t              add_use(ast::expr_handle h);
+
+        // return info about a node; return nullptr if h was not visited
+        const cse_node_info*
+                            get_info(ast::expr_handle h) const;
+
+    public:
+        template<class Node>
+        size_t eval(const Node* ast);
+
+        size_t eval(const ast::scalar_rep* h);
+        size_t eval(const ast::symbol_rep* h);
+        size_t eval(const ast::add_build* h);
+        size_t eval(const ast::mult_build* h);
+        size_t eval(const ast::add_rep* h);
+        size_t eval(const ast::mult_rep* h);
+        size_t eval(const ast::function_rep* h);
+};
+
+size_t cse_counter::add_use(ast::expr_handle h)
+{
+    auto pos        = m_info.find(h);
+
+    if (pos != m_info.end())
+    {
+        ++pos->second.m_uses;
+        return pos->second.m_cost;
+    };
+
+    cse_node_info info;
+    info.m_uses     = 1;
+    info.m_cost     = visit(h);
+
+    m_info.insert(info_map::value_type(h, info));
+    return info.m_cost;
+};
+
+const cse_node_info* cse_counter::get_info(ast::expr_handle h) const
+{
+    auto pos        = m_info.find(h);
+
+    if (pos == m_info.end())
+        return nullptr;
+    else
+        return &pos->second;
+};
+
+size_t cse_counter::eval(const ast::scalar_rep* h)
+{
+    (void)h;
+    return 0;
+};
+
+size_t cse_counter::eval(const ast::symbol_rep* h)
+{
+    (void)h;
+    return 0;
+};
+
+size_t cse_counter::eval(const ast::add_build* h)
+{
+    (void)h;
+    assertion(0,"we should not be here");
+    throw;
+};
+
+size_t cse_counter::eval(const ast::mult_build* h)
+{
+    (void)h;
+    assertion(0,"we should not be here");
+    throw;
+};
+
+size_t cse_counter::eval(const ast::add_rep* h)
+{
+    size_t n        = h->size();
+    size_t cost     = 0;
+    size_t n_terms  = n;
+
+    for (size_t i = 0; i < n; ++i)
+    {
+        const value& v  = h->V(i);
+
+        if (v.is_one() == false && v.is_minus_one() == false)
+            ++cost;
+
+        cost        += add_use(h->E(i));
+    };
+
+    if (h->V0().is_zero() == false)
+        ++n_terms;
+
+    if (h->has_log() == true)
+    {
+        // log evaluation and addition
+        cost        += add_use(h->Log()) + 1;
+        ++n_terms;
+    };
+
+    if (n_terms > 0)
+        cost        += n_terms - 1;
+
+    return cost;
+};
+
+size_t cse_counter::eval(const ast::mult_rep* h)
+{
+    size_t in       = h->isize();
+    size_t rn       = h->rsize();
+    size_t cost     = 0;
+    size_t n_terms  = in + rn;
+
+    for (size_t i = 0; i < in; ++i)
+    {
+        if (h->IV(i) != 1)
+            ++cost;
+
+        cost        += add_use(h->IE(i));
+    };
+
+    for (size_t i = 0; i < rn; ++i)
+        cost        += add_use(h->RE(i)) + 1;
+
+    if (h->has_exp() == true)
+    {
+        cost        += add_use(h->Exp()) + 1;
+        ++n_terms;
+    };
+
+    if (n_terms > 0)
+        cost        += n_terms - 1;
+
+    return cost;
+};
+
+size_t cse_counter::eval(const ast::function_rep* h)
+{
+    size_t n        = h->size();
+    size_t cost     = 1;
+
+    for (size_t i = 0; i < n; ++i)
+        cost        += add_use(h->arg(i));
+
+    return cost;
+};
+
+//--------------------------------------------------------------------
+//                  cse_rebuilder
+//--------------------------------------------------------------------
+
+// rebuild expressions replacing common subexpressions by temporaries
+class cse_rebuilder : public sym_dag::dag_visitor<sym_arrow::ast::term_tag,
+                            cse_rebuilder>
+{
+    public:
+        using tag_type      = sym_arrow::ast::term_tag;
+
+    private:
+        using subs_map      = std::unordered_map<ast::expr_handle, expr>;
+
+    private:
+        const cse_counter&  m_counter;
+        cse_program&        m_prog;
+        std::string         m_prefix;
+        size_t              m_temp_index;
+        subs_map            m_subs;
+
+    public:
+        cse_rebuilder(const cse_counter& counter, cse_program& prog,
+                      const std::string& prefix);
+
+        // expression equivalent to h
+        expr                make(ast::expr_handle h);
+
+    public:
+        template<class Node>
+        expr eval(const Node* ast);
+
+        expr eval(const ast::scalar_rep* h);
+        expr eval(const ast::symbol_rep* h);
+        expr eval(const ast::add_build* h);
+        expr eval(const ast::mult_build* h);
+        expr eval(const ast::add_rep* h);
+        expr eval(const ast::mult_rep* h);
+        expr eval(const ast::function_rep* h);
+
+    private:
+        bool                is_temp(ast::expr_handle h) const;
+        expr                make_temp(expr&& ex);
+};
+
+cse_rebuilder::cse_rebuilder(const cse_counter& counter, cse_program& prog,
+                             const std::string& prefix)
+    :m_counter(counter), m_prog(prog), m_prefix(prefix), m_temp_index(0)
+{};
+
+bool cse_rebuilder::is_temp(ast::expr_handle h) const
+{
+    // evaluation of a node used n times is replaced by evaluation of
+    // the node once and n - 1 references to a temporary
+    const cse_node_info* info   = m_counter.get_info(h);
+
+    return info != nullptr && info->m_uses > 1 && info->m_cost > 0;
+};
+
+expr cse_rebuilder::make_temp(expr&& ex)
+{
+    symbol sym;
+
+    // names of symbols appearing in expressions are skipped; all symbols
+    // were visited by the counter
+    for (;;)
+    {
+        std::ostringstream os;
+        os << m_prefix << ++m_temp_index;
+
+        sym     = symbol(os.str());
+
+        if (m_counter.get_info(expr(sym).get_expr_handle()) == nullptr)
+            break;
+    };
+
+    m_prog.m_temps.push_back(sym);
+    m_prog.m_temp_values.push_back(std::move(ex));
+
+    return expr(sym);
+};
+
+expr cse_rebuilder::make(ast::expr_handle h)
+{
+    if (h->isa<ast::scalar_rep>() == true || h->isa<ast::symbol_rep>() == true)
+        return expr(h);
+
+    auto pos    = m_subs.find(h);
+
+    if (pos != m_subs.end())
+        return pos->second;
+
+    expr ret    = visit(h);
+
+    if (is_temp(h) == true)
+        ret     = make_temp(std::move(ret));
+
+    m_subs.insert(subs_map::value_type(h, ret));
+    return ret;
+};
+
+expr cse_rebuilder::eval(const ast::scalar_rep* h)
+{
+    return expr(ast::expr_ptr::from_this(h));
+};
+
+expr cse_rebuilder::eval(const ast::symbol_rep* h)
+{
+    return expr(ast::expr_ptr::from_this(h));
+};
+
+expr cse_rebuilder::eval(const ast::add_build* h)
+{
+    (void)h;
+    assertion(0,"we should not be here");
+    throw;
+};
+
+expr cse_rebuilder::eval(const ast::mult_build* h)
+{
+    (void)h;
+    assertion(0,"we should not be here");
+    throw;
+};
+
+expr cse_rebuilder::eval(const ast::add_rep* h)
+{
+    using item          = ast::build_item<value>;
+
+    size_t n            = h->size();
+
+    std::vector<item> items;
+    items.reserve(n);
+
+    for (size_t i = 0; i < n; ++i)
+        items.push_back(item(h->V(i), make(h->E(i))));
+
+    ast::expr_ptr ret;
+
+    if (h->has_log() == false)
+    {
+        ast::add_build_info2<item> bi(h->V0(), n, items.data(), nullptr);
+        ret             = ast::add_build::make(bi);
+    }
+    else
+    {
+        item log_it     = item(value::make_one(), make(h->Log()));
+
+        ast::add_build_info2<item> bi(h->V0(), n, items.data(), &log_it);
+        ret             = ast::add_build::make(bi);
+    };
+
+    // factorization could destroy found subexpressions
+    expr res            = expr(std::move(ret));
+    res.cannonize(false);
+
+    return res;
+};
+
+expr cse_rebuilder::eval(const ast::mult_rep* h)
+{
+    using iitem         = ast::build_item<int>;
+    using ritem         = ast::build_item<value>;
+
+    size_t in           = h->isize();
+    size_t rn           = h->rsize();
+
+    std::vector<iitem> iitems;
+    std::vector<ritem> ritems;
+    iitems.reserve(in);
+    ritems.reserve(rn);
+
+    for (size_t i = 0; i < in; ++i)
+        iitems.push_back(iitem(h->IV(i), make(h->IE(i))));
+
+    for (size_t i = 0; i < rn; ++i)
+        ritems.push_back(ritem(h->RV(i), make(h->RE(i))));
+
+    expr exp_term;
+
+    if (h->has_exp() == true)
+        exp_term        = make(h->Exp());
+
+    ast::expr_handle ex_h   = exp_term.is_null() ? nullptr : exp_term.get_ptr().get();
+
+    ast::mult_build_info<iitem, ritem> bi(in, iitems.data(), rn, ritems.data(), ex_h);
+
+    expr res            = expr(ast::mult_build::make(bi));
+    res.cannonize(false);
+
+    return res;
+};
+
+expr cse_rebuilder::eval(const ast::function_rep* h)
+{
+    size_t n            = h->size();
+
+    std::vector<expr> args;
+    args.reserve(n);
+
+    for (size_t i = 0; i < n; ++i)
+        args.push_back(make(h->arg(i)));
+
+    ast::function_rep_info bi(h->name(), n, args.data());
+
+    expr res            = expr(ast::function_rep::make(bi));
+    res.cannonize(false);
+
+    return res;
+};
+
+}};
+
+namespace sym_arrow
+{
+
+cse_program::cse_program()
+    :m_ops_before(0), m_ops_after(0)
+{};
+
+cse_program sym_arrow::extract_cse(const std::vector<expr>& ex,
+                                   const std::string& temp_prefix)
+{
+    cse_program prog;
+    details::cse_counter counter;
+
+    for (const expr& e : ex)
+    {
+        e.cannonize();
+        prog.m_ops_before   += counter.add_use(e.get_expr_handle());
+    };
+
+    details::cse_rebuilder rb(counter, prog, temp_prefix);
+
+    for (const expr& e : ex)
+        prog.m_outputs.push_back(rb.make(e.get_expr_handle()));
+
+    details::cse_counter counter_after;
+
+    for (const expr& e : prog.m_temp_values)
+        prog.m_ops_after    += counter_after.add_use(e.get_expr_handle());
+
+    for (const expr& e : prog.m_outputs)
+        prog.m_ops_after    += counter_after.add_use(e.get_expr_handle());
+
+    return prog;
+};
+
+size_t sym_arrow::count_ops(const expr& ex)
+{
+    ex.cannonize();
+    return details::cse_counter().add_use(ex.get_expr_handle());
+};
+
+};
@@ -0,0 +1,500 @@
+/* 
+ *  This file is a part of sym_arrow library.
+ *
+ *  Copyright (c) Pawe Kowal 2017 - 2021
+ *
+ *  This program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program; if not, write to the Free Software
+ *  Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA 02111-1307 USA
+ */
+
+#include "sym_arrow/functions/forward_diff.h"
+#include "sym_arrow/functions/expr_functions.h"
+#include "sym_arrow/func/num_eval.h"
+#include "sym_arrow/func/builtin_table.h"
+#include "sym_arrow/ast/cannonization/cannonize.h"
+#include "sym_arrow/error/error_formatter.h"
+#include "sym_arrow/utils/stack_array.h"
+
+#include <cmath>
+
+namespace sym_arrow { namespace details
+{
+
+namespace sd = sym_arrow :: details;
+
+// dual number x + d * e, where e^2 = 0
+struct dual_number
+{
+    static const bool   second_order = false;
+
+    double              m_val;
+    double              m_dif;
+
+    static dual_number make(double x, double d1, double d2)
+    {
+        (void)d2;
+        return dual_number{x, d1};
+    };
+
+    // return f(this) given value and derivatives of f at m_val
+    dual_number chain(double f, double f1, double f2) const
+    {
+        (void)f2;
+        return dual_number{f, f1 * m_dif};
+    };
+
+    bool is_constant() const
+    {
+        return m_dif == 0.0;
+    };
+
+    // derivative in the second direction
+    double dif2() const
+    {
+        return 0.0;
+    };
+
+    // return f(args) given value f, gradient grad and derivatives of
+    // gradient in the second direction hess_2
+    static dual_number make_function(const dual_number* args, size_t n, double f,
+                                     const double* grad, const double* hess_2)
+    {
+        (void)hess_2;
+
+        double d    = 0.0;
+
+        for (size_t i = 0; i < n; ++i)
+        {
+            if (args[i].m_dif != 0.0)
+                d   += grad[i] * args[i].m_dif;
+        };
+
+        return dual_number{f, d};
+    };
+
+    friend dual_number operator+(const dual_number& a, const dual_number& b)
+    {
+        return dual_number{a.m_val + b.m_val, a.m_dif + b.m_dif};
+    };
+
+    friend dual_number operator*(double c, const dual_number& a)
+    {
+        return dual_number{c * a.m_val, c * a.m_dif};
+    };
+
+    friend dual_number operator*(const dual_number& a, const dual_number& b)
+    {
+        return dual_number{a.m_val * b.m_val, a.m_dif * b.m_val + a.m_val * b.m_dif};
+    };
+};
+
+// hyper-dual number x + d1 * e1 + d2 * e2 + d12 * e1 * e2, where
+// e1^2 = e2^2 = 0
+struct hyper_dual_number
+{
+    static const bool   second_order = true;
+
+    double              m_val;
+    double              m_dif1;
+    double              m_dif2;
+    double              m_dif12;
+
+    static hyper_dual_number make(double x, double d1, double d2)
+    {
+        return hyper_dual_number{x, d1, d2, 0.0};
+    };
+
+    hyper_dual_number chain(double f, double f1, double f2) const
+    {
+        return hyper_dual_number{f, f1 * m_dif1, f1 * m_dif2,
+                                 f1 * m_dif12 + f2 * m_dif1 * m_dif2};
+    };
+
+    bool is_constant() const
+    {
+        return m_dif1 == 0.0 && m_dif2 == 0.0 && m_dif12 == 0.0;
+    };
+
+    double dif2() const
+    {
+        return m_dif2;
+    };
+
+    static hyper_dual_number make_function(const hyper_dual_number* args, size_t n,
+                                double f, const double* grad, const double* hess_2)
+    {
+        hyper_dual_number ret{f, 0.0, 0.0, 0.0};
+
+        for (size_t i = 0; i < n; ++i)
+        {
+            if (args[i].is_constant() == true)
+                continue;
+
+            ret.m_dif1  += grad[i] * args[i].m_dif1;
+            ret.m_dif2  += grad[i] * args[i].m_dif2;
+            ret.m_dif12 += grad[i] * args[i].m_dif12 + hess_2[i] * args[i].m_dif1;
+        };
+
+        return ret;
+    };
+
+    friend hyper_dual_number operator+(const hyper_dual_number& a, const hyper_dual_number& b)
+    {
+        return hyper_dual_number{a.m_val + b.m_val, a.m_dif1 + b.m_dif1,
+                                 a.m_dif2 + b.m_dif2, a.m_dif12 + b.m_dif12};
+    };
+
+    friend hyper_dual_number operator*(double c, const hyper_dual_number& a)
+    {
+        return hyper_dual_number{c * a.m_val, c * a.m_dif1, c * a.m_dif2, c * a.m_dif12};
+    };
+
+    friend hyper_dual_number operator*(const hyper_dual_number& a, const hyper_dual_number& b)
+    {
+        return hyper_dual_number{a.m_val * b.m_val,
+                    a.m_dif1 * b.m_val + a.m_val * b.m_dif1,
+                    a.m_dif2 * b.m_val + a.m_val * b.m_dif2,
+                    a.m_dif12 * b.m_val + a.m_dif1 * b.m_dif2 + a.m_dif2 * b.m_dif1
+                        + a.m_val * b.m_dif12};
+    };
+};
+
+// directions of symbols indexed by symbol code
+class direction_table
+{
+    private:
+        std::vector<double> m_dir;
+
+    public:
+        direction_table(const std::vector<symbol>& syms, const std::vector<value>& dir);
+
+        double get(size_t code) const
+        {
+            return code < m_dir.size() ? m_dir[code] : 0.0;
+        };
+};
+
+direction_table::direction_table(const std::vector<symbol>& syms,
+                                 const std::vector<value>& dir)
+{
+    if (syms.size() != dir.size())
+    {
+        error::error_formatter ef;
+        ef.head() << "invalid size of direction";
+
+        ef.new_info();
+        ef.line() << "expecting direction of size: " << syms.size();
+
+        ef.new_info();
+        ef.line() << "supplied direction has size: " << dir.size();
+
+        throw std::runtime_error(ef.str());
+    };
+
+    for (size_t i = 0; i < syms.size(); ++i)
+    {
+        size_t code     = syms[i].get_symbol_code();
+
+        if (code >= m_dir.size())
+            m_dir.resize(code + 1, 0.0);
+
+        m_dir[code]     = dir[i].get_value();
+    };
+};
+
+dual_value eval_dual_impl(const expr& ex, const data_provider& dp,
+                          const direction_table& dir, const diff_context& dc);
+
+// evaluation of dual numbers; dir2 is used only by hyper-dual numbers
+template<class Number>
+class forward_diff_traits
+{
+    public:
+        using number_type   = Number;
+
+    private:
+        const data_provider&    m_dp;
+        const direction_table&  m_dir1;
+        const direction_table&  m_dir2;
+        diff_context            m_dc;
+
+    public:
+        forward_diff_traits(const data_provider& dp, const direction_table& dir1,
+                            const direction_table& dir2, const diff_context& dc)
+            :m_dp(dp), m_dir1(dir1), m_dir2(dir2), m_dc(dc)
+        {};
+
+        number_type make_scalar(const value& v)
+        {
+            return number_type::make(v.get_value(), 0.0, 0.0);
+        };
+
+        number_type make_symbol(const ast::symbol_rep* h)
+        {
+            size_t code     = h->get_symbol_code();
+            double x        = m_dp.get_value(symbol(h)).get_value();
+
+            return number_type::make(x, m_dir1.get(code), m_dir2.get(code));
+        };
+
+        number_type add(const number_type& a, const number_type& b)
+        {
+            return a + b;
+        };
+
+        number_type scale(const value& c, const number_type& a)
+        {
+            return c.get_value() * a;
+        };
+
+        number_type mult(const number_type& a, const number_type& b)
+        {
+            return a * b;
+        };
+
+        number_type power_int(const number_type& a, int p)
+        {
+            double x        = a.m_val;
+            double f        = sym_arrow::power_int(value(x), p).get_value();
+
+            if (p == 0)
+                return a.chain(f, 0.0, 0.0);
+            if (p == 1)
+                return a.chain(f, 1.0, 0.0);
+
+            double f1       = p * sym_arrow::power_int(value(x), p - 1).get_value();
+            double f2       = p * (p - 1.0) * sym_arrow::power_int(value(x), p - 2).get_value();
+
+            return a.chain(f, f1, f2);
+        };
+
+        number_type power_real(const number_type& a, const value& pv)
+        {
+            // real power |x|^p
+            double x        = a.m_val;
+            double p        = pv.get_value();
+            double f        = sym_arrow::power_real(value(x), pv).get_value();
+            double ax       = std::abs(x);
+            double sign     = x > 0.0 ? 1.0 : (x < 0.0 ? -1.0 : 0.0);
+
+            double f1       = p * std::pow(ax, p - 1.0) * sign;
+            double f2       = p == 1.0 ? 0.0 : p * (p - 1.0) * std::pow(ax, p - 2.0);
+
+            return a.chain(f, f1, f2);
+        };
+
+        number_type exp(const number_type& a)
+        {
+            double f        = sym_arrow::exp(value(a.m_val)).get_value();
+            return a.chain(f, f, f);
+        };
+
+        number_type log(const number_type& a)
+        {
+            // log |x|
+            double x        = a.m_val;
+            double f        = sym_arrow::log(value(x)).get_value();
+            double f1       = 1.0 / x;
+
+            return a.chain(f, f1, -f1 * f1);
+        };
+
+        number_type make_function(const ast::function_rep* h, const number_type* args,
+                                  size_t n);
+
+    private:
+        number_type make_user_function(const ast::function_rep* h, const number_type* args,
+                                       size_t n);
+
+        static void error_diff_rule_not_defined(const symbol& func_name, size_t n_args,
+                                       size_t arg);
+};
+
+template<class Number>
+Number forward_diff_traits<Number>::make_function(const ast::function_rep* h,
+                                const Number* args, size_t n)
+{
+    builtin_code code   = builtin_table::get().get_code(h->name(), n);
+
+    if (code == builtin_code::none)
+        return make_user_function(h, args, n);
+
+    double vals[2];
+    double grad[2];
+    double hess[4];
+    double hess_2[2];
+
+    for (size_t i = 0; i < n; ++i)
+        vals[i]         = args[i].m_val;
+
+    double f    = builtin_table::eval_diff(code, vals, grad,
+                                           Number::second_order ? hess : nullptr);
+
+    if (Number::second_order == true)
+    {
+        for (size_t i = 0; i < n; ++i)
+        {
+            hess_2[i]   = 0.0;
+
+            for (size_t j = 0; j < n; ++j)
+                hess_2[i] += hess[i * n + j] * args[j].dif2();
+        };
+    };
+
+    return Number::make_function(args, n, f, grad, hess_2);
+};
+
+template<class Number>
+Number forward_diff_traits<Number>::make_user_function(const ast::function_rep* h,
+                                const Number* args, size_t n)
+{
+    using value_pod     = sd::pod_type<value>;
+    using expr_pod      = sd::pod_type<expr>;
+
+    int val_counter     = 0;
+    int ex_counter      = 0;
+
+    value_pod::destructor_type d_val(&val_counter);
+    expr_pod::destructor_type d_ex(&ex_counter);
+
+    sd::stack_array<value_pod> val_buff(n, &d_val);
+    sd::stack_array<expr_pod> ex_buff(n, &d_ex);
+    sd::stack_array<double> grad_buff(n);
+    sd::stack_array<double> hess_buff(n);
+
+    value* vals         = val_buff.get_cast<value>();
+    expr* ex_args       = ex_buff.get_cast<expr>();
+    double* grad        = grad_buff.get();
+    double* hess_2      = hess_buff.get();
+
+    for (size_t i = 0; i < n; ++i)
+    {
+        new(vals + val_counter) value(args[i].m_val);
+        ++val_counter;
+
+        new(ex_args + ex_counter) expr(h->arg(i));
+        ++ex_counter;
+    };
+
+    symbol name         = symbol(ast::symbol_ptr::from_this(h->name()));
+    double f            = m_dp.eval_function(name, vals, n).get_value();
+
+    // partial derivatives are given by expressions defined in diff
+    // context; derivatives of partial derivatives in the second
+    // direction are evaluated using dual numbers
+    for (size_t i = 0; i < n; ++i)
+    {
+        grad[i]         = 0.0;
+        hess_2[i]       = 0.0;
+
+        if (args[i].is_constant() == true)
+            continue;
+
+        expr dif        = m_dc.diff(name, i, ex_args, n);
+
+        if (dif.is_null() == true)
+            error_diff_rule_not_defined(name, n, i);
+
+        if (Number::second_order == true)
+        {
+            dual_value dv   = eval_dual_impl(dif, m_dp, m_dir2, m_dc);
+            grad[i]         = dv.m_value.get_value();
+            hess_2[i]       = dv.m_dif.get_value();
+        }
+        else
+        {
+            grad[i]         = sym_arrow::eval(dif, m_dp).get_value();
+        };
+    };
+
+    return Number::make_function(args, n, f, grad, hess_2);
+};
+
+template<class Number>
+void forward_diff_traits<Number>::error_diff_rule_not_defined(const symbol& func_name,
+                                size_t n_args, size_t arg)
+{
+    error::error_formatter ef;
+    ef.head() << "differentiation rule not defined";
+
+    ef.new_info();
+    ef.line() << "unable to find differentiation rule d/dx" << arg + 1 << " ";
+    disp(ef.line(), func_name, false);
+    ef.line() << " with " << n_args << " arguments";
+
+    throw std::runtime_error(ef.str());
+};
+
+// evaluate a cannonized expression
+template<class Number>
+static Number eval_forward(const expr& ex, const data_provider& dp,
+                           const direction_table& dir1, const direction_table& dir2,
+                           const diff_context& dc)
+{
+    forward_diff_traits<Number> traits(dp, dir1, dir2, dc);
+    do_num_eval_vis<forward_diff_traits<Number>> vis(traits);
+
+    return vis.make(ex.get_expr_handle());
+};
+
+dual_value eval_dual_impl(const expr& ex, const data_provider& dp,
+                          const direction_table& dir, const diff_context& dc)
+{
+    ex.cannonize(ast::cannonize::do_cse_lazy());
+
+    dual_number res     = eval_forward<dual_number>(ex, dp, dir, dir, dc);
+
+    dual_value ret;
+    ret.m_value         = value::make_value(res.m_val);
+    ret.m_dif           = value::make_value(res.m_dif);
+
+    return ret;
+};
+
+}};
+
+namespace sym_arrow
+{
+
+dual_value sym_arrow::eval_dual(const expr& ex, const data_provider& dp,
+                        const std::vector<symbol>& syms, const std::vector<value>& dir,
+                        const diff_context& dc)
+{
+    details::direction_table dir_table(syms, dir);
+    return details::eval_dual_impl(ex, dp, dir_table, dc);
+};
+
+hyper_dual_value sym_arrow::eval_hyper_dual(const expr& ex, const data_provider& dp,
+                        const std::vector<symbol>& syms, const std::vector<value>& dir1,
+                        const std::vector<value>& dir2, const diff_context& dc)
+{
+    ex.cannonize(ast::cannonize::do_cse_lazy());
+
+    details::direction_table dir_table1(syms, dir1);
+    details::direction_table dir_table2(syms, dir2);
+
+    details::hyper_dual_number res
+        = details::eval_forward<details::hyper_dual_number>(ex, dp, dir_table1, 
+                                            dir_table2, dc);
+
+    hyper_dual_value ret;
+    ret.m_value         = value::make_value(res.m_val);
+    ret.m_dif1          = value::make_value(res.m_dif1);
+    ret.m_dif2          = value::make_value(res.m_dif2);
+    ret.m_dif12         = value::make_value(res.m_dif12);
+
+    return ret;
+};
+
+};
@@ -0,0 +1,737 @@
+/* 
+ *  This file is a part of sym_arrow library.
+ *
+ *  Copyright (c) Pawe Kowal 2017 - 2021
+ *
+ *  This program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program; if not, write to the Free Software
+ *  Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA 02111-1307 USA
+ */
+
+#include "sym_arrow/functions/interval_eval.h"
+#include "sym_arrow/functions/expr_functions.h"
+#include "sym_arrow/func/num_eval.h"
+#include "sym_arrow/func/builtin_table.h"
+#include "sym_arrow/ast/cannonization/cannonize.h"
+#include "sym_arrow/error/error_formatter.h"
+
+#include <cmath>
+#include <limits>
+#include <algorithm>
+
+namespace sym_arrow { namespace details
+{
+
+// interval with double bounds
+struct ival
+{
+    double      m_lo;
+    double      m_hi;
+};
+
+// interval arithmetic; bounds are rounded outward by a number of ulps
+// not smaller than the error of the operation
+class interval_arith
+{
+    private:
+        // error of elementary functions in ulps
+        static constexpr double func_ulps   = 4.0;
+
+        static constexpr double pi          = 3.14159265358979323846;
+        static constexpr double two_pi      = 6.28318530717958647692;
+
+    public:
+        static ival make(double x);
+        static ival make(double lo, double hi);
+        static ival make(const interval& x);
+        static interval to_interval(const ival& x);
+
+        static ival whole();
+
+        static ival add(const ival& a, const ival& b);
+        static ival scale(double c, const ival& a);
+        static ival mult(const ival& a, const ival& b);
+        static ival power_int(const ival& a, int p);
+        static ival power_real(const ival& a, double p);
+        static ival exp(const ival& a);
+        static ival log(const ival& a);
+        static ival builtin(builtin_code code, const ival* args);
+
+    private:
+        static double down(double x, double ulps = 1.0);
+        static double up(double x, double ulps = 1.0);
+        static double mult(double a, double b);
+
+        static ival abs(const ival& a);
+        static ival inv(const ival& a);
+        static ival increasing(const ival& a, double (*f)(double), double lo, double hi);
+        static ival periodic(const ival& a, double (*f)(double), double max_at,
+                        double min_at);
+        static ival atan2(const ival& y, const ival& x);
+        static bool contains_period(const ival& a, double c);
+};
+
+inline double interval_arith::down(double x, double ulps)
+{
+    if (x != x)
+        return -std::numeric_limits<double>::infinity();
+
+    if (std::abs(x) == std::numeric_limits<double>::infinity())
+        return x;
+
+    double eps  = std::numeric_limits<double>::epsilon();
+    return x - (std::abs(x) * ulps * eps + std::numeric_limits<double>::denorm_min());
+};
+
+inline double interval_arith::up(double x, double ulps)
+{
+    if (x != x)
+        return std::numeric_limits<double>::infinity();
+
+    if (std::abs(x) == std::numeric_limits<double>::infinity())
+        return x;
+
+    double eps  = std::numeric_limits<double>::epsilon();
+    return x + (std::abs(x) * ulps * eps + std::numeric_limits<double>::denorm_min());
+};
+
+inline double interval_arith::mult(double a, double b)
+{
+    // 0 * inf = 0 in interval arithmetic
+    if (a == 0.0 || b == 0.0)
+        return 0.0;
+
+    return a * b;
+};
+
+inline ival interval_arith::make(double x)
+{
+    return ival{x, x};
+};
+
+inline ival interval_arith::make(double lo, double hi)
+{
+    return ival{lo, hi};
+};
+
+inline ival interval_arith::make(const interval& x)
+{
+    return ival{x.m_lower.get_value(), x.m_upper.get_value()};
+};
+
+inline interval interval_arith::to_interval(const ival& x)
+{
+    return interval(value::make_value(x.m_lo), value::make_value(x.m_hi));
+};
+
+inline ival interval_arith::whole()
+{
+    double inf  = std::numeric_limits<double>::infinity();
+    return ival{-inf, inf};
+};
+
+ival interval_arith::add(const ival& a, const ival& b)
+{
+    return ival{down(a.m_lo + b.m_lo), up(a.m_hi + b.m_hi)};
+};
+
+ival interval_arith::scale(double c, const ival& a)
+{
+    if (c == 0.0)
+        return make(0.0);
+
+    if (c > 0.0)
+        return ival{down(mult(c, a.m_lo)), up(mult(c, a.m_hi))};
+    else
+        return ival{down(mult(c, a.m_hi)), up(mult(c, a.m_lo))};
+};
+
+ival interval_arith::mult(const ival& a, const ival& b)
+{
+    double p1   = mult(a.m_lo, b.m_lo);
+    double p2   = mult(a.m_lo, b.m_hi);
+    double p3   = mult(a.m_hi, b.m_lo);
+    double p4   = mult(a.m_hi, b.m_hi);
+
+    double lo   = std::min(std::min(p1, p2), std::min(p3, p4));
+    double hi   = std::max(std::max(p1, p2), std::max(p3, p4));
+
+    return ival{down(lo), up(hi)};
+};
+
+ival interval_arith::abs(const ival& a)
+{
+    if (a.m_lo >= 0.0)
+        return a;
+
+    if (a.m_hi <= 0.0)
+        return ival{-a.m_hi, -a.m_lo};
+
+    return ival{0.0, std::max(-a.m_lo, a.m_hi)};
+};
+
+ival interval_arith::inv(const ival& a)
+{
+    double inf  = std::numeric_limits<double>::infinity();
+
+    if (a.m_lo > 0.0 || a.m_hi < 0.0)
+        return ival{down(1.0 / a.m_hi), up(1.0 / a.m_lo)};
+
+    if (a.m_lo == 0.0 && a.m_hi > 0.0)
+        return ival{down(1.0 / a.m_hi), inf};
+
+    if (a.m_hi == 0.0 && a.m_lo < 0.0)
+        return ival{-inf, up(1.0 / a.m_lo)};
+
+    return whole();
+};
+
+ival interval_arith::power_int(const ival& a, int p)
+{
+    if (p == 0)
+        return make(1.0);
+
+    if (p < 0)
+        return inv(power_int(a, -p));
+
+    if (p == 1)
+        return a;
+
+    double ulps = p + 1.0;
+    double e    = double(p);
+
+    // odd powers are increasing
+    if (p % 2 == 1)
+        return ival{down(std::pow(a.m_lo, e), ulps), up(std::pow(a.m_hi, e), ulps)};
+
+    // even powers are nonnegative
+    ival b      = abs(a);
+    double lo   = b.m_lo == 0.0 ? 0.0 : std::max(0.0, down(std::pow(b.m_lo, e), ulps));
+
+    return ival{lo, up(std::pow(b.m_hi, e), ulps)};
+};
+
+ival interval_arith::power_real(const ival& a, double p)
+{
+    // real power |x|^p
+    if (p == 0.0)
+        return make(1.0);
+
+    ival b      = abs(a);
+
+    if (p > 0.0)
+    {
+        double lo   = std::max(0.0, down(std::pow(b.m_lo, p), func_ulps));
+        return ival{lo, up(std::pow(b.m_hi, p), func_ulps)};
+    };
+
+    double lo   = std::max(0.0, down(std::pow(b.m_hi, p), func_ulps));
+    return ival{lo, up(std::pow(b.m_lo, p), func_ulps)};
+};
+
+ival interval_arith::exp(const ival& a)
+{
+    double lo   = std::max(0.0, down(std::exp(a.m_lo), func_ulps));
+    return ival{lo, up(std::exp(a.m_hi), func_ulps)};
+};
+
+ival interval_arith::log(const ival& a)
+{
+    // log |x|
+    ival b      = abs(a);
+    return ival{down(std::log(b.m_lo), func_ulps), up(std::log(b.m_hi), func_ulps)};
+};
+
+ival interval_arith::increasing(const ival& a, double (*f)(double), double lo,
+                                double hi)
+{
+    double l    = std::max(lo, down(f(a.m_lo), func_ulps));
+    double h    = std::min(hi, up(f(a.m_hi), func_ulps));
+
+    return ival{l, h};
+};
+
+bool interval_arith::contains_period(const ival& a, double c)
+{
+    // return true if c + 2 * pi * k is in a for some k; a is enlarged
+    // to account for rounding errors
+    double tol  = 1e-12 * (1.0 + std::max(std::abs(a.m_lo), std::abs(a.m_hi)));
+    double lo   = a.m_lo - tol;
+    double hi   = a.m_hi + tol;
+
+    double k    = std::ceil((lo - c) / two_pi);
+    return c + two_pi * k <= hi;
+};
+
+ival interval_arith::periodic(const ival& a, double (*f)(double), double max_at,
+                              double min_at)
+{
+    bool finite     = std::abs(a.m_lo) < std::numeric_limits<double>::infinity()
+                    && std::abs(a.m_hi) < std::numeric_limits<double>::infinity();
+
+    if (finite == false || a.m_hi - a.m_lo >= two_pi)
+        return ival{-1.0, 1.0};
+
+    double f_lo     = f(a.m_lo);
+    double f_hi     = f(a.m_hi);
+
+    double lo       = std::max(-1.0, down(std::min(f_lo, f_hi), func_ulps));
+    double hi       = std::min(1.0, up(std::max(f_lo, f_hi), func_ulps));
+
+    if (contains_period(a, max_at) == true)
+        hi          = 1.0;
+
+    if (contains_period(a, min_at) == true)
+        lo          = -1.0;
+
+    return ival{lo, hi};
+};
+
+ival interval_arith::atan2(const ival& y, const ival& x)
+{
+    double pi_up    = up(pi);
+
+    // atan2 is continuous and monotone in each argument if the branch
+    // cut x <= 0, y = 0 is not crossed; extremes are at corners
+    if (x.m_lo > 0.0 || y.m_lo > 0.0 || y.m_hi < 0.0)
+    {
+        double v1   = std::atan2(y.m_lo, x.m_lo);
+        double v2   = std::atan2(y.m_lo, x.m_hi);
+        double v3   = std::atan2(y.m_hi, x.m_lo);
+        double v4   = std::atan2(y.m_hi, x.m_hi);
+
+        double lo   = std::min(std::min(v1, v2), std::min(v3, v4));
+        double hi   = std::max(std::max(v1, v2), std::max(v3, v4));
+
+        return ival{std::max(-pi_up, down(lo, func_ulps)), std::min(pi_up, up(hi, func_ulps))};
+    };
+
+    return ival{-pi_up, pi_up};
+};
+
+static double logistic_bound(double x)
+{
+    double args[1]  = {x};
+    return builtin_table::eval(builtin_code::logistic, args);
+};
+
+static double sin_bound(double x)   { return std::sin(x); };
+static double cos_bound(double x)   { return std::cos(x); };
+static double tanh_bound(double x)  { return std::tanh(x); };
+static double erf_bound(double x)   { return std::erf(x); };
+static double sqrt_bound(double x)  { return std::sqrt(x); };
+
+ival interval_arith::builtin(builtin_code code, const ival* args)
+{
+    switch (code)
+    {
+        case builtin_code::sin:
+            return periodic(args[0], &sin_bound, 0.5 * pi, -0.5 * pi);
+        case builtin_code::cos:
+            return periodic(args[0], &cos_bound, 0.0, pi);
+        case builtin_code::tanh:
+            return increasing(args[0], &tanh_bound, -1.0, 1.0);
+        case builtin_code::erf:
+            return increasing(args[0], &erf_bound, -1.0, 1.0);
+        case builtin_code::logistic:
+            return increasing(args[0], &logistic_bound, 0.0, 1.0);
+        case builtin_code::atan2:
+            return atan2(args[0], args[1]);
+        case builtin_code::sqrt:
+        {
+            // sqrt is defined for x >= 0 only
+            if (args[0].m_hi < 0.0)
+                return whole();
+
+            ival a  = ival{std::max(args[0].m_lo, 0.0), args[0].m_hi};
+            double inf  = std::numeric_limits<double>::infinity();
+            return increasing(a, &sqrt_bound, 0.0, inf);
+        }
+        default:
+            assertion(0, "unknown builtin function");
+            throw;
+    };
+};
+
+// evaluation of intervals of a single box
+class interval_traits
+{
+    public:
+        using number_type   = ival;
+        using arith         = interval_arith;
+
+    private:
+        const interval_provider&    m_ip;
+
+    public:
+        interval_traits(const interval_provider& ip)
+            :m_ip(ip)
+        {};
+
+        ival make_scalar(const value& v)
+        {
+            return arith::make(v.get_value());
+        };
+
+        ival make_symbol(const ast::symbol_rep* h)
+        {
+            return arith::make(m_ip.get_interval(symbol(h)));
+        };
+
+        ival add(const ival& a, const ival& b)          { return arith::add(a, b); };
+        ival scale(const value& c, const ival& a)       { return arith::scale(c.get_value(), a); };
+        ival mult(const ival& a, const ival& b)         { return arith::mult(a, b); };
+        ival power_int(const ival& a, int p)            { return arith::power_int(a, p); };
+        ival power_real(const ival& a, const value& p)  { return arith::power_real(a, p.get_value()); };
+        ival exp(const ival& a)                         { return arith::exp(a); };
+        ival log(const ival& a)                         { return arith::log(a); };
+
+        ival make_function(const ast::function_rep* h, const ival* args, size_t n);
+};
+
+ival interval_traits::make_function(const ast::function_rep* h, const ival* args, size_t n)
+{
+    builtin_code code   = builtin_table::get().get_code(h->name(), n);
+
+    if (code != builtin_code::none)
+        return arith::builtin(code, args);
+
+    std::vector<interval> arg_vec(n);
+
+    for (size_t i = 0; i < n; ++i)
+        arg_vec[i]      = arith::to_interval(args[i]);
+
+    symbol name         = symbol(ast::symbol_ptr::from_this(h->name()));
+    return arith::make(m_ip.eval_function(name, arg_vec.data(), n));
+};
+
+// evaluation of intervals of a block of boxes; numbers are indices of
+// rows storing intervals for all boxes in the block
+class interval_batch_traits
+{
+    public:
+        using number_type   = size_t;
+        using arith         = interval_arith;
+        using box_vec       = std::vector<std::vector<interval>>;
+
+    private:
+        static const size_t no_slot = size_t(-1);
+
+    private:
+        const interval_provider&    m_ip;
+        const box_vec&      m_boxes;
+
+        // positions of symbols in boxes indexed by symbol code
+        std::vector<size_t> m_slots;
+
+        // first box and number of boxes in current block
+        size_t              m_first;
+        size_t              m_size;
+
+        std::vector<ival>   m_rows;
+
+    public:
+        interval_batch_traits(const interval_provider& ip, const std::vector<symbol>& syms,
+                              const box_vec& boxes);
+
+        // set current block
+        void        set_block(size_t first, size_t size);
+
+        // interval of k-th box in the block
+        const ival& get(size_t row, size_t k) const
+        {
+            return m_rows[row * m_size + k];
+        };
+
+        size_t make_scalar(const value& v);
+        size_t make_symbol(const ast::symbol_rep* h);
+        size_t add(size_t a, size_t b);
+        size_t scale(const value& c, size_t a);
+        size_t mult(size_t a, size_t b);
+        size_t power_int(size_t a, int p);
+        size_t power_real(size_t a, const value& p);
+        size_t exp(size_t a);
+        size_t log(size_t a);
+        size_t make_function(const ast::function_rep* h, const size_t* args, size_t n);
+
+    private:
+        size_t      new_row();
+        ival*       row(size_t r)   { return m_rows.data() + r * m_size; };
+};
+
+interval_batch_traits::interval_batch_traits(const interval_provider& ip,
+                            const std::vector<symbol>& syms, const box_vec& boxes)
+    :m_ip(ip), m_boxes(boxes), m_first(0), m_size(0)
+{
+    for (size_t i = 0; i < syms.size(); ++i)
+    {
+        size_t code     = syms[i].get_symbol_code();
+
+        if (code >= m_slots.size())
+            m_slots.resize(code + 1, size_t(no_slot));
+
+        m_slots[code]   = i;
+    };
+};
+
+void interval_batch_traits::set_block(size_t first, size_t size)
+{
+    m_first     = first;
+    m_size      = size;
+
+    m_rows.clear();
+};
+
+inline size_t interval_batch_traits::new_row()
+{
+    size_t r    = m_rows.size() / m_size;
+    m_rows.resize(m_rows.size() + m_size);
+
+    return r;
+};
+
+size_t interval_batch_traits::make_scalar(const value& v)
+{
+    size_t r    = new_row();
+    ival* res   = row(r);
+
+    for (size_t k = 0; k < m_size; ++k)
+        res[k]  = arith::make(v.get_value());
+
+    return r;
+};
+
+size_t interval_batch_traits::make_symbol(const ast::symbol_rep* h)
+{
+    size_t code = h->get_symbol_code();
+    size_t slot = code < m_slots.size() ? m_slots[code] : no_slot;
+
+    size_t r    = new_row();
+    ival* res   = row(r);
+
+    if (slot == no_slot)
+    {
+        ival x  = arith::make(m_ip.get_interval(symbol(h)));
+
+        for (size_t k = 0; k < m_size; ++k)
+            res[k]  = x;
+    }
+    else
+    {
+        for (size_t k = 0; k < m_size; ++k)
+            res[k]  = arith::make(m_boxes[m_first + k][slot]);
+    };
+
+    return r;
+};
+
+size_t interval_batch_traits::add(size_t a, size_t b)
+{
+    size_t r    = new_row();
+    ival* res   = row(r);
+
+    for (size_t k = 0; k < m_size; ++k)
+        res[k]  = arith::add(get(a, k), get(b, k));
+
+    return r;
+};
+
+size_t interval_batch_traits::scale(const value& c, size_t a)
+{
+    size_t r    = new_row();
+    ival* res   = row(r);
+    double cv   = c.get_value();
+
+    for (size_t k = 0; k < m_size; ++k)
+        res[k]  = arith::scale(cv, get(a, k));
+
+    return r;
+};
+
+size_t interval_batch_traits::mult(size_t a, size_t b)
+{
+    size_t r    = new_row();
+    ival* res   = row(r);
+
+    for (size_t k = 0; k < m_size; ++k)
+        res[k]  = arith::mult(get(a, k), get(b, k));
+
+    return r;
+};
+
+size_t interval_batch_traits::power_int(size_t a, int p)
+{
+    size_t r    = new_row();
+    ival* res   = row(r);
+
+    for (size_t k = 0; k < m_size; ++k)
+        res[k]  = arith::power_int(get(a, k), p);
+
+    return r;
+};
+
+size_t interval_batch_traits::power_real(size_t a, const value& p)
+{
+    size_t r    = new_row();
+    ival* res   = row(r);
+    double pv   = p.get_value();
+
+    for (size_t k = 0; k < m_size; ++k)
+        res[k]  = arith::power_real(get(a, k), pv);
+
+    return r;
+};
+
+size_t interval_batch_traits::exp(size_t a)
+{
+    size_t r    = new_row();
+    ival* res   = row(r);
+
+    for (size_t k = 0; k < m_size; ++k)
+        res[k]  = arith::exp(get(a, k));
+
+    return r;
+};
+
+size_t interval_batch_traits::log(size_t a)
+{
+    size_t r    = new_row();
+    ival* res   = row(r);
+
+    for (size_t k = 0; k < m_size; ++k)
+        res[k]  = arith::log(get(a, k));
+
+    return r;
+};
+
+size_t interval_batch_traits::make_function(const ast::function_rep* h, const size_t* args,
+                                            size_t n)
+{
+    builtin_code code   = builtin_table::get().get_code(h->name(), n);
+
+    size_t r            = new_row();
+
+    if (code != builtin_code::none)
+    {
+        ival arg_buff[2];
+
+        for (size_t k = 0; k < m_size; ++k)
+        {
+            for (size_t i = 0; i < n; ++i)
+                arg_buff[i] = get(args[i], k);
+
+            row(r)[k]   = arith::builtin(code, arg_buff);
+        };
+
+        return r;
+    };
+
+    symbol name         = symbol(ast::symbol_ptr::from_this(h->name()));
+    std::vector<interval> arg_vec(n);
+
+    for (size_t k = 0; k < m_size; ++k)
+    {
+        for (size_t i = 0; i < n; ++i)
+            arg_vec[i]  = arith::to_interval(get(args[i], k));
+
+        row(r)[k]       = arith::make(m_ip.eval_function(name, arg_vec.data(), n));
+    };
+
+    return r;
+};
+
+}};
+
+namespace sym_arrow
+{
+
+//-------------------------------------------------------------------
+//                  interval
+//-------------------------------------------------------------------
+interval::interval()
+    :m_lower(value::make_zero()), m_upper(value::make_zero())
+{};
+
+interval::interval(const value& lower, const value& upper)
+    :m_lower(lower), m_upper(upper)
+{};
+
+bool interval::contains(const value& x) const
+{
+    double v    = x.get_value();
+    return m_lower.get_value() <= v && v <= m_upper.get_value();
+};
+
+//-------------------------------------------------------------------
+//                  functions
+//-------------------------------------------------------------------
+interval sym_arrow::eval_interval(const expr& ex, const interval_provider& ip)
+{
+    using traits_type   = details::interval_traits;
+
+    ex.cannonize(ast::cannonize::do_cse_lazy());
+
+    traits_type traits(ip);
+    details::do_num_eval_vis<traits_type> vis(traits);
+
+    details::ival res   = vis.make(ex.get_expr_handle());
+    return details::interval_arith::to_interval(res);
+};
+
+std::vector<interval> sym_arrow::eval_interval(const expr& ex, const std::vector<symbol>& syms,
+                        const std::vector<std::vector<interval>>& boxes,
+                        const interval_provider& ip)
+{
+    using traits_type       = details::interval_batch_traits;
+
+    // number of boxes evaluated in one traversal
+    static const size_t block_size  = 256;
+
+    for (size_t k = 0; k < boxes.size(); ++k)
+    {
+        if (boxes[k].size() != syms.size())
+        {
+            error::error_formatter ef;
+            ef.head() << "invalid size of box " << k;
+
+            ef.new_info();
+            ef.line() << "expecting box of size: " << syms.size();
+
+            ef.new_info();
+            ef.line() << "supplied box has size: " << boxes[k].size();
+
+            throw std::runtime_error(ef.str());
+        };
+    };
+
+    ex.cannonize(ast::cannonize::do_cse_lazy());
+
+    traits_type traits(ip, syms, boxes);
+    std::vector<interval> ret(boxes.size());
+
+    for (size_t first = 0; first < boxes.size(); first += block_size)
+    {
+        size_t size     = std::min(block_size, boxes.size() - first);
+        traits.set_block(first, size);
+
+        details::do_num_eval_vis<traits_type> vis(traits);
+        size_t res      = vis.make(ex.get_expr_handle());
+
+        for (size_t k = 0; k < size; ++k)
+            ret[first + k]  = details::interval_arith::to_interval(traits.get(res, k));
+    };
+
+    return ret;
+};
+
+};
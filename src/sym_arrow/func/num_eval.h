@@ -0,0 +1,250 @@
+/* 
+ *  This file is a part of sym_arrow library.
+ *
+ *  Copyright (c) Pawe Kowal 2017 - 2021
+ *
+ *  This program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program; if not, write to the Free Software
+ *  Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA 02111-1307 USA
+ */
+
+#pragma once
+
+#include "sym_arrow/config.h"
+#include "sym_arrow/nodes/expr.h"
+#include "dag/dag.h"
+#include "sym_arrow/ast/ast.h"
+#include "sym_arrow/ast/mult_rep.inl"
+#include "sym_arrow/utils/pool_hash_map.h"
+#include "sym_arrow/utils/stack_array.h"
+
+namespace sym_arrow { namespace details
+{
+
+// evaluation of an expression in a numeric type defined by Traits;
+// values of distinct subexpressions are memoized, therefore every node
+// is evaluated once; Traits must define:
+//
+//     using number_type  = [numeric type];
+//
+//     number_type  make_scalar(const value& v);
+//     number_type  make_symbol(const ast::symbol_rep* h);
+//     number_type  make_function(const ast::function_rep* h,
+//                      const number_type* args, size_t n);
+//     number_type  add(const number_type& a, const number_type& b);
+//     number_type  scale(const value& c, const number_type& a);
+//     number_type  mult(const number_type& a, const number_type& b);
+//     number_type  power_int(const number_type& a, int p);
+//     number_type  power_real(const number_type& a, const value& p);
+//     number_type  exp(const number_type& a);
+//     number_type  log(const number_type& a);
+//
+// number_type must be a pod type
+template<class Traits>
+class do_num_eval_vis : public sym_dag::dag_visitor<sym_arrow::ast::term_tag,
+                                    do_num_eval_vis<Traits>>
+{
+    public:
+        using number_type   = typename Traits::number_type;
+        using tag_type      = sym_arrow::ast::term_tag;
+
+    private:
+        struct memo_item
+        {
+            number_type     m_value;
+
+            memo_item(const number_type& v)
+                :m_value(v)
+            {};
+
+            template<class Stack>
+            void release(Stack&)
+            {};
+        };
+
+        using hash_map      = utils::pool_hash_map<ast::expr_handle, memo_item,
+                                utils::expr_hash_equal>;
+
+    private:
+        Traits&         m_traits;
+        hash_map        m_hash_map;
+
+        do_num_eval_vis(const do_num_eval_vis&) = delete;
+        do_num_eval_vis& operator=(const do_num_eval_vis&) = delete;
+
+    public:
+        do_num_eval_vis(Traits& traits);
+        ~do_num_eval_vis();
+
+        // evaluate a cannonized expression
+        number_type     make(ast::expr_handle h);
+
+    public:
+        template<class Node>
+        number_type eval(const Node* ast);
+
+        number_type eval(const ast::scalar_rep* h);
+        number_type eval(const ast::symbol_rep* h);
+        number_type eval(const ast::add_build* h);
+        number_type eval(const ast::mult_build* h);
+        number_type eval(const ast::add_rep* h);
+        number_type eval(const ast::mult_rep* h);
+        number_type eval(const ast::function_rep* h);
+
+    private:
+        // evaluate log of h
+        number_type     make_log(ast::expr_handle h);
+};
+
+template<class Traits>
+do_num_eval_vis<Traits>::do_num_eval_vis(Traits& traits)
+    :m_traits(traits)
+{};
+
+template<class Traits>
+do_num_eval_vis<Traits>::~do_num_eval_vis()
+{
+    using context   = ast::expr_base::context_type;
+    auto st         = context::get().get_stack();
+
+    m_hash_map.clear(st.get());
+};
+
+template<class Traits>
+typename do_num_eval_vis<Traits>::number_type
+do_num_eval_vis<Traits>::make(ast::expr_handle h)
+{
+    // scalars and symbols are not memoized
+    if (h->isa<ast::scalar_rep>() == true || h->isa<ast::symbol_rep>() == true)
+        return this->visit(h);
+
+    auto pos        = m_hash_map.find(h);
+
+    if (pos.empty() == false)
+        return pos->get_value().m_value;
+
+    number_type ret = this->visit(h);
+    m_hash_map.insert(h, memo_item(ret));
+
+    return ret;
+};
+
+template<class Traits>
+typename do_num_eval_vis<Traits>::number_type
+do_num_eval_vis<Traits>::eval(const ast::scalar_rep* h)
+{
+    return m_traits.make_scalar(h->get_data());
+};
+
+template<class Traits>
+typename do_num_eval_vis<Traits>::number_type
+do_num_eval_vis<Traits>::eval(const ast::symbol_rep* h)
+{
+    return m_traits.make_symbol(h);
+};
+
+template<class Traits>
+typename do_num_eval_vis<Traits>::number_type
+do_num_eval_vis<Traits>::eval(const ast::add_build* h)
+{
+    (void)h;
+    assertion(0,"we should not be here");
+    throw;
+};
+
+template<class Traits>
+typename do_num_eval_vis<Traits>::number_type
+do_num_eval_vis<Traits>::eval(const ast::mult_build* h)
+{
+    (void)h;
+    assertion(0,"we should not be here");
+    throw;
+};
+
+template<class Traits>
+typename do_num_eval_vis<Traits>::number_type
+do_num_eval_vis<Traits>::eval(const ast::add_rep* h)
+{
+    number_type ret = m_traits.make_scalar(h->V0());
+    size_t size     = h->size();
+
+    for (size_t i = 0; i < size; ++i)
+        ret         = m_traits.add(ret, m_traits.scale(h->V(i), make(h->E(i))));
+
+    if (h->has_log())
+        ret         = m_traits.add(ret, make_log(h->Log()));
+
+    return ret;
+};
+
+template<class Traits>
+typename do_num_eval_vis<Traits>::number_type
+do_num_eval_vis<Traits>::eval(const ast::mult_rep* h)
+{
+    number_type ret = m_traits.make_scalar(value::make_one());
+
+    for (size_t i = 0; i < h->isize(); ++i)
+        ret         = m_traits.mult(ret, m_traits.power_int(make(h->IE(i)), h->IV(i)));
+
+    for (size_t i = 0; i < h->rsize(); ++i)
+        ret         = m_traits.mult(ret, m_traits.power_real(make(h->RE(i)), h->RV(i)));
+
+    if (h->has_exp())
+        ret         = m_traits.mult(ret, m_traits.exp(make(h->Exp())));
+
+    return ret;
+};
+
+template<class Traits>
+typename do_num_eval_vis<Traits>::number_type
+do_num_eval_vis<Traits>::eval(const ast::function_rep* h)
+{
+    size_t size     = h->size();
+
+    stack_array<number_type> buff(size);
+    number_type* args   = buff.get();
+
+    for (size_t i = 0; i < size; ++i)
+        args[i]     = make(h->arg(i));
+
+    return m_traits.make_function(h, args, size);
+};
+
+template<class Traits>
+typename do_num_eval_vis<Traits>::number_type
+do_num_eval_vis<Traits>::make_log(ast::expr_handle h)
+{
+    // the same as in eval: log of a product is the sum of logs of
+    // factors
+    if (h->isa<ast::mult_rep>() == false)
+        return m_traits.log(make(h));
+
+    const ast::mult_rep* mh = h->static_cast_to<ast::mult_rep>();
+    number_type ret         = m_traits.make_scalar(value::make_zero());
+
+    for (size_t i = 0; i < mh->isize(); ++i)
+    {
+        value p             = value::make_value(mh->IV(i));
+        ret                 = m_traits.add(ret, m_traits.scale(p, make_log(mh->IE(i))));
+    };
+
+    for (size_t i = 0; i < mh->rsize(); ++i)
+        ret                 = m_traits.add(ret, m_traits.scale(mh->RV(i), make_log(mh->RE(i))));
+
+    if (mh->has_exp())
+        ret                 = m_traits.add(ret, make(mh->Exp()));
+
+    return ret;
+};
+
+}};
@@ -18,74 +18,26 @@
  *  Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA 02111-1307 USA
  */
 
-#include "sym_arrow/functions/contexts.h"
-#include "sym_arrow/ast/symbol_rep.h"
-#include "sym_arrow/nodes/symbol.inl"
+#include "sym_arrow/config.h"
+#include "sym_arrow/nodes/expr.h"
 #include "sym_arrow/ast/ast.h"
 #include "sym_arrow/functions/expr_functions.h"
-
-#include "antlr/antlr.h"
-#include "grammar/output/lexer_sym_arrow.hpp"
-#include "grammar/output/parser_sym_arrow.hpp"
+#include "expr_parser.h"
 
 namespace sym_arrow
 {
 
 expr sym_arrow::parse(const std::string& v)
 {
-    if (v.size() == 0)
-        return ast::scalar_rep::make_zero();
-
-    region::region reg;
-
-    std::istringstream is(v);
-
-    lexer_sym_arrow lexer(&reg,is);
-
-    antlr::TokenStreamHiddenTokenFilter filter(&reg,lexer);
-
-    filter.hide(lexer_sym_arrow::WHITESPACE);
-    filter.hide(lexer_sym_arrow::NEWLINE);
-    filter.hide(lexer_sym_arrow::COMMENT);
-    filter.hide(lexer_sym_arrow::SL_DCOMMENT);
-    filter.hide(lexer_sym_arrow::SL_COMMENT);
-    filter.hide(lexer_sym_arrow::ML_COMMENT);
-    filter.hide(lexer_sym_arrow::NOT_NEWLINE);    
-    filter.hide(lexer_sym_arrow::CONTINUATION);    
-
-    parser_sym_arrow parser(&reg,filter);
+    return parse(v.data(), v.size());
+};
 
-    parser.init(&std::cout);
+expr sym_arrow::parse(const char* str, size_t size)
+{
+    if (size == 0)
+        return ast::scalar_rep::make_zero();
 
-    try
-    {
-        expr ex = parser.stringUnit();
-        return ex;
-    }
-    catch (antlr::CharStreamIOException& e)
-    {
-        throw std::runtime_error(e.getMessage());
-    }
-    catch (antlr::RecognitionException& e)
-    {
-        throw std::runtime_error(e.getMessage());
-    }
-    catch (antlr::TokenStreamRecognitionException& e)
-    {
-        throw std::runtime_error(e.getMessage());
-    }
-    catch (antlr::TokenStreamIOException& e)
-    {
-        throw std::runtime_error(e.getMessage());
-    }
-    catch (antlr::TokenStreamRetryException& e)
-    {
-        throw std::runtime_error(e.getMessage());
-    }
-    catch(antlr::ANTLRException& e)
-    {
-        throw std::runtime_error(e.getMessage());
-    }
+    return details::expr_parser(str, size).make();
 };
 
-};
\ No newline at end of file
+};
@@ -0,0 +1,327 @@
+/* 
+ *  This file is a part of sym_arrow library.
+ *
+ *  Copyright (c) Pawe Kowal 2017 - 2021
+ *
+ *  This program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program; if not, write to the Free Software
+ *  Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA 02111-1307 USA
+ */
+
+#include "sym_arrow/config.h"
+#include "sym_arrow/nodes/expr.h"
+#include "sym_arrow/functions/expr_functions.h"
+#include "sym_arrow/error/error_formatter.h"
+#include "expr_parser.h"
+
+#include <istream>
+#include <iterator>
+
+#ifdef _WIN32
+    #include <windows.h>
+#else
+    #include <sys/mman.h>
+    #include <sys/stat.h>
+    #include <fcntl.h>
+    #include <unistd.h>
+#endif
+
+namespace sym_arrow { namespace details
+{
+
+namespace sd = sym_arrow :: details;
+
+// read only view of a file mapped into memory
+class mapped_file
+{
+    private:
+        const char*     m_data;
+        size_t          m_size;
+
+        #ifdef _WIN32
+            HANDLE      m_file;
+            HANDLE      m_map;
+        #else
+            int         m_file;
+        #endif
+
+    public:
+        explicit mapped_file(const std::string& file_name);
+        ~mapped_file();
+
+        mapped_file(const mapped_file&) = delete;
+        mapped_file& operator=(const mapped_file&) = delete;
+
+        const char*     data() const    { return m_data; };
+        size_t          size() const    { return m_size; };
+
+    private:
+        void            close();
+
+        [[noreturn]]
+        static void     error_open(const std::string& file_name);
+};
+
+#ifdef _WIN32
+
+mapped_file::mapped_file(const std::string& file_name)
+    :m_data(nullptr), m_size(0), m_file(INVALID_HANDLE_VALUE), m_map(NULL)
+{
+    m_file  = CreateFileA(file_name.c_str(), GENERIC_READ, FILE_SHARE_READ,
+                NULL, OPEN_EXISTING, FILE_FLAG_SEQUENTIAL_SCAN, NULL);
+
+    if (m_file == INVALID_HANDLE_VALUE)
+        error_open(file_name);
+
+    LARGE_INTEGER size;
+
+    if (GetFileSizeEx(m_file, &size) == FALSE)
+    {
+        close();
+        error_open(file_name);
+    };
+
+    m_size  = (size_t)size.QuadPart;
+
+    // empty file cannot be mapped
+    if (m_size == 0)
+        return;
+
+    m_map   = CreateFileMappingA(m_file, NULL, PAGE_READONLY, 0, 0, NULL);
+
+    if (m_map == NULL)
+    {
+        close();
+        error_open(file_name);
+    };
+
+    m_data  = (const char*)MapViewOfFile(m_map, FILE_MAP_READ, 0, 0, 0);
+
+    if (m_data == nullptr)
+    {
+        close();
+        error_open(file_name);
+    };
+};
+
+void mapped_file::close()
+{
+    if (m_data != nullptr)
+        UnmapViewOfFile(m_data);
+
+    if (m_map != NULL)
+        CloseHandle(m_map);
+
+    if (m_file != INVALID_HANDLE_VALUE)
+        CloseHandle(m_file);
+
+    m_data  = nullptr;
+    m_map   = NULL;
+    m_file  = INVALID_HANDLE_VALUE;
+};
+
+#else
+
+mapped_file::mapped_file(const std::string& file_name)
+    :m_data(nullptr), m_size(0), m_file(-1)
+{
+    m_file  = ::open(file_name.c_str(), O_RDONLY);
+
+    if (m_file == -1)
+        error_open(file_name);
+
+    struct stat st;
+
+    if (::fstat(m_file, &st) != 0)
+    {
+        close();
+        error_open(file_name);
+    };
+
+    m_size  = (size_t)st.st_size;
+
+    // empty file cannot be mapped
+    if (m_size == 0)
+        return;
+
+    void* ptr   = ::mmap(nullptr, m_size, PROT_READ, MAP_PRIVATE, m_file, 0);
+
+    if (ptr == MAP_FAILED)
+    {
+        close();
+        error_open(file_name);
+    };
+
+    m_data  = (const char*)ptr;
+};
+
+void mapped_file::close()
+{
+    if (m_data != nullptr)
+        ::munmap((void*)m_data, m_size);
+
+    if (m_file != -1)
+        ::close(m_file);
+
+    m_data  = nullptr;
+    m_file  = -1;
+};
+
+#endif
+
+mapped_file::~mapped_file()
+{
+    close();
+};
+
+void mapped_file::error_open(const std::string& file_name)
+{
+    error::error_formatter ef;
+    ef.head() << "unable to open file: " << file_name;
+
+    throw std::runtime_error(ef.str());
+};
+
+// split a text into statements and parse them; statements are separated
+// by semicolons or new lines outside of brackets
+class statement_parser
+{
+    private:
+        const char*                 m_str;
+        size_t                      m_size;
+        std::vector<named_expr>&    m_out;
+
+        // tokens of the current statement; storage is reused
+        std::vector<token>          m_tokens;
+
+    public:
+        statement_parser(const char* str, size_t size, std::vector<named_expr>& out)
+            :m_str(str), m_size(size), m_out(out)
+        {};
+
+        void    make();
+
+    private:
+        void    parse_statement();
+};
+
+void statement_parser::make()
+{
+    // statements are found by the lexer, which knows about comments,
+    // strings and continuations; tokens of a statement are collected
+    // and parsed immediately, the text is lexed only once
+    expr_lexer lexer(m_str, m_size);
+
+    long depth          = 0;
+
+    for (;;)
+    {
+        token t = lexer.next();
+
+        bool finish     = (t.m_type == token_type::eof)
+                        || (t.m_type == token_type::semi && depth <= 0)
+                        || (t.m_newline == true && depth <= 0);
+
+        if (finish == true && m_tokens.empty() == false)
+        {
+            // the statement ends where the next token starts
+            token eof       = t;
+            eof.m_type      = token_type::eof;
+            eof.m_length    = 0;
+
+            m_tokens.push_back(eof);
+            parse_statement();
+
+            m_tokens.clear();
+            depth           = 0;
+        };
+
+        if (t.m_type == token_type::eof)
+            break;
+
+        if (t.m_type == token_type::semi && depth <= 0)
+            continue;
+
+        m_tokens.push_back(t);
+
+        switch (t.m_type)
+        {
+            case token_type::lparen:
+            case token_type::lbrack:
+            case token_type::lcurl:
+                ++depth;
+                break;
+            case token_type::rparen:
+            case token_type::rbrack:
+            case token_type::rcurl:
+                --depth;
+                break;
+            default:
+                break;
+        };
+    };
+};
+
+void statement_parser::parse_statement()
+{
+    // tokens are terminated by eof token, therefore there are at least
+    // two tokens
+    const token& first  = m_tokens[0];
+    const token& second = m_tokens[1];
+
+    bool named  = first.m_type == token_type::identifier
+                && second.m_type == token_type::assign;
+
+    if (named == false)
+    {
+        expr ex = expr_parser(m_tokens.data()).make_all();
+
+        m_out.push_back(named_expr(std::string(), std::move(ex)));
+        return;
+    };
+
+    expr ex = expr_parser(m_tokens.data() + 2).make_all();
+
+    m_out.push_back(named_expr(std::string(first.m_begin, first.m_length),
+                               std::move(ex)));
+};
+
+}};
+
+namespace sym_arrow
+{
+
+std::vector<named_expr> sym_arrow::parse_file(const std::string& file_name)
+{
+    // parsing builds new nodes in the dag, which is not thread safe,
+    // therefore statements are parsed sequentially; input is not copied
+    details::mapped_file file(file_name);
+
+    std::vector<named_expr> ret;
+    details::statement_parser(file.data(), file.size(), ret).make();
+
+    return ret;
+};
+
+std::vector<named_expr> sym_arrow::parse_stream(std::istream& is)
+{
+    std::string str((std::istreambuf_iterator<char>(is)),
+                    std::istreambuf_iterator<char>());
+
+    std::vector<named_expr> ret;
+    details::statement_parser(str.data(), str.size(), ret).make();
+
+    return ret;
+};
+
+};
@@ -0,0 +1,666 @@
+/* 
+ *  This file is a part of sym_arrow library.
+ *
+ *  Copyright (c) Pawe Kowal 2017 - 2021
+ *
+ *  This program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program; if not, write to the Free Software
+ *  Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA 02111-1307 USA
+ */
+
+#include "sym_arrow/functions/reverse_diff.h"
+#include "sym_arrow/functions/expr_functions.h"
+#include "sym_arrow/nodes/expr.h"
+#include "dag/dag.h"
+#include "sym_arrow/ast/ast.h"
+#include "sym_arrow/ast/mult_rep.inl"
+#include "sym_arrow/ast/cannonization/cannonize.h"
+#include "sym_arrow/func/builtin_table.h"
+#include "sym_arrow/error/error_formatter.h"
+#include "sym_arrow/utils/pool_hash_map.h"
+#include "sym_arrow/utils/stack_array.h"
+
+#include <cmath>
+
+namespace sym_arrow { namespace details
+{
+
+namespace sd = sym_arrow :: details;
+
+// data provider used when only symbols with given values are allowed
+class no_data_provider : public data_provider
+{
+    public:
+        virtual value   get_value(const symbol& sh) const override;
+        virtual value   eval_function(const symbol& name, const value* subexpr,
+                            size_t n_size) const override;
+};
+
+value no_data_provider::get_value(const symbol& sh) const
+{
+    error::error_formatter ef;
+    ef.head() << "value of symbol not set";
+
+    ef.new_info();
+    ef.line() << "symbol: ";
+    disp(ef.line(), sh, false);
+
+    throw std::runtime_error(ef.str());
+};
+
+value no_data_provider::eval_function(const symbol& name, const value*, size_t) const
+{
+    error::error_formatter ef;
+    ef.head() << "unable to evaluate function without data provider";
+
+    ef.new_info();
+    ef.line() << "function: ";
+    disp(ef.line(), name, false);
+
+    throw std::runtime_error(ef.str());
+};
+
+// values of all nodes of an expression computed in a forward sweep;
+// adjoints are accumulated in a reverse sweep
+class gradient_tape : public sym_dag::dag_visitor<sym_arrow::ast::term_tag, gradient_tape>
+{
+    private:
+        struct index_item
+        {
+            size_t          m_index;
+
+            index_item(size_t index)
+                :m_index(index)
+            {};
+
+            template<class Stack>
+            void release(Stack&)
+            {};
+        };
+
+        struct tape_node
+        {
+            ast::expr_handle    m_expr;
+            double              m_value;
+            double              m_adj;
+
+            // position of indices of children in m_children
+            size_t              m_first_child;
+        };
+
+        using hash_map      = utils::pool_hash_map<ast::expr_handle, index_item,
+                                utils::expr_hash_equal>;
+        using node_vec      = std::vector<tape_node>;
+        using index_vec     = std::vector<size_t>;
+        using slot_vec      = std::vector<size_t>;
+
+        static const size_t no_slot = size_t(-1);
+
+        // data provider used to evaluate differentiation rules; arguments
+        // of a rule take values of arguments of the differentiated function,
+        // symbols with given values take these values, other symbols and
+        // functions are evaluated by the data provider of the tape
+        class rule_data_provider : public data_provider
+        {
+            private:
+                const gradient_tape&    m_tape;
+                const symbol*           m_args;
+                const double*           m_arg_vals;
+                size_t                  m_size;
+
+            public:
+                rule_data_provider(const gradient_tape& tape, const symbol* args,
+                                   const double* arg_vals, size_t size)
+                    :m_tape(tape), m_args(args), m_arg_vals(arg_vals), m_size(size)
+                {};
+
+                virtual value   get_value(const symbol& sh) const override;
+                virtual value   eval_function(const symbol& name, const value* subexpr,
+                                    size_t n_size) const override;
+        };
+
+    private:
+        // indices of nodes on the tape
+        hash_map            m_index;
+        node_vec            m_nodes;
+        index_vec           m_children;
+
+        // positions of symbols in the array of values indexed by symbol code
+        slot_vec            m_slots;
+        const value*        m_vals;
+        value*              m_grad;
+
+        const data_provider&    m_dp;
+        diff_context        m_dc;
+
+        gradient_tape(const gradient_tape&) = delete;
+        gradient_tape& operator=(const gradient_tape&) = delete;
+
+    public:
+        using tag_type  = sym_arrow::ast::term_tag;
+
+    public:
+        gradient_tape(const std::vector<symbol>& syms, const value* vals, value* grad,
+                      const data_provider& dp, const diff_context& dc);
+        ~gradient_tape();
+
+        // forward sweep; return position of h on the tape
+        size_t          make(ast::expr_handle h);
+
+        // value of a node on the tape
+        double          get_value(size_t pos) const;
+
+        // reverse sweep; accumulate derivatives of the node at position
+        // pos in the gradient
+        void            make_gradient(size_t pos);
+
+    public:
+        template<class Node>
+        size_t eval(const Node* ast);
+
+        size_t eval(const ast::scalar_rep* h);
+        size_t eval(const ast::symbol_rep* h);
+        size_t eval(const ast::add_build* h);
+        size_t eval(const ast::mult_build* h);
+        size_t eval(const ast::add_rep* h);
+        size_t eval(const ast::mult_rep* h);
+        size_t eval(const ast::function_rep* h);
+
+    private:
+        size_t          push(ast::expr_handle h, double val);
+        size_t          find(ast::expr_handle h);
+
+        // value of a symbol given explicitly or returned by the data provider
+        double          get_symbol_value(const symbol& sym) const;
+
+        // log of h; the same as in eval: log of a product is the sum of
+        // logs of factors
+        double          make_log(ast::expr_handle h);
+
+        void            adjoint_add(const ast::add_rep* h, const tape_node& node);
+        void            adjoint_mult(const ast::mult_rep* h, const tape_node& node);
+        void            adjoint_function(const ast::function_rep* h, const tape_node& node);
+        void            adjoint_log(ast::expr_handle h, double adj);
+};
+
+gradient_tape::gradient_tape(const std::vector<symbol>& syms, const value* vals,
+                value* grad, const data_provider& dp, const diff_context& dc)
+    :m_vals(vals), m_grad(grad), m_dp(dp), m_dc(dc)
+{
+    for (size_t i = 0; i < syms.size(); ++i)
+    {
+        size_t code     = syms[i].get_symbol_code();
+
+        if (code >= m_slots.size())
+            m_slots.resize(code + 1, no_slot);
+
+        m_slots[code]   = i;
+    };
+};
+
+gradient_tape::~gradient_tape()
+{
+    using context   = ast::expr_base::context_type;
+    auto st         = context::get().get_stack();
+
+    m_index.clear(st.get());
+};
+
+inline double gradient_tape::get_value(size_t pos) const
+{
+    return m_nodes[pos].m_value;
+};
+
+inline size_t gradient_tape::push(ast::expr_handle h, double val)
+{
+    m_nodes.push_back(tape_node{h, val, 0.0, m_children.size()});
+    return m_nodes.size() - 1;
+};
+
+size_t gradient_tape::make(ast::expr_handle h)
+{
+    // scalars are not memoized
+    if (h->isa<ast::scalar_rep>() == true)
+        return visit(h);
+
+    auto pos        = m_index.find(h);
+
+    if (pos.empty() == false)
+        return pos->get_value().m_index;
+
+    size_t ret      = visit(h);
+    m_index.insert(h, index_item(ret));
+
+    return ret;
+};
+
+size_t gradient_tape::find(ast::expr_handle h)
+{
+    auto pos        = m_index.find(h);
+
+    assertion(pos.empty() == false, "node not on the tape");
+    return pos->get_value().m_index;
+};
+
+size_t gradient_tape::eval(const ast::scalar_rep* h)
+{
+    return push(h, h->get_data().get_value());
+};
+
+double gradient_tape::get_symbol_value(const symbol& sym) const
+{
+    size_t code     = sym.get_symbol_code();
+    size_t slot     = code < m_slots.size() ? m_slots[code] : no_slot;
+
+    if (slot != no_slot)
+        return m_vals[slot].get_value();
+    else
+        return m_dp.get_value(sym).get_value();
+};
+
+value gradient_tape::rule_data_provider::get_value(const symbol& sh) const
+{
+    for (size_t i = 0; i < m_size; ++i)
+    {
+        if (m_args[i] == sh)
+            return value::make_value(m_arg_vals[i]);
+    };
+
+    return value::make_value(m_tape.get_symbol_value(sh));
+};
+
+value gradient_tape::rule_data_provider::eval_function(const symbol& name,
+                                const value* subexpr, size_t n_size) const
+{
+    return m_tape.m_dp.eval_function(name, subexpr, n_size);
+};
+
+size_t gradient_tape::eval(const ast::symbol_rep* h)
+{
+    return push(h, get_symbol_value(symbol(h)));
+};
+
+size_t gradient_tape::eval(const ast::add_build* h)
+{
+    (void)h;
+    assertion(0,"we should not be here");
+    throw;
+};
+
+size_t gradient_tape::eval(const ast::mult_build* h)
+{
+    (void)h;
+    assertion(0,"we should not be here");
+    throw;
+};
+
+size_t gradient_tape::eval(const ast::add_rep* h)
+{
+    size_t size     = h->size();
+
+    sd::stack_array<size_t> buff(size);
+    size_t* ind     = buff.get();
+
+    double val      = h->V0().get_value();
+
+    for (size_t i = 0; i < size; ++i)
+    {
+        ind[i]      = make(h->E(i));
+        val         = val + h->V(i).get_value() * get_value(ind[i]);
+    };
+
+    if (h->has_log())
+        val         = val + make_log(h->Log());
+
+    size_t ret      = push(h, val);
+    m_children.insert(m_children.end(), ind, ind + size);
+
+    return ret;
+};
+
+size_t gradient_tape::eval(const ast::mult_rep* h)
+{
+    size_t isize    = h->isize();
+    size_t rsize    = h->rsize();
+    size_t size     = isize + rsize + (h->has_exp() ? 1 : 0);
+
+    sd::stack_array<size_t> buff(size);
+    size_t* ind     = buff.get();
+
+    value val       = value::make_one();
+
+    for (size_t i = 0; i < isize; ++i)
+    {
+        ind[i]      = make(h->IE(i));
+        val         = val * power_int(value(get_value(ind[i])), h->IV(i));
+    };
+
+    for (size_t i = 0; i < rsize; ++i)
+    {
+        ind[isize + i]  = make(h->RE(i));
+        val         = val * power_real(value(get_value(ind[isize + i])), h->RV(i));
+    };
+
+    if (h->has_exp())
+    {
+        ind[size - 1]   = make(h->Exp());
+        val         = val * exp(value(get_value(ind[size - 1])));
+    };
+
+    size_t ret      = push(h, val.get_value());
+    m_children.insert(m_children.end(), ind, ind + size);
+
+    return ret;
+};
+
+size_t gradient_tape::eval(const ast::function_rep* h)
+{
+    size_t size     = h->size();
+
+    sd::stack_array<size_t> buff(size);
+    size_t* ind     = buff.get();
+
+    for (size_t i = 0; i < size; ++i)
+        ind[i]      = make(h->arg(i));
+
+    builtin_code code   = builtin_table::get().get_code(h->name(), size);
+    double val;
+
+    if (code != builtin_code::none)
+    {
+        double args[2];
+
+        for (size_t i = 0; i < size; ++i)
+            args[i] = get_value(ind[i]);
+
+        val         = builtin_table::eval(code, args);
+    }
+    else
+    {
+        using value_pod     = sd::pod_type<value>;
+        int size_counter    = 0;
+        value_pod::destructor_type d(&size_counter);
+
+        sd::stack_array<value_pod> args_buff(size, &d);
+        value* args         = args_buff.get_cast<value>();
+
+        for (size_t i = 0; i < size; ++i)
+        {
+            new(args + size_counter) value(get_value(ind[i]));
+            ++size_counter;
+        };
+
+        symbol name = symbol(ast::symbol_ptr::from_this(h->name()));
+        val         = m_dp.eval_function(name, args, size).get_value();
+    };
+
+    size_t ret      = push(h, val);
+    m_children.insert(m_children.end(), ind, ind + size);
+
+    return ret;
+};
+
+double gradient_tape::make_log(ast::expr_handle h)
+{
+    if (h->isa<ast::mult_rep>() == false)
+        return log(value(get_value(make(h)))).get_value();
+
+    const ast::mult_rep* mh = h->static_cast_to<ast::mult_rep>();
+    double ret              = 0.0;
+
+    for (size_t i = 0; i < mh->isize(); ++i)
+        ret                 = ret + mh->IV(i) * make_log(mh->IE(i));
+
+    for (size_t i = 0; i < mh->rsize(); ++i)
+        ret                 = ret + mh->RV(i).get_value() * make_log(mh->RE(i));
+
+    if (mh->has_exp())
+        ret                 = ret + get_value(make(mh->Exp()));
+
+    return ret;
+};
+
+void gradient_tape::make_gradient(size_t root)
+{
+    m_nodes[root].m_adj     = 1.0;
+
+    // children are stored on the tape before parents
+    for (size_t i = root + 1; i > 0; --i)
+    {
+        const tape_node& node   = m_nodes[i - 1];
+
+        if (node.m_adj == 0.0)
+            continue;
+
+        ast::expr_handle h      = node.m_expr;
+
+        if (h->isa<ast::symbol_rep>() == true)
+        {
+            size_t code = h->static_cast_to<ast::symbol_rep>()->get_symbol_code();
+            size_t slot = code < m_slots.size() ? m_slots[code] : no_slot;
+
+            if (slot != no_slot)
+                m_grad[slot]    = m_grad[slot] + value(node.m_adj);
+        }
+        else if (h->isa<ast::add_rep>() == true)
+        {
+            adjoint_add(h->static_cast_to<ast::add_rep>(), node);
+        }
+        else if (h->isa<ast::mult_rep>() == true)
+        {
+            adjoint_mult(h->static_cast_to<ast::mult_rep>(), node);
+        }
+        else if (h->isa<ast::function_rep>() == true)
+        {
+            adjoint_function(h->static_cast_to<ast::function_rep>(), node);
+        };
+    };
+};
+
+void gradient_tape::adjoint_add(const ast::add_rep* h, const tape_node& node)
+{
+    const size_t* ind   = m_children.data() + node.m_first_child;
+    double adj          = node.m_adj;
+
+    for (size_t i = 0; i < h->size(); ++i)
+        m_nodes[ind[i]].m_adj   += adj * h->V(i).get_value();
+
+    if (h->has_log())
+        adjoint_log(h->Log(), adj);
+};
+
+void gradient_tape::adjoint_log(ast::expr_handle h, double adj)
+{
+    if (h->isa<ast::scalar_rep>() == true)
+        return;
+
+    if (h->isa<ast::mult_rep>() == false)
+    {
+        // d/dx log|x| = 1/x
+        tape_node& arg  = m_nodes[find(h)];
+        arg.m_adj       += adj / arg.m_value;
+        return;
+    };
+
+    const ast::mult_rep* mh = h->static_cast_to<ast::mult_rep>();
+
+    for (size_t i = 0; i < mh->isize(); ++i)
+        adjoint_log(mh->IE(i), adj * mh->IV(i));
+
+    for (size_t i = 0; i < mh->rsize(); ++i)
+        adjoint_log(mh->RE(i), adj * mh->RV(i).get_value());
+
+    if (mh->has_exp() && mh->Exp()->isa<ast::scalar_rep>() == false)
+        m_nodes[find(mh->Exp())].m_adj  += adj;
+};
+
+void gradient_tape::adjoint_mult(const ast::mult_rep* h, const tape_node& node)
+{
+    size_t isize        = h->isize();
+    size_t rsize        = h->rsize();
+    size_t size         = isize + rsize + (h->has_exp() ? 1 : 0);
+
+    const size_t* ind   = m_children.data() + node.m_first_child;
+
+    // values of factors and products of factors before and after given
+    // factor; division by the value of a factor is avoided
+    sd::stack_array<double> buff(3 * size + 1);
+    double* fact        = buff.get();
+    double* prod_after  = fact + size;
+    double* dif         = prod_after + size + 1;
+
+    for (size_t i = 0; i < size; ++i)
+    {
+        double x        = get_value(ind[i]);
+
+        if (i < isize)
+        {
+            int p       = h->IV(i);
+            fact[i]     = power_int(value(x), p).get_value();
+            dif[i]      = p * power_int(value(x), p - 1).get_value();
+        }
+        else if (i < isize + rsize)
+        {
+            // real power |x|^p
+            const value& p  = h->RV(i - isize);
+            double sign     = x > 0.0 ? 1.0 : (x < 0.0 ? -1.0 : 0.0);
+
+            fact[i]     = power_real(value(x), p).get_value();
+            dif[i]      = p.get_value() * std::pow(std::abs(x), p.get_value() - 1.0) * sign;
+        }
+        else
+        {
+            fact[i]     = exp(value(x)).get_value();
+            dif[i]      = fact[i];
+        };
+    };
+
+    prod_after[size]    = 1.0;
+
+    for (size_t i = size; i > 0; --i)
+        prod_after[i - 1]   = prod_after[i] * fact[i - 1];
+
+    double adj          = node.m_adj;
+    double prod_before  = 1.0;
+
+    for (size_t i = 0; i < size; ++i)
+    {
+        double d        = prod_before * prod_after[i + 1] * dif[i];
+        m_nodes[ind[i]].m_adj   += adj * d;
+        prod_before     = prod_before * fact[i];
+    };
+};
+
+void gradient_tape::adjoint_function(const ast::function_rep* h, const tape_node& node)
+{
+    size_t size         = h->size();
+    const size_t* ind   = m_children.data() + node.m_first_child;
+    double adj          = node.m_adj;
+
+    builtin_code code   = builtin_table::get().get_code(h->name(), size);
+
+    if (code != builtin_code::none)
+    {
+        double args[2];
+        double grad[2];
+
+        for (size_t i = 0; i < size; ++i)
+            args[i]     = get_value(ind[i]);
+
+        builtin_table::eval_diff(code, args, grad, nullptr);
+
+        for (size_t i = 0; i < size; ++i)
+            m_nodes[ind[i]].m_adj   += adj * grad[i];
+
+        return;
+    };
+
+    // partial derivatives are defined by diff context; rules are evaluated
+    // directly with arguments of a rule bound to values of arguments stored
+    // on the tape, therefore no expression is created
+    sd::stack_array<double> buff(size);
+    double* args        = buff.get();
+
+    for (size_t i = 0; i < size; ++i)
+        args[i]         = get_value(ind[i]);
+
+    symbol name         = symbol(ast::symbol_ptr::from_this(h->name()));
+    std::vector<symbol> rule_args;
+
+    for (size_t i = 0; i < size; ++i)
+    {
+        expr dif        = m_dc.get_diff_rule(name, i, size, rule_args);
+
+        if (dif.is_null() == true)
+        {
+            error::error_formatter ef;
+            ef.head() << "differentiation rule not defined";
+
+            ef.new_info();
+            ef.line() << "unable to find differentiation rule d/dx" << i + 1 << " ";
+            disp(ef.line(), name, false);
+            ef.line() << " with " << size << " arguments";
+
+            throw std::runtime_error(ef.str());
+        };
+
+        rule_data_provider dp(*this, rule_args.data(), args, size);
+
+        double d        = sym_arrow::eval(dif, dp).get_value();
+        m_nodes[ind[i]].m_adj   += adj * d;
+    };
+};
+
+}};
+
+namespace sym_arrow
+{
+
+value sym_arrow::eval_gradient(const expr& ex, const std::vector<symbol>& syms,
+                    const std::vector<value>& vals, std::vector<value>& grad)
+{
+    details::no_data_provider dp;
+    return eval_gradient(ex, syms, vals, grad, dp, global_diff_context());
+};
+
+value sym_arrow::eval_gradient(const expr& ex, const std::vector<symbol>& syms,
+                    const std::vector<value>& vals, std::vector<value>& grad,
+                    const data_provider& dp, const diff_context& dc)
+{
+    if (syms.size() != vals.size())
+    {
+        error::error_formatter ef;
+        ef.head() << "invalid size of values";
+
+        ef.new_info();
+        ef.line() << "expecting values of size: " << syms.size();
+
+        ef.new_info();
+        ef.line() << "supplied values have size: " << vals.size();
+
+        throw std::runtime_error(ef.str());
+    };
+
+    ex.cannonize(ast::cannonize::do_cse_lazy());
+
+    grad.assign(syms.size(), value::make_zero());
+
+    details::gradient_tape tape(syms, vals.data(), grad.data(), dp, dc);
+
+    size_t root     = tape.make(ex.get_expr_handle());
+    tape.make_gradient(root);
+
+    return value::make_value(tape.get_value(root));
+};
+
+};
@@ -0,0 +1,532 @@
+/* 
+ *  This file is a part of sym_arrow library.
+ *
+ *  Copyright (c) Pawe Kowal 2017 - 2021
+ *
+ *  This program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program; if not, write to the Free Software
+ *  Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA 02111-1307 USA
+ */
+
+#include "sl_program.h"
+#include "builtin_table.h"
+#include "sym_arrow/ast/ast.h"
+#include "sym_arrow/ast/mult_rep.inl"
+#include "sym_arrow/utils/stack_array.h"
+#include "sym_arrow/error/error_formatter.h"
+
+namespace sym_arrow { namespace details
+{
+
+namespace sd = sym_arrow :: details;
+
+//--------------------------------------------------------------------
+//                  sl_program_builder
+//--------------------------------------------------------------------
+class sl_program_builder : public sym_dag::dag_visitor<sym_arrow::ast::term_tag,
+                                    sl_program_builder>
+{
+    public:
+        using tag_type      = sym_arrow::ast::term_tag;
+
+    private:
+        using handle_map    = std::map<ast::expr_handle, size_t>;
+        using code_map      = std::map<size_t, size_t>;
+        using power_map     = std::map<std::pair<size_t, int>, size_t>;
+
+    private:
+        sl_program&         m_prog;
+        handle_map          m_values;
+        handle_map          m_logs;
+        handle_map          m_exps;
+        power_map           m_powers;
+        code_map            m_input_map;
+        code_map            m_func_map;
+
+    public:
+        sl_program_builder(sl_program& prog);
+
+        // register storing value of the expression h
+        size_t              make_value(ast::expr_handle h);
+
+    public:
+        template<class Node>
+        size_t eval(const Node* ast);
+
+        size_t eval(const ast::scalar_rep* h);
+        size_t eval(const ast::symbol_rep* h);
+        size_t eval(const ast::add_build* h);
+        size_t eval(const ast::mult_build* h);
+        size_t eval(const ast::add_rep* h);
+        size_t eval(const ast::mult_rep* h);
+        size_t eval(const ast::function_rep* h);
+
+    private:
+        size_t              make_log(ast::expr_handle h);
+        size_t              make_exp(ast::expr_handle h);
+        size_t              make_power_int(size_t r, int pow);
+        size_t              make_power_pos(size_t r, int pow);
+        size_t              make_scaled(size_t r, const value& v);
+        size_t              push(sl_code code, size_t arg1, size_t arg2 = 0,
+                                const value& scal = value::make_zero());
+};
+
+sl_program_builder::sl_program_builder(sl_program& prog)
+    :m_prog(prog)
+{
+    size_t n_inputs = prog.m_inputs.size();
+
+    for (size_t i = 0; i < n_inputs; ++i)
+    {
+        size_t code = prog.m_inputs[i].get_ptr()->get_symbol_code();
+        m_input_map.insert(code_map::value_type(code, i));
+    };
+};
+
+size_t sl_program_builder::push(sl_code code, size_t arg1, size_t arg2, const value& scal)
+{
+    return m_prog.push(code, arg1, arg2, scal);
+};
+
+size_t sl_program_builder::make_value(ast::expr_handle h)
+{
+    auto pos    = m_values.find(h);
+
+    if (pos != m_values.end())
+        return pos->second;
+
+    size_t r    = visit(h);
+    m_values.insert(handle_map::value_type(h, r));
+
+    return r;
+};
+
+size_t sl_program_builder::make_exp(ast::expr_handle h)
+{
+    auto pos    = m_exps.find(h);
+
+    if (pos != m_exps.end())
+        return pos->second;
+
+    size_t r    = push(sl_code::exp, make_value(h));
+    m_exps.insert(handle_map::value_type(h, r));
+
+    return r;
+};
+
+// log|h| evaluated in the same way as in eval function
+size_t sl_program_builder::make_log(ast::expr_handle h)
+{
+    auto pos    = m_logs.find(h);
+
+    if (pos != m_logs.end())
+        return pos->second;
+
+    size_t r    = 0;
+
+    if (h->isa<ast::scalar_rep>() == true)
+    {
+        value v = log(h->static_cast_to<ast::scalar_rep>()->get_data());
+        r       = push(sl_code::constant, 0, 0, v);
+    }
+    else if (h->isa<ast::mult_rep>() == true)
+    {
+        const ast::mult_rep* mh = h->static_cast_to<ast::mult_rep>();
+
+        bool init       = false;
+
+        for(size_t i = 0; i < mh->isize(); ++i)
+        {
+            size_t tmp  = make_scaled(make_log(mh->IE(i)), value(mh->IV(i)));
+            r           = (init == false) ? tmp : push(sl_code::add, r, tmp);
+            init        = true;
+        };
+
+        for(size_t i = 0; i < mh->rsize(); ++i)
+        {
+            size_t tmp  = make_scaled(make_log(mh->RE(i)), mh->RV(i));
+            r           = (init == false) ? tmp : push(sl_code::add, r, tmp);
+            init        = true;
+        };
+
+        if (mh->has_exp())
+        {
+            size_t tmp  = make_value(mh->Exp());
+            r           = (init == false) ? tmp : push(sl_code::add, r, tmp);
+            init        = true;
+        };
+
+        if (init == false)
+            r           = push(sl_code::constant, 0, 0, value::make_zero());
+    }
+    else
+    {
+        r       = push(sl_code::log, make_value(h));
+    };
+
+    m_logs.insert(handle_map::value_type(h, r));
+    return r;
+};
+
+size_t sl_program_builder::make_scaled(size_t r, const value& v)
+{
+    if (v.is_one() == true)
+        return r;
+
+    return push(sl_code::scale, r, 0, v);
+};
+
+size_t sl_program_builder::make_power_int(size_t r, int pow)
+{
+    if (pow == 0)
+        return push(sl_code::constant, 0, 0, value::make_one());
+
+    if (pow > 0)
+        return make_power_pos(r, pow);
+
+    // pow = INT_MIN is not possible in mult_rep
+    size_t tmp  = make_power_pos(r, -pow);
+
+    auto key    = std::pair<size_t, int>(r, pow);
+    auto pos    = m_powers.find(key);
+
+    if (pos != m_powers.end())
+        return pos->second;
+
+    size_t ret  = push(sl_code::inv, tmp);
+    m_powers.insert(power_map::value_type(key, ret));
+
+    return ret;
+};
+
+// binary powering; intermediate powers are shared
+size_t sl_program_builder::make_power_pos(size_t r, int pow)
+{
+    if (pow == 1)
+        return r;
+
+    auto key    = std::pair<size_t, int>(r, pow);
+    auto pos    = m_powers.find(key);
+
+    if (pos != m_powers.end())
+        return pos->second;
+
+    size_t ret;
+
+    if (pow % 2 == 0)
+    {
+        size_t tmp  = make_power_pos(r, pow / 2);
+        ret         = push(sl_code::mult, tmp, tmp);
+    }
+    else
+    {
+        size_t tmp  = make_power_pos(r, pow - 1);
+        ret         = push(sl_code::mult, tmp, r);
+    };
+
+    m_powers.insert(power_map::value_type(key, ret));
+    return ret;
+};
+
+size_t sl_program_builder::eval(const ast::scalar_rep* h)
+{
+    return push(sl_code::constant, 0, 0, h->get_data());
+};
+
+size_t sl_program_builder::eval(const ast::symbol_rep* h)
+{
+    auto pos    = m_input_map.find(h->get_symbol_code());
+
+    if (pos == m_input_map.end())
+    {
+        error::error_formatter ef;
+        ef.head() << "unable to generate code";
+        ef.new_info();
+        ef.line() << "symbol " << h->get_name() << " is not an input";
+
+        throw std::runtime_error(ef.str());
+    };
+
+    return push(sl_code::input, pos->second);
+};
+
+size_t sl_program_builder::eval(const ast::add_build* h)
+{
+    (void)h;
+    assertion(0,"we should not be here");
+    throw;
+}
+
+size_t sl_program_builder::eval(const ast::mult_build* h)
+{
+    (void)h;
+    assertion(0,"we should not be here");
+    throw;
+}
+
+size_t sl_program_builder::eval(const ast::add_rep* h)
+{
+    // V0 + sum V(i) * E(i) + log|Log|
+    size_t size = h->size();
+    bool init   = false;
+    size_t r    = 0;
+
+    const value& v0 = h->V0();
+
+    for(size_t i = 0; i < size; ++i)
+    {
+        size_t tmp      = make_value(h->E(i));
+        const value& v  = h->V(i);
+
+        if (init == false)
+        {
+            tmp         = make_scaled(tmp, v);
+
+            if (v0.is_zero() == false)
+                tmp     = push(sl_code::add_scal, tmp, 0, v0);
+
+            r           = tmp;
+            init        = true;
+        }
+        else if (v.is_minus_one() == true)
+        {
+            r           = push(sl_code::sub, r, tmp);
+        }
+        else
+        {
+            r           = push(sl_code::add, r, make_scaled(tmp, v));
+        };
+    };
+
+    if (h->has_log())
+    {
+        size_t tmp      = make_log(h->Log());
+
+        if (init == false)
+        {
+            if (v0.is_zero() == false)
+                tmp     = push(sl_code::add_scal, tmp, 0, v0);
+
+            r           = tmp;
+            init        = true;
+        }
+        else
+        {
+            r           = push(sl_code::add, r, tmp);
+        };
+    };
+
+    if (init == false)
+        r               = push(sl_code::constant, 0, 0, v0);
+
+    return r;
+};
+
+size_t sl_program_builder::eval(const ast::mult_rep* h)
+{
+    // exp(Exp) * prod IE(i)^IV(i) * prod |RE(i)|^RV(i)
+    bool init   = false;
+    size_t r    = 0;
+
+    for(size_t i = 0; i < h->isize(); ++i)
+    {
+        size_t tmp  = make_power_int(make_value(h->IE(i)), h->IV(i));
+        r           = (init == false) ? tmp : push(sl_code::mult, r, tmp);
+        init        = true;
+    };
+
+    for(size_t i = 0; i < h->rsize(); ++i)
+    {
+        size_t tmp  = push(sl_code::pow_real, make_value(h->RE(i)), 0, h->RV(i));
+        r           = (init == false) ? tmp : push(sl_code::mult, r, tmp);
+        init        = true;
+    };
+
+    if (h->has_exp())
+    {
+        size_t tmp  = make_exp(h->Exp());
+        r           = (init == false) ? tmp : push(sl_code::mult, r, tmp);
+        init        = true;
+    };
+
+    if (init == false)
+        r           = push(sl_code::constant, 0, 0, value::make_one());
+
+    return r;
+};
+
+size_t sl_program_builder::eval(const ast::function_rep* h)
+{
+    size_t size     = h->size();
+
+    using size_pod      =  sd::pod_type<size_t>;
+    int size_counter    = 0;
+    size_pod::destructor_type d(&size_counter);
+
+    sd::stack_array<size_pod> buff(size, &d);
+    size_t* buff_ptr    = reinterpret_cast<size_t*>(buff.get());
+
+    for(size_t i = 0; i < size; ++i)
+    {
+        buff_ptr[size_counter]  = make_value(h->arg(i));
+        ++size_counter;
+    };
+
+    size_t code     = h->name()->get_symbol_code();
+    auto pos        = m_func_map.find(code);
+    size_t f_index;
+
+    if (pos == m_func_map.end())
+    {
+        f_index     = m_prog.m_functions.size();
+        m_prog.m_functions.push_back(symbol(ast::symbol_ptr::from_this(h->name())));
+        m_func_map.insert(code_map::value_type(code, f_index));
+    }
+    else
+    {
+        f_index     = pos->second;
+    };
+
+    size_t args_pos = m_prog.m_args.size();
+    m_prog.m_args.push_back(size);
+
+    for(size_t i = 0; i < size; ++i)
+        m_prog.m_args.push_back(buff_ptr[i]);
+
+    return push(sl_code::call, f_index, args_pos);
+};
+
+//--------------------------------------------------------------------
+//                  sl_program
+//--------------------------------------------------------------------
+sl_program::sl_program(const std::vector<expr>& ex, const std::vector<symbol>& inputs)
+    :m_inputs(inputs)
+{
+    sl_program_builder builder(*this);
+
+    size_t n    = ex.size();
+    m_outputs.reserve(n);
+
+    for (size_t i = 0; i < n; ++i)
+    {
+        ex[i].cannonize(do_cse_default);
+
+        size_t r = builder.make_value(ex[i].get_ptr().get());
+        m_outputs.push_back(r);
+    };
+};
+
+size_t sl_program::push(sl_code code, size_t arg1, size_t arg2, const value& scal)
+{
+    m_instr.push_back(sl_instr(code, arg1, arg2, scal));
+    return m_instr.size() - 1;
+};
+
+void sl_program::eval(const value* in, value* out, const data_provider& dp) const
+{
+    size_t n            = m_instr.size();
+
+    using value_pod     =  sd::pod_type<value>;
+    int size_counter    = 0;
+    value_pod::destructor_type d(&size_counter);
+
+    sd::stack_array<value_pod> buff(n, &d);
+    value* reg          = reinterpret_cast<value*>(buff.get());
+
+    std::vector<value> args;
+
+    for (size_t k = 0; k < n; ++k)
+    {
+        const sl_instr& ins = m_instr[k];
+        value tmp;
+
+        switch (ins.m_code)
+        {
+            case sl_code::input:
+                tmp = in[ins.m_arg1];
+                break;
+            case sl_code::constant:
+                tmp = ins.m_scal;
+                break;
+            case sl_code::add:
+                tmp = reg[ins.m_arg1] + reg[ins.m_arg2];
+                break;
+            case sl_code::sub:
+                tmp = reg[ins.m_arg1] - reg[ins.m_arg2];
+                break;
+            case sl_code::mult:
+                tmp = reg[ins.m_arg1] * reg[ins.m_arg2];
+                break;
+            case sl_code::add_scal:
+                tmp = ins.m_scal + reg[ins.m_arg1];
+                break;
+            case sl_code::scale:
+                tmp = ins.m_scal * reg[ins.m_arg1];
+                break;
+            case sl_code::inv:
+                tmp = inv(reg[ins.m_arg1]);
+                break;
+            case sl_code::pow_real:
+                tmp = power_real(reg[ins.m_arg1], ins.m_scal);
+                break;
+            case sl_code::exp:
+                tmp = exp(reg[ins.m_arg1]);
+                break;
+            case sl_code::log:
+                tmp = log(reg[ins.m_arg1]);
+                break;
+            case sl_code::call:
+            {
+                size_t n_args   = m_args[ins.m_arg2];
+                const size_t* a = m_args.data() + ins.m_arg2 + 1;
+
+                args.resize(n_args);
+
+                for (size_t i = 0; i < n_args; ++i)
+                    args[i]     = reg[a[i]];
+
+                const symbol& f = m_functions[ins.m_arg1];
+                builtin_code bc = builtin_table::get().get_code(f.get_ptr().get(), n_args);
+
+                if (bc != builtin_code::none)
+                {
+                    double vals[2];
+
+                    for (size_t i = 0; i < n_args; ++i)
+                        vals[i] = args[i].get_value();
+
+                    tmp = value::make_value(builtin_table::eval(bc, vals));
+                }
+                else
+                {
+                    tmp = dp.eval_function(f, args.data(), n_args);
+                };
+
+                break;
+            }
+            default:
+                assertion(0, "unknown instruction");
+                throw;
+        };
+
+        new(reg + size_counter) value(tmp);
+        ++size_counter;
+    };
+
+    size_t n_out        = m_outputs.size();
+
+    for (size_t i = 0; i < n_out; ++i)
+        out[i]          = reg[m_outputs[i]];
+};
+
+}};
@@ -0,0 +1,122 @@
+/* 
+ *  This file is a part of sym_arrow library.
+ *
+ *  Copyright (c) Pawe Kowal 2017 - 2021
+ *
+ *  This program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program; if not, write to the Free Software
+ *  Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA 02111-1307 USA
+ */
+
+#pragma once
+
+#include "sym_arrow/nodes/expr.h"
+#include "sym_arrow/functions/contexts.h"
+
+#include <vector>
+#include <map>
+
+namespace sym_arrow { namespace details
+{
+
+#pragma warning(push)
+#pragma warning(disable: 4251)  // needs to have dll-interface to be used by clients
+
+// codes of instructions of a straight-line program
+enum class sl_code : int
+{
+    input,          // r = x[arg1]
+    constant,       // r = scal
+    add,            // r = r[arg1] + r[arg2]
+    sub,            // r = r[arg1] - r[arg2]
+    mult,           // r = r[arg1] * r[arg2]
+    add_scal,       // r = scal + r[arg1]
+    scale,          // r = scal * r[arg1]
+    inv,            // r = 1 / r[arg1]
+    pow_real,       // r = |r[arg1]|^scal
+    exp,            // r = exp(r[arg1])
+    log,            // r = log|r[arg1]|
+    call,           // r = f_arg1(r[args[arg2 + 1]], ..., r[args[arg2 + n]]),
+                    // where n = args[arg2]
+};
+
+// single instruction of a straight-line program; result of k-th
+// instruction is stored in k-th register
+struct sl_instr
+{
+    sl_code         m_code;
+    size_t          m_arg1;
+    size_t          m_arg2;
+    value           m_scal;
+
+    sl_instr(sl_code code, size_t arg1, size_t arg2, const value& scal)
+        :m_code(code), m_arg1(arg1), m_arg2(arg2), m_scal(scal)
+    {};
+};
+
+// sequence of instructions evaluating a vector of expressions with
+// common subexpressions evaluated only once; every instruction defines
+// new register
+class SYM_ARROW_EXPORT sl_program
+{
+    private:
+        using instr_vec     = std::vector<sl_instr>;
+        using index_vec     = std::vector<size_t>;
+        using symbol_vec    = std::vector<symbol>;
+
+    private:
+        instr_vec           m_instr;
+        index_vec           m_args;
+        index_vec           m_outputs;
+        symbol_vec          m_inputs;
+        symbol_vec          m_functions;
+
+    public:
+        // create program evaluating expressions ex; ex can depend only
+        // on symbols from inputs; expressions are cannonized first
+        sl_program(const std::vector<expr>& ex, const std::vector<symbol>& inputs);
+
+        // number of instructions (and registers)
+        size_t              size() const            { return m_instr.size(); };
+
+        // k-th instruction
+        const sl_instr&     get_instr(size_t k) const   { return m_instr[k]; };
+
+        // arguments of call instructions
+        const index_vec&    get_call_args() const   { return m_args; };
+
+        // registers storing results
+        const index_vec&    get_outputs() const     { return m_outputs; };
+
+        // input symbols
+        const symbol_vec&   get_inputs() const      { return m_inputs; };
+
+        // functions called by the program in order of first appearance
+        const symbol_vec&   get_functions() const   { return m_functions; };
+
+        // evaluate the program; in is an array of values of input symbols,
+        // out is an array of size get_outputs().size(); functions are
+        // evaluated by the data provider dp
+        void                eval(const value* in, value* out,
+                                const data_provider& dp) const;
+
+    private:
+        friend class sl_program_builder;
+
+        size_t              push(sl_code code, size_t arg1, size_t arg2,
+                                const value& scal);
+};
+
+#pragma warning(pop)
+
+}};
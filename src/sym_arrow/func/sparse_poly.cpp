@@ -0,0 +1,862 @@
+/* 
+ *  This file is a part of sym_arrow library.
+ *
+ *  Copyright (c) Pawe Kowal 2017 - 2021
+ *
+ *  This program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program; if not, write to the Free Software
+ *  Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA 02111-1307 USA
+ */
+
+#include "sym_arrow/functions/sparse_poly.h"
+#include "sym_arrow/functions/expr_functions.h"
+#include "dag/dag.h"
+#include "sym_arrow/ast/ast.h"
+#include "sym_arrow/ast/mult_rep.inl"
+#include "sym_arrow/ast/builder/add_build.h"
+#include "sym_arrow/ast/builder/build_item.h"
+#include "sym_arrow/ast/cannonization/cannonize.h"
+#include "sym_arrow/utils/stack_array.h"
+#include "sym_arrow/error/error_formatter.h"
+
+#include <unordered_map>
+#include <algorithm>
+
+namespace sym_arrow { namespace details
+{
+
+// maximum number of symbols of sparse_poly
+static const size_t poly_max_symbols    = 32;
+
+// width of exponent field for n symbols
+static size_t get_poly_width(size_t n)
+{
+    if (n > poly_max_symbols)
+    {
+        error::error_formatter ef;
+        ef.head() << "too many symbols in sparse_poly: " << n
+                  << ", maximum number of symbols is " << poly_max_symbols;
+
+        throw std::runtime_error(ef.str());
+    };
+
+    if (n == 0)
+        return 32;
+
+    return std::min<size_t>(64 / n, 32);
+};
+
+static void error_not_polynomial(const std::string& reason)
+{
+    error::error_formatter ef;
+    ef.head() << "expression is not a polynomial: " << reason;
+
+    throw std::runtime_error(ef.str());
+};
+
+// map from symbol codes to positions in the list of symbols
+class poly_symbol_map
+{
+    private:
+        std::unordered_map<size_t, size_t>  m_map;
+
+    public:
+        poly_symbol_map(const std::vector<symbol>& syms);
+
+        // return position of a symbol or -1 if symbol is not present
+        size_t          find(size_t code) const;
+};
+
+poly_symbol_map::poly_symbol_map(const std::vector<symbol>& syms)
+{
+    for (size_t i = 0; i < syms.size(); ++i)
+        m_map[syms[i].get_ptr()->get_symbol_code()] = i;
+};
+
+size_t poly_symbol_map::find(size_t code) const
+{
+    auto pos    = m_map.find(code);
+
+    if (pos == m_map.end())
+        return size_t(-1);
+    else
+        return pos->second;
+};
+
+//--------------------------------------------------------------------
+//                  do_poly_vis
+//--------------------------------------------------------------------
+// convert cannonized expression to sparse_poly
+class do_poly_vis : public sym_dag::dag_visitor<sym_arrow::ast::term_tag, do_poly_vis>
+{
+    public:
+        using tag_type      = sym_arrow::ast::term_tag;
+
+    private:
+        using poly_map      = std::unordered_map<ast::expr_handle, sparse_poly>;
+
+    private:
+        const std::vector<symbol>&  m_symbols;
+        poly_symbol_map             m_symbol_map;
+        poly_map                    m_map;
+
+    public:
+        do_poly_vis(const std::vector<symbol>& syms);
+
+        sparse_poly         make(ast::expr_handle h);
+
+    public:
+        template<class Node>
+        sparse_poly eval(const Node* ast);
+
+        sparse_poly eval(const ast::scalar_rep* h);
+        sparse_poly eval(const ast::symbol_rep* h);
+        sparse_poly eval(const ast::add_build* h);
+        sparse_poly eval(const ast::mult_build* h);
+        sparse_poly eval(const ast::add_rep* h);
+        sparse_poly eval(const ast::mult_rep* h);
+        sparse_poly eval(const ast::function_rep* h);
+};
+
+do_poly_vis::do_poly_vis(const std::vector<symbol>& syms)
+    :m_symbols(syms), m_symbol_map(syms)
+{};
+
+sparse_poly do_poly_vis::make(ast::expr_handle h)
+{
+    auto pos        = m_map.find(h);
+
+    if (pos != m_map.end())
+        return pos->second;
+
+    sparse_poly ret = visit(h);
+    m_map.insert(poly_map::value_type(h, ret));
+
+    return ret;
+};
+
+sparse_poly do_poly_vis::eval(const ast::scalar_rep* h)
+{
+    return sparse_poly(m_symbols, h->get_data());
+};
+
+sparse_poly do_poly_vis::eval(const ast::symbol_rep* h)
+{
+    size_t var      = m_symbol_map.find(h->get_symbol_code());
+
+    if (var == size_t(-1))
+        error_not_polynomial(std::string("unexpected symbol ") + h->get_name());
+
+    return sparse_poly::make_symbol(m_symbols, var);
+};
+
+sparse_poly do_poly_vis::eval(const ast::add_build* h)
+{
+    (void)h;
+    assertion(0,"expression not explicit");
+    throw;
+};
+
+sparse_poly do_poly_vis::eval(const ast::mult_build* h)
+{
+    (void)h;
+    assertion(0,"expression not explicit");
+    throw;
+};
+
+sparse_poly do_poly_vis::eval(const ast::add_rep* h)
+{
+    if (h->has_log() == true)
+        error_not_polynomial("log term");
+
+    sparse_poly ret(m_symbols, h->V0());
+    size_t n        = h->size();
+
+    for (size_t i = 0; i < n; ++i)
+        ret         += h->V(i) * make(h->E(i));
+
+    return ret;
+};
+
+sparse_poly do_poly_vis::eval(const ast::mult_rep* h)
+{
+    if (h->has_exp() == true)
+        error_not_polynomial("exp term");
+
+    if (h->rsize() > 0)
+        error_not_polynomial("real power");
+
+    sparse_poly ret(m_symbols, value::make_one());
+    size_t n        = h->isize();
+
+    for (size_t i = 0; i < n; ++i)
+    {
+        if (h->IV(i) < 0)
+            error_not_polynomial("negative power");
+
+        ret         *= make(h->IE(i)).power(h->IV(i));
+    };
+
+    return ret;
+};
+
+sparse_poly do_poly_vis::eval(const ast::function_rep* h)
+{
+    error_not_polynomial(std::string("function ") + h->name()->get_name());
+    throw;
+};
+
+//--------------------------------------------------------------------
+//                  do_is_poly_vis
+//--------------------------------------------------------------------
+// check if cannonized expression is a polynomial
+class do_is_poly_vis : public sym_dag::dag_visitor<sym_arrow::ast::term_tag, do_is_poly_vis>
+{
+    public:
+        using tag_type      = sym_arrow::ast::term_tag;
+
+    private:
+        using check_map     = std::unordered_map<ast::expr_handle, bool>;
+
+    private:
+        poly_symbol_map     m_symbol_map;
+        check_map           m_map;
+
+    public:
+        do_is_poly_vis(const std::vector<symbol>& syms);
+
+        bool                make(ast::expr_handle h);
+
+    public:
+        template<class Node>
+        bool eval(const Node* ast);
+
+        bool eval(const ast::scalar_rep* h);
+        bool eval(const ast::symbol_rep* h);
+        bool eval(const ast::add_build* h);
+        bool eval(const ast::mult_build* h);
+        bool eval(const ast::add_rep* h);
+        bool eval(const ast::mult_rep* h);
+        bool eval(const ast::function_rep* h);
+};
+
+do_is_poly_vis::do_is_poly_vis(const std::vector<symbol>& syms)
+    :m_symbol_map(syms)
+{};
+
+bool do_is_poly_vis::make(ast::expr_handle h)
+{
+    auto pos        = m_map.find(h);
+
+    if (pos != m_map.end())
+        return pos->second;
+
+    bool ret        = visit(h);
+    m_map.insert(check_map::value_type(h, ret));
+
+    return ret;
+};
+
+bool do_is_poly_vis::eval(const ast::scalar_rep* h)
+{
+    (void)h;
+    return true;
+};
+
+bool do_is_poly_vis::eval(const ast::symbol_rep* h)
+{
+    return m_symbol_map.find(h->get_symbol_code()) != size_t(-1);
+};
+
+bool do_is_poly_vis::eval(const ast::add_build* h)
+{
+    (void)h;
+    assertion(0,"expression not explicit");
+    throw;
+};
+
+bool do_is_poly_vis::eval(const ast::mult_build* h)
+{
+    (void)h;
+    assertion(0,"expression not explicit");
+    throw;
+};
+
+bool do_is_poly_vis::eval(const ast::add_rep* h)
+{
+    if (h->has_log() == true)
+        return false;
+
+    size_t n        = h->size();
+
+    for (size_t i = 0; i < n; ++i)
+    {
+        if (make(h->E(i)) == false)
+            return false;
+    };
+
+    return true;
+};
+
+bool do_is_poly_vis::eval(const ast::mult_rep* h)
+{
+    if (h->has_exp() == true || h->rsize() > 0)
+        return false;
+
+    size_t n        = h->isize();
+
+    for (size_t i = 0; i < n; ++i)
+    {
+        if (h->IV(i) < 0 || make(h->IE(i)) == false)
+            return false;
+    };
+
+    return true;
+};
+
+bool do_is_poly_vis::eval(const ast::function_rep* h)
+{
+    (void)h;
+    return false;
+};
+
+}};
+
+namespace sym_arrow
+{
+
+//--------------------------------------------------------------------
+//                  sparse_poly
+//--------------------------------------------------------------------
+sparse_poly::sparse_poly()
+    :m_width(details::get_poly_width(0))
+{};
+
+sparse_poly::sparse_poly(const std::vector<symbol>& syms, size_t width)
+    :m_symbols(syms), m_width(width)
+{};
+
+sparse_poly::sparse_poly(const std::vector<symbol>& syms)
+    :m_symbols(syms), m_width(details::get_poly_width(syms.size()))
+{};
+
+sparse_poly::sparse_poly(const std::vector<symbol>& syms, const value& c)
+    :sparse_poly(syms)
+{
+    if (c.is_zero() == false)
+    {
+        m_exps.push_back(0);
+        m_coefs.push_back(c.get_value());
+    };
+};
+
+sparse_poly::sparse_poly(const expr& ex, const std::vector<symbol>& syms)
+    :sparse_poly(syms)
+{
+    ex.cannonize(false);
+    *this   = details::do_poly_vis(syms).make(ex.get_expr_handle());
+};
+
+sparse_poly sparse_poly::make_symbol(const std::vector<symbol>& syms, size_t var)
+{
+    sparse_poly ret(syms);
+
+    ret.m_exps.push_back(exp_type(1) << ret.shift(var));
+    ret.m_coefs.push_back(1.0);
+
+    return ret;
+};
+
+bool sparse_poly::is_polynomial(const expr& ex, const std::vector<symbol>& syms)
+{
+    ex.cannonize(false);
+    return details::do_is_poly_vis(syms).make(ex.get_expr_handle());
+};
+
+const std::vector<symbol>& sparse_poly::get_symbols() const
+{
+    return m_symbols;
+};
+
+size_t sparse_poly::size() const
+{
+    return m_coefs.size();
+};
+
+bool sparse_poly::is_zero() const
+{
+    return m_coefs.size() == 0;
+};
+
+value sparse_poly::coef(size_t k) const
+{
+    return value::make_value(m_coefs[k]);
+};
+
+int sparse_poly::exponent(size_t k, size_t var) const
+{
+    exp_type mask   = (exp_type(1) << m_width) - 1;
+    return int((m_exps[k] >> shift(var)) & mask);
+};
+
+int sparse_poly::degree(size_t var) const
+{
+    int deg         = 0;
+
+    for (size_t k = 0; k < m_exps.size(); ++k)
+        deg         = std::max(deg, exponent(k, var));
+
+    return deg;
+};
+
+int sparse_poly::max_exponent() const
+{
+    return int((exp_type(1) << (m_width - 1)) - 1);
+};
+
+inline size_t sparse_poly::shift(size_t var) const
+{
+    // first symbol is stored in the most significant bits
+    return (m_symbols.size() - 1 - var) * m_width;
+};
+
+sparse_poly::exp_type sparse_poly::guard_mask() const
+{
+    exp_type mask   = 0;
+
+    for (size_t i = 0; i < m_symbols.size(); ++i)
+        mask        |= exp_type(1) << (shift(i) + m_width - 1);
+
+    return mask;
+};
+
+void sparse_poly::check_symbols(const sparse_poly& other) const
+{
+    bool ok     = m_symbols.size() == other.m_symbols.size();
+
+    for (size_t i = 0; ok == true && i < m_symbols.size(); ++i)
+    {
+        ok      = m_symbols[i].get_ptr()->get_symbol_code()
+                    == other.m_symbols[i].get_ptr()->get_symbol_code();
+    };
+
+    if (ok == true)
+        return;
+
+    error::error_formatter ef;
+    ef.head() << "sparse polynomials have different lists of symbols";
+
+    throw std::runtime_error(ef.str());
+};
+
+void sparse_poly::error_overflow() const
+{
+    error::error_formatter ef;
+    ef.head() << "exponent overflow in sparse_poly; maximum exponent is "
+              << max_exponent();
+
+    throw std::runtime_error(ef.str());
+};
+
+void sparse_poly::add(const sparse_poly& other, double scal)
+{
+    check_symbols(other);
+
+    size_t n        = m_exps.size();
+    size_t m        = other.m_exps.size();
+
+    std::vector<exp_type> exps;
+    std::vector<double> coefs;
+
+    exps.reserve(n + m);
+    coefs.reserve(n + m);
+
+    size_t i        = 0;
+    size_t j        = 0;
+
+    // merge sorted terms
+    while (i < n || j < m)
+    {
+        if (j == m || (i < n && m_exps[i] < other.m_exps[j]))
+        {
+            exps.push_back(m_exps[i]);
+            coefs.push_back(m_coefs[i]);
+            ++i;
+        }
+        else if (i == n || other.m_exps[j] < m_exps[i])
+        {
+            exps.push_back(other.m_exps[j]);
+            coefs.push_back(scal * other.m_coefs[j]);
+            ++j;
+        }
+        else
+        {
+            double c    = m_coefs[i] + scal * other.m_coefs[j];
+
+            if (c != 0.0)
+            {
+                exps.push_back(m_exps[i]);
+                coefs.push_back(c);
+            };
+
+            ++i;
+            ++j;
+        };
+    };
+
+    m_exps.swap(exps);
+    m_coefs.swap(coefs);
+};
+
+sparse_poly& sparse_poly::operator+=(const sparse_poly& other)
+{
+    add(other, 1.0);
+    return *this;
+};
+
+sparse_poly& sparse_poly::operator-=(const sparse_poly& other)
+{
+    add(other, -1.0);
+    return *this;
+};
+
+sparse_poly& sparse_poly::operator*=(const value& scal)
+{
+    double s        = scal.get_value();
+
+    if (s == 0.0)
+    {
+        m_exps.clear();
+        m_coefs.clear();
+        return *this;
+    };
+
+    for (double& c : m_coefs)
+        c           *= s;
+
+    return *this;
+};
+
+sparse_poly& sparse_poly::operator*=(const sparse_poly& other)
+{
+    check_symbols(other);
+
+    size_t n        = m_exps.size();
+    size_t m        = other.m_exps.size();
+    exp_type guard  = guard_mask();
+
+    if (n == 0 || m == 0)
+    {
+        m_exps.clear();
+        m_coefs.clear();
+        return *this;
+    };
+
+    if (m == 1)
+    {
+        // adding the same exponent preserves ordering
+        exp_type e  = other.m_exps[0];
+        double c    = other.m_coefs[0];
+
+        // overflow is checked first, this polynomial is not modified if
+        // an exception is thrown
+        for (size_t i = 0; i < n; ++i)
+        {
+            if (((m_exps[i] + e) & guard) != 0)
+                error_overflow();
+        };
+
+        for (size_t i = 0; i < n; ++i)
+        {
+            m_exps[i]   += e;
+            m_coefs[i]  *= c;
+        };
+
+        return *this;
+    };
+
+    using term_map  = std::unordered_map<exp_type, double>;
+
+    term_map terms;
+    terms.reserve(std::min<size_t>(n * m, 1 << 24));
+
+    for (size_t i = 0; i < n; ++i)
+    {
+        for (size_t j = 0; j < m; ++j)
+        {
+            exp_type e  = m_exps[i] + other.m_exps[j];
+
+            if ((e & guard) != 0)
+                error_overflow();
+
+            terms[e]    += m_coefs[i] * other.m_coefs[j];
+        };
+    };
+
+    std::vector<std::pair<exp_type, double>> sorted;
+    sorted.reserve(terms.size());
+
+    for (const auto& t : terms)
+    {
+        if (t.second != 0.0)
+            sorted.push_back(t);
+    };
+
+    std::sort(sorted.begin(), sorted.end(),
+              [](const std::pair<exp_type, double>& a, const std::pair<exp_type, double>& b)
+              { return a.first < b.first; });
+
+    m_exps.resize(sorted.size());
+    m_coefs.resize(sorted.size());
+
+    for (size_t k = 0; k < sorted.size(); ++k)
+    {
+        m_exps[k]   = sorted[k].first;
+        m_coefs[k]  = sorted[k].second;
+    };
+
+    return *this;
+};
+
+sparse_poly sparse_poly::power(int n) const
+{
+    if (n < 0)
+    {
+        error::error_formatter ef;
+        ef.head() << "negative power of sparse_poly: " << n;
+
+        throw std::runtime_error(ef.str());
+    };
+
+    sparse_poly ret(m_symbols, value::make_one());
+    sparse_poly base(*this);
+
+    while (n > 0)
+    {
+        if (n % 2 == 1)
+            ret     *= base;
+
+        n           = n / 2;
+
+        if (n > 0)
+            base    *= base;
+    };
+
+    return ret;
+};
+
+sparse_poly sparse_poly::diff(size_t var, int n) const
+{
+    if (n <= 0)
+        return *this;
+
+    sparse_poly ret(m_symbols, m_width);
+
+    size_t sh       = shift(var);
+    exp_type mask   = (exp_type(1) << m_width) - 1;
+    exp_type dec    = exp_type(n) << sh;
+
+    ret.m_exps.reserve(m_exps.size());
+    ret.m_coefs.reserve(m_coefs.size());
+
+    // subtracting the same exponent preserves ordering
+    for (size_t k = 0; k < m_exps.size(); ++k)
+    {
+        int e       = int((m_exps[k] >> sh) & mask);
+
+        if (e < n)
+            continue;
+
+        double c    = m_coefs[k];
+
+        for (int i = 0; i < n; ++i)
+            c       *= double(e - i);
+
+        ret.m_exps.push_back(m_exps[k] - dec);
+        ret.m_coefs.push_back(c);
+    };
+
+    return ret;
+};
+
+sparse_poly sparse_poly::diff(const symbol& sym, int n) const
+{
+    size_t code     = sym.get_ptr()->get_symbol_code();
+
+    for (size_t i = 0; i < m_symbols.size(); ++i)
+    {
+        if (m_symbols[i].get_ptr()->get_symbol_code() == code)
+            return diff(i, n);
+    };
+
+    return sparse_poly(m_symbols, m_width);
+};
+
+value sparse_poly::eval(const value* vals) const
+{
+    size_t n_sym    = m_symbols.size();
+
+    // powers of values of symbols
+    std::vector<std::vector<double>> pows(n_sym);
+
+    for (size_t i = 0; i < n_sym; ++i)
+    {
+        int deg     = degree(i);
+        double x    = vals[i].get_value();
+
+        pows[i].resize(deg + 1);
+        pows[i][0]  = 1.0;
+
+        for (int j = 1; j <= deg; ++j)
+            pows[i][j]  = pows[i][j - 1] * x;
+    };
+
+    exp_type mask   = (exp_type(1) << m_width) - 1;
+    double ret      = 0.0;
+
+    for (size_t k = 0; k < m_exps.size(); ++k)
+    {
+        double t    = m_coefs[k];
+        exp_type e  = m_exps[k];
+
+        for (size_t i = n_sym; i > 0; --i)
+        {
+            t       *= pows[i - 1][size_t(e & mask)];
+            e       = e >> m_width;
+        };
+
+        ret         += t;
+    };
+
+    return value::make_value(ret);
+};
+
+value sparse_poly::eval(const data_provider& dp) const
+{
+    std::vector<value> vals;
+    vals.reserve(m_symbols.size());
+
+    for (const symbol& s : m_symbols)
+        vals.push_back(dp.get_value(s));
+
+    return eval(vals.data());
+};
+
+expr sparse_poly::to_expr() const
+{
+    using item          = ast::build_item<value>;
+    using iitem_handle  = ast::build_item<int>::handle_type;
+    using ritem_handle  = ast::build_item<value>::handle_type;
+    using iitem_array   = details::stack_array<details::pod_type<iitem_handle>>;
+
+    size_t n_sym        = m_symbols.size();
+    value add           = value::make_zero();
+
+    std::vector<item> items;
+    items.reserve(m_exps.size());
+
+    iitem_array arr(n_sym);
+    iitem_handle* ih    = (iitem_handle*)arr.get();
+
+    for (size_t k = 0; k < m_exps.size(); ++k)
+    {
+        value c         = value::make_value(m_coefs[k]);
+        size_t pos      = 0;
+
+        for (size_t i = 0; i < n_sym; ++i)
+        {
+            int e       = exponent(k, i);
+
+            if (e != 0)
+            {
+                new(ih + pos) iitem_handle(e, m_symbols[i].get_ptr().get());
+                ++pos;
+            };
+        };
+
+        if (pos == 0)
+        {
+            add         = add + c;
+            continue;
+        };
+
+        if (pos == 1 && ih[0].m_value == 1)
+        {
+            items.push_back(item(c, expr(ih[0].m_expr)));
+            continue;
+        };
+
+        // powers of symbols are already cannonical
+        std::sort(ih, ih + pos, [](const iitem_handle& a, const iitem_handle& b)
+                  { return a.compare(b); });
+
+        ast::mult_rep_info<iitem_handle, ritem_handle> mi(pos, ih, nullptr, 0, nullptr);
+        items.push_back(item(c, expr(ast::mult_rep::make(mi))));
+    };
+
+    if (items.size() == 0)
+        return expr(add);
+
+    ast::add_build_info2<item> bi(add, items.size(), items.data(), nullptr);
+
+    // cse would factor the polynomial
+    expr ret            = expr(ast::add_build::make(bi));
+    ret.cannonize(false);
+
+    ast::cannonize().set_cse_done(ret);
+    return ret;
+};
+
+sparse_poly sym_arrow::operator+(const sparse_poly& a, const sparse_poly& b)
+{
+    sparse_poly ret(a);
+    ret     += b;
+    return ret;
+};
+
+sparse_poly sym_arrow::operator-(const sparse_poly& a, const sparse_poly& b)
+{
+    sparse_poly ret(a);
+    ret     -= b;
+    return ret;
+};
+
+sparse_poly sym_arrow::operator*(const sparse_poly& a, const sparse_poly& b)
+{
+    sparse_poly ret(a);
+    ret     *= b;
+    return ret;
+};
+
+sparse_poly sym_arrow::operator*(const value& a, const sparse_poly& b)
+{
+    sparse_poly ret(b);
+    ret     *= a;
+    return ret;
+};
+
+sparse_poly sym_arrow::operator*(const sparse_poly& a, const value& b)
+{
+    sparse_poly ret(a);
+    ret     *= b;
+    return ret;
+};
+
+sparse_poly sym_arrow::operator-(const sparse_poly& a)
+{
+    sparse_poly ret(a);
+    ret     *= value::make_value(-1.0);
+    return ret;
+};
+
+};
@@ -23,24 +23,249 @@
 #include "dag/dag.h"
 #include "sym_arrow/ast/ast.h"
 #include "sym_arrow/ast/builder/vlist_add.h"
+#include "sym_arrow/ast/cannonization/cannonize.h"
+#include "sym_arrow/utils/pool_hash_map.h"
 #include "sym_arrow/utils/stack_array.h"
 #include "sym_arrow/functions/contexts.h"
 #include "sym_arrow/ast/mult_rep.inl"
 #include "sym_arrow/func/symbol_functions.h"
 #include "sym_arrow/functions/expr_functions.h"
+#include "sym_arrow/func/subs_skeleton.h"
+#include "sym_arrow/error/error_formatter.h"
 
 #include <sstream>
+#include <unordered_map>
+#include <vector>
 
 namespace sym_arrow { namespace details
 {
 
 namespace sd = sym_arrow :: details;
 
+// rebuild a sum; child(e) returns substitution of a subterm e or null
+// expression if e is not changed; return null expression if no subterm
+// is changed
+template<class Child_fun>
+static expr subs_add(const ast::add_rep* h, Child_fun& child)
+{
+    size_t n            = h->size();
+    bool any            = false;
+
+    using item          = ast::build_item<value>;
+    using item_pod      = sd::pod_type<item>;
+
+    int size_counter    = 0;
+    item_pod::destructor_type d(&size_counter);
+    sd::stack_array<item_pod> sum_buff(n, &d);    
+
+    item* sum_buff_ptr  = sum_buff.get_cast<item>();
+
+    for (size_t j = 0; j < n; ++j)
+    {
+        expr tmp        = child(h->E(j));
+
+        if (tmp.is_null() == true)
+            tmp         = expr(h->E(j));
+        else
+            any         = true;
+
+        new (sum_buff_ptr + size_counter) item(h->V(j), std::move(tmp));
+        ++size_counter;
+    };
+
+    value add           = h->V0();
+    expr log_term;
+
+    if (h->has_log() == true)
+    {
+        log_term        = child(h->Log());
+
+        if (log_term.is_null() == true)
+        {
+            log_term    = expr(h->Log());
+        }
+        else
+        {
+            any         = true;
+
+            // the same rule as in simplify
+            if (log_term.get_ptr()->isa<ast::scalar_rep>() == true)
+            {
+                add     = add + log(cast_scalar(log_term).get_value());
+                log_term = expr();
+            };
+        };
+    };
+
+    if (any == false)
+        return expr();
+
+    // subterms are combined by one cannonization
+    ast::expr_ptr res;
+
+    if (log_term.is_null() == true)
+    {
+        ast::add_build_info2<item> bi(add, size_counter, sum_buff_ptr, nullptr);
+        res             = ast::add_build::make(bi);
+    }
+    else
+    {
+        item log_it     = item(value::make_one(), log_term);
+        ast::add_build_info2<item> bi(add, size_counter, sum_buff_ptr, &log_it);
+        res             = ast::add_build::make(bi);
+    };
+
+    expr ret            = expr(std::move(res));
+    ret.cannonize(ast::cannonize::do_cse_lazy());
+
+    return ret;
+};
+
+// rebuild a product; child is as in subs_add
+template<class Child_fun>
+static expr subs_mult(const ast::mult_rep* h, Child_fun& child)
+{
+    size_t in           = h->isize();
+    size_t rn           = h->rsize();
+    bool any            = false;
+
+    using iitem         = ast::build_item<int>;
+    using ritem         = ast::build_item<value>;
+    using iitem_pod     = sd::pod_type<iitem>;
+    using ritem_pod     = sd::pod_type<ritem>;
+
+    int ipow_counter    = 0;
+    iitem_pod::destructor_type d_ipow(&ipow_counter);
+    sd::stack_array<iitem_pod> ipow_buff(in, &d_ipow);
+
+    iitem* ipow_ptr     = ipow_buff.get_cast<iitem>();
+
+    for (size_t i = 0; i < in; ++i)
+    {
+        expr tmp        = child(h->IE(i));
+
+        if (tmp.is_null() == true)
+            tmp         = expr(h->IE(i));
+        else
+            any         = true;
+
+        new (ipow_ptr + ipow_counter) iitem(h->IV(i), std::move(tmp));
+        ++ipow_counter;
+    };
+
+    int rpow_counter    = 0;
+    ritem_pod::destructor_type d_rpow(&rpow_counter);
+    sd::stack_array<ritem_pod> rpow_buff(rn, &d_rpow);    
+
+    ritem* rpow_ptr     = rpow_buff.get_cast<ritem>();
+
+    for (size_t i = 0; i < rn; ++i)
+    {
+        expr tmp        = child(h->RE(i));
+
+        if (tmp.is_null() == true)
+            tmp         = expr(h->RE(i));
+        else
+            any         = true;
+
+        new (rpow_ptr + rpow_counter) ritem(h->RV(i), std::move(tmp));
+        ++rpow_counter;
+    };
+
+    expr exp_term;
+
+    if (h->has_exp() == true)
+    {
+        exp_term        = child(h->Exp());
+
+        if (exp_term.is_null() == true)
+            exp_term    = expr(h->Exp());
+        else
+            any         = true;
+    };
+
+    if (any == false)
+        return expr();
+
+    // subterms are combined by one cannonization
+    ast::expr_handle ex_h   = exp_term.is_null() ? nullptr : exp_term.get_ptr().get();
+
+    ast::mult_build_info<iitem, ritem> bi(in, ipow_ptr, rn, rpow_ptr, ex_h);
+
+    expr ret            = expr(ast::mult_build::make(bi));
+    ret.cannonize(ast::cannonize::do_cse_lazy());
+
+    return ret;
+};
+
+// rebuild a function; child is as in subs_add
+template<class Child_fun>
+static expr subs_function(const ast::function_rep* h, Child_fun& child)
+{
+    size_t n                = h->size();
+
+    int size_counter        = 0;
+    bool any                = false;
+
+    using expr_pod          =  sd::pod_type<expr>;
+    expr_pod::destructor_type d(&size_counter);
+    sd::stack_array<expr_pod> buff(n, &d);    
+
+    expr* buff_ptr          = reinterpret_cast<expr*>(buff.get());
+
+    for (size_t j = 0; j < n; ++j)
+    {
+        expr tmp            = child(h->arg(j));
+
+        if (tmp.is_null() == true)
+        {
+            tmp             = expr(h->arg(j));
+        }
+        else
+        {
+            tmp.cannonize(do_cse_default);
+            any             = true;
+        };
+
+        new(buff_ptr + size_counter) expr(std::move(tmp));
+        ++size_counter;
+    };
+
+    if (any == false)
+        return expr();
+
+    using info              = ast::function_rep_info;
+    info f_info             = info(h->name(), n, buff_ptr);
+    ast::expr_ptr ep        = ast::function_rep::make(f_info);
+
+    return expr(ep);
+};
+
+// substitution of symbols; results are memoized, therefore every
+// distinct subexpression is processed once; null expression is returned
+// if a subexpression is not changed
 class do_subs_vis : public sym_dag::dag_visitor<sym_arrow::ast::term_tag, do_subs_vis>
 {
+    private:
+        // unchanged subexpressions are mapped to itself
+        using hash_map      = utils::pool_hash_map<ast::expr_handle, ast::expr_ptr, 
+                                utils::expr_hash_equal>;
+
+    private:
+        hash_map        m_hash_map;
+
+        do_subs_vis(const do_subs_vis&) = delete;
+        do_subs_vis& operator=(const do_subs_vis&) = delete;
+
     public:
         using tag_type  = sym_arrow::ast::term_tag;
 
+    public:
+        do_subs_vis();
+        ~do_subs_vis();
+
+        expr make(ast::expr_handle h, const subs_context& sub);
+
     public:
         template<class Node>
         expr eval(const Node* ast, const subs_context& sub);
@@ -54,6 +279,45 @@ class do_subs_vis : public sym_dag::dag_visitor<sym_arrow::ast::term_tag, do_sub
         expr eval(const ast::function_rep* h, const subs_context& sub);
 };
 
+do_subs_vis::do_subs_vis()
+{};
+
+do_subs_vis::~do_subs_vis()
+{
+    using context   = ast::expr_base::context_type;
+    auto st         = context::get().get_stack();
+
+    m_hash_map.clear(st.get());
+};
+
+expr do_subs_vis::make(ast::expr_handle h, const subs_context& sc)
+{
+    // scalars and symbols are not memoized
+    if (h->isa<ast::scalar_rep>() == true || h->isa<ast::symbol_rep>() == true)
+        return visit(h, sc);
+
+    auto pos        = m_hash_map.find(h);
+
+    if (pos.empty() == false)
+    {
+        const ast::expr_ptr& res    = pos->get_value();
+
+        if (res.get() == h)
+            return expr();
+        else
+            return expr(res);
+    };
+
+    expr ret        = visit(h, sc);
+
+    if (ret.is_null() == true)
+        m_hash_map.insert(h, ast::expr_ptr::from_this(h));
+    else
+        m_hash_map.insert(h, ret.get_ptr());
+
+    return ret;
+};
+
 expr do_subs_vis::eval(const ast::scalar_rep* h, const subs_context& sub)
 {
     (void)h;
@@ -63,8 +327,7 @@ expr do_subs_vis::eval(const ast::scalar_rep* h, const subs_context& sub)
 
 expr do_subs_vis::eval(const ast::symbol_rep* h, const subs_context& sc)
 {
-    expr res2 = sc.subs(symbol(h));
-    return res2;
+    return sc.subs(h->get_symbol_code());
 };
 
 expr do_subs_vis::eval(const ast::add_build* h, const subs_context& sub)
@@ -88,201 +351,166 @@ expr do_subs_vis::eval(const ast::add_rep* h, const subs_context& sc)
     if (ast::details::has_any_symbol(h, sc.get_symbol_set()) == false)
         return expr();
 
-    size_t n                = h->size();
-    int size_counter        = 0;
-    bool any                = false;
+    auto child  = [this, &sc](ast::expr_handle e) { return make(e, sc); };
+    return subs_add(h, child);
+};
 
-    using expr_pod          =  sd::pod_type<expr>;
-    expr_pod::destructor_type d(&size_counter);
-    sd::stack_array<expr_pod> buff(n, &d);    
+expr do_subs_vis::eval(const ast::mult_rep* h, const subs_context& sc)
+{
+    if (ast::details::has_any_symbol(h, sc.get_symbol_set()) == false)
+        return expr();
 
-    expr* buff_ptr          = reinterpret_cast<expr*>(buff.get());
+    auto child  = [this, &sc](ast::expr_handle e) { return make(e, sc); };
+    return subs_mult(h, child);
+};
 
-    for (size_t j = 0; j < n; ++j)
-    {
-        expr tmp            = visit(h->E(j), sc);
+expr do_subs_vis::eval(const ast::function_rep* h, const subs_context& sc)
+{
+    if (h->size() == 0 || ast::details::has_any_symbol(h, sc.get_symbol_set()) == false)
+        return expr();
 
-        if (tmp.is_null() == true)
-            tmp             = expr(h->E(j));
-        else
-            any             = true;
+    auto child  = [this, &sc](ast::expr_handle e) { return make(e, sc); };
+    return subs_function(h, child);
+};
 
-        new(buff_ptr + size_counter) expr(std::move(tmp));
-        ++size_counter;
-    };
+const size_t subs_skeleton::no_node;
 
-    if (h->has_log() == true)
+subs_skeleton::subs_skeleton(ast::expr_handle h, const std::vector<symbol>& syms)
+{
+    for (size_t i = 0; i < syms.size(); ++i)
     {
-        expr tmp            = visit(h->Log(), sc);
+        size_t code     = syms[i].get_ptr()->get_symbol_code();
 
-        if (tmp.is_null() == true)
-            tmp             = expr(h->Log());
-        else
-            any             = true;
+        if (code >= m_slots.size())
+            m_slots.resize(code + 1, no_node);
 
-        new(buff_ptr + size_counter) expr(std::move(tmp));
-        ++size_counter;
+        m_slots[code]   = i;
+        m_set           = m_set.set(code);
     };
 
-    if (any == false)
-        return expr();
+    m_root              = build(h);
+    index_map().swap(m_map);
+};
 
-    expr subsexpr       = expr(h->V0());
+size_t subs_skeleton::size() const
+{
+    return m_nodes.size();
+};
 
-    for (size_t j = 0; j < n; ++j)
-    {
-        const value& b  = h->V(j);
-        expr tmp        = std::move(buff_ptr[j]);
-        subsexpr        = std::move(subsexpr) + (b * std::move(tmp));
-    };
+size_t subs_skeleton::build_node(ast::expr_handle h, size_t slot, const index_vec& children)
+{
+    size_t first        = m_children.size();
+    m_children.insert(m_children.end(), children.begin(), children.end());
 
-    if (h->has_log() == true)
-    {
-        expr tmp        = std::move(buff_ptr[n]);
-        subsexpr        = std::move(subsexpr) + log(std::move(tmp));
-    };
+    size_t index        = m_nodes.size();
+    m_nodes.push_back(node{h, slot, first});
+    m_map.insert(index_map::value_type(h, index));
 
-    return subsexpr;
+    return index;
 };
 
-expr do_subs_vis::eval(const ast::mult_rep* h, const subs_context& sc)
+size_t subs_skeleton::build(ast::expr_handle h)
 {
-    if (ast::details::has_any_symbol(h, sc.get_symbol_set()) == false)
-        return expr();
+    if (h->isa<ast::scalar_rep>() == true)
+        return no_node;
 
-    size_t in               = h->isize();
-    int isize_counter       = 0;
-    bool any                = false;
+    auto pos            = m_map.find(h);
 
-    using expr_pod          =  sd::pod_type<expr>;
+    if (pos != m_map.end())
+        return pos->second;
 
-    expr_pod::destructor_type id(&isize_counter);
-    sd::stack_array<expr_pod> ibuff(in, &id);    
-    expr* ibuff_ptr         = reinterpret_cast<expr*>(ibuff.get());
+    index_vec children;
 
-    for (size_t i = 0; i < h->isize(); ++i)
+    if (h->isa<ast::symbol_rep>() == true)
     {
-        expr tmp            = visit(h->IE(i), sc);
+        size_t code     = h->static_cast_to<ast::symbol_rep>()->get_symbol_code();
+        size_t slot     = code < m_slots.size() ? m_slots[code] : no_node;
 
-        if (tmp.is_null() == true)
-            tmp             = expr(h->IE(i));
-        else
-            any             = true;
+        if (slot == no_node)
+            return no_node;
 
-        new(ibuff_ptr + isize_counter) expr(std::move(tmp));
-        ++isize_counter;
+        return build_node(h, slot, children);
     };
 
-    size_t rn               = h->rsize();
-    int rsize_counter       = 0;
-
-    expr_pod::destructor_type rd(&rsize_counter);
-    sd::stack_array<expr_pod> rbuff(rn, &rd);    
-    expr* rbuff_ptr         = reinterpret_cast<expr*>(rbuff.get());
+    if (ast::details::has_any_symbol(h, m_set) == false)
+        return no_node;
 
-    for (size_t i = 0; i < h->rsize(); ++i)
+    if (h->isa<ast::add_rep>() == true)
     {
-        expr tmp            = visit(h->RE(i), sc);    
-
-        if (tmp.is_null() == true)
-            tmp             = expr(h->RE(i));
-        else
-            any             = true;
-
-        new(rbuff_ptr + rsize_counter) expr(std::move(tmp));
-        ++rsize_counter;
-    };
+        const ast::add_rep* ah  = h->static_cast_to<ast::add_rep>();
 
-    expr exp_subs;
+        for (size_t i = 0; i < ah->size(); ++i)
+            children.push_back(build(ah->E(i)));
 
-    if (h->has_exp())
+        if (ah->has_log() == true)
+            children.push_back(build(ah->Log()));
+    }
+    else if (h->isa<ast::mult_rep>() == true)
     {
-        exp_subs            = visit(h->Exp(), sc);
+        const ast::mult_rep* mh = h->static_cast_to<ast::mult_rep>();
 
-        if (exp_subs.is_null() == true)
-            exp_subs        = expr(h->Exp());
-        else
-            any             = true;
-    };
+        for (size_t i = 0; i < mh->isize(); ++i)
+            children.push_back(build(mh->IE(i)));
 
-    if (any == false)
-        return expr();
+        for (size_t i = 0; i < mh->rsize(); ++i)
+            children.push_back(build(mh->RE(i)));
 
-    expr subsexprint = ast::scalar_rep::make_one();
-
-    for (size_t i = 0; i < h->isize(); ++i)
+        if (mh->has_exp() == true)
+            children.push_back(build(mh->Exp()));
+    }
+    else if (h->isa<ast::function_rep>() == true)
     {
-        // integer powers IE(i)^IV(i)
-        expr tmp            = std::move(ibuff_ptr[i]);
-
-        if (h->IV(i) != 1)
-            tmp             = power_int(std::move(tmp), h->IV(i));
-
-        subsexprint         = std::move(subsexprint) * std::move(tmp);
-    };
+        const ast::function_rep* fh = h->static_cast_to<ast::function_rep>();
 
-    expr subsexprreal       = ast::scalar_rep::make_one();
-
-    for (size_t i = 0; i < h->rsize(); ++i)
+        for (size_t i = 0; i < fh->size(); ++i)
+            children.push_back(build(fh->arg(i)));
+    }
+    else
     {
-        // real powers RE(i)^RV(i)
-        expr tmp_base       = std::move(rbuff_ptr[i]);
-        const value& a      = h->RV(i);
-
-        expr tmp            = power_real(std::move(tmp_base), a);
-        subsexprreal        = std::move(subsexprreal) * std::move(tmp);
+        assertion(0,"expression not cannonized");
     };
 
-    expr subsexprexp        = ast::scalar_rep::make_zero();
-
-    if (h->has_exp())
-        subsexprexp         = std::move(exp_subs);
-
-    return std::move(subsexprint) * exp(std::move(subsexprexp)) * std::move(subsexprreal);
+    return build_node(h, no_node, children);
 };
 
-expr do_subs_vis::eval(const ast::function_rep* h, const subs_context& sc)
+expr subs_skeleton::make(const expr* binding) const
 {
-    size_t n                = h->size();
-
-    if (ast::details::has_any_symbol(h, sc.get_symbol_set()) == false || n == 0)       
+    if (m_root == no_node)
         return expr();
-    
-    int size_counter        = 0;
-    bool any                = false;
-
-    using expr_pod          =  sd::pod_type<expr>;
-    expr_pod::destructor_type d(&size_counter);
-    sd::stack_array<expr_pod> buff(n, &d);    
 
-    expr* buff_ptr          = reinterpret_cast<expr*>(buff.get());
+    size_t n            = m_nodes.size();
+    std::vector<expr> res(n);
 
-    for (size_t j = 0; j < n; ++j)
+    for (size_t i = 0; i < n; ++i)
     {
-        expr tmp            = visit(h->arg(j), sc);
+        const node& nd  = m_nodes[i];
 
-        if (tmp.is_null() == true)
-        {
-            tmp             = expr(h->arg(j));
-        }
-        else
+        if (nd.m_slot != no_node)
         {
-            tmp.cannonize(do_cse_default);
-            any             = true;
+            res[i]      = binding[nd.m_slot];
+            continue;
         };
 
-        new(buff_ptr + size_counter) expr(std::move(tmp));
-        ++size_counter;
-    };
+        size_t pos      = nd.m_first;
 
-    if (any == false)
-        return expr();
+        auto child      = [this, &res, &pos](ast::expr_handle e)
+        {
+            (void)e;
+            size_t k    = m_children[pos++];
+            return k == no_node ? expr() : res[k];
+        };
 
-    using info              = ast::function_rep_info;
-    info f_info             = info(h->name(), n, buff_ptr);
-    ast::expr_ptr ep        = ast::function_rep::make(f_info);
+        ast::expr_handle h  = nd.m_handle;
 
-    return expr(ep);
+        if (h->isa<ast::add_rep>() == true)
+            res[i]      = subs_add(h->static_cast_to<ast::add_rep>(), child);
+        else if (h->isa<ast::mult_rep>() == true)
+            res[i]      = subs_mult(h->static_cast_to<ast::mult_rep>(), child);
+        else
+            res[i]      = subs_function(h->static_cast_to<ast::function_rep>(), child);
+    };
+
+    return res[m_root];
 };
 
 }};
@@ -305,7 +533,7 @@ expr sym_arrow::subs(const expr& ex, const subs_context& sub)
 
     const ast::expr_base* h     = ex.get_ptr().get();
 
-    expr ret = details::do_subs_vis().visit(h, sub);
+    expr ret = details::do_subs_vis().make(h, sub);
 
     if (ret.is_null() == true)
         return ex;
@@ -313,4 +541,41 @@ expr sym_arrow::subs(const expr& ex, const subs_context& sub)
         return ret;
 };
 
+std::vector<expr> sym_arrow::subs_batch(const expr& ex, const std::vector<symbol>& syms,
+                        const std::vector<std::vector<expr>>& bindings)
+{
+    ex.cannonize(do_cse_default);
+
+    details::subs_skeleton sk(ex.get_expr_handle(), syms);
+
+    std::vector<expr> ret;
+    ret.reserve(bindings.size());
+
+    for (size_t k = 0; k < bindings.size(); ++k)
+    {
+        if (bindings[k].size() != syms.size())
+        {
+            error::error_formatter ef;
+            ef.head() << "invalid size of binding " << k;
+
+            ef.new_info();
+            ef.line() << "expecting binding of size: " << syms.size();
+
+            ef.new_info();
+            ef.line() << "supplied binding has size: " << bindings[k].size();
+
+            throw std::runtime_error(ef.str());
+        };
+
+        expr res        = sk.make(bindings[k].data());
+
+        if (res.is_null() == true)
+            ret.push_back(ex);
+        else
+            ret.push_back(std::move(res));
+    };
+
+    return ret;
+};
+
 };
\ No newline at end of file
@@ -0,0 +1,87 @@
+/* 
+ *  This file is a part of sym_arrow library.
+ *
+ *  Copyright (c) Pawe Kowal 2017 - 2021
+ *
+ *  This program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program; if not, write to the Free Software
+ *  Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA 02111-1307 USA
+ */
+
+#pragma once
+
+#include "sym_arrow/nodes/expr.h"
+#include "dbs/dbs.h"
+
+#include <vector>
+#include <unordered_map>
+
+namespace sym_arrow { namespace details
+{
+
+// nodes of an expression depending on substituted symbols; nodes are
+// sorted such that subterms precede terms; substitutions are created by
+// visiting only these nodes
+class subs_skeleton
+{
+    public:
+        using dbs       = dbs_lib::dbs;
+
+        // index of unaffected nodes
+        static const size_t no_node = size_t(-1);
+
+    private:
+        struct node
+        {
+            ast::expr_handle    m_handle;
+
+            // position of substituted symbol or no_node
+            size_t              m_slot;
+
+            // position of the first subterm in m_children
+            size_t              m_first;
+        };
+
+        using node_vec  = std::vector<node>;
+        using index_vec = std::vector<size_t>;
+        using index_map = std::unordered_map<ast::expr_handle, size_t>;
+
+    private:
+        dbs             m_set;
+        index_vec       m_slots;
+        node_vec        m_nodes;
+
+        // indices of subterms of every node in the order subterms are
+        // visited by subs_add, subs_mult and subs_function
+        index_vec       m_children;
+        size_t          m_root;
+
+        // map from handles to indices; used only during construction
+        index_map       m_map;
+
+    public:
+        subs_skeleton(ast::expr_handle h, const std::vector<symbol>& syms);
+
+        // number of nodes depending on substituted symbols
+        size_t          size() const;
+
+        // substitute symbols by expressions binding[0], ...; return null
+        // expression if the expression is not changed
+        expr            make(const expr* binding) const;
+
+    private:
+        size_t          build(ast::expr_handle h);
+        size_t          build_node(ast::expr_handle h, size_t slot, const index_vec& children);
+};
+
+}};
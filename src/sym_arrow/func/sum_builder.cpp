@@ -0,0 +1,483 @@
+/* 
+ *  This file is a part of sym_arrow library.
+ *
+ *  Copyright (c) Pawe Kowal 2017 - 2021
+ *
+ *  This program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program; if not, write to the Free Software
+ *  Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA 02111-1307 USA
+ */
+
+#include "sym_arrow/functions/sum_builder.h"
+#include "sym_arrow/functions/expr_functions.h"
+#include "sym_arrow/ast/ast.h"
+#include "sym_arrow/ast/builder/add_build.h"
+#include "sym_arrow/ast/builder/mult_build.h"
+
+#include <unordered_map>
+#include <vector>
+
+namespace sym_arrow { namespace details
+{
+
+namespace sd = sym_arrow :: details;
+
+//--------------------------------------------------------------------
+//                  sum_builder_impl
+//--------------------------------------------------------------------
+class sum_builder_impl
+{
+    private:
+        using item          = ast::build_item<value>;
+        using item_vec      = std::vector<item>;
+        using index_map     = std::unordered_map<ast::expr_handle, size_t>;
+
+    private:
+        value               m_const;
+        item_vec            m_items;
+
+        // position of a term in m_items
+        index_map           m_index;
+
+    public:
+        sum_builder_impl(size_t n);
+
+        void                add(const value& coef, const expr& ex);
+        void                add(const value& coef);
+        size_t              size() const;
+        expr                make() const;
+        void                clear();
+
+    private:
+        void                add_item(const value& coef, ast::expr_handle h);
+};
+
+sum_builder_impl::sum_builder_impl(size_t n)
+    :m_const(value::make_zero())
+{
+    m_items.reserve(n);
+    m_index.reserve(n);
+};
+
+void sum_builder_impl::add(const value& coef, const expr& ex)
+{
+    if (coef.is_zero() == true)
+        return;
+
+    ex.cannonize();
+
+    ast::expr_handle h  = ex.get_expr_handle();
+
+    if (h->isa<ast::scalar_rep>() == true)
+    {
+        m_const         = m_const + coef * h->static_cast_to<ast::scalar_rep>()->get_data();
+        return;
+    };
+
+    if (h->isa<ast::add_rep>() == true)
+    {
+        const ast::add_rep* ah  = h->static_cast_to<ast::add_rep>();
+
+        // sums with log term are not split; the log term must be
+        // combined with other log terms by cannonization
+        if (ah->has_log() == false)
+        {
+            m_const     = m_const + coef * ah->V0();
+
+            size_t n    = ah->size();
+
+            for (size_t i = 0; i < n; ++i)
+                add_item(coef * ah->V(i), ah->E(i));
+
+            return;
+        };
+    };
+
+    add_item(coef, h);
+};
+
+void sum_builder_impl::add(const value& coef)
+{
+    m_const             = m_const + coef;
+};
+
+inline void sum_builder_impl::add_item(const value& coef, ast::expr_handle h)
+{
+    auto pos            = m_index.find(h);
+
+    if (pos != m_index.end())
+    {
+        value& v        = m_items[pos->second].get_value_ref();
+        v               = v + coef;
+        return;
+    };
+
+    m_index.insert(pos, index_map::value_type(h, m_items.size()));
+    m_items.push_back(item(coef, h));
+};
+
+size_t sum_builder_impl::size() const
+{
+    return m_items.size();
+};
+
+expr sum_builder_impl::make() const
+{
+    // terms with zero coefficient are removed
+    item_vec items;
+    items.reserve(m_items.size());
+
+    for (const item& it : m_items)
+    {
+        if (it.get_value().is_zero() == false)
+            items.push_back(it);
+    };
+
+    if (items.size() == 0)
+        return expr(m_const);
+
+    ast::add_build_info2<item> bi(m_const, items.size(), items.data(), nullptr);
+
+    expr ret    = expr(ast::add_build::make(bi));
+    ret.cannonize();
+
+    return ret;
+};
+
+void sum_builder_impl::clear()
+{
+    m_const     = value::make_zero();
+    m_items.clear();
+    m_index.clear();
+};
+
+//--------------------------------------------------------------------
+//                  product_builder_impl
+//--------------------------------------------------------------------
+class product_builder_impl
+{
+    private:
+        using iitem         = ast::build_item<int>;
+        using ritem         = ast::build_item<value>;
+        using iitem_vec     = std::vector<iitem>;
+        using ritem_vec     = std::vector<ritem>;
+        using index_map     = std::unordered_map<ast::expr_handle, size_t>;
+
+    private:
+        value               m_scal;
+        iitem_vec           m_iitems;
+        ritem_vec           m_ritems;
+
+        // position of a factor in m_iitems and m_ritems
+        index_map           m_iindex;
+        index_map           m_rindex;
+
+    public:
+        product_builder_impl(size_t n);
+
+        void                mult(const expr& ex, int pow);
+        void                mult(const expr& ex, const value& pow);
+        void                mult(const value& scal);
+        size_t              size() const;
+        expr                make() const;
+        void                clear();
+
+    private:
+        void                add_item(int pow, ast::expr_handle h);
+        void                add_item(const value& pow, ast::expr_handle h);
+};
+
+product_builder_impl::product_builder_impl(size_t n)
+    :m_scal(value::make_one())
+{
+    m_iitems.reserve(n);
+    m_iindex.reserve(n);
+};
+
+void product_builder_impl::mult(const expr& ex, int pow)
+{
+    if (pow == 0)
+        return;
+
+    ex.cannonize();
+
+    ast::expr_handle h  = ex.get_expr_handle();
+
+    if (h->isa<ast::scalar_rep>() == true)
+    {
+        m_scal  = m_scal * power_int(h->static_cast_to<ast::scalar_rep>()->get_data(), pow);
+        return;
+    };
+
+    if (h->isa<ast::add_rep>() == true)
+    {
+        // scaled term a * x
+        const ast::add_rep* ah  = h->static_cast_to<ast::add_rep>();
+
+        if (ah->V0().is_zero() == false || ah->size() != 1 || ah->has_log() == true)
+            return add_item(pow, h);
+
+        m_scal  = m_scal * power_int(ah->V(0), pow);
+        h       = ah->E(0);
+    };
+
+    if (h->isa<ast::mult_rep>() == true)
+    {
+        // exp term must be combined with other exp terms by
+        // cannonization
+        const ast::mult_rep* mh = h->static_cast_to<ast::mult_rep>();
+
+        if (mh->has_exp() == true)
+            return add_item(pow, h);
+
+        size_t in   = mh->isize();
+        size_t rn   = mh->rsize();
+
+        for (size_t i = 0; i < in; ++i)
+            add_item(mh->IV(i) * pow, mh->IE(i));
+
+        for (size_t i = 0; i < rn; ++i)
+            add_item(mh->RV(i) * double(pow), mh->RE(i));
+
+        return;
+    };
+
+    add_item(pow, h);
+};
+
+void product_builder_impl::mult(const expr& ex, const value& pow)
+{
+    if (pow.is_zero() == true)
+        return;
+
+    ex.cannonize();
+
+    ast::expr_handle h  = ex.get_expr_handle();
+
+    if (h->isa<ast::scalar_rep>() == true)
+    {
+        m_scal  = m_scal * power_real(h->static_cast_to<ast::scalar_rep>()->get_data(), pow);
+        return;
+    };
+
+    // products are not split, since real power of an int power need
+    // not be a real power of the base
+    add_item(pow, h);
+};
+
+void product_builder_impl::mult(const value& scal)
+{
+    m_scal  = m_scal * scal;
+};
+
+inline void product_builder_impl::add_item(int pow, ast::expr_handle h)
+{
+    auto pos            = m_iindex.find(h);
+
+    if (pos != m_iindex.end())
+    {
+        int& v          = m_iitems[pos->second].get_value_ref();
+        v               = v + pow;
+        return;
+    };
+
+    m_iindex.insert(pos, index_map::value_type(h, m_iitems.size()));
+    m_iitems.push_back(iitem(pow, h));
+};
+
+inline void product_builder_impl::add_item(const value& pow, ast::expr_handle h)
+{
+    auto pos            = m_rindex.find(h);
+
+    if (pos != m_rindex.end())
+    {
+        value& v        = m_ritems[pos->second].get_value_ref();
+        v               = v + pow;
+        return;
+    };
+
+    m_rindex.insert(pos, index_map::value_type(h, m_ritems.size()));
+    m_ritems.push_back(ritem(pow, h));
+};
+
+size_t product_builder_impl::size() const
+{
+    return m_iitems.size() + m_ritems.size();
+};
+
+expr product_builder_impl::make() const
+{
+    if (m_scal.is_zero() == true)
+        return expr(m_scal);
+
+    // factors with zero power are removed
+    iitem_vec iitems;
+    ritem_vec ritems;
+    iitems.reserve(m_iitems.size());
+    ritems.reserve(m_ritems.size());
+
+    for (const iitem& it : m_iitems)
+    {
+        if (it.get_value() != 0)
+            iitems.push_back(it);
+    };
+
+    for (const ritem& it : m_ritems)
+    {
+        if (it.get_value().is_zero() == false)
+            ritems.push_back(it);
+    };
+
+    if (iitems.size() == 0 && ritems.size() == 0)
+        return expr(m_scal);
+
+    ast::mult_build_info<iitem, ritem> bi(iitems.size(), iitems.data(),
+                                          ritems.size(), ritems.data(), nullptr);
+
+    expr ret    = expr(ast::mult_build::make(bi));
+
+    if (m_scal.is_one() == false)
+        ret     = m_scal * std::move(ret);
+
+    ret.cannonize();
+    return ret;
+};
+
+void product_builder_impl::clear()
+{
+    m_scal      = value::make_one();
+    m_iitems.clear();
+    m_ritems.clear();
+    m_iindex.clear();
+    m_rindex.clear();
+};
+
+}};
+
+namespace sym_arrow
+{
+
+//--------------------------------------------------------------------
+//                  sum_builder
+//--------------------------------------------------------------------
+sum_builder::sum_builder()
+    :m_impl(new details::sum_builder_impl(0))
+{};
+
+sum_builder::sum_builder(size_t n)
+    :m_impl(new details::sum_builder_impl(n))
+{};
+
+sum_builder::sum_builder(sum_builder&& other)
+    :m_impl(std::move(other.m_impl))
+{};
+
+sum_builder& sum_builder::operator=(sum_builder&& other)
+{
+    m_impl = std::move(other.m_impl);
+    return *this;
+};
+
+sum_builder::~sum_builder()
+{};
+
+void sum_builder::add(const expr& ex)
+{
+    m_impl->add(value::make_one(), ex);
+};
+
+void sum_builder::add(const value& coef, const expr& ex)
+{
+    m_impl->add(coef, ex);
+};
+
+void sum_builder::add(const value& coef)
+{
+    m_impl->add(coef);
+};
+
+size_t sum_builder::size() const
+{
+    return m_impl->size();
+};
+
+expr sum_builder::make() const
+{
+    return m_impl->make();
+};
+
+void sum_builder::clear()
+{
+    m_impl->clear();
+};
+
+//--------------------------------------------------------------------
+//                  product_builder
+//--------------------------------------------------------------------
+product_builder::product_builder()
+    :m_impl(new details::product_builder_impl(0))
+{};
+
+product_builder::product_builder(size_t n)
+    :m_impl(new details::product_builder_impl(n))
+{};
+
+product_builder::product_builder(product_builder&& other)
+    :m_impl(std::move(other.m_impl))
+{};
+
+product_builder& product_builder::operator=(product_builder&& other)
+{
+    m_impl = std::move(other.m_impl);
+    return *this;
+};
+
+product_builder::~product_builder()
+{};
+
+void product_builder::mult(const expr& ex)
+{
+    m_impl->mult(ex, 1);
+};
+
+void product_builder::mult(const expr& ex, int pow)
+{
+    m_impl->mult(ex, pow);
+};
+
+void product_builder::mult(const expr& ex, const value& pow)
+{
+    m_impl->mult(ex, pow);
+};
+
+void product_builder::mult(const value& scal)
+{
+    m_impl->mult(scal);
+};
+
+size_t product_builder::size() const
+{
+    return m_impl->size();
+};
+
+expr product_builder::make() const
+{
+    return m_impl->make();
+};
+
+void product_builder::clear()
+{
+    m_impl->clear();
+};
+
+};
@@ -25,6 +25,7 @@
 #include "compound.h"
 #include "sym_arrow/ast/ast.h"
 #include "sym_arrow/functions/expr_functions.h"
+#include "sym_arrow/ast/helpers/expr_order.h"
 
 namespace sym_arrow { namespace details
 {
@@ -69,6 +70,5 @@ sym_arrow::expr sym_arrow::abs(expr&& a0)
 
 size_t sym_arrow::hash_value(const expr& ex)
 {
-    size_t seed = (size_t)ex.get_ptr().get();    
-    return seed;
+    return ast::expr_order::hash(ex.get_ptr().get());
 };
@@ -56,7 +56,7 @@ struct calculate_code_bits
 template<class Tag>
 struct calculate_flag_bits
 {
-    static const size_t max         = 3;
+    static const size_t max         = 4;
     static const size_t value       = dag_tag_traits<Tag>::user_flag_bits;
 
     static_assert(value <= max, "too many bits of uset flags in dag_item");
@@ -0,0 +1,235 @@
+/* 
+ *  This file is a part of sym_arrow library.
+ *
+ *  Copyright (c) Pawe Kowal 2017 - 2021
+ *
+ *  This program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program; if not, write to the Free Software
+ *  Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA 02111-1307 USA
+ */
+
+#pragma once
+
+#include "sym_arrow/utils/double_double.h"
+#include <cmath>
+
+namespace sym_arrow { namespace details
+{
+
+// s + e = a + b exactly
+inline double two_sum(double a, double b, double& e)
+{
+    double s    = a + b;
+    double bb   = s - a;
+    e           = (a - (s - bb)) + (b - bb);
+
+    return s;
+};
+
+// s + e = a + b exactly, assuming |a| >= |b|
+inline double quick_two_sum(double a, double b, double& e)
+{
+    double s    = a + b;
+    e           = b - (s - a);
+
+    return s;
+};
+
+// p + e = a * b exactly
+inline double two_prod(double a, double b, double& e)
+{
+    double p    = a * b;
+    e           = std::fma(a, b, -p);
+
+    return p;
+};
+
+}};
+
+namespace sym_arrow
+{
+
+//---------------------------------------------------------------------
+//                  double_double
+//---------------------------------------------------------------------
+inline double_double::double_double(double x)
+    :m_hi(x), m_lo(0.0)
+{};
+
+inline double_double::double_double(double hi, double lo)
+    :m_hi(hi), m_lo(lo)
+{};
+
+inline double_double& double_double::operator+=(const double_double& x)
+{
+    return *this = *this + x;
+};
+
+inline double_double& double_double::operator-=(const double_double& x)
+{
+    return *this = *this - x;
+};
+
+inline double_double& double_double::operator*=(const double_double& x)
+{
+    return *this = *this * x;
+};
+
+inline double_double& double_double::operator/=(const double_double& x)
+{
+    return *this = *this / x;
+};
+
+//---------------------------------------------------------------------
+//                  arithmetic
+//---------------------------------------------------------------------
+inline double_double operator-(const double_double& x)
+{
+    return double_double(-x.hi(), -x.lo());
+};
+
+inline double_double operator+(const double_double& a, const double_double& b)
+{
+    double e, f;
+    double s    = details::two_sum(a.hi(), b.hi(), e);
+    double t    = details::two_sum(a.lo(), b.lo(), f);
+
+    e           += t;
+    s           = details::quick_two_sum(s, e, e);
+    e           += f;
+    s           = details::quick_two_sum(s, e, e);
+
+    return double_double(s, e);
+};
+
+inline double_double operator+(const double_double& a, double b)
+{
+    double e;
+    double s    = details::two_sum(a.hi(), b, e);
+
+    e           += a.lo();
+    s           = details::quick_two_sum(s, e, e);
+
+    return double_double(s, e);
+};
+
+inline double_double operator+(double a, const double_double& b)
+{
+    return b + a;
+};
+
+inline double_double operator-(const double_double& a, const double_double& b)
+{
+    return a + (-b);
+};
+
+inline double_double operator-(const double_double& a, double b)
+{
+    return a + (-b);
+};
+
+inline double_double operator-(double a, const double_double& b)
+{
+    return (-b) + a;
+};
+
+inline double_double operator*(const double_double& a, const double_double& b)
+{
+    double e;
+    double p    = details::two_prod(a.hi(), b.hi(), e);
+
+    e           += a.hi() * b.lo() + a.lo() * b.hi();
+    p           = details::quick_two_sum(p, e, e);
+
+    return double_double(p, e);
+};
+
+inline double_double operator*(const double_double& a, double b)
+{
+    double e;
+    double p    = details::two_prod(a.hi(), b, e);
+
+    e           += a.lo() * b;
+    p           = details::quick_two_sum(p, e, e);
+
+    return double_double(p, e);
+};
+
+inline double_double operator*(double a, const double_double& b)
+{
+    return b * a;
+};
+
+inline double_double operator/(const double_double& a, const double_double& b)
+{
+    // long division; every step gives next 53 bits of the quotient
+    double q1       = a.hi() / b.hi();
+    double_double r = a - b * q1;
+
+    double q2       = r.hi() / b.hi();
+    r               = r - b * q2;
+
+    double q3       = r.hi() / b.hi();
+
+    double e;
+    q1              = details::quick_two_sum(q1, q2, e);
+
+    return double_double(q1, e) + q3;
+};
+
+inline double_double operator/(const double_double& a, double b)
+{
+    return a / double_double(b);
+};
+
+inline double_double operator/(double a, const double_double& b)
+{
+    return double_double(a) / b;
+};
+
+inline bool operator==(const double_double& a, const double_double& b)
+{
+    return a.hi() == b.hi() && a.lo() == b.lo();
+};
+
+inline bool operator!=(const double_double& a, const double_double& b)
+{
+    return (a == b) == false;
+};
+
+inline bool operator<(const double_double& a, const double_double& b)
+{
+    return a.hi() < b.hi() || (a.hi() == b.hi() && a.lo() < b.lo());
+};
+
+inline bool operator>(const double_double& a, const double_double& b)
+{
+    return b < a;
+};
+
+inline bool operator<=(const double_double& a, const double_double& b)
+{
+    return (b < a) == false;
+};
+
+inline bool operator>=(const double_double& a, const double_double& b)
+{
+    return (a < b) == false;
+};
+
+inline double_double abs(const double_double& x)
+{
+    return (x.hi() < 0.0) ? -x : x;
+};
+
+};
@@ -0,0 +1,63 @@
+/* 
+ *  This file is a part of sym_arrow library.
+ *
+ *  Copyright (c) Pawe Kowal 2017 - 2021
+ *
+ *  This program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program; if not, write to the Free Software
+ *  Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA 02111-1307 USA
+ */
+
+#pragma once
+
+#include "sym_arrow/functions/static_eval.h"
+
+namespace sym_arrow { namespace details
+{
+
+template<class Provider>
+value eval_function_static(const void* provider, size_t name_code, const value* args,
+                           size_t n_size)
+{
+    const Provider* dp  = static_cast<const Provider*>(provider);
+    return dp->eval_function(name_code, args, n_size);
+};
+
+// set_mask is optional in Provider
+template<class Provider>
+auto get_set_mask(const Provider& dp, int) -> decltype(dp.set_mask())
+{
+    return dp.set_mask();
+};
+
+template<class Provider>
+const unsigned char* get_set_mask(const Provider&, long)
+{
+    return nullptr;
+};
+
+}};
+
+namespace sym_arrow
+{
+
+template<class Provider>
+typename std::enable_if<std::is_base_of<data_provider, Provider>::value == false, value>::type
+eval(const expr& ex, const Provider& dp)
+{
+    return details::eval_indexed(ex, dp.values(), dp.size(), 
+                                 details::get_set_mask(dp, 0), &dp,
+                                 &details::eval_function_static<Provider>);
+};
+
+};
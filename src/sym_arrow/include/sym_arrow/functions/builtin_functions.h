@@ -0,0 +1,61 @@
+/* 
+ *  This file is a part of sym_arrow library.
+ *
+ *  Copyright (c) Pawe Kowal 2017 - 2021
+ *
+ *  This program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program; if not, write to the Free Software
+ *  Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA 02111-1307 USA
+ */
+
+#pragma once
+
+#include "sym_arrow/config.h"
+#include "sym_arrow/fwd_decls.h"
+#include "sym_arrow/nodes/expr.h"
+
+namespace sym_arrow
+{
+
+// builtin elementary functions; these functions are represented by
+// function nodes with reserved names ($sin, $cos, $tanh, $erf, $atan2,
+// $logistic, $sqrt), that cannot be used by user symbols; derivatives are
+// computed without a diff_context and values without calling
+// data_provider::eval_function; functions of scalars are evaluated
+// immediately; functions created by the function function or parsed from
+// a string, for example sin[x], are user functions even if they have
+// the same name as a builtin function
+
+// sine function
+expr SYM_ARROW_EXPORT    sin(const expr& x);
+
+// cosine function
+expr SYM_ARROW_EXPORT    cos(const expr& x);
+
+// hyperbolic tangent
+expr SYM_ARROW_EXPORT    tanh(const expr& x);
+
+// error function
+expr SYM_ARROW_EXPORT    erf(const expr& x);
+
+// square root; NaN for negative x; note that power_real(x, 0.5) is
+// the square root of |x|
+expr SYM_ARROW_EXPORT    sqrt(const expr& x);
+
+// arc tangent of y/x using signs of arguments to determine the quadrant
+expr SYM_ARROW_EXPORT    atan2(const expr& y, const expr& x);
+
+// logistic function 1 / (1 + exp(-x))
+expr SYM_ARROW_EXPORT    logistic(const expr& x);
+
+};
@@ -0,0 +1,97 @@
+/* 
+ *  This file is a part of sym_arrow library.
+ *
+ *  Copyright (c) Pawe Kowal 2017 - 2021
+ *
+ *  This program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program; if not, write to the Free Software
+ *  Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA 02111-1307 USA
+ */
+
+#pragma once
+
+#include "sym_arrow/nodes/expr.h"
+#include "sym_arrow/functions/contexts.h"
+#include "sym_arrow/utils/double_double.h"
+
+#include <vector>
+#include <memory>
+#include <complex>
+
+#pragma warning(push)
+#pragma warning(disable:4251)    //needs to have dll-interface
+
+namespace sym_arrow
+{
+
+// vector of expressions compiled to a sequence of instructions operating
+// on doubles or other numeric types; compilation is cached, i.e.
+// compiling again the same expressions with the same inputs reuses
+// existing code; expressions are cannonized first
+class SYM_ARROW_EXPORT compiled_expr
+{
+    private:
+        using impl_type = std::shared_ptr<const details::compiled_expr_impl>;
+
+    private:
+        impl_type       m_impl;
+
+    public:
+        // compile expressions ex; expressions can depend only on symbols
+        // from inputs
+        compiled_expr(const std::vector<expr>& ex, const std::vector<symbol>& inputs);
+
+        // compile single expression
+        compiled_expr(const expr& ex, const std::vector<symbol>& inputs);
+
+        // number of input symbols
+        size_t          num_inputs() const;
+
+        // number of compiled expressions
+        size_t          num_outputs() const;
+
+        // number of instructions
+        size_t          num_instructions() const;
+
+        // evaluate expressions; in is an array of values of input
+        // symbols; results are stored in the array out of length
+        // num_outputs(); user functions are evaluated by dp
+        void            eval(const double* in, double* out,
+                            const data_provider& dp) const;
+
+        // evaluate expressions at n_points points; value of i-th input at
+        // j-th point is in[i * n_points + j] and value of i-th expression
+        // is stored in out[i * n_points + j]
+        void            eval(size_t n_points, const double* in, double* out,
+                            const data_provider& dp) const;
+
+        // evaluate expressions in numeric type T, which is one of float,
+        // double, long double, std::complex<double> and double_double;
+        // scalars are converted to T once, when expressions are compiled;
+        // log and real powers act on absolute values as for doubles,
+        // sqrt of a complex number is the principal square root;
+        // user functions are evaluated by dp in double precision and are
+        // not available for complex numbers, as well as erf and atan2
+        template<class T>
+        void            eval(const T* in, T* out, const data_provider& dp) const;
+
+        // evaluate expressions at n_points points in numeric type T;
+        // layout of in and out as for doubles
+        template<class T>
+        void            eval(size_t n_points, const T* in, T* out,
+                            const data_provider& dp) const;
+};
+
+};
+
+#pragma warning(pop)
@@ -25,6 +25,7 @@
 
 #include <map>
 #include <memory>
+#include <vector>
 
 #pragma warning(push)
 #pragma warning(disable:4251)    //needs to have dll-interface
@@ -120,6 +121,11 @@ class SYM_ARROW_EXPORT subs_context
         // if substitution is not defined
         expr            subs(const symbol& sh) const;
 
+        // get substitution for a symbol with code sym_code (as returned
+        // by symbol_rep::get_symbol_code); return empty expression if
+        // substitution is not defined
+        expr            subs(size_t sym_code) const;
+
         // visit stored substitution
         void            visit_substitutions(substitution_vis& info) const;
 
@@ -150,6 +156,14 @@ class SYM_ARROW_EXPORT diff_context
         expr            diff(const symbol& func_name, size_t arg_num, const expr* args,
                             size_t n_args);
 
+        // get differentiation rule d/dx_i f[x0, ..., xn] -> dif[x0, ..., xn]
+        // for a function 'func_name' with n_args arguments and i = arg_num;
+        // return dif and set rule_args to x0, ..., xn; return empty
+        // expression if appropriate diff rule is not defined; no expression
+        // is created
+        expr            get_diff_rule(const symbol& func_name, size_t arg_num,
+                            size_t n_args, std::vector<symbol>& rule_args) const;
+
         // add differentiation rule d/dx_i f[x0, ..., xn] -> dif[x0, ..., xn]
         void            add_diff_rule(const symbol& func_name, size_t n_args,
                             const symbol* args, size_t diff_arg, const expr& dif);
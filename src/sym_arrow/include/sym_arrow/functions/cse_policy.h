@@ -0,0 +1,98 @@
+/* 
+ *  This file is a part of sym_arrow library.
+ *
+ *  Copyright (c) Pawe Kowal 2017 - 2021
+ *
+ *  This program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program; if not, write to the Free Software
+ *  Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA 02111-1307 USA
+ */
+
+#pragma once
+
+#include "sym_arrow/config.h"
+#include "sym_arrow/fwd_decls.h"
+
+namespace sym_arrow
+{
+
+// limits of common subexpression elimination (i.e. factorization of
+// sums) performed during cannonization; by default there are no limits
+class SYM_ARROW_EXPORT cse_policy
+{
+    private:
+        size_t          m_max_rounds;
+        size_t          m_max_group_size;
+        size_t          m_work_budget;
+        double          m_time_limit;
+
+    public:
+        // create policy without limits
+        cse_policy();
+
+        // set maximum number of factorization rounds performed on one sum
+        cse_policy&     set_max_rounds(size_t n);
+
+        // set maximum number of subexpressions factored out in one round
+        cse_policy&     set_max_group_size(size_t n);
+
+        // set maximum work, measured as number of compared items, done
+        // during the whole cannonization
+        cse_policy&     set_work_budget(size_t n);
+
+        // set maximum time in seconds spent on factorization during the
+        // whole cannonization; negative value means no limit
+        cse_policy&     set_time_limit(double sec);
+
+        size_t          get_max_rounds() const      { return m_max_rounds; };
+        size_t          get_max_group_size() const  { return m_max_group_size; };
+        size_t          get_work_budget() const     { return m_work_budget; };
+        double          get_time_limit() const      { return m_time_limit; };
+
+        // return true if there are no limits
+        bool            is_unlimited() const;
+};
+
+// summary of common subexpression elimination performed with given
+// cse_policy
+struct SYM_ARROW_EXPORT cse_report
+{
+    // number of factorization rounds
+    size_t              m_rounds;
+
+    // work done measured as number of compared items
+    size_t              m_work;
+
+    // number of sums, for which factorization was stopped because of
+    // the round limit
+    size_t              m_round_limited;
+
+    // number of factorizations, for which group of subexpressions
+    // was truncated
+    size_t              m_group_limited;
+
+    // true if work budget was exceeded
+    bool                m_work_exceeded;
+
+    // true if time limit was exceeded
+    bool                m_time_exceeded;
+
+    // create empty report
+    cse_report();
+
+    // return true if no limit was reached, i.e. the result is the same
+    // as without limits
+    bool                is_complete() const;
+};
+
+};
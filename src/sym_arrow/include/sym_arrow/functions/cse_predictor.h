@@ -0,0 +1,144 @@
+/* 
+ *  This file is a part of sym_arrow library.
+ *
+ *  Copyright (c) Pawe Kowal 2017 - 2021
+ *
+ *  This program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program; if not, write to the Free Software
+ *  Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA 02111-1307 USA
+ */
+
+#pragma once
+
+#include "sym_arrow/config.h"
+#include "sym_arrow/fwd_decls.h"
+
+#include <memory>
+
+#pragma warning(push)
+#pragma warning(disable:4251)    //needs to have dll-interface
+
+namespace sym_arrow
+{
+
+// data observed after common subexpression elimination of a sum
+struct SYM_ARROW_EXPORT cse_observation
+{
+    // true if hash table of previous results was checked
+    bool                m_checked;
+
+    // true if result was found in the hash table
+    bool                m_hit;
+
+    // true if the sum was factorized or result was found in the hash
+    // table
+    bool                m_factorized;
+
+    // time in seconds spent on hash table lookup; zero if hash table
+    // was not checked
+    double              m_lookup_time;
+
+    // time in seconds spent on factorization; zero if factorization
+    // was not performed
+    double              m_fact_time;
+};
+
+// statistics of predictions made by a cse predictor
+struct SYM_ARROW_EXPORT cse_predictor_stats
+{
+    // number of predictions
+    size_t              m_predictions;
+
+    // number of predictions different than observed factorization
+    size_t              m_errors;
+
+    // number of hash table lookups
+    size_t              m_checks;
+
+    // number of successful hash table lookups
+    size_t              m_hits;
+
+    // number of performed factorizations
+    size_t              m_factorizations;
+
+    // total time of hash table lookups
+    double              m_lookup_time;
+
+    // total time of factorizations
+    double              m_fact_time;
+
+    // estimated net time saved by the hash table, i.e. number of hits
+    // times mean factorization time minus time of all lookups; time of
+    // successful lookups is also spent instead of a factorization
+    double              m_saved_time;
+
+    // create empty statistics
+    cse_predictor_stats();
+
+    // fraction of correct predictions
+    double              accuracy() const;
+};
+
+// strategy deciding if result of common subexpression elimination of
+// a sum should be looked up in a hash table of previous results; lookup
+// requires building the sum before factorization
+class SYM_ARROW_EXPORT cse_predictor
+{
+    public:
+        virtual ~cse_predictor() {};
+
+        // return true if the hash table should be checked; level is the
+        // nesting level of cannonization calls
+        virtual bool    get_prediction(int level) = 0;
+
+        // report observation after prediction made at given level
+        virtual void    add_observation(int level, const cse_observation& obs) = 0;
+};
+
+// predictor used by default; probability of factorization is estimated
+// from last n_lags observations using Dirichlet priors; num_levels
+// independent predictors are used for different nesting levels; old
+// observations are forgotten at rate given by variance_scal
+std::shared_ptr<cse_predictor> SYM_ARROW_EXPORT
+                        make_cse_predictor_dirichlet(int num_levels = 5,
+                            double variance_scal = 0.995);
+
+// predictor always returning given value
+std::shared_ptr<cse_predictor> SYM_ARROW_EXPORT
+                        make_cse_predictor_const(bool value);
+
+// predictor comparing expected gain (hit rate times mean factorization
+// time) with mean lookup time; estimates are updated with exponential
+// weights given by decay; every explore_period-th prediction is true
+// in order to update hit rate estimates
+std::shared_ptr<cse_predictor> SYM_ARROW_EXPORT
+                        make_cse_predictor_cost_model(double decay = 0.95,
+                            int explore_period = 32);
+
+// set predictor used by cannonization; statistics are not reset
+void SYM_ARROW_EXPORT   set_cse_predictor(const std::shared_ptr<cse_predictor>& pred);
+
+// get predictor used by cannonization
+std::shared_ptr<cse_predictor> SYM_ARROW_EXPORT
+                        get_cse_predictor();
+
+// get statistics of predictions made since last reset
+cse_predictor_stats SYM_ARROW_EXPORT
+                        get_cse_predictor_stats();
+
+// reset statistics of predictions
+void SYM_ARROW_EXPORT   reset_cse_predictor_stats();
+
+};
+
+#pragma warning(pop)
@@ -0,0 +1,53 @@
+/* 
+ *  This file is a part of sym_arrow library.
+ *
+ *  Copyright (c) Pawe Kowal 2017 - 2021
+ *
+ *  This program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program; if not, write to the Free Software
+ *  Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA 02111-1307 USA
+ */
+
+#pragma once
+
+#include "sym_arrow/nodes/expr.h"
+
+namespace sym_arrow
+{
+
+// incremental update of cannonized sums and products; result is the
+// same as result of cannonize(false) called on the edited expression,
+// but sorted terms of ex are reused; common subexpressions are not
+// eliminated; if ex or t are not cannonized, then they are cannonized
+// first without cse
+
+// return ex + c * t
+expr SYM_ARROW_EXPORT   insert_term(const expr& ex, const value& c, const expr& t);
+
+// remove term t from a sum ex, i.e. return ex - c * t, where c is the
+// coefficient of t in ex; coef is set to c; if ex does not contain the
+// term t, then ex is returned and coef is zero
+expr SYM_ARROW_EXPORT   remove_term(const expr& ex, const expr& t, value& coef);
+
+// return c * ex
+expr SYM_ARROW_EXPORT   scale(const expr& ex, const value& c);
+
+// return ex * t^p
+expr SYM_ARROW_EXPORT   insert_factor(const expr& ex, const expr& t, int p);
+
+// remove factor t^p from a product ex, i.e. return ex * t^-p, where p is
+// the integer power of t in ex; pow is set to p; if ex does not contain
+// an integer power of t, then ex is returned and pow is zero
+expr SYM_ARROW_EXPORT   remove_factor(const expr& ex, const expr& t, int& pow);
+
+};
@@ -23,6 +23,11 @@
 #include "sym_arrow/nodes/expr.h"
 #include "sym_arrow/functions/contexts.h"
 
+#include <vector>
+#include <string>
+#include <utility>
+#include <iosfwd>
+
 namespace sym_arrow
 {
 
@@ -47,6 +52,25 @@ std::string SYM_ARROW_EXPORT
 // create expression for a string representation
 expr SYM_ARROW_EXPORT    parse(const std::string& expression_string);
 
+// create expression for a string representation given by an array
+// of characters of length size; array need not be null terminated
+expr SYM_ARROW_EXPORT    parse(const char* str, size_t size);
+
+// expression together with its name; name is empty if expression
+// is not named
+using named_expr        = std::pair<std::string, expr>;
+
+// parse all expressions stored in a file; each line contains one
+// expression or a statement of the form name = expr; statements can
+// also be separated by semicolons; statement can span many lines if
+// a continuation ... is used or brackets are not closed
+std::vector<named_expr> SYM_ARROW_EXPORT
+                        parse_file(const std::string& file_name);
+
+// parse all expressions read from a stream; the same as parse_file
+std::vector<named_expr> SYM_ARROW_EXPORT
+                        parse_stream(std::istream& is);
+
 // differentiation with respect a symbol sym
 expr SYM_ARROW_EXPORT    diff(const expr& ex, const symbol& sym, 
                             const diff_context& dif = global_diff_context());
@@ -62,12 +86,43 @@ expr SYM_ARROW_EXPORT    subs(const expr& ex, const symbol& sym, const expr& sub
 // stored in sub context
 expr SYM_ARROW_EXPORT    subs(const expr& ex, const subs_context& sub);
 
+// substitute symbols syms[i] by expressions bindings[k][i] for every k;
+// nodes of ex depending on symbols syms are found once and only these
+// nodes are visited for every binding; every binding must have the same
+// size as syms
+std::vector<expr> SYM_ARROW_EXPORT
+                        subs_batch(const expr& ex, const std::vector<symbol>& syms,
+                            const std::vector<std::vector<expr>>& bindings);
+
 // evaluate and expression
 value SYM_ARROW_EXPORT   eval(const expr& ex, const data_provider& dp);
 
+// generate C source code of a function
+//     void func_name(const double* x, double* y, const sym_arrow_func* f)
+// evaluating expressions ex; x[i] is the value of inputs[i], results are
+// stored in y; f[k] is a pointer to the k-th user function (functions
+// are listed in a comment in generated code), builtin functions are
+// evaluated by functions from math.h; common subexpressions are
+// evaluated once; expressions can depend only on symbols from inputs
+void SYM_ARROW_EXPORT    codegen_c(const std::vector<expr>& ex,
+                            const std::vector<symbol>& inputs, std::ostream& os,
+                            const std::string& func_name = "eval_expr");
+
 // perform simplifications
 expr SYM_ARROW_EXPORT    simplify(const expr& ex);
 
+// expand expression; products are distributed over sums and positive
+// integer powers of sums are expanded; negative powers, real powers,
+// exp and log terms and arguments of functions are not expanded; result
+// is cannonized without common subexpression elimination, which would
+// factor the polynomial again
+expr SYM_ARROW_EXPORT    expand(const expr& ex);
+
+// expand expression and group terms by monomials in symbols syms, i.e.
+// return sum_k m_k * c_k, where m_k are distinct monomials in syms and
+// c_k do not depend on syms except through atoms, that are not expanded
+expr SYM_ARROW_EXPORT    collect(const expr& ex, const std::vector<symbol>& syms);
+
 // check internal representation; for debug purpose only
 bool SYM_ARROW_EXPORT    check_expression(const expr& ex);
 
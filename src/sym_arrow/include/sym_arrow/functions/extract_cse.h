@@ -0,0 +1,77 @@
+/* 
+ *  This file is a part of sym_arrow library.
+ *
+ *  Copyright (c) Pawe Kowal 2017 - 2021
+ *
+ *  This program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program; if not, write to the Free Software
+ *  Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA 02111-1307 USA
+ */
+
+#pragma once
+
+#include "sym_arrow/nodes/expr.h"
+
+#include <vector>
+#include <string>
+
+#pragma warning(push)
+#pragma warning(disable:4251)    //needs to have dll-interface
+
+namespace sym_arrow
+{
+
+// straight-line program evaluating a vector of expressions; repeated
+// subexpressions are evaluated once and assigned to temporaries
+struct SYM_ARROW_EXPORT cse_program
+{
+    // temporary symbols
+    std::vector<symbol>     m_temps;
+
+    // definitions of temporaries; k-th definition can depend only on
+    // inputs and temporaries 0, ..., k-1
+    std::vector<expr>       m_temp_values;
+
+    // expressions depending on inputs and temporaries
+    std::vector<expr>       m_outputs;
+
+    // number of operations required to evaluate all expressions
+    // separately
+    size_t                  m_ops_before;
+
+    // number of operations required to evaluate all temporaries and
+    // outputs
+    size_t                  m_ops_after;
+
+    // create empty program
+    cse_program();
+};
+
+// find common subexpressions in expressions ex and create straight-line
+// program evaluating these expressions; subexpression is assigned to a
+// temporary if it is used at least twice in the union of all expressions
+// and is not an atom; names of temporaries are temp_prefix1,
+// temp_prefix2, ..., names of symbols appearing in ex are skipped;
+// expressions are cannonized first
+cse_program SYM_ARROW_EXPORT
+                        extract_cse(const std::vector<expr>& ex,
+                            const std::string& temp_prefix = "cse_");
+
+// number of arithmetic operations and function calls required to
+// evaluate an expression; common subexpressions are evaluated many
+// times; expression is cannonized first
+size_t SYM_ARROW_EXPORT count_ops(const expr& ex);
+
+};
+
+#pragma warning(pop)
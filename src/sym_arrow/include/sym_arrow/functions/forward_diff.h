@@ -0,0 +1,80 @@
+/* 
+ *  This file is a part of sym_arrow library.
+ *
+ *  Copyright (c) Pawe Kowal 2017 - 2021
+ *
+ *  This program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program; if not, write to the Free Software
+ *  Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA 02111-1307 USA
+ */
+
+#pragma once
+
+#include "sym_arrow/config.h"
+#include "sym_arrow/fwd_decls.h"
+#include "sym_arrow/nodes/value.h"
+#include "sym_arrow/functions/contexts.h"
+
+#include <vector>
+
+namespace sym_arrow
+{
+
+// value of an expression and its first order directional derivative
+struct SYM_ARROW_EXPORT dual_value
+{
+    // value of the expression
+    value               m_value;
+
+    // derivative in direction dir, i.e. grad' * dir
+    value               m_dif;
+};
+
+// value of an expression and its first and second order directional
+// derivatives
+struct SYM_ARROW_EXPORT hyper_dual_value
+{
+    // value of the expression
+    value               m_value;
+
+    // derivative in direction dir1, i.e. grad' * dir1
+    value               m_dif1;
+
+    // derivative in direction dir2, i.e. grad' * dir2
+    value               m_dif2;
+
+    // second order derivative dir1' * H * dir2, where H is the hessian
+    value               m_dif12;
+};
+
+// evaluate an expression and its derivative in direction dir using
+// forward mode differentiation on dual numbers; values of symbols and
+// user functions are given by dp; dir[i] is the direction of symbol
+// syms[i], other symbols have zero direction; no expressions are created
+// except derivatives of user functions, which are defined by dc
+dual_value SYM_ARROW_EXPORT
+                        eval_dual(const expr& ex, const data_provider& dp,
+                            const std::vector<symbol>& syms, const std::vector<value>& dir,
+                            const diff_context& dc = global_diff_context());
+
+// evaluate an expression, its derivatives in directions dir1 and dir2
+// and the second order derivative dir1' * H * dir2 using hyper-dual
+// numbers; setting dir1 = dir2 = e_k gives the second derivative with
+// respect to syms[k]; other arguments as in eval_dual
+hyper_dual_value SYM_ARROW_EXPORT
+                        eval_hyper_dual(const expr& ex, const data_provider& dp,
+                            const std::vector<symbol>& syms, const std::vector<value>& dir1,
+                            const std::vector<value>& dir2,
+                            const diff_context& dc = global_diff_context());
+
+};
@@ -0,0 +1,86 @@
+/* 
+ *  This file is a part of sym_arrow library.
+ *
+ *  Copyright (c) Pawe Kowal 2017 - 2021
+ *
+ *  This program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program; if not, write to the Free Software
+ *  Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA 02111-1307 USA
+ */
+
+#pragma once
+
+#include "sym_arrow/config.h"
+#include "sym_arrow/fwd_decls.h"
+#include "sym_arrow/nodes/value.h"
+
+#include <vector>
+
+#pragma warning(push)
+#pragma warning(disable:4251)    //needs to have dll-interface
+
+namespace sym_arrow
+{
+
+// closed interval [m_lower, m_upper]; bounds can be infinite
+struct SYM_ARROW_EXPORT interval
+{
+    value               m_lower;
+    value               m_upper;
+
+    // create interval [0, 0]
+    interval();
+
+    // create interval [lower, upper]
+    interval(const value& lower, const value& upper);
+
+    // return true if x is in this interval
+    bool                contains(const value& x) const;
+};
+
+// define intervals of symbols and enclosures of functions
+class SYM_ARROW_EXPORT interval_provider
+{
+    public:
+        virtual ~interval_provider() {};
+
+        // return interval of values of a symbol sh
+        virtual interval    get_interval(const symbol& sh) const = 0;
+
+        // return interval containing all values of a function with
+        // n_size arguments in intervals stored in the array args
+        virtual interval    eval_function(const symbol& name, const interval* args,
+                                size_t n_size) const = 0;
+};
+
+// return interval containing all values of an expression when symbols
+// take values in intervals given by ip; bounds are rounded outward;
+// values of distinct subexpressions are computed once, but dependencies
+// between subexpressions are not taken into account, therefore the
+// interval can be wider than the range of ex
+interval SYM_ARROW_EXPORT
+                        eval_interval(const expr& ex, const interval_provider& ip);
+
+// bound values of an expression over many boxes; boxes[k][i] is the
+// interval of syms[i] in the k-th box; intervals of other symbols and
+// enclosures of user functions are given by ip; the expression is
+// traversed once for a block of boxes and every operation is applied to
+// all boxes in the block
+std::vector<interval> SYM_ARROW_EXPORT
+                        eval_interval(const expr& ex, const std::vector<symbol>& syms,
+                            const std::vector<std::vector<interval>>& boxes,
+                            const interval_provider& ip);
+
+};
+
+#pragma warning(pop)
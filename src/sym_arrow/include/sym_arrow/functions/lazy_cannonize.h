@@ -0,0 +1,61 @@
+/* 
+ *  This file is a part of sym_arrow library.
+ *
+ *  Copyright (c) Pawe Kowal 2017 - 2021
+ *
+ *  This program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program; if not, write to the Free Software
+ *  Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA 02111-1307 USA
+ */
+
+#pragma once
+
+#include "sym_arrow/config.h"
+#include "sym_arrow/fwd_decls.h"
+
+namespace sym_arrow
+{
+
+// level of cannonization reached by an expression
+enum class cannonize_level
+{
+    // additive or multiplicative terms are not built yet
+    none,
+
+    // expression is cannonized without common subexpression elimination
+    light,
+
+    // expression is cannonized with common subexpression elimination
+    full
+};
+
+// if val is true, then lazy cannonization is used; in this mode
+// subexpressions formed when new expressions are built and expressions
+// passed to eval are cannonized without common subexpression elimination;
+// the full cannonical form is materialized when an operation requires
+// cannonical structure (disp, subs, diff, comparisons, etc.) or when
+// expr::cannonize(true) is called, also for expressions already cannonized
+// in light mode; common subexpression elimination is then performed on all
+// subexpressions, therefore the full cannonical form does not depend on
+// whether lazy cannonization was used; by default lazy cannonization is
+// disabled
+void SYM_ARROW_EXPORT   set_lazy_cannonization(bool val);
+
+// return true if lazy cannonization is used
+bool SYM_ARROW_EXPORT   get_lazy_cannonization();
+
+// return level of cannonization reached by an expression
+cannonize_level SYM_ARROW_EXPORT
+                        get_cannonize_level(const expr& ex);
+
+};
@@ -0,0 +1,42 @@
+/* 
+ *  This file is a part of sym_arrow library.
+ *
+ *  Copyright (c) Pawe Kowal 2017 - 2021
+ *
+ *  This program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program; if not, write to the Free Software
+ *  Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA 02111-1307 USA
+ */
+
+#pragma once
+
+#include "sym_arrow/config.h"
+
+namespace sym_arrow
+{
+
+// if val is true, then terms of sums and products are ordered and nodes
+// are hashed using structural hashes instead of memory addresses; in this
+// mode cannonical forms, results of common subexpression elimination and
+// printed expressions do not depend on memory layout and are the same in
+// every run; this function must be called before any expression is
+// created, the mode cannot be changed later, since hashes and orderings
+// of existing nodes would become invalid; exception is thrown if the mode
+// is changed when sums, products or function calls exist (also in
+// caches)
+void SYM_ARROW_EXPORT   set_deterministic_ordering(bool val);
+
+// return true if deterministic ordering is used
+bool SYM_ARROW_EXPORT   get_deterministic_ordering();
+
+};
@@ -0,0 +1,42 @@
+/* 
+ *  This file is a part of sym_arrow library.
+ *
+ *  Copyright (c) Pawe Kowal 2017 - 2021
+ *
+ *  This program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program; if not, write to the Free Software
+ *  Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA 02111-1307 USA
+ */
+
+#pragma once
+
+#include "sym_arrow/config.h"
+
+namespace sym_arrow
+{
+
+// set number of threads used during cannonization to sort and merge
+// terms of sums and products with at least min_size terms; if num_threads
+// is zero, then number of hardware threads is used; num_threads = 1
+// disables parallel processing; result does not depend on the number of
+// threads
+void SYM_ARROW_EXPORT   set_cannonize_threads(size_t num_threads,
+                            size_t min_size = 100000);
+
+// number of threads used to cannonize wide sums and products
+size_t SYM_ARROW_EXPORT get_cannonize_threads();
+
+// minimum number of terms of a sum or a product processed in parallel
+size_t SYM_ARROW_EXPORT get_cannonize_min_size();
+
+};
@@ -0,0 +1,50 @@
+/* 
+ *  This file is a part of sym_arrow library.
+ *
+ *  Copyright (c) Pawe Kowal 2017 - 2021
+ *
+ *  This program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program; if not, write to the Free Software
+ *  Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA 02111-1307 USA
+ */
+
+#pragma once
+
+#include "sym_arrow/config.h"
+#include "sym_arrow/fwd_decls.h"
+#include "sym_arrow/nodes/value.h"
+#include "sym_arrow/functions/contexts.h"
+
+#include <vector>
+
+namespace sym_arrow
+{
+
+// evaluate an expression and its gradient with respect to symbols syms
+// using reverse mode differentiation; vals[i] is the value of syms[i];
+// gradient is stored in grad, which is resized to the size of syms;
+// values of all nodes are stored on a tape in one forward sweep and
+// adjoints are accumulated in one reverse sweep; ex can depend only on
+// symbols from syms and builtin functions; return value of ex
+value SYM_ARROW_EXPORT  eval_gradient(const expr& ex, const std::vector<symbol>& syms,
+                            const std::vector<value>& vals, std::vector<value>& grad);
+
+// evaluate an expression and its gradient as above; values of symbols
+// not in syms and values of user functions are given by dp; derivatives
+// of user functions are defined by dc
+value SYM_ARROW_EXPORT  eval_gradient(const expr& ex, const std::vector<symbol>& syms,
+                            const std::vector<value>& vals, std::vector<value>& grad,
+                            const data_provider& dp,
+                            const diff_context& dc = global_diff_context());
+
+};
@@ -0,0 +1,141 @@
+/* 
+ *  This file is a part of sym_arrow library.
+ *
+ *  Copyright (c) Pawe Kowal 2017 - 2021
+ *
+ *  This program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program; if not, write to the Free Software
+ *  Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA 02111-1307 USA
+ */
+
+#pragma once
+
+#include "sym_arrow/nodes/expr.h"
+#include "sym_arrow/functions/contexts.h"
+
+#include <vector>
+#include <cstdint>
+
+#pragma warning(push)
+#pragma warning(disable:4251)    //needs to have dll-interface
+
+namespace sym_arrow
+{
+
+// sparse polynomial with real coefficients in a fixed list of at most 32
+// symbols; every term is stored as a coefficient and exponents of all
+// symbols packed into one 64-bit word; terms are sorted by packed
+// exponents; maximum exponent depends on the number of symbols (2^31 - 1
+// for at most two symbols, 127 for 8 symbols, 7 for 16 symbols); arithmetic,
+// differentiation and evaluation do not create expression nodes; this is
+// much faster than operations on expressions for polynomial workloads;
+// polynomials with different symbol lists cannot be combined
+class SYM_ARROW_EXPORT sparse_poly
+{
+    private:
+        using exp_type  = std::uint64_t;
+
+    private:
+        std::vector<symbol>     m_symbols;
+        size_t                  m_width;
+        std::vector<exp_type>   m_exps;
+        std::vector<double>     m_coefs;
+
+    public:
+        // zero polynomial without symbols
+        sparse_poly();
+
+        // zero polynomial in symbols syms
+        explicit sparse_poly(const std::vector<symbol>& syms);
+
+        // constant polynomial in symbols syms
+        sparse_poly(const std::vector<symbol>& syms, const value& c);
+
+        // convert an expression to a polynomial in symbols syms;
+        // exception is thrown if ex is not a polynomial in syms with
+        // numeric coefficients
+        sparse_poly(const expr& ex, const std::vector<symbol>& syms);
+
+        // polynomial equal to the symbol syms[var]
+        static sparse_poly  make_symbol(const std::vector<symbol>& syms, size_t var);
+
+        // return true if ex is a polynomial in symbols syms with numeric
+        // coefficients
+        static bool         is_polynomial(const expr& ex, const std::vector<symbol>& syms);
+
+    public:
+        // list of symbols
+        const std::vector<symbol>&
+                            get_symbols() const;
+
+        // number of terms
+        size_t              size() const;
+
+        // return true if this polynomial is zero
+        bool                is_zero() const;
+
+        // coefficient of k-th term
+        value               coef(size_t k) const;
+
+        // exponent of symbol var in k-th term
+        int                 exponent(size_t k, size_t var) const;
+
+        // degree in symbol var
+        int                 degree(size_t var) const;
+
+        // maximum exponent that can be stored
+        int                 max_exponent() const;
+
+        // n-th derivative with respect to symbol var or sym; derivative
+        // with respect to a symbol not in the list of symbols is zero
+        sparse_poly         diff(size_t var, int n = 1) const;
+        sparse_poly         diff(const symbol& sym, int n = 1) const;
+
+        // n-th power, n >= 0
+        sparse_poly         power(int n) const;
+
+        // evaluate polynomial; vals[i] is the value of i-th symbol
+        value               eval(const value* vals) const;
+
+        // evaluate polynomial; values of symbols are given by dp
+        value               eval(const data_provider& dp) const;
+
+        // convert to cannonized expression
+        expr                to_expr() const;
+
+    public:
+        sparse_poly&        operator+=(const sparse_poly& other);
+        sparse_poly&        operator-=(const sparse_poly& other);
+        sparse_poly&        operator*=(const sparse_poly& other);
+        sparse_poly&        operator*=(const value& scal);
+
+    private:
+        sparse_poly(const std::vector<symbol>& syms, size_t width);
+
+        exp_type            guard_mask() const;
+        size_t              shift(size_t var) const;
+        void                check_symbols(const sparse_poly& other) const;
+        void                add(const sparse_poly& other, double scal);
+        void                error_overflow() const;
+};
+
+sparse_poly SYM_ARROW_EXPORT operator+(const sparse_poly& a, const sparse_poly& b);
+sparse_poly SYM_ARROW_EXPORT operator-(const sparse_poly& a, const sparse_poly& b);
+sparse_poly SYM_ARROW_EXPORT operator*(const sparse_poly& a, const sparse_poly& b);
+sparse_poly SYM_ARROW_EXPORT operator*(const value& a, const sparse_poly& b);
+sparse_poly SYM_ARROW_EXPORT operator*(const sparse_poly& a, const value& b);
+sparse_poly SYM_ARROW_EXPORT operator-(const sparse_poly& a);
+
+};
+
+#pragma warning(pop)
@@ -0,0 +1,124 @@
+/* 
+ *  This file is a part of sym_arrow library.
+ *
+ *  Copyright (c) Pawe Kowal 2017 - 2021
+ *
+ *  This program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program; if not, write to the Free Software
+ *  Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA 02111-1307 USA
+ */
+
+#pragma once
+
+#include "sym_arrow/config.h"
+#include "sym_arrow/fwd_decls.h"
+#include "sym_arrow/nodes/value.h"
+#include "sym_arrow/functions/contexts.h"
+
+#include <vector>
+#include <type_traits>
+
+#pragma warning(push)
+#pragma warning(disable:4251)    //needs to have dll-interface
+
+namespace sym_arrow
+{
+
+// data provider resolved at compile time; a class Provider used in
+// eval<Provider> must define functions:
+//
+//     // array of values indexed by symbol code, i.e. value of a symbol
+//     // sym is values()[sym.get_symbol_code()]
+//     const value*    values() const;
+//
+//     // size of the array returned by values()
+//     size_t          size() const;
+//
+//     // evaluate a function with name given by a symbol with code
+//     // name_code and n_size arguments evaluated to values stored in
+//     // the array args
+//     value           eval_function(size_t name_code, const value* args,
+//                         size_t n_size) const;
+//
+// and can define a function:
+//
+//     // array of size size(); symbol with code c has no value if
+//     // set_mask()[c] == 0; if this function is not defined, then all
+//     // symbols with code less than size() have values
+//     const unsigned char* set_mask() const;
+//
+// values of symbols are read from the array without any calls;
+// eval_function is called only for functions that are not builtin
+// functions
+
+// data provider storing values of symbols in a vector indexed by
+// symbol code; only builtin functions can be evaluated
+class SYM_ARROW_EXPORT indexed_data_provider
+{
+    private:
+        std::vector<value>  m_values;
+        std::vector<unsigned char>
+                            m_set;
+
+    public:
+        indexed_data_provider();
+
+        // set value of a symbol
+        void            set_value(const symbol& sym, const value& val);
+
+        // array of values indexed by symbol code
+        const value*    values() const;
+
+        // size of the array returned by values()
+        size_t          size() const;
+
+        // array of flags indexed by symbol code; nonzero flag is set
+        // for symbols with value
+        const unsigned char*
+                        set_mask() const;
+
+        // throws an exception
+        value           eval_function(size_t name_code, const value* args,
+                            size_t n_size) const;
+};
+
+// evaluate an expression using a data provider resolved at compile time;
+// exception is thrown if some symbol in ex has no value, i.e. its code is
+// not less than dp.size() or it is not marked in dp.set_mask()
+template<class Provider>
+typename std::enable_if<std::is_base_of<data_provider, Provider>::value == false, value>::type
+                        eval(const expr& ex, const Provider& dp);
+
+};
+
+namespace sym_arrow { namespace details
+{
+
+// function evaluating a function with name given by a symbol with code
+// name_code; provider is the pointer passed to eval_indexed
+using eval_function_ptr = value (*)(const void* provider, size_t name_code,
+                            const value* args, size_t n_size);
+
+// evaluate an expression; value of a symbol with code c is vals[c];
+// if set_mask is not null, then symbols with set_mask[c] == 0 have no
+// value; functions that are not builtin functions are evaluated by calling
+// func(provider, ...)
+value SYM_ARROW_EXPORT  eval_indexed(const expr& ex, const value* vals, size_t n_vals,
+                            const unsigned char* set_mask, const void* provider, 
+                            eval_function_ptr func);
+
+}};
+
+#pragma warning(pop)
+
+#include "sym_arrow/details/static_eval.inl"
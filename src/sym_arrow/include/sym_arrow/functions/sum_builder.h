@@ -0,0 +1,136 @@
+/* 
+ *  This file is a part of sym_arrow library.
+ *
+ *  Copyright (c) Pawe Kowal 2017 - 2021
+ *
+ *  This program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program; if not, write to the Free Software
+ *  Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA 02111-1307 USA
+ */
+
+#pragma once
+
+#include "sym_arrow/nodes/expr.h"
+
+#include <memory>
+
+#pragma warning(push)
+#pragma warning(disable:4251)    //needs to have dll-interface
+
+namespace sym_arrow
+{
+
+// builder of a sum of many terms; like terms are combined immediately
+// using a hash table, and one additive expression is created at the
+// end; this is much faster than adding terms one by one using
+// operator+ when number of terms is large
+class SYM_ARROW_EXPORT sum_builder
+{
+    private:
+        using impl_type = std::unique_ptr<details::sum_builder_impl>;
+
+    private:
+        impl_type       m_impl;
+
+    public:
+        // create empty sum
+        sum_builder();
+
+        // create empty sum; memory for n terms is reserved
+        explicit sum_builder(size_t n);
+
+        sum_builder(sum_builder&& other);
+        sum_builder& operator=(sum_builder&& other);
+
+        ~sum_builder();
+
+        sum_builder(const sum_builder&) = delete;
+        sum_builder& operator=(const sum_builder&) = delete;
+
+    public:
+        // add a term ex
+        void            add(const expr& ex);
+
+        // add a term coef * ex
+        void            add(const value& coef, const expr& ex);
+
+        // add a constant
+        void            add(const value& coef);
+
+        // number of distinct terms added so far (constant term is
+        // not counted)
+        size_t          size() const;
+
+        // create cannonized sum of all terms added so far; the builder
+        // is not modified
+        expr            make() const;
+
+        // remove all terms
+        void            clear();
+};
+
+// builder of a product of many factors; powers of the same base are
+// combined immediately using a hash table, and one multiplicative
+// expression is created at the end
+class SYM_ARROW_EXPORT product_builder
+{
+    private:
+        using impl_type = std::unique_ptr<details::product_builder_impl>;
+
+    private:
+        impl_type       m_impl;
+
+    public:
+        // create empty product
+        product_builder();
+
+        // create empty product; memory for n factors is reserved
+        explicit product_builder(size_t n);
+
+        product_builder(product_builder&& other);
+        product_builder& operator=(product_builder&& other);
+
+        ~product_builder();
+
+        product_builder(const product_builder&) = delete;
+        product_builder& operator=(const product_builder&) = delete;
+
+    public:
+        // multiply by ex
+        void            mult(const expr& ex);
+
+        // multiply by ex^pow
+        void            mult(const expr& ex, int pow);
+
+        // multiply by ex^pow, where ex^pow is the real power as
+        // defined by power_real function
+        void            mult(const expr& ex, const value& pow);
+
+        // multiply by a constant
+        void            mult(const value& scal);
+
+        // number of distinct factors added so far (constant factor is
+        // not counted)
+        size_t          size() const;
+
+        // create cannonized product of all factors added so far; the
+        // builder is not modified
+        expr            make() const;
+
+        // remove all factors
+        void            clear();
+};
+
+};
+
+#pragma warning(pop)
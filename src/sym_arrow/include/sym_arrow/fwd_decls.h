@@ -37,6 +37,17 @@ class function_expr;
 class data_provider;
 class subs_context;
 class diff_context;
+class compiled_expr;
+class sum_builder;
+class product_builder;
+class cse_policy;
+struct cse_report;
+struct cse_program;
+class cse_predictor;
+struct cse_predictor_stats;
+struct cse_observation;
+class sparse_poly;
+class double_double;
 
 };
 
@@ -45,6 +56,9 @@ namespace sym_arrow { namespace details
 
 class subs_context_impl;
 class diff_context_impl;
+class compiled_expr_impl;
+class sum_builder_impl;
+class product_builder_impl;
 
 }};
 
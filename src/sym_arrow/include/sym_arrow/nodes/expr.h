@@ -94,6 +94,14 @@ class SYM_ARROW_EXPORT expr
         // function is costly
         void                cannonize(bool do_cse = do_cse_default) const;
 
+        // cannonize this object and perform common subexpression
+        // elimination with limits given by a policy; return summary of
+        // the elimination; expressions cannonized with limits may be
+        // less simplified; if a limit was reached, then the expression
+        // is not marked as fully cannonized and next call to
+        // cannonize(true) completes the elimination
+        cse_report          cannonize(const cse_policy& policy) const;
+
         // return pointer to this object
         const expr*         operator->() const;
 
@@ -32,5 +32,21 @@
 #include "sym_arrow/nodes/mult_expr.h"
 #include "sym_arrow/nodes/function_expr.h"
 #include "sym_arrow/functions/expr_functions.h"
+#include "sym_arrow/functions/compiled_expr.h"
+#include "sym_arrow/functions/sum_builder.h"
+#include "sym_arrow/functions/cse_policy.h"
+#include "sym_arrow/functions/extract_cse.h"
+#include "sym_arrow/functions/cse_predictor.h"
+#include "sym_arrow/functions/parallel_options.h"
+#include "sym_arrow/functions/expr_edit.h"
+#include "sym_arrow/functions/ordering.h"
+#include "sym_arrow/functions/lazy_cannonize.h"
+#include "sym_arrow/functions/sparse_poly.h"
+#include "sym_arrow/functions/builtin_functions.h"
+#include "sym_arrow/functions/static_eval.h"
+#include "sym_arrow/functions/forward_diff.h"
+#include "sym_arrow/functions/reverse_diff.h"
+#include "sym_arrow/functions/interval_eval.h"
 #include "sym_arrow/nodes/expr_visitor.h"
 #include "sym_arrow/utils/timer.h"
+#include "sym_arrow/utils/double_double.h"
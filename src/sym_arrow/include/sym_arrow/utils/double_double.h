@@ -0,0 +1,114 @@
+/* 
+ *  This file is a part of sym_arrow library.
+ *
+ *  Copyright (c) Pawe Kowal 2017 - 2021
+ *
+ *  This program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program; if not, write to the Free Software
+ *  Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA 02111-1307 USA
+ */
+
+#pragma once
+
+#include "sym_arrow/config.h"
+
+namespace sym_arrow
+{
+
+// floating point number represented as unevaluated sum m_hi + m_lo of
+// two doubles, where |m_lo| <= ulp(m_hi) / 2; precision is about 32
+// significant digits, the range is the same as for double
+class SYM_ARROW_EXPORT double_double
+{
+    private:
+        double              m_hi;
+        double              m_lo;
+
+    public:
+        // uninitialized number; this type is trivial, therefore arrays
+        // of double_double can be stored in raw memory
+        double_double() = default;
+
+        // convert a double; conversion is exact
+        explicit double_double(double x);
+
+        // create number hi + lo; |lo| <= ulp(hi) / 2 is assumed
+        double_double(double hi, double lo);
+
+        // the leading part
+        double              hi() const          { return m_hi; };
+
+        // the trailing part
+        double              lo() const          { return m_lo; };
+
+        // round to double
+        double              to_double() const   { return m_hi + m_lo; };
+
+        double_double&      operator+=(const double_double& x);
+        double_double&      operator-=(const double_double& x);
+        double_double&      operator*=(const double_double& x);
+        double_double&      operator/=(const double_double& x);
+};
+
+inline double_double    operator-(const double_double& x);
+
+inline double_double    operator+(const double_double& a, const double_double& b);
+inline double_double    operator+(const double_double& a, double b);
+inline double_double    operator+(double a, const double_double& b);
+
+inline double_double    operator-(const double_double& a, const double_double& b);
+inline double_double    operator-(const double_double& a, double b);
+inline double_double    operator-(double a, const double_double& b);
+
+inline double_double    operator*(const double_double& a, const double_double& b);
+inline double_double    operator*(const double_double& a, double b);
+inline double_double    operator*(double a, const double_double& b);
+
+inline double_double    operator/(const double_double& a, const double_double& b);
+inline double_double    operator/(const double_double& a, double b);
+inline double_double    operator/(double a, const double_double& b);
+
+inline bool             operator==(const double_double& a, const double_double& b);
+inline bool             operator!=(const double_double& a, const double_double& b);
+inline bool             operator<(const double_double& a, const double_double& b);
+inline bool             operator>(const double_double& a, const double_double& b);
+inline bool             operator<=(const double_double& a, const double_double& b);
+inline bool             operator>=(const double_double& a, const double_double& b);
+
+// absolute value
+inline double_double    abs(const double_double& x);
+
+// elementary functions evaluated with double_double precision; arguments
+// of sin and cos are reduced modulo pi / 2 in double_double arithmetic,
+// therefore accuracy is lost for very large arguments
+SYM_ARROW_EXPORT double_double  exp(const double_double& x);
+
+// natural logarithm; x must be positive
+SYM_ARROW_EXPORT double_double  log(const double_double& x);
+
+// x^p for x >= 0
+SYM_ARROW_EXPORT double_double  pow(const double_double& x, const double_double& p);
+SYM_ARROW_EXPORT double_double  sqrt(const double_double& x);
+SYM_ARROW_EXPORT double_double  sin(const double_double& x);
+SYM_ARROW_EXPORT double_double  cos(const double_double& x);
+SYM_ARROW_EXPORT double_double  tanh(const double_double& x);
+SYM_ARROW_EXPORT double_double  erf(const double_double& x);
+SYM_ARROW_EXPORT double_double  atan2(const double_double& y, const double_double& x);
+
+// evaluate sin and cos of the same argument
+SYM_ARROW_EXPORT void           sin_cos(const double_double& x, double_double& s,
+                                    double_double& c);
+
+};
+
+#include "sym_arrow/details/double_double.inl"
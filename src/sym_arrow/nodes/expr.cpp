@@ -26,7 +26,9 @@
 #include "sym_arrow/exception.h"
 #include "sym_arrow/ast/ast.h"
 #include "sym_arrow/ast/cannonization/cannonize.h"
+#include "sym_arrow/ast/cannonization/cse_budget.h"
 #include "sym_arrow/functions/expr_functions.h"
+#include "sym_arrow/functions/cse_policy.h"
 
 //#include <vld.h>
 
@@ -130,10 +132,66 @@ bool expr::is_cannonized() const
 
 void expr::cannonize(bool do_cse) const
 {
-    if (ast::cannonize().is_cannonized(*this) == true)
-        return;
+    ast::cannonize c;
+
+    if (c.is_cannonized(*this) == true)
+    {
+        // expressions cannonized without cse (in lazy mode) or with
+        // cse truncated by a policy are cannonized again when cse is
+        // requested
+        if (do_cse == false || c.is_cse_done(*this) == true)
+        {
+            return;
+        };
 
-    const_cast<expr&>(*this) = ast::cannonize().make(*this, do_cse);
+        const_cast<expr&>(*this) = c.make_cse(*this);
+    }
+    else if (do_cse == true && ast::cannonize::is_lazy() == true)
+    {
+        // subexpressions were cannonized without cse when this expression
+        // was built
+        const_cast<expr&>(*this) = c.make_cse(*this);
+    }
+    else
+    {
+        const_cast<expr&>(*this) = c.make(*this, do_cse);
+    };
+
+    if (do_cse == true && ast::cse_budget::is_complete() == true)
+        c.set_cse_done(*this);
+};
+
+cse_report expr::cannonize(const cse_policy& policy) const
+{
+    cse_report report;
+    ast::cannonize c;
+
+    if (c.is_cannonized(*this) == true)
+    {
+        if (c.is_cse_done(*this) == true)
+            return report;
+
+        ast::cse_budget budget(policy);
+        const_cast<expr&>(*this) = c.make_cse(*this);
+        report  = budget.get_report();
+    }
+    else if (ast::cannonize::is_lazy() == true)
+    {
+        ast::cse_budget budget(policy);
+        const_cast<expr&>(*this) = c.make_cse(*this);
+        report  = budget.get_report();
+    }
+    else
+    {
+        const_cast<expr&>(*this) = c.make(*this, policy, report);
+    };
+
+    // result truncated by the policy is completed by later cannonization
+    // with cse
+    if (report.is_complete() == true)
+        c.set_cse_done(*this);
+
+    return report;
 };
 
 bool operator==(const expr& v1, const expr& v2)
@@ -209,7 +267,7 @@ expr sym_arrow::function(const symbol& sym, const std::vector<expr>& arg)
 expr sym_arrow::function(const symbol& sym, const expr* arg, size_t n)
 {
     for (size_t i = 0; i < n; ++i)
-        arg[i].cannonize(do_cse_default);
+        arg[i].cannonize(ast::cannonize::do_cse_lazy());
 
     using info              = ast::function_rep_info;
 
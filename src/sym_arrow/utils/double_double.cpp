@@ -0,0 +1,337 @@
+/* 
+ *  This file is a part of sym_arrow library.
+ *
+ *  Copyright (c) Pawe Kowal 2017 - 2021
+ *
+ *  This program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program; if not, write to the Free Software
+ *  Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA 02111-1307 USA
+ */
+
+#include "sym_arrow/utils/double_double.h"
+
+#include <cmath>
+#include <limits>
+
+namespace sym_arrow { namespace details
+{
+
+// constants rounded to double_double
+static const double_double dd_ln2       = double_double(6.931471805599453094e-01,
+                                                        2.3190468138462996e-17);
+static const double_double dd_pi        = double_double(3.141592653589793116e+00,
+                                                        1.2246467991473532e-16);
+static const double_double dd_pi_2      = double_double(1.570796326794896558e+00,
+                                                        6.123233995736766e-17);
+static const double_double dd_2_sqrt_pi = double_double(1.1283791670955126,
+                                                        1.533545961316588e-17);
+
+// relative precision of double_double
+static const double dd_eps              = 4.93038065763132e-32;
+
+static double_double dd_inf()
+{
+    return double_double(std::numeric_limits<double>::infinity());
+};
+
+static double_double dd_nan()
+{
+    return double_double(std::numeric_limits<double>::quiet_NaN());
+};
+
+static bool is_finite(const double_double& x)
+{
+    return std::isfinite(x.hi());
+};
+
+// multiply by 2^k; exact
+static double_double ldexp(const double_double& x, int k)
+{
+    return double_double(std::ldexp(x.hi(), k), std::ldexp(x.lo(), k));
+};
+
+// exp(x) - 1 for |x| <= ln(2) / 2
+static double_double expm1_reduced(const double_double& x)
+{
+    // further reduction by 2^9; then exp(r) - 1 is squared back using
+    // (s + 1)^2 - 1 = s * (s + 2)
+    const int n_sq      = 9;
+    double_double r     = ldexp(x, -n_sq);
+
+    double_double s     = r;
+    double_double term  = r;
+
+    for (int k = 2; k < 20; ++k)
+    {
+        term            = term * r / double(k);
+        s               = s + term;
+
+        if (std::abs(term.hi()) <= dd_eps * std::abs(s.hi()))
+            break;
+    };
+
+    for (int i = 0; i < n_sq; ++i)
+        s               = s * (s + 2.0);
+
+    return s;
+};
+
+// sin and cos for |x| <= pi / 4 by Taylor series
+static void sin_cos_reduced(const double_double& x, double_double& s, double_double& c)
+{
+    double_double x2    = x * x;
+
+    s                   = x;
+    c                   = double_double(1.0);
+
+    double_double term  = x;
+
+    for (int k = 1; k < 30; ++k)
+    {
+        // term = x^(2k + 1) / (2k + 1)! with alternating sign
+        term            = -term * x2 / double((2 * k) * (2 * k + 1));
+        s               = s + term;
+
+        if (std::abs(term.hi()) <= dd_eps * std::abs(s.hi()))
+            break;
+    };
+
+    term                = double_double(1.0);
+
+    for (int k = 1; k < 30; ++k)
+    {
+        term            = -term * x2 / double((2 * k - 1) * (2 * k));
+        c               = c + term;
+
+        if (std::abs(term.hi()) <= dd_eps)
+            break;
+    };
+};
+
+}};
+
+namespace sym_arrow
+{
+
+namespace sd = sym_arrow :: details;
+
+double_double exp(const double_double& x)
+{
+    if (x.hi() != x.hi())
+        return x;
+
+    // values out of range
+    if (x.hi() > 709.78)
+        return sd::dd_inf();
+
+    if (x.hi() < -745.2)
+        return double_double(0.0);
+
+    // x = m * ln2 + r, |r| <= ln2 / 2
+    double m            = std::floor(x.hi() / sd::dd_ln2.hi() + 0.5);
+    double_double r     = x - sd::dd_ln2 * m;
+
+    double_double s     = sd::expm1_reduced(r) + 1.0;
+    return sd::ldexp(s, int(m));
+};
+
+double_double log(const double_double& x)
+{
+    if (x.hi() != x.hi() || x.hi() < 0.0)
+        return sd::dd_nan();
+
+    if (x.hi() == 0.0)
+        return -sd::dd_inf();
+
+    if (sd::is_finite(x) == false)
+        return x;
+
+    // one Newton step for exp(y) = x doubles number of correct digits
+    double_double y     = double_double(std::log(x.hi()));
+    y                   = y + x * exp(-y) - 1.0;
+
+    return y;
+};
+
+double_double pow(const double_double& x, const double_double& p)
+{
+    if (p.hi() == 0.0)
+        return double_double(1.0);
+
+    if (x.hi() == 0.0)
+        return p.hi() > 0.0 ? double_double(0.0) : sd::dd_inf();
+
+    return exp(p * log(x));
+};
+
+double_double sqrt(const double_double& x)
+{
+    if (x.hi() <= 0.0)
+        return x.hi() == 0.0 ? double_double(0.0) : sd::dd_nan();
+
+    if (sd::is_finite(x) == false)
+        return x;
+
+    // one Newton step
+    double_double y     = double_double(std::sqrt(x.hi()));
+    return y + (x - y * y) / (2.0 * y);
+};
+
+void sin_cos(const double_double& x, double_double& s, double_double& c)
+{
+    if (sd::is_finite(x) == false)
+    {
+        s               = sd::dd_nan();
+        c               = sd::dd_nan();
+        return;
+    };
+
+    // x = k * pi / 2 + r, |r| <= pi / 4
+    double k            = std::floor(x.hi() / sd::dd_pi_2.hi() + 0.5);
+    double_double r     = x - sd::dd_pi_2 * k;
+
+    double_double sr, cr;
+    sd::sin_cos_reduced(r, sr, cr);
+
+    int q               = int(std::fmod(k, 4.0));
+
+    if (q < 0)
+        q               += 4;
+
+    switch (q)
+    {
+        case 0: s = sr;  c = cr;  break;
+        case 1: s = cr;  c = -sr; break;
+        case 2: s = -sr; c = -cr; break;
+        default: s = -cr; c = sr; break;
+    };
+};
+
+double_double sin(const double_double& x)
+{
+    double_double s, c;
+    sin_cos(x, s, c);
+
+    return s;
+};
+
+double_double cos(const double_double& x)
+{
+    double_double s, c;
+    sin_cos(x, s, c);
+
+    return c;
+};
+
+double_double tanh(const double_double& x)
+{
+    if (x.hi() != x.hi())
+        return x;
+
+    double_double a     = abs(x);
+    double_double ret;
+
+    if (a.hi() > 40.0)
+    {
+        ret             = double_double(1.0);
+    }
+    else if (a.hi() > 0.5)
+    {
+        // no cancellation in 1 - e
+        double_double e = exp(-2.0 * a);
+        ret             = (1.0 - e) / (1.0 + e);
+    }
+    else
+    {
+        // tanh = sinh / cosh by Taylor series of sinh
+        double_double a2    = a * a;
+        double_double sh    = a;
+        double_double term  = a;
+
+        for (int k = 1; k < 30; ++k)
+        {
+            term        = term * a2 / double((2 * k) * (2 * k + 1));
+            sh          = sh + term;
+
+            if (std::abs(term.hi()) <= sd::dd_eps * std::abs(sh.hi()))
+                break;
+        };
+
+        ret             = sh / sqrt(1.0 + sh * sh);
+    };
+
+    return x.hi() < 0.0 ? -ret : ret;
+};
+
+double_double erf(const double_double& x)
+{
+    if (x.hi() != x.hi())
+        return x;
+
+    double_double a     = abs(x);
+    double_double ret;
+
+    // erfc(a) < 1e-34 for a >= 9
+    if (a.hi() >= 9.0)
+    {
+        ret             = double_double(1.0);
+    }
+    else
+    {
+        // erf(a) = 2 / sqrt(pi) * exp(-a^2) * sum_k 2^k a^(2k + 1) / (2k + 1)!!;
+        // terms are positive, therefore there is no cancellation
+        double_double a2    = a * a;
+        double_double sum   = a;
+        double_double term  = a;
+
+        for (int k = 1; k < 400; ++k)
+        {
+            term        = term * (2.0 * a2) / double(2 * k + 1);
+            sum         = sum + term;
+
+            if (std::abs(term.hi()) <= sd::dd_eps * std::abs(sum.hi()))
+                break;
+        };
+
+        ret             = sd::dd_2_sqrt_pi * exp(-a2) * sum;
+    };
+
+    return x.hi() < 0.0 ? -ret : ret;
+};
+
+double_double atan2(const double_double& y, const double_double& x)
+{
+    if (x.hi() == 0.0 && y.hi() == 0.0)
+        return double_double(std::atan2(y.hi(), x.hi()));
+
+    if (sd::is_finite(x) == false || sd::is_finite(y) == false)
+        return double_double(std::atan2(y.hi(), x.hi()));
+
+    // one Newton step for y * cos(z) - x * sin(z) = 0
+    double_double z     = double_double(std::atan2(y.hi(), x.hi()));
+
+    double_double s, c;
+    sin_cos(z, s, c);
+
+    z                   = z + (y * c - x * s) / (x * c + y * s);
+
+    // keep the result in [-pi, pi]
+    if (z > sd::dd_pi)
+        z               = sd::dd_pi;
+    else if (z < -sd::dd_pi)
+        z               = -sd::dd_pi;
+
+    return z;
+};
+
+};
@@ -21,6 +21,7 @@
 #pragma once
 
 #include "dag/refptr.h"
+#include "sym_arrow/ast/helpers/expr_order.h"
 #include <boost/pool/object_pool.hpp>
 
 namespace sym_arrow { namespace utils { namespace details
@@ -54,9 +55,13 @@ namespace sym_arrow { namespace utils
 
 struct expr_hash_equal
 {
+    // maps keyed by nodes are memo tables, which are never iterated, thus
+    // hashes do not affect results; structural hashes are used in the
+    // deterministic mode anyway, so that also bucket layout and cache
+    // evictions do not depend on addresses
     static size_t hash_value(ast::expr_handle h)
     { 
-        return (size_t)h;
+        return ast::expr_order::hash(h);
     };
 
     static bool equal(ast::expr_handle h1, ast::expr_handle h2)
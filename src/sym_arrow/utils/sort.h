@@ -32,6 +32,12 @@ void sort_ins(Value_type* ptr, size_t size, Comparer comp);
 template<class Value_type, class Comparer> 
 void sort_q(Value_type* ptr, size_t size, Comparer comp);
 
+// stable LSD radix sort of array ptr of given size by keys of type
+// size_t returned by key(elem); buf must have space for size elements;
+// bytes equal for all keys are skipped
+template<class Value_type, class Key_func> 
+void sort_radix(Value_type* ptr, Value_type* buf, size_t size, Key_func key);
+
 };};
 
 #include "sym_arrow/utils/sort.inl"
@@ -68,4 +68,59 @@ inline void sort_q(Type * const ptr, const size_t n, Comparer comp)
     return sort_q(ptr, ptr+n, comp);
 }
 
+template <class Type, class Key_func>
+void sort_radix(Type* ptr, Type* buf, size_t n, Key_func key)
+{
+    static const size_t radix_bits  = 8;
+    static const size_t radix_size  = size_t(1) << radix_bits;
+    static const size_t radix_mask  = radix_size - 1;
+    static const size_t key_bits    = sizeof(size_t) * 8;
+
+    if (n <= 1)
+        return;
+
+    // find bits that differ between keys
+    size_t key_0        = key(ptr[0]);
+    size_t diff         = 0;
+
+    for (size_t i = 1; i < n; ++i)
+        diff            |= key(ptr[i]) ^ key_0;
+
+    Type* src           = ptr;
+    Type* dst           = buf;
+    size_t count[radix_size];
+
+    for (size_t shift = 0; shift < key_bits; shift += radix_bits)
+    {
+        if (((diff >> shift) & radix_mask) == 0)
+            continue;
+
+        for (size_t i = 0; i < radix_size; ++i)
+            count[i]    = 0;
+
+        for (size_t i = 0; i < n; ++i)
+            ++count[(key(src[i]) >> shift) & radix_mask];
+
+        size_t pos      = 0;
+
+        for (size_t i = 0; i < radix_size; ++i)
+        {
+            size_t c    = count[i];
+            count[i]    = pos;
+            pos         += c;
+        };
+
+        for (size_t i = 0; i < n; ++i)
+            dst[count[(key(src[i]) >> shift) & radix_mask]++] = std::move(src[i]);
+
+        std::swap(src, dst);
+    };
+
+    if (src != ptr)
+    {
+        for (size_t i = 0; i < n; ++i)
+            ptr[i]      = std::move(src[i]);
+    };
+};
+
 };};
\ No newline at end of file
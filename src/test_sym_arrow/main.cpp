@@ -23,25 +23,52 @@
 #include "sym_arrow/sym_arrow.h"
 
 #include <iostream>
+#include <string>
 //#include <vld.h>
 
 int main(int argc, const char* argv[])
 {
     using namespace sym_arrow::testing;
 
-    (void)argc;
-    (void)argv;    
-
     // number of random trials
     size_t n_rep = 100000;
 
     try
     {
+        // process started by test_deterministic_order; deterministic ordering
+        // is set before any expression is created
+        if (argc == 3 && std::string(argv[1]) == "--deterministic-order")
+            return test_set::run_deterministic_order(argv[2]);
+
         test_set::example();
 
         test_set::test_diff();
         test_set::test_diff_context();
         test_set::test_harmonics();
+        test_set::test_codegen();
+        test_set::test_compiled_expr();
+        test_set::test_parse();
+        test_set::test_parse_file();
+        test_set::test_sum_builder();
+        test_set::test_cse_policy();
+        test_set::test_extract_cse();
+        test_set::test_cse_predictor();
+        test_set::test_parallel_cannonize();
+        test_set::test_item_collector();
+        test_set::test_expr_edit();
+        test_set::test_deterministic_order(argv[0]);
+        test_set::test_lazy_cannonize();
+        test_set::test_expand();
+        test_set::test_sparse_poly();
+        test_set::test_subs_shared();
+        test_set::test_diff_rules();
+        test_set::test_subs_batch();
+        test_set::test_builtin_functions();
+        test_set::test_static_eval();
+        test_set::test_forward_diff();
+        test_set::test_reverse_diff();
+        test_set::test_interval_eval();
+        test_set::test_numeric_types();
 
         test_set::test_special_cases();
         test_set::test_visitor();        
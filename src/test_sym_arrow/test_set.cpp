@@ -24,9 +24,20 @@
 #include "expr_rand.h"
 #include "sym_arrow/utils/timer.h"
 #include "../../sym_arrow/func/symbol_functions.h"
+#include "../../sym_arrow/func/sl_program.h"
 
 
 #include <fstream>
+#include <sstream>
+#include <iomanip>
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+
+#ifndef _WIN32
+    #include <dlfcn.h>
+#endif
 
 namespace sym_arrow { namespace testing
 {
@@ -344,5 +355,3251 @@ void test_set::test_diff_context()
     std::cout << "func diff time: " << t << "\n";  
 };
 
+// path of a file in the directory for temporary files
+static std::string temp_file_path(const std::string& name)
+{
+    const char* dir     = std::getenv("TMPDIR");
+
+    if (dir == nullptr)
+        dir             = std::getenv("TEMP");
+
+#ifdef _WIN32
+    std::string path    = (dir != nullptr) ? dir : ".";
+    return path + "\\" + name;
+#else
+    std::string path    = (dir != nullptr) ? dir : "/tmp";
+    return path + "/" + name;
+#endif
+};
+
+// functions called by compiled code; the k-th function of the evaluated
+// program is evaluated as the function g_codegen_funcs[k]
+static const std::vector<symbol>*   g_codegen_funcs = nullptr;
+static const data_provider*         g_codegen_dp    = nullptr;
+
+using codegen_func      = double (*)(const double* args, int n_args);
+using codegen_entry     = void (*)(const double* x, double* y, const codegen_func* f);
+
+template<size_t K>
+static double codegen_call(const double* args, int n_args)
+{
+    std::vector<expr> ex;
+
+    for (int i = 0; i < n_args; ++i)
+        ex.push_back(expr(args[i]));
+
+    symbol name     = (*g_codegen_funcs)[K];
+    return eval(function(name, ex), *g_codegen_dp).get_value();
+};
+
+static const size_t codegen_max_funcs  = 4;
+
+static const codegen_func codegen_funcs[codegen_max_funcs]
+    = {&codegen_call<0>, &codegen_call<1>, &codegen_call<2>, &codegen_call<3>};
+
+// compile C code generated for expressions ex[i], evaluating the function
+// func_i, and compare results with eval; funcs[i] are functions called by
+// func_i; return number of failures or -1 if a C compiler is not available
+static int compile_codegen(const std::string& src, const std::vector<std::vector<expr>>& ex,
+                    const std::vector<std::vector<symbol>>& funcs, 
+                    const std::vector<value>& in, const data_provider& dp)
+{
+#ifdef _WIN32
+    (void)src; (void)ex; (void)funcs; (void)in; (void)dp;
+    return -1;
+#else
+    if (std::system("cc --version > /dev/null 2>&1") != 0)
+        return -1;
+
+    std::string c_file      = temp_file_path("sym_arrow_codegen_test.c");
+    std::string so_file     = temp_file_path("sym_arrow_codegen_test.so");
+
+    {
+        std::ofstream os(c_file);
+        os << src;
+    };
+
+    std::string cmd         = "cc -shared -fPIC -o " + so_file + " " + c_file + " -lm";
+
+    if (std::system(cmd.c_str()) != 0)
+    {
+        std::cout << "unable to compile generated code" << "\n";
+        return 1;
+    };
+
+    void* lib               = dlopen(so_file.c_str(), RTLD_NOW);
+
+    if (lib == nullptr)
+    {
+        std::cout << "unable to load compiled code: " << dlerror() << "\n";
+        return 1;
+    };
+
+    std::vector<double> x;
+    for (const value& v : in)
+        x.push_back(v.get_value());
+
+    int n_failed            = 0;
+    g_codegen_dp            = &dp;
+
+    for (size_t i = 0; i < ex.size(); ++i)
+    {
+        std::ostringstream name;
+        name << "func_" << i;
+
+        codegen_entry fun   = (codegen_entry)dlsym(lib, name.str().c_str());
+
+        if (fun == nullptr || funcs[i].size() > codegen_max_funcs)
+        {
+            ++n_failed;
+            continue;
+        };
+
+        std::vector<double> y(ex[i].size());
+        g_codegen_funcs     = &funcs[i];
+
+        fun(x.data(), y.data(), codegen_funcs);
+
+        for (size_t j = 0; j < ex[i].size(); ++j)
+        {
+            double v1       = eval(ex[i][j], dp).get_value();
+            double v2       = y[j];
+
+            if (v1 == v2 || (v1 != v1 && v2 != v2))
+                continue;
+
+            double tol      = 1e-10 * std::max(std::abs(v1), std::abs(v2));
+
+            if (std::abs(v1 - v2) > tol)
+                ++n_failed;
+        };
+    };
+
+    dlclose(lib);
+
+    std::remove(c_file.c_str());
+    std::remove(so_file.c_str());
+
+    return n_failed;
+#endif
+};
+
+void test_set::test_codegen()
+{
+    std::cout << "\n" << "test codegen:" << "\n";
+
+    {
+        symbol x("x");
+        symbol y("y");
+
+        std::vector<expr> ex;
+        ex.push_back(parse("x^5*y^-2 + exp[x*y] + log[x*y] + |x|^0.5"));
+        ex.push_back(parse("f[x^2, exp[x*y]] + 2*x^5"));
+
+        codegen_c(ex, std::vector<symbol>{x, y}, std::cout);
+    };
+
+    init_genrand(17);
+
+    int n_sym           = 6;
+    rand_state r(n_sym, 12, false, false);
+    rand_data_provider dp(&r);
+
+    std::vector<symbol> inputs;
+    std::vector<value> in;
+
+    for (int i = 1; i <= n_sym; ++i)
+    {
+        std::ostringstream os;
+        os << "x" << i;
+        inputs.push_back(symbol(os.str().c_str()));
+        in.push_back(dp.get_value(inputs.back()));
+    };
+
+    size_t n_rep        = 1000;
+    size_t n_failed     = 0;
+
+    // generated code is compiled for a part of expressions
+    size_t n_compiled   = 200;
+    std::ostringstream src;
+    std::vector<std::vector<expr>> ex_compiled;
+    std::vector<std::vector<symbol>> funcs_compiled;
+
+    for (size_t i = 0; i < n_rep; ++i)
+    {
+        std::vector<expr> ex;
+        ex.push_back(r.rand_expr(0).first);
+        ex.push_back(r.rand_expr(0).first);
+
+        // builtin functions are evaluated by math.h functions and user
+        // functions are called through function pointers
+        if (i % 10 == 0)
+        {
+            ex[0]       = ex[0] + sin(inputs[0] * inputs[1]) 
+                        + function(symbol("f"), inputs[2], inputs[3]);
+            ex[1]       = ex[1] * atan2(inputs[4], inputs[5]);
+        };
+
+        details::sl_program prog(ex, inputs);
+
+        if (i < n_compiled)
+        {
+            std::ostringstream name;
+            name << "func_" << i;
+
+            codegen_c(ex, inputs, src, name.str());
+
+            // builtin functions have reserved names beginning with '$'
+            // and are not passed to generated code
+            std::vector<symbol> user_funcs;
+
+            for (const symbol& s : prog.get_functions())
+            {
+                if (s.get_name()[0] != '$')
+                    user_funcs.push_back(s);
+            };
+
+            ex_compiled.push_back(ex);
+            funcs_compiled.push_back(user_funcs);
+        };
+
+        value out[2];
+        prog.eval(in.data(), out, dp);
+
+        for (size_t j = 0; j < 2; ++j)
+        {
+            double v1   = eval(ex[j], dp).get_value();
+            double v2   = out[j].get_value();
+
+            if (v1 == v2 || (v1 != v1 && v2 != v2))
+                continue;
+
+            double tol  = 1e-10 * std::max(std::abs(v1), std::abs(v2));
+
+            if (std::abs(v1 - v2) > tol)
+                ++n_failed;
+        };
+    };
+
+    int n_failed_c      = compile_codegen(src.str(), ex_compiled, funcs_compiled, in, dp);
+
+    if (n_failed_c < 0)
+        std::cout << "C compiler not available, compiled code not tested" << "\n";
+    else
+        n_failed        += n_failed_c;
+
+    if (n_failed == 0)
+        std::cout << "test_codegen: OK" << "\n";
+    else
+        std::cout << "test_codegen: FAILED " << n_failed << "\n";
+};
+
+void test_set::test_compiled_expr()
+{
+    std::cout << "\n" << "test compiled expressions:" << "\n";
+
+    init_genrand(19);
+
+    int n_sym           = 6;
+    rand_state r(n_sym, 12, false, false);
+    rand_data_provider dp(&r);
+
+    std::vector<symbol> inputs;
+    std::vector<double> in;
+
+    for (int i = 1; i <= n_sym; ++i)
+    {
+        std::ostringstream os;
+        os << "x" << i;
+        inputs.push_back(symbol(os.str().c_str()));
+        in.push_back(dp.get_value(inputs.back()).get_value());
+    };
+
+    size_t n_failed     = 0;
+    expr sum            = scalar::make_zero();
+
+    for (size_t i = 0; i < 1000; ++i)
+    {
+        expr ex         = r.rand_expr(0).first;
+        sum             = sum + ex;
+
+        compiled_expr ce(ex, inputs);
+
+        double out;
+        ce.eval(in.data(), &out, dp);
+
+        double v        = eval(ex, dp).get_value();
+
+        if (v == out || (v != v && out != out))
+            continue;
+
+        if (std::abs(v - out) > 1e-10 * std::max(std::abs(v), std::abs(out)))
+            ++n_failed;
+    };
+
+    // batch evaluation at distinct points spanning several blocks of 256
+    // points; the last block can be incomplete
+    {
+        std::vector<expr> ex;
+
+        for (size_t i = 0; i < 20; ++i)
+            ex.push_back(r.rand_expr(0).first);
+
+        compiled_expr ce(ex, inputs);
+
+        std::vector<size_t> sizes   = {1, 255, 256, 3 * 256, 3 * 256 + 77};
+
+        for (size_t n_points : sizes)
+        {
+            std::vector<double> in_batch(n_sym * n_points);
+            std::vector<double> out_batch(ex.size() * n_points);
+
+            for (int i = 0; i < n_sym; ++i)
+            {
+                for (size_t j = 0; j < n_points; ++j)
+                    in_batch[i * n_points + j] = in[i] * (1.0 + 0.5 * double(j) / n_points)
+                                               + 0.01 * (i + 1);
+            };
+
+            ce.eval(n_points, in_batch.data(), out_batch.data(), dp);
+
+            for (size_t j = 0; j < n_points; ++j)
+            {
+                indexed_data_provider ip;
+
+                for (int i = 0; i < n_sym; ++i)
+                    ip.set_value(inputs[i], value(in_batch[i * n_points + j]));
+
+                for (size_t k = 0; k < ex.size(); ++k)
+                {
+                    double v    = eval(ex[k], ip).get_value();
+                    double out  = out_batch[k * n_points + j];
+
+                    if (v == out || (v != v && out != out))
+                        continue;
+
+                    if (std::abs(v - out) > 1e-10 * std::max(std::abs(v), std::abs(out)))
+                        ++n_failed;
+                };
+            };
+        };
+    };
+
+    if (n_failed == 0)
+        std::cout << "test_compiled_expr: OK" << "\n";
+    else
+        std::cout << "test_compiled_expr: FAILED " << n_failed << "\n";
+
+    // compilation cost versus tree walk
+    sum.cannonize();
+    size_t n_eval       = 10000;
+
+    tic();
+    compiled_expr ce(sum, inputs);
+    double t_comp       = toc();
+
+    tic();
+    for (size_t i = 0; i < n_eval; ++i)
+        eval(sum, dp);
+    double t_eval       = toc() / n_eval;
+
+    double out;
+
+    tic();
+    for (size_t i = 0; i < n_eval; ++i)
+        ce.eval(in.data(), &out, dp);
+    double t_tape       = toc() / n_eval;
+
+    std::vector<double> in_batch(n_sym * n_eval);
+    std::vector<double> out_batch(n_eval);
+
+    for (int i = 0; i < n_sym; ++i)
+    {
+        for (size_t j = 0; j < n_eval; ++j)
+            in_batch[i * n_eval + j] = in[i];
+    };
+
+    tic();
+    ce.eval(n_eval, in_batch.data(), out_batch.data(), dp);
+    double t_batch      = toc() / n_eval;
+
+    std::cout << "instructions: " << ce.num_instructions() << "\n";
+    std::cout << "compile time: " << t_comp << "\n";
+    std::cout << "eval time: " << t_eval << "\n";
+    std::cout << "compiled eval time: " << t_tape << "\n";
+    std::cout << "compiled batch eval time: " << t_batch << "\n";
+
+    if (t_eval > t_tape)
+        std::cout << "break-even evaluations: " << t_comp / (t_eval - t_tape) << "\n";
+};
+
+void test_set::test_parse()
+{
+    std::cout << "\n" << "test parse:" << "\n";
+
+    symbol x("x");
+    symbol y("y");
+    symbol z("z");
+    symbol f("f");
+
+    using test_case     = std::pair<std::string, expr>;
+
+    std::vector<test_case> cases;
+    cases.push_back(test_case("x + 2*y - 3", x + 2*y - 3));
+    cases.push_back(test_case("x*y/z*2", x*y/z*2));
+    cases.push_back(test_case("-x^2", -power_int(x, 2)));
+    cases.push_back(test_case("2^-x", power_real(expr(2.0), -x)));
+    cases.push_back(test_case("|x - y|", abs(x - y)));
+    cases.push_back(test_case("f[x, y^2] + exp[x] + log[y]", 
+                        function(f, x, power_int(y, 2)) + exp(x) + log(y)));
+    cases.push_back(test_case("x^2.5 * (x + y)*(x - y)", 
+                        power_real(x, 2.5) * (x + y) * (x - y)));
+    cases.push_back(test_case("% comment\n x + 1", x + 1));
+    cases.push_back(test_case("%{ a %{ b %} c %}\r\n x \\ y", x / y));
+
+    bool ok = true;
+
+    for (const auto& c : cases)
+    {
+        expr ex = parse(c.first);
+        ex.cannonize();
+        c.second.cannonize();
+
+        if (ex != c.second)
+        {
+            std::cout << "invalid result: " << c.first << "\n";
+            ok = false;
+        };
+    };
+
+    using error_case    = std::pair<std::string, std::string>;
+
+    std::vector<error_case> errors;
+    errors.push_back(error_case("(x + y", "expecting ')', found '', line: 1:7"));
+    errors.push_back(error_case("x + * y", "unexpected token: *, line: 1:5"));
+    errors.push_back(error_case("x + \n", "unexpected end of file, line: 2:1"));
+    errors.push_back(error_case("f[x y]", "expecting ']', found 'y', line: 1:5"));
+
+    for (const auto& c : errors)
+    {
+        std::string msg;
+
+        try
+        {
+            parse(c.first);
+        }
+        catch(std::exception& ex)
+        {
+            msg = ex.what();
+        };
+
+        if (msg != c.second)
+        {
+            std::cout << "invalid error message: " << msg << "\n";
+            ok = false;
+        };
+    };
+
+    if (ok == true)
+        std::cout << "test_parse: OK" << "\n";
+    else
+        std::cout << "test_parse: FAILED" << "\n";
+
+    // throughput
+    init_genrand(23);
+    rand_state r(6, 12, false, false);
+
+    std::ostringstream os;
+
+    for (size_t i = 0; i < 20000; ++i)
+    {
+        if (i > 0)
+            os << " + ";
+
+        os << "(" << to_string(r.rand_expr(0).first) << ")";
+    };
+
+    std::string str = os.str();
+
+    tic();
+    expr ex         = parse(str);
+    double t        = toc();
+
+    double mb       = str.size() / (1024.0 * 1024.0);
+
+    std::cout << "parsed: " << mb << " MB" << "\n";
+    std::cout << "parse time: " << t << "\n";
+    std::cout << "throughput: " << mb / t << " MB/s" << "\n";
+};
+
+void test_set::test_parse_file()
+{
+    std::cout << "\n" << "test parse file:" << "\n";
+
+    symbol x("x");
+    symbol y("y");
+    symbol f("f");
+
+    std::string text    = "a = x + y;  b = f[x, ...\n"
+                          "  y] % comment\n"
+                          "\n"
+                          "x^2; (x\n"
+                          " - y)\n"
+                          "%{ c = x %}\n";
+
+    std::vector<named_expr> res_ok;
+    res_ok.push_back(named_expr("a", x + y));
+    res_ok.push_back(named_expr("b", function(f, x, y)));
+    res_ok.push_back(named_expr("", power_int(x, 2)));
+    res_ok.push_back(named_expr("", x - y));
+
+    std::istringstream is(text);
+    std::vector<named_expr> res = parse_stream(is);
+
+    bool ok = res.size() == res_ok.size();
+
+    for (size_t i = 0; ok == true && i < res.size(); ++i)
+    {
+        res[i].second.cannonize();
+        res_ok[i].second.cannonize();
+
+        if (res[i].first != res_ok[i].first || res[i].second != res_ok[i].second)
+            ok = false;
+    };
+
+    // statements cannot have trailing tokens
+    std::string msg;
+
+    try
+    {
+        std::istringstream is2("a = x\nb = x y");
+        parse_stream(is2);
+    }
+    catch(std::exception& ex)
+    {
+        msg = ex.what();
+    };
+
+    if (msg != "unexpected token: y, line: 2:7")
+    {
+        std::cout << "invalid error message: " << msg << "\n";
+        ok = false;
+    };
+
+    // throughput
+    init_genrand(29);
+    rand_state r(6, 12, false, false);
+
+    std::string file_name   = "test_parse_file.txt";
+    size_t n_expr           = 20000;
+    std::vector<expr> ex_vec;
+
+    {
+        std::ofstream os(file_name);
+
+        for (size_t i = 0; i < n_expr; ++i)
+        {
+            ex_vec.push_back(r.rand_expr(0).first);
+            os << "e" << i << " = " << to_string(ex_vec.back()) << "\n";
+        };
+    };
+
+    tic();
+    res             = parse_file(file_name);
+    double t        = toc();
+
+    if (res.size() != n_expr)
+    {
+        ok = false;
+    }
+    else
+    {
+        for (size_t i = 0; i < n_expr; ++i)
+        {
+            // printed and parsed scalars need not be exactly equal
+            if (res[i].first != "e" + std::to_string(i))
+                ok = false;
+        };
+    };
+
+    std::remove(file_name.c_str());
+
+    if (ok == true)
+        std::cout << "test_parse_file: OK" << "\n";
+    else
+        std::cout << "test_parse_file: FAILED" << "\n";
+
+    std::cout << "expressions: " << n_expr << "\n";
+    std::cout << "parse time: " << t << "\n";
+};
+
+void test_set::test_sum_builder()
+{
+    std::cout << "\n" << "test sum builder:" << "\n";
+
+    init_genrand(31);
+
+    rand_state r(6, 8, false, false);
+    rand_data_provider dp(&r);
+
+    std::vector<expr> pool;
+
+    for (size_t i = 0; i < 500; ++i)
+        pool.push_back(r.rand_expr(0).first);
+
+    size_t n_terms      = 50000;
+
+    // incremental construction
+    tic();
+
+    expr sum_inc        = scalar::make_zero();
+
+    for (size_t i = 0; i < n_terms; ++i)
+    {
+        value c         = value(double(int(i % 7) - 3));
+        sum_inc         = std::move(sum_inc) + c * pool[(i * 7919) % pool.size()];
+    };
+
+    sum_inc.cannonize();
+    double t_inc        = toc();
+
+    // construction with sum_builder
+    tic();
+
+    sum_builder sb(pool.size());
+
+    for (size_t i = 0; i < n_terms; ++i)
+    {
+        value c         = value(double(int(i % 7) - 3));
+        sb.add(c, pool[(i * 7919) % pool.size()]);
+    };
+
+    expr sum_sb         = sb.make();
+    double t_sb         = toc();
+
+    double v_inc        = eval(sum_inc, dp).get_value();
+    double v_sb         = eval(sum_sb, dp).get_value();
+
+    bool ok             = std::abs(v_inc - v_sb) 
+                        <= 1e-8 * std::max(1.0, std::max(std::abs(v_inc), std::abs(v_sb)))
+                        || (v_inc != v_inc && v_sb != v_sb);
+
+    // product builder
+    symbol x("x1");
+    symbol y("x2");
+
+    product_builder pb;
+    pb.mult(power_int(x, 2));
+    pb.mult(x, -1);
+    pb.mult(value(3.0));
+    pb.mult(2 * y, 2);
+    pb.mult(y, value(0.5));
+
+    expr prod           = pb.make();
+    expr prod_ok        = power_int(x, 2) * power_int(x, -1) * 3 * power_int(2 * y, 2) 
+                        * power_real(y, 0.5);
+
+    double v_prod       = eval(prod, dp).get_value();
+    double v_prod_ok    = eval(prod_ok, dp).get_value();
+
+    if (std::abs(v_prod - v_prod_ok) > 1e-12 * std::abs(v_prod_ok))
+        ok = false;
+
+    if (ok == true)
+        std::cout << "test_sum_builder: OK" << "\n";
+    else
+        std::cout << "test_sum_builder: FAILED" << "\n";
+
+    std::cout << "terms: " << n_terms << "\n";
+    std::cout << "operator+ time: " << t_inc << "\n";
+    std::cout << "sum_builder time: " << t_sb << "\n";
+};
+
+// wide sum with many shared power bases
+static expr make_cse_test_sum(const std::vector<symbol>& x)
+{
+    expr ret            = scalar::make_zero();
+    size_t n            = x.size();
+
+    for (size_t i = 0; i < n; ++i)
+    for (size_t j = 0; j < n; ++j)
+    for (size_t k = 0; k < n; ++k)
+    {
+        value c         = value(double(i + 2 * j + 3 * k + 1));
+        ret             = std::move(ret) + c * x[i] * power_int(x[j], 2) 
+                            * power_int(x[k], 3);
+    };
+
+    return ret;
+};
+
+void test_set::test_cse_policy()
+{
+    std::cout << "\n" << "test cse policy:" << "\n";
+
+    init_genrand(37);
+
+    int n_sym           = 6;
+    rand_state r(n_sym, 8, false, false);
+    rand_data_provider dp(&r);
+
+    std::vector<symbol> x;
+
+    for (int i = 1; i <= n_sym; ++i)
+    {
+        std::ostringstream os;
+        os << "x" << i;
+        x.push_back(symbol(os.str().c_str()));
+    };
+
+    bool ok             = true;
+
+    // limited factorizations must be done first, otherwise result
+    // of full factorization is taken from cse hash
+    expr ex_rounds      = make_cse_test_sum(x);
+
+    tic();
+    cse_report rep_rounds = ex_rounds.cannonize(cse_policy().set_max_rounds(1));
+    double t_rounds     = toc();
+
+    if (rep_rounds.m_round_limited == 0 || rep_rounds.is_complete() == true)
+        ok = false;
+
+    expr ex_time        = make_cse_test_sum(x);
+    cse_report rep_time = ex_time.cannonize(cse_policy().set_time_limit(0.0));
+
+    if (rep_time.m_time_exceeded == false || rep_time.m_rounds != 0)
+        ok = false;
+
+    expr ex_work        = make_cse_test_sum(x);
+    cse_report rep_work = ex_work.cannonize(cse_policy().set_work_budget(100)
+                            .set_max_group_size(1));
+
+    if (rep_work.m_work_exceeded == false)
+        ok = false;
+
+    expr ex_full        = make_cse_test_sum(x);
+
+    tic();
+    cse_report rep_full = ex_full.cannonize(cse_policy());
+    double t_full       = toc();
+
+    if (rep_full.is_complete() == false)
+        ok = false;
+
+    // all results must be equivalent
+    double v_full       = eval(ex_full, dp).get_value();
+    double tol          = 1e-10 * std::max(1.0, std::abs(v_full));
+
+    if (std::abs(eval(ex_rounds, dp).get_value() - v_full) > tol)
+        ok = false;
+    if (std::abs(eval(ex_time, dp).get_value() - v_full) > tol)
+        ok = false;
+    if (std::abs(eval(ex_work, dp).get_value() - v_full) > tol)
+        ok = false;
+
+    // limited pass followed by a full pass on the same dag; the sum is
+    // shared by both products and result of the limited pass cannot be
+    // reused by the full pass
+    {
+        expr shared     = make_cse_test_sum(x);
+        expr prod_lim   = shared * x[0];
+        expr prod_full  = shared * x[1];
+
+        cse_report rep_lim = prod_lim.cannonize(cse_policy().set_max_rounds(1));
+
+        if (rep_lim.is_complete() == true)
+            ok = false;
+
+        // truncated result is not marked as fully cannonized
+        if (get_cannonize_level(prod_lim) != cannonize_level::light)
+            ok = false;
+
+        prod_full.cannonize(true);
+
+        expr prod_ref   = make_cse_test_sum(x) * x[1];
+        prod_ref.cannonize(true);
+
+        if (prod_full.get_ptr() != prod_ref.get_ptr())
+            ok = false;
+
+        // later cannonization with cse completes the truncated result
+        prod_lim.cannonize(true);
+
+        if (get_cannonize_level(prod_lim) != cannonize_level::full)
+            ok = false;
+
+        double v_compl  = eval(prod_lim, dp).get_value();
+        double v_lim    = eval(make_cse_test_sum(x) * x[0], dp).get_value();
+
+        if (std::abs(v_compl - v_lim) > 1e-10 * std::max(1.0, std::abs(v_lim)))
+            ok = false;
+    };
+
+    if (ok == true)
+        std::cout << "test_cse_policy: OK" << "\n";
+    else
+        std::cout << "test_cse_policy: FAILED" << "\n";
+
+    std::cout << "one round: time " << t_rounds << ", work " << rep_rounds.m_work << "\n";
+    std::cout << "unlimited: time " << t_full << ", work " << rep_full.m_work 
+              << ", rounds " << rep_full.m_rounds << "\n";
+};
+
+void test_set::test_extract_cse()
+{
+    std::cout << "\n" << "test extract cse:" << "\n";
+
+    init_genrand(41);
+
+    int n_sym           = 6;
+    rand_state r(n_sym, 10, false, false);
+    rand_data_provider dp(&r);
+
+    std::vector<symbol> x;
+
+    for (int i = 1; i <= n_sym; ++i)
+    {
+        std::ostringstream os;
+        os << "x" << i;
+        x.push_back(symbol(os.str().c_str()));
+    };
+
+    size_t n_failed     = 0;
+    size_t ops_before   = 0;
+    size_t ops_after    = 0;
+    size_t n_temps      = 0;
+    double time         = 0.0;
+
+    for (size_t k = 0; k < 50; ++k)
+    {
+        // function and its gradient
+        expr f          = r.rand_expr(0).first;
+
+        std::vector<expr> ex;
+        ex.push_back(f);
+
+        for (int i = 0; i < n_sym; ++i)
+            ex.push_back(diff(f, x[i]));
+
+        tic();
+        cse_program prog    = extract_cse(ex);
+        time            += toc();
+
+        ops_before      += prog.m_ops_before;
+        ops_after       += prog.m_ops_after;
+        n_temps         += prog.m_temps.size();
+
+        // substitute temporaries back
+        for (size_t i = 0; i < ex.size(); ++i)
+        {
+            expr res    = prog.m_outputs[i];
+
+            for (size_t j = prog.m_temps.size(); j > 0; --j)
+                res     = subs(res, prog.m_temps[j - 1], prog.m_temp_values[j - 1]);
+
+            double v1   = eval(ex[i], dp).get_value();
+            double v2   = eval(res, dp).get_value();
+
+            if (v1 == v2 || (v1 != v1 && v2 != v2))
+                continue;
+
+            if (std::abs(v1 - v2) > 1e-8 * std::max(1.0, std::abs(v1)))
+                ++n_failed;
+        };
+    };
+
+    if (ops_after > ops_before)
+        ++n_failed;
+
+    // input symbol with the name of the first temporary
+    {
+        symbol u("cse_1");
+        expr g          = x[0] * u + x[1];
+
+        std::vector<expr> ex;
+        ex.push_back(exp(g) + u);
+        ex.push_back(sin(g) * x[2]);
+
+        cse_program prog    = extract_cse(ex);
+
+        if (prog.m_temps.empty() == true)
+            ++n_failed;
+
+        for (const symbol& t : prog.m_temps)
+        {
+            if (t == u)
+                ++n_failed;
+        };
+    };
+
+    if (n_failed == 0)
+        std::cout << "test_extract_cse: OK" << "\n";
+    else
+        std::cout << "test_extract_cse: FAILED " << n_failed << "\n";
+
+    std::cout << "operations before: " << ops_before << "\n";
+    std::cout << "operations after: " << ops_after << "\n";
+    std::cout << "temporaries: " << n_temps << "\n";
+    std::cout << "time: " << time << "\n";
+};
+
+static std::vector<double> run_cse_predictor_test(rand_state& r, rand_data_provider& dp,
+                                    const std::shared_ptr<cse_predictor>& pred,
+                                    cse_predictor_stats& stats, double& time)
+{
+    set_cse_predictor(pred);
+    reset_cse_predictor_stats();
+
+    // the same workload for each predictor
+    init_genrand(43);
+
+    std::vector<double> ret;
+
+    tic();
+
+    for (size_t k = 0; k < 200; ++k)
+    {
+        expr ex         = r.rand_expr(0).first;
+        ex.cannonize(true);
+
+        ret.push_back(eval(ex, dp).get_value());
+    };
+
+    time                = toc();
+    stats               = get_cse_predictor_stats();
+
+    return ret;
+};
+
+void test_set::test_cse_predictor()
+{
+    std::cout << "\n" << "test cse predictor:" << "\n";
+
+    init_genrand(43);
+
+    int n_sym           = 6;
+    rand_state r(n_sym, 8, false, false);
+    rand_data_provider dp(&r);
+
+    std::vector<std::string> names;
+    std::vector<std::shared_ptr<cse_predictor>> preds;
+
+    names.push_back("dirichlet");
+    preds.push_back(make_cse_predictor_dirichlet());
+
+    names.push_back("always");
+    preds.push_back(make_cse_predictor_const(true));
+
+    names.push_back("never");
+    preds.push_back(make_cse_predictor_const(false));
+
+    names.push_back("cost model");
+    preds.push_back(make_cse_predictor_cost_model());
+
+    std::shared_ptr<cse_predictor> old_pred = get_cse_predictor();
+
+    size_t n_failed     = 0;
+    std::vector<double> ref;
+
+    for (size_t i = 0; i < preds.size(); ++i)
+    {
+        cse_predictor_stats stats;
+        double time;
+
+        std::vector<double> res = run_cse_predictor_test(r, dp, preds[i], stats, time);
+
+        if (i == 0)
+            ref         = res;
+
+        // prediction strategy cannot change results
+        for (size_t j = 0; j < res.size(); ++j)
+        {
+            double v1   = ref[j];
+            double v2   = res[j];
+
+            if (v1 == v2 || (v1 != v1 && v2 != v2))
+                continue;
+
+            if (std::abs(v1 - v2) > 1e-8 * std::max(1.0, std::abs(v1)))
+                ++n_failed;
+        };
+
+        if (preds[i] == preds[1] && stats.m_checks != stats.m_predictions)
+            ++n_failed;
+
+        if (preds[i] == preds[2] && stats.m_checks != 0)
+            ++n_failed;
+
+        std::cout << names[i] << ": time " << time << ", predictions " 
+                  << stats.m_predictions << ", accuracy " << stats.accuracy()
+                  << ", hits " << stats.m_hits << ", saved time " 
+                  << stats.m_saved_time << "\n";
+    };
+
+    set_cse_predictor(old_pred);
+
+    if (n_failed == 0)
+        std::cout << "test_cse_predictor: OK" << "\n";
+    else
+        std::cout << "test_cse_predictor: FAILED " << n_failed << "\n";
+};
+
+// sum with many repeated terms; coefficients are not exact, therefore
+// result depends on order of merging of repeated terms
+static expr make_wide_test_sum(const std::vector<symbol>& x, size_t n_terms)
+{
+    expr ret            = scalar::make_zero();
+    size_t n            = x.size();
+
+    for (size_t k = 0; k < n_terms; ++k)
+    {
+        size_t i        = (k * 7) % n;
+        size_t j        = (k * 13 + k / n) % n;
+        value c         = value(1.0 / double(k + 3));
+
+        ret             = std::move(ret) + c * x[i] * x[j];
+    };
+
+    return ret;
+};
+
+void test_set::test_parallel_cannonize()
+{
+    std::cout << "\n" << "test parallel cannonize:" << "\n";
+
+    init_genrand(47);
+
+    int n_sym           = 20;
+    rand_state r(n_sym, 8, false, false);
+    rand_data_provider dp(&r);
+
+    std::vector<symbol> x;
+
+    for (int i = 1; i <= n_sym; ++i)
+    {
+        std::ostringstream os;
+        os << "x" << i;
+        x.push_back(symbol(os.str().c_str()));
+    };
+
+    size_t old_threads  = get_cannonize_threads();
+    size_t old_min_size = get_cannonize_min_size();
+    size_t n_terms      = 200000;
+    bool ok             = true;
+
+    // default algorithm
+    set_cannonize_threads(1, size_t(-1));
+
+    expr ex_def         = make_wide_test_sum(x, n_terms);
+
+    tic();
+    ex_def.cannonize(false);
+    double t_def        = toc();
+
+    // stable algorithm, one thread
+    set_cannonize_threads(1, 1000);
+
+    expr ex_seq         = make_wide_test_sum(x, n_terms);
+
+    tic();
+    ex_seq.cannonize(false);
+    double t_seq        = toc();
+
+    // stable algorithm, many threads
+    set_cannonize_threads(4, 1000);
+
+    expr ex_par         = make_wide_test_sum(x, n_terms);
+
+    tic();
+    ex_par.cannonize(false);
+    double t_par        = toc();
+
+    set_cannonize_threads(old_threads, old_min_size);
+
+    // results must be identical
+    if (ex_seq.get_expr_handle() != ex_par.get_expr_handle())
+        ok = false;
+
+    double v_def        = eval(ex_def, dp).get_value();
+    double v_par        = eval(ex_par, dp).get_value();
+
+    if (std::abs(v_def - v_par) > 1e-10 * std::max(1.0, std::abs(v_def)))
+        ok = false;
+
+    if (ok == true)
+        std::cout << "test_parallel_cannonize: OK" << "\n";
+    else
+        std::cout << "test_parallel_cannonize: FAILED" << "\n";
+
+    std::cout << "default: " << t_def << ", one thread: " << t_seq 
+              << ", four threads: " << t_par << "\n";
+};
+
+void test_set::test_item_collector()
+{
+    std::cout << "\n" << "test item collector:" << "\n";
+
+    init_genrand(53);
+
+    int n_sym           = 50;
+    rand_state r(n_sym, 8, false, false);
+    rand_data_provider dp(&r);
+
+    std::vector<symbol> x;
+
+    for (int i = 1; i <= n_sym; ++i)
+    {
+        std::ostringstream os;
+        os << "x" << i;
+        x.push_back(symbol(os.str().c_str()));
+    };
+
+    // distinct terms of sums
+    std::vector<expr> terms;
+
+    for (int i = 0; i < n_sym; ++i)
+    for (int j = i; j < n_sym; ++j)
+        terms.push_back(x[i] * x[j]);
+
+    size_t n_failed     = 0;
+
+    for (size_t n_items = 10; n_items <= 100000; n_items *= 10)
+    {
+        // sum with repeated terms
+        expr sum        = scalar::make_zero();
+        double sum_val  = 0.0;
+        double sum_abs  = 0.0;
+
+        for (size_t k = 0; k < n_items; ++k)
+        {
+            const expr& t   = terms[(k * 31) % terms.size()];
+            double c        = double(k % 7) - 3.0;
+            double v        = c * eval(t, dp).get_value();
+
+            sum             = std::move(sum) + value(c) * t;
+            sum_val         += v;
+            sum_abs         += std::abs(v);
+        };
+
+        tic();
+        sum.cannonize(false);
+        double t_sum    = toc();
+
+        double v_sum    = eval(sum, dp).get_value();
+
+        if (std::abs(v_sum - sum_val) > 1e-10 * std::max(1.0, sum_abs))
+            ++n_failed;
+
+        // product of integer and real powers of the same bases
+        expr prod       = scalar::make_one();
+
+        for (size_t k = 0; k < n_items; ++k)
+        {
+            const symbol& s = x[(k * 17) % n_sym];
+
+            if (k % 2 == 0)
+                prod        = std::move(prod) * power_int(s, 1);
+            else
+                prod        = std::move(prod) * power_real(s, value(0.5));
+        };
+
+        tic();
+        prod.cannonize(false);
+        double t_prod   = toc();
+
+        // compare with product of powers of absolute values
+        double log_val  = 0.0;
+        double log_prod = 0.0;
+
+        for (size_t k = 0; k < n_items; ++k)
+        {
+            double v    = std::abs(eval(x[(k * 17) % n_sym], dp).get_value());
+            log_val     += (k % 2 == 0) ? std::log(v) : 0.5 * std::log(v);
+        };
+
+        double v_prod   = eval(prod, dp).get_value();
+        log_prod        = std::log(std::abs(v_prod));
+
+        if (v_prod == v_prod && v_prod != 0.0 && std::abs(log_prod) < 1e300
+            && std::abs(log_prod - log_val) > 1e-8 * std::max(1.0, std::abs(log_val)))
+        {
+            ++n_failed;
+        };
+
+        std::cout << "items " << n_items << ": sum " << t_sum << " ("
+                  << double(n_items) / std::max(t_sum, 1e-9) << " items/s), product " 
+                  << t_prod << " (" << double(n_items) / std::max(t_prod, 1e-9) 
+                  << " items/s)" << "\n";
+    };
+
+    if (n_failed == 0)
+        std::cout << "test_item_collector: OK" << "\n";
+    else
+        std::cout << "test_item_collector: FAILED " << n_failed << "\n";
+};
+
+static bool is_same_expr(const expr& a, const expr& b)
+{
+    return a.get_expr_handle() == b.get_expr_handle();
+};
+
+void test_set::test_expr_edit()
+{
+    std::cout << "\n" << "test expr edit:" << "\n";
+
+    int n_sym           = 8;
+    std::vector<symbol> x;
+
+    for (int i = 1; i <= n_sym; ++i)
+    {
+        std::ostringstream os;
+        os << "x" << i;
+        x.push_back(symbol(os.str().c_str()));
+    };
+
+    std::vector<expr> terms;
+
+    for (int i = 0; i < n_sym; ++i)
+    {
+        terms.push_back(x[i]);
+
+        for (int j = i; j < n_sym; ++j)
+            terms.push_back(x[i] * x[j]);
+    };
+
+    size_t n_failed     = 0;
+
+    for (size_t k = 0; k < 200; ++k)
+    {
+        expr sum        = scalar::make_zero();
+        expr sum2       = expr(value(0.5));
+
+        for (size_t m = 0; m < k % 20; ++m)
+        {
+            value c     = value(double(m % 5) - 1.75);
+            sum         = std::move(sum) + c * terms[(k * 7 + m * 13) % terms.size()];
+            sum2        = std::move(sum2) + c * terms[(k * 5 + m * 3) % terms.size()];
+        };
+
+        sum.cannonize(false);
+        sum2.cannonize(false);
+
+        const expr& t   = terms[(k * 11) % terms.size()];
+        value c         = value(double(k % 5) - 2.0);
+
+        // insert term
+        expr r1         = insert_term(sum, c, t);
+        expr r2         = sum + c * t;
+        r2.cannonize(false);
+
+        if (is_same_expr(r1, r2) == false)
+            ++n_failed;
+
+        // insert sum
+        expr r3         = insert_term(sum, c, sum2);
+        expr r4         = sum + c * sum2;
+        r4.cannonize(false);
+
+        if (is_same_expr(r3, r4) == false)
+            ++n_failed;
+
+        // remove term
+        value coef;
+        expr r5         = remove_term(r1, t, coef);
+        expr r6         = r1 - coef * t;
+        r6.cannonize(false);
+
+        if (is_same_expr(r5, r6) == false)
+            ++n_failed;
+
+        // scale
+        expr r7         = scale(sum, c);
+        expr r8         = c * sum;
+        r8.cannonize(false);
+
+        if (is_same_expr(r7, r8) == false)
+            ++n_failed;
+
+        // products
+        expr prod       = scalar::make_one();
+
+        for (size_t m = 0; m < k % 6; ++m)
+            prod        = std::move(prod) * power_int(x[(k + 3 * m) % n_sym], int(m % 3) - 1);
+
+        if (k % 4 == 0)
+            prod        = std::move(prod) * power_real(x[k % n_sym], value(0.5));
+
+        prod.cannonize(false);
+
+        const symbol& s = x[(k * 3) % n_sym];
+        int p           = int(k % 5) - 2;
+
+        expr r9         = insert_factor(prod, s, p);
+        expr r10        = prod * power_int(s, p);
+        r10.cannonize(false);
+
+        if (is_same_expr(r9, r10) == false)
+            ++n_failed;
+
+        int pow;
+        expr r11        = remove_factor(r9, s, pow);
+        expr r12        = r9 * power_int(s, -pow);
+        r12.cannonize(false);
+
+        if (is_same_expr(r11, r12) == false)
+            ++n_failed;
+    };
+
+    // large sum edited term by term
+    std::vector<expr> big_terms;
+
+    for (int i = 0; i < n_sym; ++i)
+    for (int j = i; j < n_sym; ++j)
+    for (int l = j; l < n_sym; ++l)
+    for (int m = l; m < n_sym; ++m)
+        big_terms.push_back(x[i] * x[j] * x[l] * x[m]);
+
+    expr big            = scalar::make_zero();
+
+    for (size_t i = 0; i < big_terms.size(); ++i)
+        big             = std::move(big) + value(double(i % 7) + 1.0) * big_terms[i];
+
+    big.cannonize(false);
+
+    size_t n_edits      = 100;
+
+    tic();
+
+    expr big_inc        = big;
+
+    for (size_t i = 0; i < n_edits; ++i)
+        big_inc         = insert_term(big_inc, value(0.5), big_terms[(i * 17) % big_terms.size()]);
+
+    double t_inc        = toc();
+
+    tic();
+
+    expr big_full       = big;
+
+    for (size_t i = 0; i < n_edits; ++i)
+    {
+        big_full        = big_full + value(0.5) * big_terms[(i * 17) % big_terms.size()];
+        big_full.cannonize(false);
+    };
+
+    double t_full       = toc();
+
+    if (is_same_expr(big_inc, big_full) == false)
+        ++n_failed;
+
+    if (n_failed == 0)
+        std::cout << "test_expr_edit: OK" << "\n";
+    else
+        std::cout << "test_expr_edit: FAILED " << n_failed << "\n";
+
+    std::cout << "terms: " << big_terms.size() << ", incremental: " << t_inc 
+              << ", full cannonization: " << t_full << "\n";
+};
+
+// value of a symbol depends only on the number following the first
+// character of its name
+class suffix_data_provider : public sym_arrow::data_provider
+{
+    public:
+        virtual value get_value(const symbol& sh) const override
+        {
+            return value(1.0 + 0.1 * std::atof(sh.get_name() + 1));
+        };
+
+        virtual value eval_function(const symbol&, const value*, size_t) const override
+        {
+            return value::make_zero();
+        };
+};
+
+// build a workload with symbols prefix1, prefix2, ...; return time of
+// cannonization
+static double run_order_test(const std::string& prefix, int n_sym, 
+                             std::vector<expr>& res, std::vector<expr>& res_rev)
+{
+    std::vector<symbol> x;
+
+    for (int i = 1; i <= n_sym; ++i)
+    {
+        std::ostringstream os;
+        os << prefix << i;
+        x.push_back(symbol(os.str().c_str()));
+    };
+
+    std::vector<expr> terms;
+
+    for (int i = 0; i < n_sym; ++i)
+    for (int j = i; j < n_sym; ++j)
+        terms.push_back(power_int(x[i], 1 + j % 3) * x[j]);
+
+    tic();
+
+    for (size_t k = 0; k < 50; ++k)
+    {
+        expr sum        = scalar::make_zero();
+
+        for (size_t m = 0; m < terms.size(); ++m)
+        {
+            if ((m + k) % 3 == 0)
+                continue;
+
+            sum         = std::move(sum) + value(double(m % 5) + 1.0) * terms[m];
+        };
+
+        sum             = std::move(sum) * (x[k % n_sym] + x[(k * 7) % n_sym]);
+        sum.cannonize();
+        res.push_back(sum);
+    };
+
+    double time         = toc();
+
+    // the same expressions with terms added in reversed order
+    for (size_t k = 0; k < 50; ++k)
+    {
+        expr sum        = scalar::make_zero();
+
+        for (size_t m = terms.size(); m > 0; --m)
+        {
+            if ((m - 1 + k) % 3 == 0)
+                continue;
+
+            sum         = std::move(sum) + value(double((m - 1) % 5) + 1.0) * terms[m - 1];
+        };
+
+        sum             = std::move(sum) * (x[k % n_sym] + x[(k * 7) % n_sym]);
+        sum.cannonize();
+        res_rev.push_back(sum);
+    };
+
+    return time;
+};
+
+static const int order_test_n_sym  = 12;
+
+int test_set::run_deterministic_order(const char* file)
+{
+    set_deterministic_ordering(true);
+
+    std::vector<expr> res, res_rev;
+    double time         = run_order_test("d", order_test_n_sym, res, res_rev);
+
+    suffix_data_provider dp;
+    size_t n_failed     = 0;
+
+    for (size_t i = 0; i < res.size(); ++i)
+    {
+        // hash consing works in deterministic mode
+        if (is_same_expr(res[i], res_rev[i]) == false)
+            ++n_failed;
+
+        if (to_string(res[i]) != to_string(res_rev[i]))
+            ++n_failed;
+    };
+
+    std::ofstream os(file);
+    os << std::setprecision(17);
+    os << n_failed << " " << time << "\n";
+
+    for (size_t i = 0; i < res.size(); ++i)
+        os << to_string(res[i]) << "\n" << eval(res[i], dp).get_value() << "\n";
+
+    return os.good() ? 0 : 1;
+};
+
+void test_set::test_deterministic_order(const char* program)
+{
+    std::cout << "\n" << "test deterministic order:" << "\n";
+
+    size_t n_failed     = 0;
+
+    std::vector<expr> res_ptr, res_ptr_rev;
+    double t_ptr        = run_order_test("p", order_test_n_sym, res_ptr, res_ptr_rev);
+
+    suffix_data_provider dp;
+
+    for (size_t i = 0; i < res_ptr.size(); ++i)
+    {
+        // hash consing works with pointer ordering
+        if (is_same_expr(res_ptr[i], res_ptr_rev[i]) == false)
+            ++n_failed;
+    };
+
+    // mode cannot be changed when expressions exist
+    {
+        bool thrown     = false;
+
+        try
+        {
+            set_deterministic_ordering(true);
+        }
+        catch (std::exception&)
+        {
+            thrown      = true;
+        };
+
+        if (thrown == false || get_deterministic_ordering() == true)
+            ++n_failed;
+    };
+
+    // deterministic ordering cannot be changed when expressions exist; the
+    // workload is run twice in new processes, where memory layouts differ
+    std::vector<std::string> printed[2];
+    double t_det        = 0.0;
+
+    for (int run = 0; run < 2; ++run)
+    {
+        std::ostringstream name;
+        name << "sym_arrow_order_test_" << run << ".txt";
+
+        std::string file    = temp_file_path(name.str());
+        std::string cmd     = "\"" + std::string(program) + "\" --deterministic-order \""
+                            + file + "\"";
+
+        if (std::system(cmd.c_str()) != 0)
+        {
+            std::cout << "unable to run: " << cmd << "\n";
+            ++n_failed;
+            continue;
+        };
+
+        std::ifstream is(file);
+
+        size_t n_failed_run = 1;
+        is >> n_failed_run >> t_det;
+        n_failed            += n_failed_run;
+
+        std::string line;
+        std::getline(is, line);
+
+        for (size_t i = 0; std::getline(is, line); ++i)
+        {
+            printed[run].push_back(line);
+
+            if (!std::getline(is, line) || i >= res_ptr.size())
+            {
+                ++n_failed;
+                break;
+            };
+
+            double v1       = eval(res_ptr[i], dp).get_value();
+            double v2       = std::strtod(line.c_str(), nullptr);
+
+            if (std::abs(v1 - v2) > 1e-10 * (1.0 + std::abs(v1)))
+                ++n_failed;
+        };
+
+        is.close();
+        std::remove(file.c_str());
+    };
+
+    // printed expressions do not depend on memory layout
+    if (printed[0].size() != res_ptr.size() || printed[0] != printed[1])
+        ++n_failed;
+
+    if (n_failed == 0)
+        std::cout << "test_deterministic_order: OK" << "\n";
+    else
+        std::cout << "test_deterministic_order: FAILED " << n_failed << "\n";
+
+    std::cout << "pointer order: " << t_ptr << ", deterministic order: " << t_det << "\n";
+};
+
+// evaluate n random expressions; return evaluation time
+static double run_lazy_eval_test(size_t n, std::vector<expr>& ex, std::vector<value>& res)
+{
+    init_genrand(81);
+
+    rand_state r(6, 10, false, false);
+    rand_data_provider dp(&r);
+
+    for (size_t i = 0; i < n; ++i)
+        ex.push_back(r.rand_expr(0).first);
+
+    tic();
+
+    for (size_t i = 0; i < n; ++i)
+        res.push_back(eval(ex[i], dp));
+
+    return toc();
+};
+
+// nested sums under products and functions; such sums are cannonized
+// when the enclosing expression is built
+static void make_nested_sums(std::vector<expr>& ex, bool light)
+{
+    symbol a("a"), b("b"), c("c"), x("x"), f("f");
+
+    expr s1             = a * b + a * c;
+    expr s2             = power_int(a, 2) * b + a * b * c;
+
+    ex.push_back(exp(x) * s1);
+    ex.push_back(x * power_real(s2, value(0.5)));
+    ex.push_back(function(f, s1, x));
+    ex.push_back(function(f, x * s2) + x);
+    ex.push_back(x * (function(f, s1) + s2));
+
+    // light results are cached on build nodes
+    if (light == true)
+    {
+        for (const expr& e : ex)
+            e.cannonize(false);
+    };
+};
+
+void test_set::test_lazy_cannonize()
+{
+    std::cout << "\n" << "test lazy cannonize:" << "\n";
+
+    bool old_mode       = get_lazy_cannonization();
+    size_t n            = 2000;
+    size_t n_failed     = 0;
+
+    std::vector<expr> ex_eager, ex_lazy;
+    std::vector<value> res_eager, res_lazy;
+
+    set_lazy_cannonization(false);
+    double t_eager      = run_lazy_eval_test(n, ex_eager, res_eager);
+
+    set_lazy_cannonization(true);
+    double t_lazy       = run_lazy_eval_test(n, ex_lazy, res_lazy);
+
+    for (size_t i = 0; i < n; ++i)
+    {
+        // evaluated expressions are cannonized
+        if (get_cannonize_level(ex_eager[i]) == cannonize_level::none)
+            ++n_failed;
+
+        if (get_cannonize_level(ex_lazy[i]) == cannonize_level::none)
+            ++n_failed;
+
+        double v1       = res_eager[i].get_value();
+        double v2       = res_lazy[i].get_value();
+
+        if (v1 == v2 || (v1 != v1 && v2 != v2))
+            continue;
+
+        if (std::abs(v1 - v2) > 1e-8 * std::max(std::abs(v1), std::abs(v2)))
+            ++n_failed;
+    };
+
+    // full cannonical form is materialized on demand
+    tic();
+
+    for (size_t i = 0; i < n; ++i)
+    {
+        ex_lazy[i].cannonize();
+
+        if (get_cannonize_level(ex_lazy[i]) != cannonize_level::full)
+            ++n_failed;
+    };
+
+    double t_full       = toc();
+
+    // full cannonical form is the same as in eager mode
+    for (size_t i = 0; i < n; ++i)
+    {
+        if (ex_lazy[i].get_ptr() != ex_eager[i].get_ptr())
+            ++n_failed;
+    };
+
+    std::vector<expr> nest_eager, nest_lazy;
+
+    set_lazy_cannonization(false);
+    make_nested_sums(nest_eager, false);
+
+    set_lazy_cannonization(true);
+    make_nested_sums(nest_lazy, true);
+
+    for (size_t i = 0; i < nest_lazy.size(); ++i)
+    {
+        nest_eager[i].cannonize();
+        nest_lazy[i].cannonize();
+
+        if (nest_lazy[i].get_ptr() != nest_eager[i].get_ptr())
+            ++n_failed;
+
+        if (get_cannonize_level(nest_lazy[i]) != cannonize_level::full)
+            ++n_failed;
+    };
+
+    set_lazy_cannonization(old_mode);
+
+    if (n_failed == 0)
+        std::cout << "test_lazy_cannonize: OK" << "\n";
+    else
+        std::cout << "test_lazy_cannonize: FAILED " << n_failed << "\n";
+
+    std::cout << "eager eval: " << t_eager << ", lazy eval: " << t_lazy 
+              << ", materialization: " << t_full << "\n";
+};
+
+// return number of terms of a sum
+static size_t num_terms(const expr& ex)
+{
+    if (get_expression_type(ex) != ast::term_types::add_rep)
+        return 1;
+
+    const add_expr& h   = cast_add(ex);
+    return h.size() + (h.V0().is_zero() ? 0 : 1);
+};
+
+void test_set::test_expand()
+{
+    std::cout << "\n" << "test expand:" << "\n";
+
+    symbol x("x");
+    symbol y("y");
+    symbol z("z");
+    symbol f("f");
+
+    suffix_data_provider dp;
+    size_t n_failed     = 0;
+
+    std::vector<expr> ex;
+    ex.push_back((x + y) * (x - y));
+    ex.push_back(power_int(x + y + value(1.0), 4));
+    ex.push_back((x + value(2.0)) * (y + value(3.0)) * (z - x));
+    ex.push_back(power_int(x + y, 3) / (x - y) + exp(x) * (x + z));
+    ex.push_back(function(f, x + y) * (x + value(1.0)) + power_real(x + z, value(0.5)) * y);
+    ex.push_back(power_int(x + y, 2) - power_int(x - y, 2) - value(4.0) * x * y);
+
+    for (size_t i = 0; i < ex.size(); ++i)
+    {
+        expr e          = expand(ex[i]);
+        expr c          = collect(ex[i], std::vector<symbol>{x});
+
+        double v0       = eval(ex[i], dp).get_value();
+        double v1       = eval(e, dp).get_value();
+        double v2       = eval(c, dp).get_value();
+
+        if (std::abs(v0 - v1) > 1e-10 * (1.0 + std::abs(v0)))
+            ++n_failed;
+
+        if (std::abs(v0 - v2) > 1e-10 * (1.0 + std::abs(v0)))
+            ++n_failed;
+    };
+
+    // known sizes
+    if (num_terms(expand(ex[0])) != 2)
+        ++n_failed;
+
+    if (num_terms(expand(ex[1])) != 15)
+        ++n_failed;
+
+    if (expand(ex[5]) != expr(value(0.0)))
+        ++n_failed;
+
+    // collection by all symbols is expansion
+    if (collect(ex[1], std::vector<symbol>{x, y}) != expand(ex[1]))
+        ++n_failed;
+
+    // expansion of a large polynomial
+    int n_sym           = 8;
+    int pow             = 8;
+    std::vector<symbol> s;
+    expr sum            = value(1.0);
+
+    for (int i = 1; i <= n_sym; ++i)
+    {
+        std::ostringstream os;
+        os << "s" << i;
+        s.push_back(symbol(os.str().c_str()));
+        sum             = std::move(sum) + s.back();
+    };
+
+    expr big            = power_int(sum, pow);
+
+    tic();
+    expr big_exp        = expand(big);
+    double t_exp        = toc();
+
+    // number of monomials of degree at most pow in n_sym variables
+    size_t n_big        = 1;
+
+    for (int i = 1; i <= n_sym; ++i)
+        n_big           = n_big * (pow + i) / i;
+
+    if (num_terms(big_exp) != n_big)
+        ++n_failed;
+
+    double v0           = eval(big, dp).get_value();
+    double v1           = eval(big_exp, dp).get_value();
+
+    if (std::abs(v0 - v1) > 1e-10 * std::abs(v0))
+        ++n_failed;
+
+    if (n_failed == 0)
+        std::cout << "test_expand: OK" << "\n";
+    else
+        std::cout << "test_expand: FAILED " << n_failed << "\n";
+
+    std::cout << "terms: " << n_big << ", expansion time: " << t_exp << "\n";
+};
+
+void test_set::test_subs_shared()
+{
+    std::cout << "\n" << "test subs shared:" << "\n";
+
+    symbol x("x");
+    symbol y("y");
+    symbol z("z");
+    symbol g("g");
+
+    suffix_data_provider dp;
+    size_t n_failed     = 0;
+
+    // substitution in all kinds of terms
+    expr ex             = power_int(x + y, 3) * exp(x * y) + log(x * y + value(2.0))
+                        + power_real(x + z, value(0.5)) * y;
+    expr sub            = z + value(1.0);
+    expr ex_sub         = subs(ex, x, sub);
+    expr ex_direct      = power_int(sub + y, 3) * exp(sub * y) + log(sub * y + value(2.0))
+                        + power_real(sub + z, value(0.5)) * y;
+
+    double v0           = eval(ex_sub, dp).get_value();
+    double v1           = eval(ex_direct, dp).get_value();
+
+    if (std::abs(v0 - v1) > 1e-10 * (1.0 + std::abs(v0)))
+        ++n_failed;
+
+    if (subs(ex, g, sub) != ex)
+        ++n_failed;
+
+    // every level uses the previous level twice; the tree has 2^depth
+    // leaves, but the dag has only depth nodes
+    int depth           = 40;
+    expr e              = x;
+
+    for (int i = 0; i < depth; ++i)
+        e               = function(g, e, e * x);
+
+    tic();
+    expr e_y            = subs(e, x, y);
+    expr e_x            = subs(e_y, y, x);
+    double t_subs       = toc();
+
+    if (e_x != e)
+        ++n_failed;
+
+    if (e_y == e)
+        ++n_failed;
+
+    if (n_failed == 0)
+        std::cout << "test_subs_shared: OK" << "\n";
+    else
+        std::cout << "test_subs_shared: FAILED " << n_failed << "\n";
+
+    std::cout << "depth: " << depth << ", subs time: " << t_subs << "\n";
+};
+
+void test_set::test_subs_batch()
+{
+    std::cout << "\n" << "test subs batch:" << "\n";
+
+    int n_sym           = 20;
+    std::vector<symbol> x;
+
+    for (int i = 1; i <= n_sym; ++i)
+    {
+        std::ostringstream os;
+        os << "x" << i;
+        x.push_back(symbol(os.str().c_str()));
+    };
+
+    symbol a("a");
+    symbol b("b");
+
+    // template expression; only a part depends on parameters a and b
+    expr ex             = scalar::make_zero();
+
+    for (int i = 0; i < n_sym; ++i)
+    {
+        expr t          = power_int(x[i] + x[(i + 1) % n_sym], 2) * exp(x[i]);
+        ex              = std::move(ex) + std::move(t);
+
+        if (i % 4 == 0)
+            ex          = std::move(ex) + a * x[i] + log(b + x[i] * x[i]);
+    };
+
+    std::vector<symbol> params{a, b};
+    std::vector<std::vector<expr>> bindings;
+
+    int n_bind          = 1000;
+
+    for (int k = 0; k < n_bind; ++k)
+    {
+        value va        = value(0.5 + 0.01 * k);
+        value vb        = value(1.0 + 0.02 * k);
+
+        if (k % 10 == 0)
+            bindings.push_back(std::vector<expr>{va * x[0], expr(vb)});
+        else
+            bindings.push_back(std::vector<expr>{expr(va), expr(vb)});
+    };
+
+    tic();
+    std::vector<expr> res = subs_batch(ex, params, bindings);
+    double t_batch      = toc();
+
+    tic();
+    std::vector<expr> res2;
+
+    for (int k = 0; k < n_bind; ++k)
+    {
+        subs_context sc;
+        sc.add_symbol(a, bindings[k][0]);
+        sc.add_symbol(b, bindings[k][1]);
+
+        res2.push_back(subs(ex, sc));
+    };
+
+    double t_subs       = toc();
+
+    size_t n_failed     = 0;
+
+    for (int k = 0; k < n_bind; ++k)
+    {
+        if (res[k] != res2[k])
+            ++n_failed;
+    };
+
+    // binding a symbol to itself does not change the expression
+    std::vector<std::vector<expr>> id{std::vector<expr>{expr(a), expr(b)}};
+
+    if (subs_batch(ex, params, id)[0] != ex)
+        ++n_failed;
+
+    if (n_failed == 0)
+        std::cout << "test_subs_batch: OK" << "\n";
+    else
+        std::cout << "test_subs_batch: FAILED " << n_failed << "\n";
+
+    std::cout << "bindings: " << n_bind << ", batch time: " << t_batch 
+              << ", subs time: " << t_subs << "\n";
+};
+
+void test_set::test_diff_rules()
+{
+    std::cout << "\n" << "test diff rules:" << "\n";
+
+    diff_context dc;
+
+    symbol f("f");
+    symbol g("g");
+    symbol x("x");
+    symbol u("u");
+    symbol y("y");
+
+    suffix_data_provider dp;
+    size_t n_failed     = 0;
+
+    // f[x] behaves like x^2, g[x, u] behaves like x * u
+    symbol args[2]      = {x, u};
+
+    dc.add_diff_rule(f, 1, &x, 0, value(2.0) * x);
+    dc.add_diff_rule(g, 2, args, 0, u);
+    dc.add_diff_rule(g, 2, args, 1, x);
+
+    expr d1             = diff(function(f, y * y), y, dc);
+    expr d2             = diff(function(g, y, power_int(y, 3)), y, dc);
+
+    double v1           = eval(d1, dp).get_value();
+    double v2           = eval(d2, dp).get_value();
+    double yv           = dp.get_value(y).get_value();
+
+    if (std::abs(v1 - 4.0 * yv * yv * yv) > 1e-12)
+        ++n_failed;
+
+    if (std::abs(v2 - 4.0 * yv * yv * yv) > 1e-12)
+        ++n_failed;
+
+    // repeated application gives the same result
+    if (diff(function(f, y * y), y, dc) != d1)
+        ++n_failed;
+
+    // rule body independent of arguments
+    dc.add_diff_rule(f, 2, args, 0, u);
+    dc.add_diff_rule(f, 2, args, 1, value(3.0));
+
+    double v3           = eval(diff(function(f, y, y), y, dc), dp).get_value();
+
+    if (std::abs(v3 - (yv + 3.0)) > 1e-12)
+        ++n_failed;
+
+    // many applications of diff rules
+    int n_sym           = 200;
+    expr ex             = scalar::make_zero();
+
+    for (int i = 1; i <= n_sym; ++i)
+    {
+        std::ostringstream os;
+        os << "x" << i;
+        symbol xi       = symbol(os.str().c_str());
+
+        ex              = std::move(ex) + function(f, xi * y) * function(g, y, xi);
+    };
+
+    int n_dif           = 3;
+    expr ex_dif         = ex;
+
+    tic();
+
+    for (int i = 0; i < n_dif; ++i)
+        ex_dif          = diff(ex_dif, y, dc);
+
+    double t            = toc();
+
+    if (n_failed == 0)
+        std::cout << "test_diff_rules: OK" << "\n";
+    else
+        std::cout << "test_diff_rules: FAILED " << n_failed << "\n";
+
+    std::cout << "function calls: " << n_sym << ", diff time: " << t << "\n";
+};
+
+// data provider evaluating functions usin and ucos
+class trig_data_provider : public suffix_data_provider
+{
+    public:
+        virtual value eval_function(const symbol& f, const value* args, size_t) const override
+        {
+            double x    = args[0].get_value();
+
+            if (std::string(f.get_name()) == "usin")
+                return value(std::sin(x));
+            else
+                return value(std::cos(x));
+        };
+};
+
+void test_set::test_builtin_functions()
+{
+    std::cout << "\n" << "test builtin functions:" << "\n";
+
+    symbol x("x3");
+    symbol y("y5");
+
+    trig_data_provider dp;
+    size_t n_failed     = 0;
+
+    double xv           = dp.get_value(x).get_value();
+    double yv           = dp.get_value(y).get_value();
+
+    // values
+    std::vector<expr> ex{sin(x), cos(x), tanh(x), erf(x), sqrt(x), atan2(x, y), logistic(x)};
+    std::vector<double> v{std::sin(xv), std::cos(xv), std::tanh(xv), std::erf(xv), 
+                          std::sqrt(xv), std::atan2(xv, yv), 1.0 / (1.0 + std::exp(-xv))};
+
+    for (size_t i = 0; i < ex.size(); ++i)
+    {
+        if (std::abs(eval(ex[i], dp).get_value() - v[i]) > 1e-14)
+            ++n_failed;
+    };
+
+    // scalar arguments are evaluated
+    if (sin(expr(value(0.0))) != expr(value(0.0)))
+        ++n_failed;
+
+    // derivatives compared with finite differences
+    double h            = 1e-6;
+
+    for (size_t i = 0; i < ex.size(); ++i)
+    {
+        expr d          = diff(ex[i], x);
+        double dv       = eval(d, dp).get_value();
+
+        expr ex_p       = subs(ex[i], x, x + value(h));
+        expr ex_m       = subs(ex[i], x, x - value(h));
+        double fd       = (eval(ex_p, dp).get_value() - eval(ex_m, dp).get_value()) / (2.0 * h);
+
+        if (std::abs(dv - fd) > 1e-7)
+            ++n_failed;
+    };
+
+    expr dy             = diff(atan2(x, y), y);
+
+    if (std::abs(eval(dy, dp).get_value() + xv / (xv * xv + yv * yv)) > 1e-14)
+        ++n_failed;
+
+    if (diff(sin(x), x) != cos(x))
+        ++n_failed;
+
+    // sqrt is not defined for negative numbers
+    if (eval(sqrt(expr(value(-4.0))), dp).is_nan() == false)
+        ++n_failed;
+
+    if (std::abs(eval(diff(sqrt(x), x), dp).get_value() - 0.5 / std::sqrt(xv)) > 1e-14)
+        ++n_failed;
+
+    // user functions with names of builtin functions are not builtin
+    {
+        symbol sin_u("sin");
+        symbol cos_u("cos");
+        symbol z("z");
+
+        diff_context dc_u;
+        dc_u.add_diff_rule(sin_u, 1, &z, 0, function(cos_u, z));
+
+        expr ex_u       = function(sin_u, x);
+
+        if (ex_u == sin(x) || parse("sin[x3]") != ex_u)
+            ++n_failed;
+
+        // trig_data_provider evaluates functions other than usin as cos
+        if (std::abs(eval(ex_u, dp).get_value() - std::cos(xv)) > 1e-14)
+            ++n_failed;
+
+        if (diff(ex_u, x, dc_u) != function(cos_u, x))
+            ++n_failed;
+    };
+
+    // sin and cos of the same argument
+    expr one            = power_int(sin(x * y), 2) + power_int(cos(x * y), 2);
+
+    if (std::abs(eval(one, dp).get_value() - 1.0) > 1e-14)
+        ++n_failed;
+
+    // compiled evaluation
+    std::vector<symbol> inputs{x, y};
+    expr ex_c           = sin(x) * atan2(x, y) + logistic(y * x) - erf(tanh(y));
+    compiled_expr ce(ex_c, inputs);
+
+    double in[2]        = {xv, yv};
+    double out[1];
+    ce.eval(in, out, dp);
+
+    if (std::abs(out[0] - eval(ex_c, dp).get_value()) > 1e-14)
+        ++n_failed;
+
+    // builtin functions and user functions with diff rules
+    diff_context dc;
+    symbol usin("usin");
+    symbol ucos("ucos");
+    symbol z("z");
+
+    dc.add_diff_rule(usin, 1, &z, 0, function(ucos, z));
+    dc.add_diff_rule(ucos, 1, &z, 0, -function(usin, z));
+
+    int n_sym           = 200;
+    expr ex_b           = scalar::make_zero();
+    expr ex_u           = scalar::make_zero();
+
+    for (int i = 1; i <= n_sym; ++i)
+    {
+        std::ostringstream os;
+        os << "x" << i;
+        symbol xi       = symbol(os.str().c_str());
+
+        ex_b            = std::move(ex_b) + sin(xi * y) * cos(xi * y);
+        ex_u            = std::move(ex_u) + function(usin, xi * y) * function(ucos, xi * y);
+    };
+
+    int n_dif           = 3;
+
+    tic();
+    expr d_b            = diff(ex_b, y, n_dif);
+    double v_b          = eval(d_b, dp).get_value();
+    double t_b          = toc();
+
+    tic();
+    expr d_u            = diff(ex_u, y, n_dif, dc);
+    double v_u          = eval(d_u, dp).get_value();
+    double t_u          = toc();
+
+    if (std::abs(v_b - v_u) > 1e-10 * (1.0 + std::abs(v_b)))
+        ++n_failed;
+
+    if (n_failed == 0)
+        std::cout << "test_builtin_functions: OK" << "\n";
+    else
+        std::cout << "test_builtin_functions: FAILED " << n_failed << "\n";
+
+    std::cout << "builtin diff and eval: " << t_b << ", user functions: " << t_u << "\n";
+};
+
+// static provider with values of rand_state symbols; functions are
+// evaluated to zero as in rand_data_provider
+class rand_indexed_provider
+{
+    private:
+        std::vector<value>  m_values;
+
+    public:
+        rand_indexed_provider(const std::vector<symbol>& syms, const rand_data_provider& dp)
+        {
+            for (const symbol& s : syms)
+            {
+                size_t code = s.get_symbol_code();
+
+                if (code >= m_values.size())
+                    m_values.resize(code + 1);
+
+                m_values[code] = dp.get_value(s);
+            };
+        };
+
+        const value*    values() const  { return m_values.data(); };
+        size_t          size() const    { return m_values.size(); };
+
+        value eval_function(size_t, const value*, size_t) const
+        {
+            return value::make_zero();
+        };
+};
+
+void test_set::test_static_eval()
+{
+    std::cout << "\n" << "test static evaluation:" << "\n";
+
+    init_genrand(23);
+
+    int n_sym           = 6;
+    rand_state r(n_sym, 12, false, false);
+    rand_data_provider dp(&r);
+
+    std::vector<symbol> syms;
+
+    for (int i = 1; i <= n_sym; ++i)
+    {
+        std::ostringstream os;
+        os << "x" << i;
+        syms.push_back(symbol(os.str().c_str()));
+    };
+
+    rand_indexed_provider sp(syms, dp);
+
+    size_t n_failed     = 0;
+    std::vector<expr> ex_vec;
+
+    for (size_t i = 0; i < 1000; ++i)
+    {
+        expr ex         = r.rand_expr(0).first;
+        ex_vec.push_back(ex);
+
+        value v1        = eval(ex, dp);
+        value v2        = eval(ex, sp);
+
+        if (v1.get_value() == v2.get_value() || (v1.is_nan() && v2.is_nan()))
+            continue;
+
+        ++n_failed;
+    };
+
+    // builtin functions and indexed_data_provider
+    {
+        symbol x        = syms[0];
+        expr ex         = sin(x) * cos(x) + atan2(x, syms[1]);
+
+        indexed_data_provider ip;
+        ip.set_value(x, dp.get_value(x));
+        ip.set_value(syms[1], dp.get_value(syms[1]));
+
+        if (eval(ex, ip).get_value() != eval(ex, dp).get_value())
+            ++n_failed;
+
+        // symbol without value
+        bool thrown     = false;
+
+        try
+        {
+            eval(ex * syms[2], indexed_data_provider());
+        }
+        catch (std::exception&)
+        {
+            thrown      = true;
+        };
+
+        if (thrown == false)
+            ++n_failed;
+
+        // symbol without value, but with code less than size()
+        indexed_data_provider ip2;
+        ip2.set_value(symbol("static_eval_last"), value(1.0));
+        ip2.set_value(x, value(1.0));
+
+        thrown          = false;
+
+        try
+        {
+            eval(x * syms[2], ip2);
+        }
+        catch (std::exception&)
+        {
+            thrown      = true;
+        };
+
+        if (thrown == false || syms[2].get_symbol_code() >= ip2.size())
+            ++n_failed;
+    };
+
+    if (n_failed == 0)
+        std::cout << "test_static_eval: OK" << "\n";
+    else
+        std::cout << "test_static_eval: FAILED " << n_failed << "\n";
+
+    // virtual versus static data provider
+    size_t n_eval       = 100;
+
+    tic();
+    for (size_t j = 0; j < n_eval; ++j)
+    {
+        for (const expr& ex : ex_vec)
+            eval(ex, dp);
+    };
+    double t_virt       = toc();
+
+    tic();
+    for (size_t j = 0; j < n_eval; ++j)
+    {
+        for (const expr& ex : ex_vec)
+            eval(ex, sp);
+    };
+    double t_static     = toc();
+
+    std::cout << "virtual provider: " << t_virt << ", static provider: " << t_static << "\n";
+};
+
+static bool is_close(double a, double b, double tol)
+{
+    return std::abs(a - b) <= tol * std::max(1.0, std::max(std::abs(a), std::abs(b)));
+};
+
+void test_set::test_forward_diff()
+{
+    std::cout << "\n" << "test forward diff:" << "\n";
+
+    diff_context dc;
+    symbol usin("usin");
+    symbol ucos("ucos");
+    symbol z("z");
+
+    dc.add_diff_rule(usin, 1, &z, 0, function(ucos, z));
+    dc.add_diff_rule(ucos, 1, &z, 0, -function(usin, z));
+
+    trig_data_provider dp;
+    size_t n_failed     = 0;
+
+    std::vector<symbol> x   = {symbol("x1"), symbol("x2"), symbol("x3")};
+    std::vector<value> dir1 = {value(0.3), value(-0.7), value(0.5)};
+    std::vector<value> dir2 = {value(0.2), value(0.4), value(-0.1)};
+
+    expr ex             = sin(x[0] * x[1]) + exp(x[2]) * power_real(x[0], value(2.5))
+                        + log(x[1]) * power_int(x[2], 3) + atan2(x[0], x[2])
+                        + tanh(x[0] - x[1]) / x[2] + function(usin, x[0] * x[2])
+                        + erf(x[1]) * logistic(x[0]);
+
+    dual_value dv       = eval_dual(ex, dp, x, dir1, dc);
+    hyper_dual_value hv = eval_hyper_dual(ex, dp, x, dir1, dir2, dc);
+
+    double v            = eval(ex, dp).get_value();
+    double d1           = 0.0;
+    double d2           = 0.0;
+    double d12          = 0.0;
+
+    for (size_t k = 0; k < x.size(); ++k)
+    {
+        expr dk         = diff(ex, x[k], dc);
+
+        d1              += dir1[k].get_value() * eval(dk, dp).get_value();
+        d2              += dir2[k].get_value() * eval(dk, dp).get_value();
+
+        for (size_t l = 0; l < x.size(); ++l)
+        {
+            double h    = eval(diff(dk, x[l], dc), dp).get_value();
+            d12         += dir1[k].get_value() * dir2[l].get_value() * h;
+        };
+    };
+
+    if (is_close(dv.m_value.get_value(), v, 1e-14) == false)
+        ++n_failed;
+    if (is_close(dv.m_dif.get_value(), d1, 1e-12) == false)
+        ++n_failed;
+    if (is_close(hv.m_value.get_value(), v, 1e-14) == false)
+        ++n_failed;
+    if (is_close(hv.m_dif1.get_value(), d1, 1e-12) == false)
+        ++n_failed;
+    if (is_close(hv.m_dif2.get_value(), d2, 1e-12) == false)
+        ++n_failed;
+    if (is_close(hv.m_dif12.get_value(), d12, 1e-11) == false)
+        ++n_failed;
+
+    // symbols without direction
+    dual_value dv0      = eval_dual(ex, dp, std::vector<symbol>(), std::vector<value>(), dc);
+
+    if (dv0.m_dif.get_value() != 0.0)
+        ++n_failed;
+
+    // invalid size of direction
+    bool thrown         = false;
+
+    try
+    {
+        eval_dual(ex, dp, x, dir1, dc);
+        eval_dual(ex, dp, x, std::vector<value>(1), dc);
+    }
+    catch (std::exception&)
+    {
+        thrown          = true;
+    };
+
+    if (thrown == false)
+        ++n_failed;
+
+    if (n_failed == 0)
+        std::cout << "test_forward_diff: OK" << "\n";
+    else
+        std::cout << "test_forward_diff: FAILED " << n_failed << "\n";
+
+    // dual numbers versus symbolic diff and eval
+    int n_sym           = 200;
+    expr ex_big         = scalar::make_zero();
+    symbol y("y");
+
+    std::vector<symbol> syms;
+    std::vector<value> dir;
+
+    for (int i = 1; i <= n_sym; ++i)
+    {
+        std::ostringstream os;
+        os << "x" << i;
+        symbol xi       = symbol(os.str().c_str());
+
+        syms.push_back(xi);
+        dir.push_back(value(1.0 / i));
+
+        ex_big          = std::move(ex_big) + sin(xi * y) * exp(xi + power_int(y, 2))
+                        + function(usin, xi) * power_int(xi - y, 3);
+    };
+
+    ex_big.cannonize();
+
+    tic();
+    dual_value dv_big   = eval_dual(ex_big, dp, syms, dir, dc);
+    double t_dual       = toc();
+
+    tic();
+    expr dif_big        = scalar::make_zero();
+
+    for (int i = 0; i < n_sym; ++i)
+        dif_big         = std::move(dif_big) + dir[i] * diff(ex_big, syms[i], dc);
+
+    double dif_val      = eval(dif_big, dp).get_value();
+    double t_sym        = toc();
+
+    sym_arrow::ast::details::expr_complexity stats;
+    sym_arrow::ast::details::measure_complexity(dif_big.get_ptr().get(), stats);
+
+    if (is_close(dv_big.m_dif.get_value(), dif_val, 1e-10) == false)
+        std::cout << "test_forward_diff: FAILED (large expression)" << "\n";
+
+    std::cout << "dual numbers: " << t_dual << ", symbolic diff and eval: " << t_sym
+              << ", created nodes: " << stats.m_subnodes << "\n";
+};
+
+void test_set::test_reverse_diff()
+{
+    std::cout << "\n" << "test reverse diff:" << "\n";
+
+    diff_context dc;
+    symbol usin("usin");
+    symbol ucos("ucos");
+    symbol z("z");
+
+    dc.add_diff_rule(usin, 1, &z, 0, function(ucos, z));
+    dc.add_diff_rule(ucos, 1, &z, 0, -function(usin, z));
+
+    trig_data_provider dp;
+    size_t n_failed     = 0;
+
+    std::vector<symbol> x   = {symbol("x1"), symbol("x2"), symbol("x3")};
+    std::vector<value> xv;
+
+    for (const symbol& s : x)
+        xv.push_back(dp.get_value(s));
+
+    // user functions and symbols from data provider
+    {
+        symbol y("y5");
+
+        expr ex         = sin(x[0] * x[1]) + exp(x[2]) * power_real(x[0], value(2.5))
+                        + log(x[1] * power_int(y, 2)) * power_int(x[2], 3) 
+                        + atan2(x[0], x[2]) + tanh(x[0] - y) / x[2] 
+                        + function(usin, x[0] * x[2]) + erf(x[1]) * logistic(x[0]);
+
+        std::vector<value> grad;
+        value v         = eval_gradient(ex, x, xv, grad, dp, dc);
+
+        if (is_close(v.get_value(), eval(ex, dp).get_value(), 1e-14) == false)
+            ++n_failed;
+
+        for (size_t k = 0; k < x.size(); ++k)
+        {
+            double dk   = eval(diff(ex, x[k], dc), dp).get_value();
+
+            if (is_close(grad[k].get_value(), dk, 1e-12) == false)
+                ++n_failed;
+        };
+    };
+
+    // differentiation rules are evaluated at given values, not at values
+    // from data provider
+    {
+        std::vector<value> xv2  = {value(0.3), value(-0.8), value(1.2)};
+        double a[3]             = {0.3, -0.8, 1.2};
+
+        expr ex         = function(usin, x[0] * x[2]) + x[1] * function(ucos, x[1] + x[2]);
+
+        std::vector<value> grad;
+        value v         = eval_gradient(ex, x, xv2, grad, dp, dc);
+
+        double v_ref    = std::sin(a[0] * a[2]) + a[1] * std::cos(a[1] + a[2]);
+        double d_ref[3] = {std::cos(a[0] * a[2]) * a[2],
+                           std::cos(a[1] + a[2]) - a[1] * std::sin(a[1] + a[2]),
+                           std::cos(a[0] * a[2]) * a[0] - a[1] * std::sin(a[1] + a[2])};
+
+        if (is_close(v.get_value(), v_ref, 1e-14) == false)
+            ++n_failed;
+
+        for (size_t k = 0; k < x.size(); ++k)
+        {
+            if (is_close(grad[k].get_value(), d_ref[k], 1e-12) == false)
+                ++n_failed;
+        };
+    };
+
+    // log terms, zero factors and symbols given only by values
+    {
+        std::vector<value> xv0  = {value(0.0), value(-1.5), value(0.7)};
+
+        expr ex         = log(x[1] * power_int(x[2], 2)) + x[0] * x[1] * exp(x[2])
+                        + power_int(x[0] + x[2], -2) * sqrt(x[2]) + log(x[1]);
+
+        indexed_data_provider ip;
+
+        for (size_t k = 0; k < x.size(); ++k)
+            ip.set_value(x[k], xv0[k]);
+
+        std::vector<value> grad;
+        value v         = eval_gradient(ex, x, xv0, grad);
+
+        if (is_close(v.get_value(), eval(ex, ip).get_value(), 1e-14) == false)
+            ++n_failed;
+
+        for (size_t k = 0; k < x.size(); ++k)
+        {
+            double dk   = eval(diff(ex, x[k]), ip).get_value();
+
+            if (is_close(grad[k].get_value(), dk, 1e-12) == false)
+                ++n_failed;
+        };
+
+        // symbol without value
+        bool thrown     = false;
+
+        try
+        {
+            eval_gradient(ex * symbol("y"), x, xv0, grad);
+        }
+        catch (std::exception&)
+        {
+            thrown      = true;
+        };
+
+        if (thrown == false)
+            ++n_failed;
+    };
+
+    if (n_failed == 0)
+        std::cout << "test_reverse_diff: OK" << "\n";
+    else
+        std::cout << "test_reverse_diff: FAILED " << n_failed << "\n";
+
+    // cost of gradient relative to one evaluation
+    int n_sym           = 2000;
+    expr ex_big         = scalar::make_zero();
+    symbol y("y");
+
+    std::vector<symbol> syms;
+    std::vector<value> vals;
+
+    for (int i = 1; i <= n_sym; ++i)
+    {
+        std::ostringstream os;
+        os << "x" << i;
+        symbol xi       = symbol(os.str().c_str());
+
+        syms.push_back(xi);
+        vals.push_back(dp.get_value(xi));
+
+        ex_big          = std::move(ex_big) + power_int(xi - y, 2) * exp(-xi * y)
+                        + sin(xi) * tanh(xi * y);
+    };
+
+    syms.push_back(y);
+    vals.push_back(dp.get_value(y));
+
+    ex_big.cannonize();
+
+    size_t n_eval       = 10;
+    std::vector<value> grad;
+
+    tic();
+    for (size_t i = 0; i < n_eval; ++i)
+        eval(ex_big, dp);
+    double t_eval       = toc() / n_eval;
+
+    tic();
+    for (size_t i = 0; i < n_eval; ++i)
+        eval_gradient(ex_big, syms, vals, grad);
+    double t_grad       = toc() / n_eval;
+
+    std::cout << "parameters: " << syms.size() << ", eval time: " << t_eval 
+              << ", gradient time: " << t_grad << "\n";
+};
+
+// interval provider with intervals of symbols given by a box; other
+// symbols have interval [0.3, 0.7]; function usin is bounded by [-1, 1]
+class box_interval_provider : public interval_provider
+{
+    private:
+        std::vector<symbol>     m_syms;
+        std::vector<interval>   m_box;
+
+    public:
+        void set_box(const std::vector<symbol>& syms, const std::vector<interval>& box)
+        {
+            m_syms  = syms;
+            m_box   = box;
+        };
+
+        virtual interval get_interval(const symbol& sh) const override
+        {
+            for (size_t i = 0; i < m_syms.size(); ++i)
+            {
+                if (m_syms[i].get_symbol_code() == sh.get_symbol_code())
+                    return m_box[i];
+            };
+
+            return interval(value(0.3), value(0.7));
+        };
+
+        virtual interval eval_function(const symbol&, const interval*, size_t) const override
+        {
+            return interval(value(-1.0), value(1.0));
+        };
+};
+
+// data provider with values of symbols given by a point; function usin
+// is evaluated as sin
+class point_data_provider : public data_provider
+{
+    private:
+        std::vector<symbol>     m_syms;
+        std::vector<double>     m_point;
+        double                  m_default;
+
+    public:
+        void set_point(const std::vector<symbol>& syms, const std::vector<double>& point,
+                       double def)
+        {
+            m_syms      = syms;
+            m_point     = point;
+            m_default   = def;
+        };
+
+        virtual value get_value(const symbol& sh) const override
+        {
+            for (size_t i = 0; i < m_syms.size(); ++i)
+            {
+                if (m_syms[i].get_symbol_code() == sh.get_symbol_code())
+                    return value(m_point[i]);
+            };
+
+            return value(m_default);
+        };
+
+        virtual value eval_function(const symbol&, const value* args, size_t) const override
+        {
+            return value(std::sin(args[0].get_value()));
+        };
+};
+
+static interval rand_interval()
+{
+    double lo   = 4.0 * rand() - 2.0;
+    double w    = rand();
+
+    return interval(value(lo), value(lo + w));
+};
+
+void test_set::test_interval_eval()
+{
+    std::cout << "\n" << "test interval eval:" << "\n";
+
+    symbol usin("usin");
+    symbol y("y");
+
+    std::vector<symbol> x   = {symbol("x1"), symbol("x2"), symbol("x3")};
+    size_t n_failed     = 0;
+
+    expr ex             = sin(x[0] * x[1]) + exp(x[2]) * power_real(x[0], value(2.5))
+                        + log(x[1] * power_int(y, 2)) * power_int(x[2], 3)
+                        + atan2(x[0], x[2]) + tanh(x[0] - y) / x[2] + cos(x[2] * y)
+                        + function(usin, x[0] * x[2]) + erf(x[1]) * logistic(x[0])
+                        + sqrt(x[1] * x[1] + y);
+
+    size_t n_boxes      = 200;
+    size_t n_points     = 20;
+
+    std::vector<std::vector<interval>> boxes(n_boxes);
+    std::vector<interval> res_single(n_boxes);
+
+    box_interval_provider ip;
+    point_data_provider dp;
+
+    // values at random points of a box are in bounds
+    for (size_t k = 0; k < n_boxes; ++k)
+    {
+        for (size_t i = 0; i < x.size(); ++i)
+            boxes[k].push_back(rand_interval());
+
+        ip.set_box(x, boxes[k]);
+        res_single[k]   = eval_interval(ex, ip);
+
+        for (size_t j = 0; j < n_points; ++j)
+        {
+            std::vector<double> point;
+
+            for (size_t i = 0; i < x.size(); ++i)
+            {
+                double lo   = boxes[k][i].m_lower.get_value();
+                double hi   = boxes[k][i].m_upper.get_value();
+                point.push_back(lo + (hi - lo) * rand());
+            };
+
+            dp.set_point(x, point, 0.3 + 0.4 * rand());
+            value v     = eval(ex, dp);
+
+            if (v.is_finite() == false)
+                continue;
+
+            if (res_single[k].contains(v) == false)
+                ++n_failed;
+        };
+    };
+
+    // batched evaluation gives the same bounds
+    {
+        std::vector<interval> res_batch = eval_interval(ex, x, boxes, ip);
+
+        for (size_t k = 0; k < n_boxes; ++k)
+        {
+            if (res_batch[k].m_lower.get_value() != res_single[k].m_lower.get_value()
+                || res_batch[k].m_upper.get_value() != res_single[k].m_upper.get_value())
+            {
+                ++n_failed;
+            }
+        };
+    };
+
+    // even powers and periodic functions
+    {
+        std::vector<interval> box   = {interval(value(-1.0), value(2.0))};
+        ip.set_box({y}, box);
+
+        interval r1     = eval_interval(power_int(y, 2), ip);
+        interval r2     = eval_interval(sin(value(10.0) * y), ip);
+        interval r3     = eval_interval(exp(-y) * power_int(y, -2), ip);
+
+        if (r1.m_lower.get_value() < 0.0 || r1.m_upper.get_value() < 4.0)
+            ++n_failed;
+
+        if (r2.m_lower.get_value() != -1.0 || r2.m_upper.get_value() != 1.0)
+            ++n_failed;
+
+        if (r3.m_lower.get_value() < 0.0)
+            ++n_failed;
+    };
+
+    // invalid size of a box
+    {
+        bool thrown     = false;
+
+        try
+        {
+            std::vector<std::vector<interval>> box = {{interval()}};
+            eval_interval(ex, x, box, ip);
+        }
+        catch (std::exception&)
+        {
+            thrown      = true;
+        };
+
+        if (thrown == false)
+            ++n_failed;
+    };
+
+    if (n_failed == 0)
+        std::cout << "test_interval_eval: OK" << "\n";
+    else
+        std::cout << "test_interval_eval: FAILED " << n_failed << "\n";
+
+    // batched evaluation against evaluation of boxes one by one
+    int n_sym           = 200;
+    expr ex_big         = scalar::make_zero();
+    std::vector<symbol> syms;
+
+    for (int i = 1; i <= n_sym; ++i)
+    {
+        std::ostringstream os;
+        os << "x" << i;
+        symbol xi       = symbol(os.str().c_str());
+
+        syms.push_back(xi);
+        ex_big          = std::move(ex_big) + power_int(xi - y, 2) * exp(-xi * y)
+                        + sin(xi) * tanh(xi * y);
+    };
+
+    ex_big.cannonize();
+
+    size_t n_big        = 2000;
+    std::vector<std::vector<interval>> big_boxes(n_big);
+
+    for (size_t k = 0; k < n_big; ++k)
+    {
+        for (size_t i = 0; i < syms.size(); ++i)
+            big_boxes[k].push_back(rand_interval());
+    };
+
+    tic();
+    for (size_t k = 0; k < n_big; ++k)
+    {
+        ip.set_box(syms, big_boxes[k]);
+        eval_interval(ex_big, ip);
+    };
+    double t_single     = toc();
+
+    tic();
+    eval_interval(ex_big, syms, big_boxes, ip);
+    double t_batch      = toc();
+
+    std::cout << "boxes: " << n_big << ", single time: " << t_single 
+              << ", batch time: " << t_batch << "\n";
+};
+
+template<class T>
+static double as_double(const T& x)
+{
+    return double(x);
+};
+
+static double as_double(const double_double& x)
+{
+    return x.to_double();
+};
+
+static double as_double(const std::complex<double>& x)
+{
+    return x.real();
+};
+
+// evaluate compiled expressions at n_points points in numeric type T;
+// return relative difference to results in double precision and store
+// evaluation time in t
+template<class T>
+static double compiled_rel_error(const compiled_expr& ce, size_t n_points,
+                        const std::vector<double>& in, const std::vector<double>& out_ref,
+                        const data_provider& dp, double& t)
+{
+    std::vector<T> in_t;
+    std::vector<T> out(out_ref.size());
+
+    for (double v : in)
+        in_t.push_back(T(v));
+
+    // for T = double the template is called explicitly, not the overload
+    // for doubles
+    tic();
+    ce.template eval<T>(n_points, in_t.data(), out.data(), dp);
+    t                   = toc();
+
+    double err          = 0.0;
+
+    for (size_t i = 0; i < out.size(); ++i)
+    {
+        double dif      = std::abs(as_double(out[i]) - out_ref[i]);
+        err             = std::max(err, dif / (1.0 + std::abs(out_ref[i])));
+    };
+
+    return err;
+};
+
+void test_set::test_numeric_types()
+{
+    std::cout << "\n" << "test numeric types:" << "\n";
+
+    symbol x("x");
+    symbol y("y");
+    symbol usin("usin");
+
+    trig_data_provider dp;
+    size_t n_failed     = 0;
+
+    // double_double arithmetic
+    {
+        double_double a = double_double(1.0) / double_double(3.0) * 3.0 - 1.0;
+        double_double b = exp(log(double_double(2.5))) - 2.5;
+        double_double s, c;
+        sin_cos(double_double(0.7), s, c);
+
+        double_double e = s * s + c * c - 1.0;
+        double_double z = atan2(s, c) - 0.7;
+
+        if (std::abs(a.to_double()) > 1e-31 || std::abs(b.to_double()) > 1e-30
+            || std::abs(e.to_double()) > 1e-30 || std::abs(z.to_double()) > 1e-30)
+        {
+            ++n_failed;
+        };
+
+        if (std::abs(erf(double_double(0.5)).to_double() - std::erf(0.5)) > 1e-16
+            || std::abs(tanh(double_double(0.3)).to_double() - std::tanh(0.3)) > 1e-16)
+        {
+            ++n_failed;
+        };
+    };
+
+    std::vector<symbol> inputs{x, y};
+    size_t n_points     = 100;
+
+    std::vector<double> in(2 * n_points);
+
+    for (size_t j = 0; j < n_points; ++j)
+    {
+        in[j]               = 0.1 + 2.0 * rand();
+        in[n_points + j]    = 0.1 + 2.0 * rand();
+    };
+
+    // all real types agree with double
+    {
+        expr ex         = sin(x * y) * atan2(x, y) + logistic(y * x) - erf(tanh(y))
+                        + power_int(x + y, -3) + power_real(x, value(0.7)) * exp(-y)
+                        + log(x * y) + function(usin, x - y) + sqrt(x);
+
+        compiled_expr ce(ex, inputs);
+
+        std::vector<double> out(n_points);
+        ce.eval(n_points, in.data(), out.data(), dp);
+
+        double t;
+
+        if (compiled_rel_error<float>(ce, n_points, in, out, dp, t) > 1e-4)
+            ++n_failed;
+
+        if (compiled_rel_error<long double>(ce, n_points, in, out, dp, t) > 1e-13)
+            ++n_failed;
+
+        if (compiled_rel_error<double_double>(ce, n_points, in, out, dp, t) > 1e-13)
+            ++n_failed;
+
+        // double in template version is the same as in the original one
+        if (compiled_rel_error<double>(ce, n_points, in, out, dp, t) != 0.0)
+            ++n_failed;
+    };
+
+    // complex numbers
+    {
+        expr ex         = sin(x * y) + logistic(y * x) + power_int(x + y, -3)
+                        + exp(-y) * tanh(x) + cos(x) * log(y);
+
+        compiled_expr ce(ex, inputs);
+
+        std::vector<double> out(n_points);
+        ce.eval(n_points, in.data(), out.data(), dp);
+
+        double t;
+
+        if (compiled_rel_error<std::complex<double>>(ce, n_points, in, out, dp, t) > 1e-13)
+            ++n_failed;
+
+        // exp(i * t) = cos(t) + i sin(t)
+        compiled_expr ce_exp(exp(x) * y, inputs);
+
+        std::complex<double> in_c[2]    = {std::complex<double>(0.0, 0.8), 
+                                           std::complex<double>(2.0, 0.0)};
+        std::complex<double> out_c[1];
+        ce_exp.eval(in_c, out_c, dp);
+
+        if (std::abs(out_c[0] - 2.0 * std::complex<double>(std::cos(0.8), std::sin(0.8)))
+                > 1e-14)
+        {
+            ++n_failed;
+        };
+
+        // functions not available for complex numbers
+        std::vector<expr> ex_err    = {erf(x), function(usin, x)};
+
+        for (const expr& e : ex_err)
+        {
+            bool thrown     = false;
+
+            try
+            {
+                compiled_expr ce_err(e, inputs);
+                ce_err.eval(in_c, out_c, dp);
+            }
+            catch (std::exception&)
+            {
+                thrown      = true;
+            };
+
+            if (thrown == false)
+                ++n_failed;
+        };
+    };
+
+    // cancellation: (x + y)^2 - x^2 - 2xy = y^2
+    {
+        expr ex         = power_int(x + y, 2) - power_int(x, 2) - value(2.0) * x * y;
+        compiled_expr ce(ex, inputs);
+
+        double yv       = 1e-10;
+        double_double in_dd[2]  = {double_double(1.0), double_double(yv)};
+        double_double out_dd[1];
+
+        ce.eval(in_dd, out_dd, dp);
+
+        double_double y2    = double_double(yv) * yv;
+
+        if (std::abs((out_dd[0] - y2).to_double()) > 1e-12 * y2.to_double())
+            ++n_failed;
+
+        double in_d[2]  = {1.0, yv};
+        double out_d[1];
+        ce.eval(in_d, out_d, dp);
+
+        std::cout << "cancellation, double: " << out_d[0] << ", double_double: "
+                  << out_dd[0].to_double() << ", exact: " << y2.to_double() << "\n";
+    };
+
+    if (n_failed == 0)
+        std::cout << "test_numeric_types: OK" << "\n";
+    else
+        std::cout << "test_numeric_types: FAILED " << n_failed << "\n";
+
+    // throughput of compiled expressions for each numeric type
+    int n_sym           = 200;
+    expr ex_big         = scalar::make_zero();
+    std::vector<symbol> syms;
+
+    for (int i = 1; i <= n_sym; ++i)
+    {
+        std::ostringstream os;
+        os << "x" << i;
+        symbol xi       = symbol(os.str().c_str());
+
+        syms.push_back(xi);
+        ex_big          = std::move(ex_big) + power_int(xi - y, 2) * exp(-xi * y)
+                        + sin(xi) * tanh(xi * y) + power_real(xi, value(1.5));
+    };
+
+    syms.push_back(y);
+
+    size_t n_big        = 1000;
+    std::vector<double> in_big(syms.size() * n_big);
+
+    for (size_t i = 0; i < in_big.size(); ++i)
+        in_big[i]       = rand();
+
+    compiled_expr ce_big(ex_big, syms);
+
+    std::vector<double> out_big(n_big);
+    ce_big.eval(n_big, in_big.data(), out_big.data(), dp);
+
+    double t_f, t_d, t_ld, t_c, t_dd;
+    compiled_rel_error<float>(ce_big, n_big, in_big, out_big, dp, t_f);
+    compiled_rel_error<double>(ce_big, n_big, in_big, out_big, dp, t_d);
+    compiled_rel_error<long double>(ce_big, n_big, in_big, out_big, dp, t_ld);
+    compiled_rel_error<std::complex<double>>(ce_big, n_big, in_big, out_big, dp, t_c);
+    compiled_rel_error<double_double>(ce_big, n_big, in_big, out_big, dp, t_dd);
+
+    std::cout << "instructions: " << ce_big.num_instructions() << ", points: " << n_big 
+              << "\n";
+    std::cout << "float: " << t_f << ", double: " << t_d << ", long double: " << t_ld
+              << ", complex: " << t_c << ", double_double: " << t_dd << "\n";
+};
+
+void test_set::test_sparse_poly()
+{
+    std::cout << "\n" << "test sparse_poly:" << "\n";
+
+    symbol x("x");
+    symbol y("y");
+    symbol z("z");
+
+    suffix_data_provider dp;
+    size_t n_failed     = 0;
+
+    // Legendre polynomials from the Bonnet recurrence:
+    // (n+1) P_{n+1} = (2n+1) x P_n - n P_{n-1}
+    std::vector<symbol> sx{x};
+    int deg             = 30;
+
+    expr e0             = value(1.0);
+    expr e1             = x;
+    sparse_poly p0(sx, value(1.0));
+    sparse_poly p1      = sparse_poly::make_symbol(sx, 0);
+
+    for (int n = 1; n < deg; ++n)
+    {
+        value a         = value(double(2 * n + 1) / double(n + 1));
+        value b         = value(double(n) / double(n + 1));
+
+        expr e2         = expand(a * x * e1 - b * e0);
+        sparse_poly p2  = a * p1 * sparse_poly::make_symbol(sx, 0) - b * p0;
+
+        e0              = std::move(e1);
+        e1              = std::move(e2);
+        p0              = std::move(p1);
+        p1              = std::move(p2);
+    };
+
+    if (p1.degree(0) != deg || p1.size() != size_t(deg / 2 + 1))
+        ++n_failed;
+
+    // P_n(1) = 1
+    value one           = value(1.0);
+
+    if (std::abs(p1.eval(&one).get_value() - 1.0) > 1e-10)
+        ++n_failed;
+
+    double v0           = eval(e1, dp).get_value();
+    double v1           = p1.eval(dp).get_value();
+
+    if (std::abs(v0 - v1) > 1e-10 * (1.0 + std::abs(v0)))
+        ++n_failed;
+
+    // conversions
+    sparse_poly p_conv(e1, sx);
+
+    if (p_conv.size() != p1.size())
+        ++n_failed;
+
+    if (std::abs(p_conv.eval(dp).get_value() - v1) > 1e-10 * (1.0 + std::abs(v1)))
+        ++n_failed;
+
+    if (std::abs(eval(p1.to_expr(), dp).get_value() - v1) > 1e-10 * (1.0 + std::abs(v1)))
+        ++n_failed;
+
+    if (sparse_poly::is_polynomial(e1, sx) == false)
+        ++n_failed;
+
+    if (sparse_poly::is_polynomial(e1 + exp(x), sx) == true)
+        ++n_failed;
+
+    if (sparse_poly::is_polynomial(e1 * y, sx) == true)
+        ++n_failed;
+
+    // repeated differentiation
+    int n_diff          = 10;
+
+    tic();
+    expr de             = e1;
+
+    for (int i = 0; i < n_diff; ++i)
+        de              = diff(de, x);
+
+    double t_expr       = toc();
+
+    tic();
+    sparse_poly dp1     = p1;
+
+    for (int i = 0; i < n_diff; ++i)
+        dp1             = dp1.diff(0);
+
+    double t_poly       = toc();
+
+    v0                  = eval(de, dp).get_value();
+    v1                  = dp1.eval(dp).get_value();
+
+    if (std::abs(v0 - v1) > 1e-8 * (1.0 + std::abs(v0)))
+        ++n_failed;
+
+    if (p1.diff(x, n_diff).size() != dp1.size() || p1.diff(y).is_zero() == false)
+        ++n_failed;
+
+    // multivariate power
+    std::vector<symbol> sxyz{x, y, z};
+    expr s              = value(1.0) + x + value(2.0) * y - z;
+    int pow             = 10;
+
+    tic();
+    sparse_poly ps      = sparse_poly(s, sxyz).power(pow);
+    double t_pow        = toc();
+
+    expr s_exp          = expand(power_int(s, pow));
+
+    if (ps.size() != num_terms(s_exp))
+        ++n_failed;
+
+    v0                  = eval(s_exp, dp).get_value();
+    v1                  = ps.eval(dp).get_value();
+
+    if (std::abs(v0 - v1) > 1e-10 * std::abs(v0))
+        ++n_failed;
+
+    if ((ps - ps).is_zero() == false)
+        ++n_failed;
+
+    // overflow of packed exponents
+    bool thrown         = false;
+
+    try
+    {
+        sparse_poly::make_symbol(sxyz, 0).power(ps.max_exponent() + 1);
+    }
+    catch (std::exception&)
+    {
+        thrown          = true;
+    };
+
+    if (thrown == false)
+        ++n_failed;
+
+    // polynomial is not modified when multiplication by a monomial
+    // overflows only in some terms
+    {
+        sparse_poly px0     = sparse_poly::make_symbol(sxyz, 0);
+        sparse_poly p_big   = px0.power(ps.max_exponent()) + sparse_poly(sxyz, value(1.0));
+        sparse_poly p_copy  = p_big;
+
+        thrown              = false;
+
+        try
+        {
+            p_big           *= px0;
+        }
+        catch (std::exception&)
+        {
+            thrown          = true;
+        };
+
+        if (thrown == false || (p_big - p_copy).is_zero() == false)
+            ++n_failed;
+    };
+
+    if (n_failed == 0)
+        std::cout << "test_sparse_poly: OK" << "\n";
+    else
+        std::cout << "test_sparse_poly: FAILED " << n_failed << "\n";
+
+    std::cout << "expr diff: " << t_expr << ", sparse_poly diff: " << t_poly
+              << ", sparse_poly power: " << t_pow << "\n";
+};
 
 }};
@@ -33,6 +33,34 @@ struct test_set
         static void     test_special_cases();
         static void     test_diff_context();
         static void     test_harmonics();
+        static void     test_codegen();
+        static void     test_compiled_expr();
+        static void     test_parse();
+        static void     test_parse_file();
+        static void     test_sum_builder();
+        static void     test_cse_policy();
+        static void     test_extract_cse();
+        static void     test_cse_predictor();
+        static void     test_parallel_cannonize();
+        static void     test_item_collector();
+        static void     test_expr_edit();
+        static void     test_deterministic_order(const char* program);
+        static void     test_lazy_cannonize();
+        static void     test_expand();
+        static void     test_sparse_poly();
+        static void     test_subs_shared();
+        static void     test_diff_rules();
+        static void     test_subs_batch();
+        static void     test_builtin_functions();
+        static void     test_static_eval();
+        static void     test_forward_diff();
+        static void     test_reverse_diff();
+        static void     test_interval_eval();
+        static void     test_numeric_types();
+
+        // workload of test_deterministic_order run in a new process with
+        // deterministic ordering; results are written to file
+        static int      run_deterministic_order(const char* file);
 
 	    static void     test_random_diff(size_t n_rep);
         static void     test_diff();